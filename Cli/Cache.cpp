@@ -0,0 +1,326 @@
+#include "Cache.h"
+#include "ConvertJob.h"
+#include "Version.h"
+#include <array>
+#include <bee/Hash.h>
+#include <bee/polyfills/filesystem.h>
+#include <bit>
+#include <fmt/format.h>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace beecli {
+namespace {
+/// <summary>
+/// Bumped when the entry layout changes.
+/// </summary>
+constexpr std::uint64_t cacheFormatVersion = 2;
+
+void update_string(bee::Hasher64 &hasher_, std::u8string_view string_) {
+  hasher_.update(static_cast<std::uint64_t>(string_.size()));
+  hasher_.update(std::as_bytes(std::span{string_.data(), string_.size()}));
+}
+
+std::string to_hex(std::uint64_t hash_) {
+  return fmt::format("{:016x}", hash_);
+}
+
+std::string to_string(std::u8string_view string_) {
+  return std::string{string_.begin(), string_.end()};
+}
+
+std::u8string to_u8string(std::string_view string_) {
+  return std::u8string{string_.begin(), string_.end()};
+}
+
+/// <summary>
+/// The job's output files, relative to the output file's directory.
+/// </summary>
+std::vector<std::u8string>
+get_output_files(const ConvertJob &job_,
+                 const bee::glTF_output &glTF_output_) {
+  namespace fs = bee::filesystem;
+  const auto outDir = fs::path{job_.outFile}.parent_path();
+
+  std::vector<std::u8string> outputFiles;
+  const auto add = [&](const fs::path &file_) {
+    const auto relative = file_.lexically_relative(outDir);
+    if (relative.empty() || *relative.begin() == "..") {
+      throw std::runtime_error("Output " + file_.string() +
+                               " is outside of the output directory.");
+    }
+    outputFiles.push_back(relative.generic_u8string());
+  };
+
+  add(fs::path{job_.outFile});
+  for (const auto &file : job_.writer->files()) {
+    add(fs::path{file});
+  }
+  for (const auto &file : glTF_output_.copied_files) {
+    add(fs::path{file});
+  }
+  return outputFiles;
+}
+} // namespace
+
+std::uint64_t hash_convert_options(const bee::ConvertOptions &options_) {
+  // Keep in sync with `bee::ConvertOptions`.
+  // `writer`, `logger`, `verbose` and `mesh_threads` don't affect the output.
+  bee::Hasher64 hasher;
+  update_string(hasher, options_.out);
+  hasher.update(static_cast<std::uint64_t>(options_.fbmDir.has_value()));
+  update_string(hasher, options_.fbmDir.value_or(u8""));
+  hasher.update(static_cast<std::uint64_t>(options_.glb));
+  hasher.update(static_cast<std::uint64_t>(options_.compact_json));
+  hasher.update(static_cast<std::uint64_t>(options_.useDataUriForBuffers));
+  hasher.update(static_cast<std::uint64_t>(options_.bufferPartition.per_mesh));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.bufferPartition.per_animation));
+  hasher.update(static_cast<std::uint64_t>(options_.bufferPartition.per_image));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.bufferPartition.max_buffer_size));
+  hasher.update(static_cast<std::uint64_t>(options_.unitConversion));
+  hasher.update(static_cast<std::uint64_t>(options_.noFlipV));
+  hasher.update(static_cast<std::uint64_t>(options_.animationBakeRate));
+  hasher.update(static_cast<std::uint64_t>(options_.prefer_local_time_span));
+  hasher.update(static_cast<std::uint64_t>(options_.match_mesh_names));
+  hasher.update(static_cast<std::uint64_t>(options_.preserve_mesh_instances));
+  hasher.update(static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(
+      options_.animation_position_error_multiplier)));
+  hasher.update(static_cast<std::uint64_t>(
+      std::bit_cast<std::uint32_t>(options_.animation_scale_error_multiplier)));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.textureResolution.disabled));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.textureResolution.locations.size()));
+  for (const auto &location : options_.textureResolution.locations) {
+    update_string(hasher, location);
+  }
+  hasher.update(static_cast<std::uint64_t>(options_.pathMode));
+  hasher.update(static_cast<std::uint64_t>(options_.export_skin));
+  hasher.update(static_cast<std::uint64_t>(options_.export_blend_shape));
+  hasher.update(static_cast<std::uint64_t>(options_.export_trs_animation));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.export_blend_shape_animation));
+  hasher.update(static_cast<std::uint64_t>(
+      std::bit_cast<std::uint32_t>(options_.sparseMorphTargets.epsilon)));
+  hasher.update(static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(
+      options_.sparseMorphTargets.max_size_ratio)));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshOptimization.vertex_cache));
+  hasher.update(static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(
+      options_.meshOptimization.overdraw_threshold)));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshOptimization.vertex_fetch));
+  // The count keeps levels from running into what follows.
+  hasher.update(
+      static_cast<std::uint64_t>(options_.levelsOfDetail.levels.size()));
+  for (const auto &level : options_.levelsOfDetail.levels) {
+    hasher.update(
+        static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(level.ratio)));
+    hasher.update(static_cast<std::uint64_t>(
+        std::bit_cast<std::uint32_t>(level.max_error)));
+  }
+  hasher.update(static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(
+      options_.levelsOfDetail.screen_error)));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshQuantization.position_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshQuantization.normal_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshQuantization.uv_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshQuantization.color_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshoptCompression.enabled));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.meshoptCompression.fallback));
+  hasher.update(static_cast<std::uint64_t>(
+      options_.meshoptCompression.octahedral_normals));
+  hasher.update(static_cast<std::uint64_t>(
+      options_.meshoptCompression.quaternion_bits));
+  hasher.update(static_cast<std::uint64_t>(
+      options_.meshoptCompression.exponential_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.dracoCompression.enabled));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.dracoCompression.fallback));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.dracoCompression.position_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.dracoCompression.normal_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.dracoCompression.uv_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.dracoCompression.color_bits));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.dracoCompression.generic_bits));
+  hasher.update(static_cast<std::uint64_t>(options_.dracoCompression.speed));
+  hasher.update(static_cast<std::uint64_t>(options_.gpuInstancing.enabled));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.gpuInstancing.min_instances));
+  hasher.update(
+      static_cast<std::uint64_t>(options_.export_fbx_file_header_info));
+  hasher.update(static_cast<std::uint64_t>(options_.export_raw_materials));
+  return hasher.digest();
+}
+
+std::uint64_t hash_file(std::u8string_view path_) {
+  namespace fs = bee::filesystem;
+  std::ifstream stream{fs::path{path_}, std::ios::binary};
+  if (!stream) {
+    throw std::runtime_error("Failed to read " + to_string(path_));
+  }
+
+  bee::Hasher64 hasher;
+  std::vector<char> chunk(1024 * 1024);
+  while (stream) {
+    stream.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+    hasher.update(std::string_view{chunk.data(),
+                                   static_cast<std::size_t>(stream.gcount())});
+  }
+  if (stream.bad()) {
+    throw std::runtime_error("Failed to read " + to_string(path_));
+  }
+  return hasher.digest();
+}
+
+std::string ConversionCache::key(const ConvertJob &job_) const {
+  namespace fs = bee::filesystem;
+
+  bee::Hasher64 hasher;
+  hasher.update(cacheFormatVersion);
+  hasher.update(version_string);
+  hasher.update(hash_convert_options(job_.convertOptions));
+  update_string(hasher, fs::absolute(fs::path{job_.inputFile})
+                            .parent_path()
+                            .lexically_normal()
+                            .generic_u8string());
+  hasher.update(hash_file(job_.inputFile));
+  return to_hex(hasher.digest());
+}
+
+bool ConversionCache::restore(std::string_view key_,
+                              const ConvertJob &job_) const {
+  namespace fs = bee::filesystem;
+
+  const auto entryDir = fs::path{_dir} / fs::path{to_u8string(key_)};
+  const auto entryFile = entryDir / "entry.json";
+  std::error_code err;
+  if (!fs::is_regular_file(entryFile, err)) {
+    return false;
+  }
+
+  bee::Json entry;
+  {
+    std::ifstream stream{entryFile};
+    stream.exceptions(std::ios::badbit | std::ios::failbit);
+    entry = bee::Json::parse(stream);
+  }
+
+  for (const auto &referencedFile : entry.at("referencedFiles")) {
+    const auto path = to_u8string(referencedFile.at("path").get<std::string>());
+    if (!fs::is_regular_file(fs::path{path}, err)) {
+      return false;
+    }
+    if (to_hex(hash_file(path)) !=
+        referencedFile.at("hash").get<std::string>()) {
+      return false;
+    }
+  }
+
+  for (const auto &unresolvedFile : entry.at("unresolvedFiles")) {
+    const auto path = to_u8string(unresolvedFile.get<std::string>());
+    if (fs::exists(fs::path{path}, err)) {
+      return false;
+    }
+  }
+
+  const auto outDir = fs::path{job_.outFile}.parent_path();
+  const auto outputs = entry.at("outputs");
+  if (outputs.empty() ||
+      fs::path{to_u8string(outputs.front().get<std::string>())} !=
+          fs::path{job_.outFile}.filename()) {
+    return false;
+  }
+  for (const auto &output : outputs) {
+    const auto relative = fs::path{to_u8string(output.get<std::string>())};
+    const auto target = outDir / relative;
+    fs::create_directories(target.parent_path());
+    fs::copy_file(entryDir / "files" / relative, target,
+                  fs::copy_options::overwrite_existing);
+  }
+  return true;
+}
+
+void ConversionCache::store(std::string_view key_,
+                            const ConvertJob &job_,
+                            const bee::glTF_output &glTF_output_) const {
+  namespace fs = bee::filesystem;
+
+  const auto entryDir = fs::path{_dir} / fs::path{to_u8string(key_)};
+  std::error_code err;
+  if (fs::exists(entryDir, err)) {
+    return;
+  }
+
+  auto entry = bee::Json::object();
+
+  auto referencedFiles = bee::Json::array();
+  for (const auto &referencedFile : glTF_output_.referenced_files) {
+    const auto path = fs::absolute(fs::path{referencedFile})
+                          .lexically_normal()
+                          .u8string();
+    referencedFiles.push_back(bee::Json{
+        {"path", to_string(path)},
+        {"hash", to_hex(hash_file(path))},
+    });
+  }
+  entry["referencedFiles"] = std::move(referencedFiles);
+
+  auto unresolvedFiles = bee::Json::array();
+  for (const auto &unresolvedFile : glTF_output_.unresolved_files) {
+    unresolvedFiles.push_back(to_string(fs::absolute(fs::path{unresolvedFile})
+                                            .lexically_normal()
+                                            .u8string()));
+  }
+  entry["unresolvedFiles"] = std::move(unresolvedFiles);
+
+  // Populate a staging directory then publish it by renaming.
+  const auto stagingDir =
+      fs::path{_dir} /
+      fs::path{to_u8string(fmt::format("{}.{:08x}.tmp", key_,
+                                       std::random_device{}()))};
+  try {
+    const auto outDir = fs::path{job_.outFile}.parent_path();
+    const auto outputs = get_output_files(job_, glTF_output_);
+    for (const auto &output : outputs) {
+      const auto relative = fs::path{output};
+      const auto target = stagingDir / "files" / relative;
+      fs::create_directories(target.parent_path());
+      fs::copy_file(outDir / relative, target,
+                    fs::copy_options::overwrite_existing);
+    }
+    entry["outputs"] = bee::Json::array();
+    for (const auto &output : outputs) {
+      entry["outputs"].push_back(to_string(output));
+    }
+
+    {
+      std::ofstream stream{stagingDir / "entry.json"};
+      stream.exceptions(std::ios::badbit | std::ios::failbit);
+      stream << entry.dump(2);
+    }
+
+    fs::rename(stagingDir, entryDir, err);
+    if (err) {
+      // Most likely, another process stored the same entry meanwhile.
+      fs::remove_all(stagingDir, err);
+    }
+  } catch (...) {
+    fs::remove_all(stagingDir, err);
+    throw;
+  }
+}
+} // namespace beecli
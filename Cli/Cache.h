@@ -0,0 +1,60 @@
+#pragma once
+
+#include <bee/Converter.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace beecli {
+struct ConvertJob;
+
+/// <summary>
+/// On-disk cache of conversion outputs, placed in front of `bee::convert()`.
+///
+/// An entry is keyed on the hash of the input file's content, the convert
+/// options, the input file's directory(which relative texture paths are
+/// resolved against) and the tool version. Which textures are referenced is
+/// only known after conversion, so the entry records them along with their
+/// content hashes, and the paths textures were looked for at in vain; a lookup
+/// hits only if the former are unchanged and none of the latter exists.
+///
+/// Entries are directories `<cache-dir>/<key>/` holding `entry.json` and the
+/// output files. They're published by renaming, so concurrent writers are
+/// fine.
+/// </summary>
+class ConversionCache {
+public:
+  ConversionCache(std::u8string_view dir_) : _dir(dir_) {
+  }
+
+  /// <exception cref="std::exception">
+  /// The input file can not be read.
+  /// </exception>
+  std::string key(const ConvertJob &job_) const;
+
+  /// <summary>
+  /// Restores the job's output files from the entry.
+  /// </summary>
+  /// <returns>False if there's no valid entry.</returns>
+  bool restore(std::string_view key_, const ConvertJob &job_) const;
+
+  /// <summary>
+  /// Stores the job's output files, which shall have been written, as the
+  /// entry.
+  /// </summary>
+  void store(std::string_view key_,
+             const ConvertJob &job_,
+             const bee::glTF_output &glTF_output_) const;
+
+private:
+  std::u8string _dir;
+};
+
+/// <summary>
+/// Hashes the options affecting the conversion output.
+/// </summary>
+std::uint64_t hash_convert_options(const bee::ConvertOptions &options_);
+
+std::uint64_t hash_file(std::u8string_view path_);
+} // namespace beecli
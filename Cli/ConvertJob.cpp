@@ -0,0 +1,216 @@
+#include "ConvertJob.h"
+#include "Cache.h"
+#include <algorithm>
+#include <bee/GLBWriter.h>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+
+namespace beecli {
+std::u8string relativeUriBetweenPath(const bee::filesystem::path &from_,
+                                     const bee::filesystem::path &to_) {
+  return to_.lexically_relative(from_).generic_u8string();
+}
+
+void ConsoleLogger::operator()(Level level_, bee::Json &&message_) {
+  const auto text = message_.dump(2);
+  (*this)(level_,
+          std::u8string_view{reinterpret_cast<const char8_t *>(text.data()),
+                             text.size()});
+}
+
+void ConsoleLogger::operator()(Level level_, std::u8string_view message_) {
+  auto &stream = level_ >= bee::Logger::Level::error ? std::cerr : std::cout;
+  // Batch jobs log from worker threads.
+  std::unique_lock lock{_streamMutex};
+  stream << _prefix
+         << std::string{reinterpret_cast<const char *>(message_.data()),
+                        message_.size()}
+         << "\n";
+}
+
+void JsonLogger::operator()(Level level_, bee::Json &&message_) {
+  _messages.push_back(bee::Json{{"level", level_}, {"message", message_}});
+}
+
+void JsonLogger::operator()(Level level_, std::u8string_view message_) {
+  (*this)(level_, bee::Json(std::string_view{
+                      reinterpret_cast<const char *>(message_.data()),
+                      message_.size()}));
+}
+
+std::optional<std::u8string> BufferWriter::buffer(const std::byte *data_,
+                                                 std::size_t size_,
+                                                 std::uint32_t index_,
+                                                 bool multi_) {
+  const bee::SegmentedBuffer::Segment segment{data_, size_};
+  return _write(std::span{&segment, 1}, index_, multi_);
+}
+
+std::optional<std::u8string>
+BufferWriter::buffer(const bee::SegmentedBuffer &buffer_,
+                     std::uint32_t index_,
+                     bool multi_) {
+  return _write(buffer_.segments(), index_, multi_);
+}
+
+std::u8string
+BufferWriter::_write(std::span<const bee::SegmentedBuffer::Segment> segments_,
+                     std::uint32_t index_,
+                     bool multi_) {
+  namespace fs = bee::filesystem;
+
+  const auto outFilePath = fs::path{_outFile};
+  const auto glTFOutBaseName = outFilePath.stem();
+  const auto glTFOutDir = outFilePath.parent_path();
+  const auto bufferOutPath =
+      glTFOutDir /
+      (multi_ ? (glTFOutBaseName.string() + std::to_string(index_) + ".bin")
+              : (glTFOutBaseName.string() + ".bin"));
+  std::error_code errc;
+  fs::create_directories(bufferOutPath.parent_path(), errc);
+  if (errc) {
+    throw std::runtime_error("Failed to create directories for buffer " +
+                             bufferOutPath.string());
+  }
+
+  bee::OutputFile file{bufferOutPath.u8string()};
+  file.write(segments_);
+  file.close();
+  _files.push_back(bufferOutPath.u8string());
+
+  return relativeUriBetweenPath(glTFOutDir, bufferOutPath);
+}
+
+bee::filesystem::path default_out_file_path(std::u8string_view input_file_,
+                                            std::u8string_view out_dir_,
+                                            bool glb_) {
+  namespace fs = bee::filesystem;
+  const auto inputFilePath = fs::path{input_file_};
+  const auto inputBaseNameNoExt = inputFilePath.stem().string();
+  const auto outDir = out_dir_.empty() ? fs::current_path() : fs::path{out_dir_};
+  return outDir / (inputBaseNameNoExt + "_glTF") /
+         (inputBaseNameNoExt + (glb_ ? ".glb" : ".gltf"));
+}
+
+ConvertJob make_convert_job(const CliArgs &cli_args_,
+                            std::u8string_view input_file_,
+                            std::unique_ptr<bee::Logger> logger_) {
+  namespace fs = bee::filesystem;
+
+  ConvertJob job;
+  job.inputFile = input_file_;
+  job.convertOptions = cli_args_.convertOptions;
+
+  if (!cli_args_.fbmDir.empty()) {
+    job.convertOptions.fbmDir = cli_args_.fbmDir;
+  }
+
+  if (cli_args_.outFile.empty()) {
+    const auto outFilePath = default_out_file_path(
+        input_file_, cli_args_.outDir, job.convertOptions.glb);
+    fs::create_directories(outFilePath.parent_path());
+    job.outFile = outFilePath.u8string();
+  } else {
+    job.outFile = cli_args_.outFile;
+  }
+  job.convertOptions.out = job.outFile;
+  { // Deduce .glb from output path
+    const auto extension = fs::path(job.outFile).extension().string();
+    std::string extensionLower = extension;
+    std::transform(extensionLower.begin(), extensionLower.end(),
+                   extensionLower.begin(), ::tolower);
+    if (extensionLower == ".glb") {
+      job.convertOptions.glb = true;
+    }
+  }
+
+  job.writer = std::make_unique<BufferWriter>(job.outFile);
+  job.convertOptions.useDataUriForBuffers = false;
+  job.convertOptions.writer = job.writer.get();
+
+  job.logger = std::move(logger_);
+  job.convertOptions.logger = job.logger.get();
+
+  job.cacheDir = cli_args_.cacheDir;
+
+  return job;
+}
+
+bool restore_cached_output(ConvertJob &job_) {
+  if (job_.cacheDir.empty()) {
+    return false;
+  }
+
+  const auto warn = [&job_](std::string_view what_) {
+    (*job_.logger)(bee::Logger::Level::warning,
+                   u8"Conversion cache: " +
+                       std::u8string{what_.begin(), what_.end()});
+  };
+
+  const ConversionCache cache{job_.cacheDir};
+  try {
+    job_.cacheKey = cache.key(job_);
+  } catch (const std::exception &exception) {
+    warn(exception.what());
+    return false;
+  }
+
+  try {
+    if (cache.restore(*job_.cacheKey, job_)) {
+      (*job_.logger)(bee::Logger::Level::info,
+                     u8"Restored outputs from the conversion cache.");
+      return true;
+    }
+  } catch (const std::exception &exception) {
+    warn(exception.what());
+  }
+  return false;
+}
+
+void write_glTF_output(ConvertJob &job_, const bee::glTF_output &glTF_output_) {
+  bee::ConvertStats::Phase writePhase;
+  std::optional<bee::ScopedPhase> writePhaseScope{writePhase};
+
+  const auto glbOut = job_.convertOptions.glb;
+  if (!glbOut) {
+    assert(!glTF_output_.glb_stored_buffer &&
+           "Should not have GLB stored buffer in such case!");
+    bee::OutputFile glTFFile{job_.outFile};
+    glTFFile.write(std::as_bytes(std::span{glTF_output_.json_text}));
+    glTFFile.close();
+  } else {
+    bee::OutputFile glbFile{job_.outFile};
+    bee::write_glb(glbFile, glTF_output_.json_text,
+                   glTF_output_.glb_stored_buffer
+                       ? &*glTF_output_.glb_stored_buffer
+                       : nullptr);
+    glbFile.close();
+  }
+
+  writePhaseScope.reset();
+  job_.stats = glTF_output_.stats;
+  (*job_.stats)["phases"]["write"] = writePhase;
+
+  if (job_.cacheKey) {
+    try {
+      ConversionCache{job_.cacheDir}.store(*job_.cacheKey, job_, glTF_output_);
+    } catch (const std::exception &exception) {
+      const std::string_view what = exception.what();
+      (*job_.logger)(bee::Logger::Level::warning,
+                     u8"Conversion cache: " +
+                         std::u8string{what.begin(), what.end()});
+    }
+  }
+}
+
+void write_json_log(std::u8string_view log_file_, const bee::Json &log_) {
+  namespace fs = bee::filesystem;
+  const auto logFilePath = fs::path{log_file_};
+  fs::create_directories(logFilePath.parent_path());
+  std::ofstream jsonLogOStream{logFilePath};
+  jsonLogOStream.exceptions(std::ios::badbit | std::ios::failbit);
+  const auto jsonLogText = log_.dump(2);
+  jsonLogOStream << jsonLogText;
+}
+} // namespace beecli
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "ReadCliArgs.h"
+#include <bee/Converter.h>
+#include <bee/polyfills/filesystem.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace beecli {
+std::u8string relativeUriBetweenPath(const bee::filesystem::path &from_,
+                                     const bee::filesystem::path &to_);
+
+class ConsoleLogger : public bee::Logger {
+public:
+  ConsoleLogger() = default;
+
+  /// <param name="prefix_">
+  /// Prepended to each message. Used to tell apart messages of batch jobs.
+  /// </param>
+  ConsoleLogger(std::string_view prefix_) : _prefix(prefix_) {
+  }
+
+  void operator()(Level level_, bee::Json &&message_) override;
+
+  void operator()(Level level_, std::u8string_view message_) override;
+
+private:
+  std::string _prefix;
+  inline static std::mutex _streamMutex;
+};
+
+class JsonLogger : public bee::Logger {
+public:
+  void operator()(Level level_, bee::Json &&message_) override;
+
+  void operator()(Level level_, std::u8string_view message_) override;
+
+  const bee::Json &messages() const {
+    return _messages;
+  }
+
+private:
+  bee::Json _messages = bee::Json::array();
+};
+
+/// <summary>
+/// Writes buffers as `.bin` files next to the output file.
+/// </summary>
+class BufferWriter : public bee::GLTFWriter {
+public:
+  BufferWriter(std::u8string_view out_file_) : _outFile(out_file_) {
+  }
+
+  virtual std::optional<std::u8string> buffer(const std::byte *data_,
+                                              std::size_t size_,
+                                              std::uint32_t index_,
+                                              bool multi_);
+
+  virtual std::optional<std::u8string>
+  buffer(const bee::SegmentedBuffer &buffer_,
+         std::uint32_t index_,
+         bool multi_);
+
+  /// <summary>
+  /// Paths of the buffers written.
+  /// </summary>
+  const std::vector<std::u8string> &files() const {
+    return _files;
+  }
+
+private:
+  std::u8string _outFile;
+  std::vector<std::u8string> _files;
+
+  std::u8string
+  _write(std::span<const bee::SegmentedBuffer::Segment> segments_,
+         std::uint32_t index_,
+         bool multi_);
+};
+
+/// <summary>
+/// Everything needed to convert a single input file.
+/// </summary>
+struct ConvertJob {
+  std::u8string inputFile;
+  std::u8string outFile;
+  bee::ConvertOptions convertOptions;
+  std::unique_ptr<BufferWriter> writer;
+  std::unique_ptr<bee::Logger> logger;
+  /// <summary>
+  /// Empty if the cache is not used.
+  /// </summary>
+  std::u8string cacheDir;
+  /// <summary>
+  /// Set by `restore_cached_output()`.
+  /// </summary>
+  std::optional<std::string> cacheKey;
+  /// <summary>
+  /// Set by `write_glTF_output()`: the conversion stats plus the time spent
+  /// writing outputs.
+  /// </summary>
+  std::optional<bee::Json> stats;
+};
+
+bee::filesystem::path default_out_file_path(std::u8string_view input_file_,
+                                            std::u8string_view out_dir_,
+                                            bool glb_);
+
+/// <summary>
+/// Note the job references `cli_args_`, which shall outlive the job.
+/// </summary>
+ConvertJob make_convert_job(const CliArgs &cli_args_,
+                            std::u8string_view input_file_,
+                            std::unique_ptr<bee::Logger> logger_);
+
+/// <summary>
+/// If the job uses the cache, looks up its outputs there.
+/// Failures of the cache are logged as warnings and count as misses.
+/// </summary>
+/// <returns>True if the outputs have been restored from the cache.</returns>
+bool restore_cached_output(ConvertJob &job_);
+
+/// <summary>
+/// Writes the output files. They're stored to the cache if the job uses it.
+/// </summary>
+void write_glTF_output(ConvertJob &job_, const bee::glTF_output &glTF_output_);
+
+void write_json_log(std::u8string_view log_file_, const bee::Json &log_);
+} // namespace beecli
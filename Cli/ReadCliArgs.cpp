@@ -81,6 +81,23 @@ struct ConvertOptionBindingTrait<&bee::ConvertOptions::preserve_mesh_instances>
   constexpr static auto default_value = "true";
 };
 
+template <>
+struct ConvertOptionBindingTrait<&bee::ConvertOptions::glb> {
+  constexpr static auto name = "glb";
+  constexpr static auto description =
+      "Output binary glTF(.glb). "
+      "This is implied if the output path has the extension `.glb`.";
+  constexpr static auto default_value = "false";
+};
+
+template <>
+struct ConvertOptionBindingTrait<&bee::ConvertOptions::compact_json> {
+  constexpr static auto name = "compact-json";
+  constexpr static auto description =
+      "Write the glTF JSON without whitespace. It's always so in .glb.";
+  constexpr static auto default_value = "false";
+};
+
 template <>
 struct ConvertOptionBindingTrait<
     &bee::ConvertOptions::animation_position_error_multiplier> {
@@ -139,8 +156,16 @@ fetch_convert_option(const cxxopts::ParseResult &cxxopts_parse_result_,
 }
 
 std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
+  return readCliArgs(args_, std::cout, std::cerr);
+}
+
+std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_,
+                                         std::ostream &out_,
+                                         std::ostream &err_) {
   std::string inputFile;
+  std::vector<std::string> moreInputFiles;
   std::string outFile;
+  std::string outDir;
   std::string fbmDir;
   std::string logFile;
   std::string unitConversion;
@@ -154,7 +179,7 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
   cxxopts::Options options{"FBX-glTF-conv",
                            "This is a FBX to glTF file format converter. \n" +
                                fmt::format("Version: {}", version_string.empty() ? "UNKNOWN" : version_string)};
-  options.positional_help("<path-to-FBX-file>");
+  options.positional_help("<path-to-FBX-file> [<more-FBX-files>...]");
 
   const auto add_cxx_option = [&options, &cliArgs ]<auto memberPtr>() {
     convert_option_binding_helper<memberPtr>::add_cxx_option(
@@ -165,9 +190,25 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
 
   options.add_options()("v,version", "Print version string.");
 
+  options.add_options()(
+      "server",
+      "Run as a conversion server. Jobs are read as JSON lines from stdin, or "
+      "from connections to --socket if specified.");
+
+  options.add_options()("socket",
+                        "Path of the Unix domain socket the server listens "
+                        "on.",
+                        cxxopts::value<std::string>());
+
   options.add_options()("input-file", "Input file",
                         cxxopts::value<std::string>());
 
+  options.add_options()(
+      "more-input-files",
+      "More input files. If specified, all input files are converted as a "
+      "batch.",
+      cxxopts::value<std::vector<std::string>>());
+
   options.add_options()("fbm-dir", "The directory to store the embedded media.",
                         cxxopts::value<std::string>());
   options.add_options()(
@@ -175,6 +216,25 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       "The output path to the .gltf or .glb file. Defaults to "
       "`<working-directory>/<FBX-filename-basename>.gltf`",
       cxxopts::value<std::string>());
+  options.add_options()(
+      "out-dir",
+      "The directory under which outputs are placed when converting a batch. "
+      "Each input file `<name>.fbx` is output to "
+      "`<out-dir>/<name>_glTF/<name>.gltf`. Defaults to the working directory.",
+      cxxopts::value<std::string>());
+  options.add_options()(
+      "jobs",
+      "Number of files converted in parallel when converting a batch. "
+      "0 means to use all hardware threads.",
+      cxxopts::value<std::uint32_t>()->default_value("0"));
+  options.add_options()(
+      "cache-dir",
+      "Directory of the conversion cache. If specified, outputs are reused "
+      "when the input file, the referenced textures and the options are "
+      "unchanged since a previous conversion.",
+      cxxopts::value<std::string>());
+  add_cxx_option.template operator()<&bee::ConvertOptions::glb>();
+  add_cxx_option.template operator()<&bee::ConvertOptions::compact_json>();
   options.add_options()("no-flip-v", "Do not flip V texture coordinates.",
                         cxxopts::value<bool>()->default_value("false"));
   options.add_options()(
@@ -239,6 +299,196 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       "console",
       cxxopts::value<std::string>());
 
+  options.add_options()(
+      "stats",
+      "Print the time spent in each conversion phase and counters such as "
+      "vertices and keyframes processed.",
+      cxxopts::value<bool>()->default_value("false"));
+
+  options.add_options()("stats-file",
+                        "Write the conversion stats into the specified file "
+                        "as JSON.",
+                        cxxopts::value<std::string>());
+
+  options.add_options()(
+      "buffer-partition",
+      "Put the data of each of these in a buffer of its own, so they can be "
+      "loaded separately. Comma separated list of:\n"
+      "- mesh - Vertices, indices and skin of each mesh.\n"
+      "- animation - Keyframes of each animation.\n"
+      "- image - Each image embedded.\n",
+      cxxopts::value<std::vector<std::string>>());
+
+  options.add_options()(
+      "max-buffer-size",
+      "Split buffers larger than this many bytes. 0 means 2GB.",
+      cxxopts::value<std::uint32_t>()->default_value("0"));
+
+  options.add_options()(
+      "mesh-threads",
+      "Number of threads assembling mesh vertices in each conversion. "
+      "0 means to use the hardware threads, divided among --jobs.",
+      cxxopts::value<std::uint32_t>()->default_value("0"));
+
+  options.add_options()(
+      "sparse-morph-epsilon",
+      "Morph target deltas whose components are all within this are taken "
+      "as zero.",
+      cxxopts::value<float>()->default_value("0"));
+
+  options.add_options()(
+      "sparse-morph-max-ratio",
+      "Write a morph target attribute as a sparse accessor if that takes "
+      "less than this fraction of the bytes of the dense one. 0 disables "
+      "sparse accessors.",
+      cxxopts::value<float>()->default_value("1"));
+
+  options.add_options()(
+      "mesh-optimization",
+      "Reorder the triangles and vertices of each mesh for the GPU. Comma "
+      "separated list of:\n"
+      "- vertex-cache - Order triangles for the vertex cache to hit.\n"
+      "- overdraw - Then draw outer clusters of triangles first.\n"
+      "- vertex-fetch - Order vertices as triangles first use them.\n",
+      cxxopts::value<std::vector<std::string>>());
+
+  options.add_options()(
+      "overdraw-threshold",
+      "Vertex cache misses allowed by the overdraw optimization, relative to "
+      "those before.",
+      cxxopts::value<float>()->default_value("1.05"));
+
+  options.add_options()(
+      "lod-ratios",
+      "Write simplified levels of detail of each mesh, with MSFT_lod. Comma "
+      "separated list of the fraction of the triangles each keeps. 0 "
+      "simplifies as far as the level's error allows. Levels listed here "
+      "only may move the surface up to the extent of the mesh.",
+      cxxopts::value<std::vector<float>>());
+
+  options.add_options()(
+      "lod-errors",
+      "Comma separated list of the most each level of detail may move the "
+      "surface, relative to the extent of the mesh. Levels listed here only "
+      "have a ratio of 0.",
+      cxxopts::value<std::vector<float>>());
+
+  options.add_options()(
+      "lod-screen-error",
+      "The error, relative to the height of the screen, at which a level of "
+      "detail gives way to the next.",
+      cxxopts::value<float>()->default_value("0.001"));
+
+  options.add_options()(
+      "quantize",
+      "Store vertex attributes as normalized integers, with "
+      "KHR_mesh_quantization: 16-bit positions, 8-bit normals, 16-bit UVs "
+      "and 8-bit colors, unless set by the options below.",
+      cxxopts::value<bool>());
+
+  options.add_options()(
+      "quantize-position-bits",
+      "Bits positions are quantized to. 0 keeps them float.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "quantize-normal-bits",
+      "Bits normals are quantized to. 0 keeps them float.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "quantize-uv-bits",
+      "Bits UVs within [0, 1] are quantized to. 0 keeps them float.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "quantize-color-bits",
+      "Bits vertex colors are quantized to. 0 keeps them float.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "meshopt-compression",
+      "Compress vertex, index and animation data with "
+      "EXT_meshopt_compression.",
+      cxxopts::value<bool>());
+
+  options.add_options()(
+      "meshopt-fallback",
+      "Also write the uncompressed data, in fallback buffers, so that the "
+      "extension isn't required.",
+      cxxopts::value<bool>());
+
+  options.add_options()("meshopt-octahedral",
+                        "Store quantized normals octahedral.",
+                        cxxopts::value<bool>());
+
+  options.add_options()(
+      "meshopt-quaternion-bits",
+      "Bits rotation keys keep with the quaternion filter. 0 keeps them "
+      "float.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "meshopt-exponential-bits",
+      "Mantissa bits float positions, translation and scale keys keep with "
+      "the exponential filter. 0 keeps them as is.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "draco",
+      "Compress mesh primitives with KHR_draco_mesh_compression. Needs a "
+      "build with Draco.",
+      cxxopts::value<bool>());
+
+  options.add_options()(
+      "draco-fallback",
+      "Also write the uncompressed primitives, so that the extension isn't "
+      "required.",
+      cxxopts::value<bool>());
+
+  options.add_options()(
+      "draco-position-bits",
+      "Bits Draco quantizes float positions to. 0 keeps them lossless.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "draco-normal-bits",
+      "Bits Draco quantizes float normals to. 0 keeps them lossless.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "draco-uv-bits",
+      "Bits Draco quantizes float UVs to. 0 keeps them lossless.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "draco-color-bits",
+      "Bits Draco quantizes float vertex colors to. 0 keeps them lossless.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "draco-generic-bits",
+      "Bits Draco quantizes other float attributes, such as skin weights, "
+      "to. 0 keeps them lossless.",
+      cxxopts::value<std::uint32_t>());
+
+  options.add_options()(
+      "draco-speed",
+      "Draco encoding speed, from 0, the smallest output, to 10, the fastest "
+      "to encode and decode.",
+      cxxopts::value<int>());
+
+  options.add_options()(
+      "gpu-instancing",
+      "Collapse static leaf nodes instancing the same meshes under the same "
+      "parent into one node, with EXT_mesh_gpu_instancing.",
+      cxxopts::value<bool>());
+
+  options.add_options()(
+      "gpu-instancing-min",
+      "The fewest nodes --gpu-instancing collapses.",
+      cxxopts::value<std::uint32_t>());
+
   options.add_options()(
       "image-path-mode",
       "Specify the mode used to specify the image path. Could "
@@ -254,7 +504,7 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       "relative path.\n",
       cxxopts::value<std::string>());
 
-  options.parse_positional("input-file");
+  options.parse_positional({"input-file", "more-input-files"});
 
   std::vector<std::string> argStrings(args_.size());
   std::transform(args_.begin(), args_.end(), argStrings.begin(),
@@ -278,6 +528,21 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       return VersionCommand{};
     }
 
+    if (cliParseResult.count("server") &&
+        cliParseResult["server"].as<bool>()) {
+      ServerCommand serverCommand;
+      if (cliParseResult.count("socket")) {
+        const auto socket = cliParseResult["socket"].as<std::string>();
+        serverCommand.socket.emplace(socket.begin(), socket.end());
+      }
+      serverCommand.jobs = cliParseResult["jobs"].as<std::uint32_t>();
+      if (cliParseResult.count("cache-dir")) {
+        const auto cacheDir = cliParseResult["cache-dir"].as<std::string>();
+        serverCommand.cacheDir.assign(cacheDir.begin(), cacheDir.end());
+      }
+      return serverCommand;
+    }
+
     const auto fetch_convert_option =
         [&cliParseResult, &cliArgs ]<auto memberPtr>() {
       convert_option_binding_helper<memberPtr>::fetch_convert_option(
@@ -288,6 +553,11 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       inputFile = cliParseResult["input-file"].as<std::string>();
     }
 
+    if (cliParseResult.count("more-input-files")) {
+      moreInputFiles =
+          cliParseResult["more-input-files"].as<std::vector<std::string>>();
+    }
+
     if (cliParseResult.count("fbm-dir")) {
       fbmDir = cliParseResult["fbm-dir"].as<std::string>();
     }
@@ -296,6 +566,23 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       outFile = cliParseResult["out"].as<std::string>();
     }
 
+    if (cliParseResult.count("out-dir")) {
+      outDir = cliParseResult["out-dir"].as<std::string>();
+    }
+
+    if (cliParseResult.count("jobs")) {
+      cliArgs.jobs = cliParseResult["jobs"].as<std::uint32_t>();
+    }
+
+    if (cliParseResult.count("cache-dir")) {
+      const auto cacheDir = cliParseResult["cache-dir"].as<std::string>();
+      cliArgs.cacheDir.assign(cacheDir.begin(), cacheDir.end());
+    }
+
+    fetch_convert_option.template operator()<&bee::ConvertOptions::glb>();
+    fetch_convert_option
+        .template operator()<&bee::ConvertOptions::compact_json>();
+
     if (cliParseResult.count("no-flip-v")) {
       cliArgs.convertOptions.noFlipV = cliParseResult["no-flip-v"].as<bool>();
     }
@@ -369,12 +656,154 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       } else if (pathModeString == "copy") {
         cliArgs.convertOptions.pathMode = bee::ConvertOptions::PathMode::copy;
       } else {
-        std::cerr << "Bad --image-path-mode \"" << pathModeString << "\"\n";
-        std::cout << options.help() << std::endl;
+        err_ << "Bad --image-path-mode \"" << pathModeString << "\"\n";
+        out_ << options.help() << std::endl;
         return {};
       }
     }
 
+    if (cliParseResult.count("buffer-partition")) {
+      auto &bufferPartition = cliArgs.convertOptions.bufferPartition;
+      for (const auto &part :
+           cliParseResult["buffer-partition"].as<std::vector<std::string>>()) {
+        if (part == "mesh") {
+          bufferPartition.per_mesh = true;
+        } else if (part == "animation") {
+          bufferPartition.per_animation = true;
+        } else if (part == "image") {
+          bufferPartition.per_image = true;
+        } else {
+          err_ << "Bad --buffer-partition \"" << part << "\"\n";
+          out_ << options.help() << std::endl;
+          return {};
+        }
+      }
+    }
+
+    if (cliParseResult.count("max-buffer-size")) {
+      cliArgs.convertOptions.bufferPartition.max_buffer_size =
+          cliParseResult["max-buffer-size"].as<std::uint32_t>();
+    }
+
+    if (cliParseResult.count("mesh-threads")) {
+      cliArgs.convertOptions.mesh_threads =
+          cliParseResult["mesh-threads"].as<std::uint32_t>();
+    }
+
+    if (cliParseResult.count("sparse-morph-epsilon")) {
+      cliArgs.convertOptions.sparseMorphTargets.epsilon =
+          cliParseResult["sparse-morph-epsilon"].as<float>();
+    }
+
+    if (cliParseResult.count("sparse-morph-max-ratio")) {
+      cliArgs.convertOptions.sparseMorphTargets.max_size_ratio =
+          cliParseResult["sparse-morph-max-ratio"].as<float>();
+    }
+
+    if (cliParseResult.count("mesh-optimization")) {
+      auto &meshOptimization = cliArgs.convertOptions.meshOptimization;
+      for (const auto &part : cliParseResult["mesh-optimization"]
+                                  .as<std::vector<std::string>>()) {
+        if (part == "vertex-cache") {
+          meshOptimization.vertex_cache = true;
+        } else if (part == "overdraw") {
+          meshOptimization.overdraw_threshold =
+              cliParseResult["overdraw-threshold"].as<float>();
+        } else if (part == "vertex-fetch") {
+          meshOptimization.vertex_fetch = true;
+        } else {
+          err_ << "Bad --mesh-optimization \"" << part << "\"\n";
+          out_ << options.help() << std::endl;
+          return {};
+        }
+      }
+    }
+
+    if (cliParseResult.count("lod-ratios") ||
+        cliParseResult.count("lod-errors")) {
+      auto &levelsOfDetail = cliArgs.convertOptions.levelsOfDetail;
+      const auto readList = [&cliParseResult](const std::string &name_) {
+        return cliParseResult.count(name_)
+                   ? cliParseResult[name_].as<std::vector<float>>()
+                   : std::vector<float>{};
+      };
+      const auto ratios = readList("lod-ratios");
+      const auto errors = readList("lod-errors");
+      levelsOfDetail.levels.resize(std::max(ratios.size(), errors.size()));
+      for (std::size_t iLevel = 0; iLevel < levelsOfDetail.levels.size();
+           ++iLevel) {
+        // A level listed in one list only is bounded by that list alone.
+        auto &level = levelsOfDetail.levels[iLevel];
+        level.ratio = iLevel < ratios.size() ? ratios[iLevel] : 0.0f;
+        level.max_error = iLevel < errors.size() ? errors[iLevel] : 1.0f;
+      }
+      levelsOfDetail.screen_error =
+          cliParseResult["lod-screen-error"].as<float>();
+    }
+
+    // Flags and bit counts of the mesh encodings below, kept as they are
+    // unless given.
+    const auto readFlag = [&cliParseResult](const std::string &name_,
+                                            bool &flag_) {
+      if (cliParseResult.count(name_)) {
+        flag_ = cliParseResult[name_].as<bool>();
+      }
+    };
+    const auto readBits = [&cliParseResult](const std::string &name_,
+                                            std::uint32_t &bits_) {
+      if (cliParseResult.count(name_)) {
+        bits_ = cliParseResult[name_].as<std::uint32_t>();
+      }
+    };
+
+    {
+      auto &meshQuantization = cliArgs.convertOptions.meshQuantization;
+      if (cliParseResult.count("quantize") &&
+          cliParseResult["quantize"].as<bool>()) {
+        meshQuantization.position_bits = 16;
+        meshQuantization.normal_bits = 8;
+        meshQuantization.uv_bits = 16;
+        meshQuantization.color_bits = 8;
+      }
+      readBits("quantize-position-bits", meshQuantization.position_bits);
+      readBits("quantize-normal-bits", meshQuantization.normal_bits);
+      readBits("quantize-uv-bits", meshQuantization.uv_bits);
+      readBits("quantize-color-bits", meshQuantization.color_bits);
+    }
+
+    {
+      auto &meshoptCompression = cliArgs.convertOptions.meshoptCompression;
+      readFlag("meshopt-compression", meshoptCompression.enabled);
+      readFlag("meshopt-fallback", meshoptCompression.fallback);
+      readFlag("meshopt-octahedral", meshoptCompression.octahedral_normals);
+      readBits("meshopt-quaternion-bits", meshoptCompression.quaternion_bits);
+      readBits("meshopt-exponential-bits",
+               meshoptCompression.exponential_bits);
+    }
+
+    {
+      auto &dracoCompression = cliArgs.convertOptions.dracoCompression;
+      readFlag("draco", dracoCompression.enabled);
+      readFlag("draco-fallback", dracoCompression.fallback);
+      readBits("draco-position-bits", dracoCompression.position_bits);
+      readBits("draco-normal-bits", dracoCompression.normal_bits);
+      readBits("draco-uv-bits", dracoCompression.uv_bits);
+      readBits("draco-color-bits", dracoCompression.color_bits);
+      readBits("draco-generic-bits", dracoCompression.generic_bits);
+      if (cliParseResult.count("draco-speed")) {
+        dracoCompression.speed = cliParseResult["draco-speed"].as<int>();
+      }
+    }
+
+    {
+      auto &gpuInstancing = cliArgs.convertOptions.gpuInstancing;
+      readFlag("gpu-instancing", gpuInstancing.enabled);
+      if (cliParseResult.count("gpu-instancing-min")) {
+        gpuInstancing.min_instances =
+            cliParseResult["gpu-instancing-min"].as<std::uint32_t>();
+      }
+    }
+
     if (cliParseResult.count("verbose")) {
       cliArgs.convertOptions.verbose = cliParseResult["verbose"].as<bool>();
     }
@@ -383,14 +812,30 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       logFile = cliParseResult["log-file"].as<std::string>();
     }
 
+    if (cliParseResult.count("stats")) {
+      cliArgs.stats = cliParseResult["stats"].as<bool>();
+    }
+
+    if (cliParseResult.count("stats-file")) {
+      const auto statsFile = cliParseResult["stats-file"].as<std::string>();
+      cliArgs.statsFile.emplace(statsFile.begin(), statsFile.end());
+    }
+
     if (inputFile.empty()) {
-      std::cerr << "Input file not specified." << std::endl;
-      std::cerr << options.help() << std::endl;
+      err_ << "Input file not specified." << std::endl;
+      err_ << options.help() << std::endl;
+      return {};
+    }
+
+    if (!moreInputFiles.empty() && !outFile.empty()) {
+      err_ << "--out can not be used when converting multiple input "
+                   "files, use --out-dir instead."
+                << std::endl;
       return {};
     }
   } catch (const cxxopts::exceptions::exception &ex_) {
-    std::cerr << ex_.what() << "\n";
-    std::cout << options.help() << std::endl;
+    err_ << ex_.what() << "\n";
+    out_ << options.help() << std::endl;
     return {};
   }
 
@@ -405,12 +850,17 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
       cliArgs.convertOptions.unitConversion =
           bee::ConvertOptions::UnitConversion::disabled;
     } else {
-      std::cerr << "Unknown unit conversion option: " << unitConversion << "\n";
+      err_ << "Unknown unit conversion option: " << unitConversion << "\n";
     }
   }
 
   cliArgs.inputFile.assign(inputFile.begin(), inputFile.end());
+  cliArgs.inputFiles.emplace_back(cliArgs.inputFile);
+  for (const auto &moreInputFile : moreInputFiles) {
+    cliArgs.inputFiles.emplace_back(moreInputFile.begin(), moreInputFile.end());
+  }
   cliArgs.outFile.assign(outFile.begin(), outFile.end());
+  cliArgs.outDir.assign(outDir.begin(), outDir.end());
   cliArgs.fbmDir.assign(fbmDir.begin(), fbmDir.end());
   if (!logFile.empty()) {
     cliArgs.logFile.emplace();
@@ -436,4 +886,4 @@ std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_) {
 
   return cliArgs;
 }
-} // namespace beecli
\ No newline at end of file
+} // namespace beecli
\ No newline at end of file
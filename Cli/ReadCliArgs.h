@@ -3,7 +3,9 @@
 #pragma once
 
 #include <bee/Converter.h>
+#include <cstdint>
 #include <optional>
+#include <ostream>
 #include <span>
 #include <string>
 #include <string_view>
@@ -13,9 +15,28 @@
 namespace beecli {
 struct CliArgs {
   std::u8string inputFile;
+  /// <summary>
+  /// All input files, starting with `inputFile`.
+  /// More than one means batch conversion.
+  /// </summary>
+  std::vector<std::u8string> inputFiles;
   std::u8string outFile;
+  std::u8string outDir;
+  /// <summary>
+  /// Number of worker threads used by batch conversion. 0 means auto.
+  /// </summary>
+  std::uint32_t jobs = 0;
   std::u8string fbmDir;
   std::optional<std::u8string> logFile;
+  /// <summary>
+  /// Directory of the conversion cache. Empty means not to use the cache.
+  /// </summary>
+  std::u8string cacheDir;
+  /// <summary>
+  /// Whether to print conversion stats.
+  /// </summary>
+  bool stats = false;
+  std::optional<std::u8string> statsFile;
   bee::ConvertOptions convertOptions;
 };
 
@@ -26,13 +47,38 @@ struct HelpCommand {
   std::string text;
 };
 
+/// <summary>
+/// Runs as a conversion server, see `Server.h`.
+/// </summary>
+struct ServerCommand {
+  /// <summary>
+  /// Path of the Unix domain socket to listen on.
+  /// If not specified, jobs are read from stdin.
+  /// </summary>
+  std::optional<std::u8string> socket;
+  std::uint32_t jobs = 0;
+  /// <summary>
+  /// Used by jobs which don't specify their own `cache-dir`.
+  /// </summary>
+  std::u8string cacheDir;
+};
+
 using ParsedCommand = std::variant<
     CliArgs,
     VersionCommand,
-    HelpCommand>;
+    HelpCommand,
+    ServerCommand>;
 
 std::optional<std::vector<std::string>>
 getCommandLineArgsU8(int argc_, const char *argv_[]);
 
 std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_);
-} // namespace beecli
\ No newline at end of file
+
+/// <summary>
+/// Prints the help and what's wrong with the arguments to `out_` and `err_`
+/// instead of the standard streams.
+/// </summary>
+std::optional<ParsedCommand> readCliArgs(std::span<std::string_view> args_,
+                                         std::ostream &out_,
+                                         std::ostream &err_);
+} // namespace beecli
\ No newline at end of file
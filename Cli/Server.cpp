@@ -0,0 +1,594 @@
+#include "Server.h"
+#include "ConvertJob.h"
+#include <algorithm>
+#include <array>
+#include <bee/polyfills/filesystem.h>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace beecli {
+namespace {
+constexpr std::array<std::string_view, 8> rejectedJobOptions = {
+    "input-file", "more-input-files", "jobs", "log-file",
+    "server",     "socket",           "help", "version",
+};
+
+/// <summary>
+/// The peer of jobs. Responses of a connection are serialized.
+/// </summary>
+class Connection {
+public:
+  virtual ~Connection() = default;
+
+  void respond(const bee::Json &response_) {
+    auto line = response_.dump();
+    line.push_back('\n');
+    std::unique_lock lock{_mutex};
+    _write(line);
+  }
+
+  void job_posted() {
+    std::unique_lock lock{_mutex};
+    ++_nPendingJobs;
+  }
+
+  void job_finished() {
+    std::unique_lock lock{_mutex};
+    --_nPendingJobs;
+    if (_nPendingJobs == 0) {
+      _idle.notify_all();
+    }
+  }
+
+  /// <summary>
+  /// Waits until all jobs posted from this connection have been responded.
+  /// </summary>
+  void wait() {
+    std::unique_lock lock{_mutex};
+    _idle.wait(lock, [this]() { return _nPendingJobs == 0; });
+  }
+
+protected:
+  virtual void _write(std::string_view line_) = 0;
+
+private:
+  std::mutex _mutex;
+  std::condition_variable _idle;
+  std::size_t _nPendingJobs = 0;
+};
+
+/// <summary>
+/// Responds to a file descriptor, which it doesn't own.
+/// </summary>
+class FileConnection : public Connection {
+public:
+  FileConnection(int fd_) : _fd(fd_) {
+  }
+
+protected:
+  void _write(std::string_view line_) override {
+    while (!line_.empty()) {
+#ifdef _WIN32
+      const auto nWritten = ::_write(_fd, line_.data(),
+                                     static_cast<unsigned int>(line_.size()));
+#else
+      const auto nWritten = ::write(_fd, line_.data(), line_.size());
+      if (nWritten < 0 && errno == EINTR) {
+        continue;
+      }
+#endif
+      if (nWritten < 0) {
+        return;
+      }
+      line_.remove_prefix(static_cast<std::size_t>(nWritten));
+    }
+  }
+
+private:
+  int _fd;
+};
+
+struct ServerJob {
+  bee::Json id;
+  CliArgs cliArgs;
+  ConvertJob convertJob;
+  /// <summary>
+  /// The output file claimed by the job while it's in flight.
+  /// </summary>
+  std::optional<bee::filesystem::path> outFile;
+};
+
+class Server {
+public:
+  Server(const ServerCommand &command_)
+      : _cacheDir(command_.cacheDir), _batchConverter(command_.jobs) {
+  }
+
+  /// <summary>
+  /// Posts the job requested by `line_`. Only the request is parsed here:
+  /// its options are read, and the cache looked up, by the worker picking it
+  /// up, so that jobs are taken in meanwhile. Requests that can't be parsed
+  /// are responded immediately.
+  /// </summary>
+  /// <returns>False if it's a shutdown request.</returns>
+  bool handle(std::string_view line_,
+              const std::shared_ptr<Connection> &connection_) {
+    if (std::all_of(line_.begin(), line_.end(),
+                    [](char ch_) {
+                      return std::isspace(static_cast<unsigned char>(ch_));
+                    })) {
+      return true;
+    }
+
+    auto job = std::make_shared<ServerJob>();
+    bee::Json request;
+    try {
+      request = bee::Json::parse(line_);
+    } catch (const std::exception &exception) {
+      connection_->respond(_makeErrorResponse(*job, exception.what()));
+      return true;
+    }
+    if (request.is_object() && request.contains("id")) {
+      job->id = request["id"];
+    }
+
+    if (const auto shutdown = request.is_object() ? request.find("shutdown")
+                                                  : request.end();
+        shutdown != request.end() && *shutdown == true) {
+      connection_->respond(bee::Json{{"id", job->id}, {"ok", true}});
+      return false;
+    }
+
+    connection_->job_posted();
+    _batchConverter.post(
+        [this, job, connection_, request = std::move(request)](
+            bee::ConvertOptions &options_) -> std::optional<std::u8string> {
+          job->cliArgs = read_server_job_args(request);
+          if (job->cliArgs.cacheDir.empty()) {
+            job->cliArgs.cacheDir = _cacheDir;
+          }
+          job->convertJob =
+              make_convert_job(job->cliArgs, job->cliArgs.inputFile,
+                               std::make_unique<JsonLogger>());
+          _claimOutFile(*job);
+          if (restore_cached_output(job->convertJob)) {
+            _finish(*job, *connection_, _makeSuccessResponse(*job));
+            return {};
+          }
+          options_ = job->convertJob.convertOptions;
+          return job->convertJob.inputFile;
+        },
+        [this, job, connection_](std::optional<bee::glTF_output> &&output_,
+                                 std::exception_ptr error_) {
+          bee::Json response;
+          try {
+            if (error_) {
+              std::rethrow_exception(error_);
+            }
+            write_glTF_output(job->convertJob, *output_);
+            response = _makeSuccessResponse(*job);
+          } catch (const std::exception &exception) {
+            response = _makeErrorResponse(*job, exception.what());
+          }
+          _finish(*job, *connection_, response);
+        });
+    return true;
+  }
+
+private:
+  std::u8string _cacheDir;
+  std::mutex _outFilesMutex;
+  std::set<bee::filesystem::path> _outFiles;
+  // Last, so that jobs are done before what they use is destroyed.
+  bee::BatchConverter _batchConverter;
+
+  /// <summary>
+  /// Rejects the job if another one in flight is output to the same file, as
+  /// the CLI rejects a batch doing so.
+  /// </summary>
+  void _claimOutFile(ServerJob &job_) {
+    auto outFile =
+        bee::filesystem::path{job_.convertJob.outFile}.lexically_normal();
+    std::unique_lock lock{_outFilesMutex};
+    if (!_outFiles.insert(outFile).second) {
+      throw std::runtime_error("Another job is being output to " +
+                               outFile.string());
+    }
+    job_.outFile = std::move(outFile);
+  }
+
+  void _finish(ServerJob &job_,
+               Connection &connection_,
+               const bee::Json &response_) {
+    if (job_.outFile) {
+      std::unique_lock lock{_outFilesMutex};
+      _outFiles.erase(*job_.outFile);
+      job_.outFile.reset();
+    }
+    connection_.respond(response_);
+    connection_.job_finished();
+  }
+
+  static bee::Json _getMessages(const ServerJob &job_) {
+    if (!job_.convertJob.logger) {
+      return bee::Json::array();
+    }
+    return static_cast<const JsonLogger *>(job_.convertJob.logger.get())
+        ->messages();
+  }
+
+  static bee::Json _makeErrorResponse(const ServerJob &job_,
+                                      std::string_view error_) {
+    return bee::Json{
+        {"id", job_.id},
+        {"ok", false},
+        {"error", error_},
+        {"messages", _getMessages(job_)},
+    };
+  }
+
+  static bee::Json _makeSuccessResponse(const ServerJob &job_) {
+    const auto &outFile = job_.convertJob.outFile;
+    bee::Json response{
+        {"id", job_.id},
+        {"ok", true},
+        {"output", std::string{outFile.begin(), outFile.end()}},
+        {"messages", _getMessages(job_)},
+    };
+    if (job_.cliArgs.stats) {
+      response["stats"] = job_.convertJob.stats.value_or(nullptr);
+    }
+    return response;
+  }
+};
+
+int run_stdin_server(Server &server_) {
+  // Only responses go to stdout: the descriptor is redirected to stderr, so
+  // that whatever else is printed, through C++ or C streams, by the converter
+  // or the FBX SDK, goes there, and responses are written to a duplicate.
+  std::cout.flush();
+  std::fflush(stdout);
+#ifdef _WIN32
+  const auto stdoutFd = ::_fileno(stdout);
+  const auto responsesFd = ::_dup(stdoutFd);
+  if (responsesFd < 0 || ::_dup2(::_fileno(stderr), stdoutFd) != 0) {
+#else
+  const auto stdoutFd = STDOUT_FILENO;
+  const auto responsesFd = ::dup(stdoutFd);
+  if (responsesFd < 0 || ::dup2(STDERR_FILENO, stdoutFd) < 0) {
+#endif
+    std::cerr << "Failed to redirect stdout: " << std::strerror(errno)
+              << "\n";
+    return -1;
+  }
+
+  const auto connection = std::make_shared<FileConnection>(responsesFd);
+  std::string line;
+  while (std::getline(std::cin, line) && server_.handle(line, connection)) {
+  }
+  connection->wait();
+
+  std::cout.flush();
+  std::fflush(stdout);
+#ifdef _WIN32
+  ::_dup2(responsesFd, stdoutFd);
+  ::_close(responsesFd);
+#else
+  ::dup2(responsesFd, stdoutFd);
+  ::close(responsesFd);
+#endif
+  return 0;
+}
+
+#ifndef _WIN32
+/// <summary>
+/// Write end of the pipe waking the socket server up to shut down, -1 if
+/// none is running.
+/// </summary>
+volatile std::sig_atomic_t shutdownFd = -1;
+
+/// <summary>
+/// Async-signal-safe.
+/// </summary>
+void request_shutdown() {
+  const auto fd = shutdownFd;
+  if (fd >= 0) {
+    // The pipe doesn't block: if it's full, a wake-up is pending anyway.
+    const char byte = 0;
+    [[maybe_unused]] const auto nWritten = ::write(fd, &byte, 1);
+  }
+}
+
+extern "C" void on_shutdown_signal(int) {
+  request_shutdown();
+}
+
+class SocketConnection : public Connection {
+public:
+  SocketConnection(int fd_) : _fd(fd_) {
+  }
+
+  ~SocketConnection() {
+    ::close(_fd);
+  }
+
+  int fd() const {
+    return _fd;
+  }
+
+protected:
+  void _write(std::string_view line_) override {
+    // If the peer is gone, there's nobody to respond to.
+    while (!line_.empty()) {
+      const auto nWritten =
+          ::send(_fd, line_.data(), line_.size(), MSG_NOSIGNAL);
+      if (nWritten < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      line_.remove_prefix(static_cast<std::size_t>(nWritten));
+    }
+  }
+
+private:
+  int _fd;
+};
+
+/// <summary>
+/// Reads jobs until the peer stops sending, or reading is shut down.
+/// </summary>
+void serve_socket_connection(
+    Server &server_, const std::shared_ptr<SocketConnection> &connection_) {
+  std::string pending;
+  std::array<char, 64 * 1024> chunk;
+  bool serving = true;
+  while (serving) {
+    const auto nRead = ::recv(connection_->fd(), chunk.data(), chunk.size(), 0);
+    if (nRead < 0 && errno == EINTR) {
+      continue;
+    }
+    if (nRead <= 0) {
+      break;
+    }
+    pending.append(chunk.data(), static_cast<std::size_t>(nRead));
+    std::string::size_type lineBegin = 0;
+    for (auto lineEnd = pending.find('\n');
+         serving && lineEnd != std::string::npos;
+         lineEnd = pending.find('\n', lineBegin)) {
+      serving = server_.handle(
+          std::string_view{pending}.substr(lineBegin, lineEnd - lineBegin),
+          connection_);
+      lineBegin = lineEnd + 1;
+    }
+    pending.erase(0, lineBegin);
+  }
+  if (serving && !pending.empty()) {
+    serving = server_.handle(pending, connection_);
+  }
+  if (!serving) {
+    request_shutdown();
+  }
+  connection_->wait();
+}
+
+int run_socket_server(Server &server_, std::u8string_view socket_path_) {
+  const auto socketPath =
+      std::string{socket_path_.begin(), socket_path_.end()};
+
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socketPath.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path is too long: " << socketPath << "\n";
+    return -1;
+  }
+  std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+  const auto listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenFd < 0) {
+    std::cerr << "Failed to create socket: " << std::strerror(errno) << "\n";
+    return -1;
+  }
+
+  // Remove the socket left by previous run.
+  ::unlink(socketPath.c_str());
+  if (::bind(listenFd, reinterpret_cast<const sockaddr *>(&address),
+             sizeof(address)) != 0 ||
+      ::listen(listenFd, SOMAXCONN) != 0) {
+    std::cerr << "Failed to listen on " << socketPath << ": "
+              << std::strerror(errno) << "\n";
+    ::close(listenFd);
+    return -1;
+  }
+
+  // Shutdown requests and signals wake the server up through a pipe.
+  std::array<int, 2> wakeFds;
+  if (::pipe(wakeFds.data()) != 0) {
+    std::cerr << "Failed to create pipe: " << std::strerror(errno) << "\n";
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    return -1;
+  }
+  ::fcntl(wakeFds[1], F_SETFL, ::fcntl(wakeFds[1], F_GETFL) | O_NONBLOCK);
+  shutdownFd = wakeFds[1];
+  const auto previousSigInt = std::signal(SIGINT, on_shutdown_signal);
+  const auto previousSigTerm = std::signal(SIGTERM, on_shutdown_signal);
+
+  std::mutex connectionsMutex;
+  std::condition_variable connectionsClosed;
+  std::set<int> connectionFds;
+
+  int retval = 0;
+  std::array<pollfd, 2> pollFds{pollfd{listenFd, POLLIN, 0},
+                                pollfd{wakeFds[0], POLLIN, 0}};
+  while (true) {
+    if (::poll(pollFds.data(), pollFds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Failed to wait for connections: " << std::strerror(errno)
+                << "\n";
+      retval = -1;
+      break;
+    }
+    if (pollFds[1].revents != 0) {
+      break;
+    }
+    if (pollFds[0].revents == 0) {
+      continue;
+    }
+
+    const auto fd = ::accept(listenFd, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      std::cerr << "Failed to accept connection: " << std::strerror(errno)
+                << "\n";
+      retval = -1;
+      break;
+    }
+
+    {
+      std::unique_lock lock{connectionsMutex};
+      connectionFds.insert(fd);
+    }
+    std::thread{[&, connection = std::make_shared<SocketConnection>(fd)]() {
+      serve_socket_connection(server_, connection);
+      std::unique_lock lock{connectionsMutex};
+      connectionFds.erase(connection->fd());
+      connectionsClosed.notify_all();
+    }}.detach();
+  }
+
+  // No more connections nor jobs are taken, but the jobs taken are still
+  // responded.
+  ::close(listenFd);
+  ::unlink(socketPath.c_str());
+  {
+    std::unique_lock lock{connectionsMutex};
+    for (const auto fd : connectionFds) {
+      ::shutdown(fd, SHUT_RD);
+    }
+    connectionsClosed.wait(lock, [&]() { return connectionFds.empty(); });
+  }
+
+  std::signal(SIGINT, previousSigInt);
+  std::signal(SIGTERM, previousSigTerm);
+  shutdownFd = -1;
+  ::close(wakeFds[0]);
+  ::close(wakeFds[1]);
+  return retval;
+}
+#endif
+} // namespace
+
+std::vector<std::string> job_options_to_args(const bee::Json &options_) {
+  if (!options_.is_object()) {
+    throw std::runtime_error("Job options should be an object.");
+  }
+
+  std::vector<std::string> args;
+  for (const auto &[key, value] : options_.items()) {
+    if (std::find(rejectedJobOptions.begin(), rejectedJobOptions.end(), key) !=
+        rejectedJobOptions.end()) {
+      throw std::runtime_error("Option \"" + key +
+                               "\" can not be specified for a job.");
+    }
+
+    const auto stringify = [&key](const bee::Json &value_) {
+      if (value_.is_string()) {
+        return value_.get<std::string>();
+      } else if (value_.is_boolean() || value_.is_number()) {
+        return value_.dump();
+      } else {
+        throw std::runtime_error("Bad value of option \"" + key + "\".");
+      }
+    };
+
+    std::string valueString;
+    if (value.is_null()) {
+      continue;
+    } else if (value.is_array()) {
+      for (const auto &element : value) {
+        if (!valueString.empty()) {
+          valueString.push_back(',');
+        }
+        valueString += stringify(element);
+      }
+    } else {
+      valueString = stringify(value);
+    }
+    args.push_back("--" + key + "=" + valueString);
+  }
+  return args;
+}
+
+CliArgs read_server_job_args(const bee::Json &request_) {
+  if (!request_.is_object()) {
+    throw std::runtime_error("Job request should be an object.");
+  }
+
+  const auto input = request_.find("input");
+  if (input == request_.end() || !input->is_string()) {
+    throw std::runtime_error("Input file not specified.");
+  }
+
+  std::vector<std::string> args{"FBX-glTF-conv",
+                                "--input-file=" + input->get<std::string>()};
+  if (const auto options = request_.find("options");
+      options != request_.end()) {
+    const auto optionArgs = job_options_to_args(*options);
+    args.insert(args.end(), optionArgs.begin(), optionArgs.end());
+  }
+
+  std::vector<std::string_view> argsSV(args.begin(), args.end());
+  std::ostringstream messagesStream;
+  auto parsedCommand = readCliArgs(argsSV, messagesStream, messagesStream);
+  const auto messages = messagesStream.str();
+  if (!parsedCommand || !std::holds_alternative<CliArgs>(*parsedCommand)) {
+    // The help text follows the error message.
+    const auto firstLine = messages.substr(0, messages.find('\n'));
+    throw std::runtime_error(firstLine.empty() ? "Bad options." : firstLine);
+  }
+  return std::get<CliArgs>(std::move(*parsedCommand));
+}
+
+int run_server(const ServerCommand &command_) {
+  Server server{command_};
+  if (!command_.socket) {
+    return run_stdin_server(server);
+  }
+#ifdef _WIN32
+  std::cerr << "--socket is not supported on Windows, "
+               "jobs can be sent through stdin instead.\n";
+  return -1;
+#else
+  return run_socket_server(server, *command_.socket);
+#endif
+}
+} // namespace beecli
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ReadCliArgs.h"
+#include <bee/Converter.h>
+#include <string>
+#include <vector>
+
+namespace beecli {
+/// <summary>
+/// Translates the `"options"` of a server job request into command line
+/// arguments. Each key is the long name of a command line option:
+/// - `true`/`false` is passed as `--key=true`/`--key=false`;
+/// - numbers and strings are passed as `--key=value`;
+/// - arrays are joined with `,`;
+/// - `null` means the option is not specified.
+/// Options which make no sense for a single job, such as `log-file`, are
+/// rejected.
+/// </summary>
+/// <exception cref="std::runtime_error">Bad options.</exception>
+std::vector<std::string> job_options_to_args(const bee::Json &options_);
+
+/// <summary>
+/// Reads the arguments of a server job request
+/// `{ "input": <input-file>, "options": { ... } }`.
+/// </summary>
+/// <exception cref="std::runtime_error">Bad request.</exception>
+CliArgs read_server_job_args(const bee::Json &request_);
+
+/// <summary>
+/// Runs as a conversion server until the input is closed, or, on a socket,
+/// until SIGINT or SIGTERM.
+/// Jobs are JSON lines `{ "id": <any>, "input": <input-file>, "options": { ...
+/// } }`. For each job, a JSON line
+/// `{ "id": <id>, "ok": true, "output": <output-file>, "messages": [...] }`
+/// or `{ "id": <id>, "ok": false, "error": <error>, "messages": [...] }` is
+/// responded once the job is done. Responses may come in any order.
+/// A job being output to the same file as another one in flight fails.
+/// A request `{ "id": <any>, "shutdown": true }`, responded with
+/// `{ "id": <id>, "ok": true }`, stops the server too.
+/// Either way, jobs already taken are done and responded first.
+/// The FBX managers are kept between jobs so that only the first jobs pay for
+/// the FBX SDK initialization.
+/// </summary>
+/// <returns>0 once stopped, -1 if the server failed.</returns>
+int run_server(const ServerCommand &command_);
+} // namespace beecli
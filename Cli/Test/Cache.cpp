@@ -0,0 +1,135 @@
+#include "Cache.h"
+#include "ConvertJob.h"
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+void write_text(const std::filesystem::path &path_, std::string_view text_) {
+  std::filesystem::create_directories(path_.parent_path());
+  std::ofstream stream{path_, std::ios::binary};
+  stream << text_;
+}
+
+std::string read_text(const std::filesystem::path &path_) {
+  std::ifstream stream{path_, std::ios::binary};
+  return std::string{std::istreambuf_iterator<char>{stream}, {}};
+}
+} // namespace
+
+TEST_CASE("Conversion cache") {
+  namespace fs = std::filesystem;
+
+  const auto root =
+      fs::temp_directory_path() / u8"FBX-glTF-conv-test" / u8"cache";
+  fs::remove_all(root);
+  const auto inputFile = root / u8"in" / u8"model.fbx";
+  const auto textureFile = root / u8"in" / u8"albedo.png";
+  const auto missingTextureFile = root / u8"in" / u8"normal.png";
+  const auto outFile = root / u8"out" / u8"model.gltf";
+  const auto cacheDir = root / u8"cache";
+  write_text(inputFile, "FBX");
+  write_text(textureFile, "PNG");
+
+  beecli::CliArgs cliArgs;
+  cliArgs.inputFile = inputFile.u8string();
+  cliArgs.outFile = outFile.u8string();
+  cliArgs.cacheDir = cacheDir.u8string();
+
+  // Pretends to convert: writes the outputs as `bee::convert()` and the CLI do.
+  const auto convert = [&](beecli::ConvertJob &job_) {
+    const std::string_view buffer{"BIN"};
+    job_.writer->buffer(reinterpret_cast<const std::byte *>(buffer.data()),
+                        buffer.size(), 0, false);
+    const auto copiedTexture = outFile.parent_path() / u8"albedo.png";
+    fs::copy_file(textureFile, copiedTexture,
+                  fs::copy_options::overwrite_existing);
+
+    bee::glTF_output output;
+    output.json_text = R"({
+  "asset": {
+    "version": "2.0"
+  }
+})";
+    output.referenced_files.push_back(textureFile.u8string());
+    output.unresolved_files.push_back(missingTextureFile.u8string());
+    output.copied_files.push_back(copiedTexture.u8string());
+    beecli::write_glTF_output(job_, output);
+  };
+
+  const auto make_job = [&]() {
+    return beecli::make_convert_job(cliArgs, cliArgs.inputFile,
+                                    std::make_unique<beecli::JsonLogger>());
+  };
+
+  { // Miss, then stores
+    auto job = make_job();
+    CHECK_UNARY_FALSE(beecli::restore_cached_output(job));
+    REQUIRE(job.cacheKey.has_value());
+    convert(job);
+  }
+
+  fs::remove_all(outFile.parent_path());
+
+  { // Hit, restores all outputs
+    auto job = make_job();
+    CHECK_UNARY(beecli::restore_cached_output(job));
+    CHECK_EQ(read_text(outFile), R"({
+  "asset": {
+    "version": "2.0"
+  }
+})");
+    CHECK_EQ(read_text(outFile.parent_path() / u8"model.bin"), "BIN");
+    CHECK_EQ(read_text(outFile.parent_path() / u8"albedo.png"), "PNG");
+  }
+
+  { // Referenced texture changed
+    write_text(textureFile, "PNG2");
+    auto job = make_job();
+    CHECK_UNARY_FALSE(beecli::restore_cached_output(job));
+    write_text(textureFile, "PNG");
+  }
+
+  { // Texture missing at conversion time added since
+    write_text(missingTextureFile, "PNG");
+    auto job = make_job();
+    CHECK_UNARY_FALSE(beecli::restore_cached_output(job));
+    fs::remove(missingTextureFile);
+  }
+
+  { // Options changed
+    auto job = make_job();
+    const auto key = beecli::ConversionCache{cliArgs.cacheDir}.key(job);
+    job.convertOptions.noFlipV = !job.convertOptions.noFlipV;
+    CHECK_NE(beecli::ConversionCache{cliArgs.cacheDir}.key(job), key);
+  }
+
+  { // Levels of detail added
+    auto job = make_job();
+    auto &levelsOfDetail = job.convertOptions.levelsOfDetail;
+    levelsOfDetail.levels = {{0.5f, 0.25f}};
+    levelsOfDetail.screen_error = 0.125f;
+    const auto key = beecli::ConversionCache{cliArgs.cacheDir}.key(job);
+    levelsOfDetail.levels = {{0.5f, 0.25f}, {0.125f, 0.25f}};
+    CHECK_NE(beecli::ConversionCache{cliArgs.cacheDir}.key(job), key);
+  }
+
+  { // Input changed
+    auto job = make_job();
+    const auto key = beecli::ConversionCache{cliArgs.cacheDir}.key(job);
+    write_text(inputFile, "FBX2");
+    CHECK_NE(beecli::ConversionCache{cliArgs.cacheDir}.key(job), key);
+    CHECK_UNARY_FALSE(beecli::restore_cached_output(job));
+  }
+
+  { // Cache not used
+    cliArgs.cacheDir.clear();
+    auto job = make_job();
+    CHECK_UNARY_FALSE(beecli::restore_cached_output(job));
+    CHECK_UNARY_FALSE(job.cacheKey.has_value());
+  }
+
+  fs::remove_all(root);
+}
@@ -239,4 +239,337 @@ CHECK_EQ(u8toexe(args.convertOptions.textureResolution.locations[0]), "/a"s);
       u8toexe(*read_cli_args_with_dummy_and("--log-file=" + logFile).logFile),
       logFile);
 }
-}
\ No newline at end of file
+
+{ // Stats
+  CHECK_EQ(read_cli_args_with_dummy_and(std::span<std::string_view>{}).stats,
+           false);
+  CHECK_EQ(read_cli_args_with_dummy_and("--stats").stats, true);
+  CHECK_EQ(u8toexe(read_cli_args_with_dummy_and("--stats-file=stats.json")
+                       .statsFile.value_or(u8"")),
+           "stats.json"s);
+}
+
+{ // Batch
+  {
+    const auto args = read_cli_args_with_dummy_and(std::span<std::string_view>{});
+    CHECK_EQ(args.inputFiles.size(), 1);
+    CHECK_EQ(u8toexe(args.inputFiles[0]), dummyInput);
+    CHECK_EQ(args.jobs, 0);
+  }
+
+  {
+    std::vector<std::string_view> args{dummyArg0, dummyInput, "--jobs=4"sv,
+                                       "/Input2.fbx"sv, "/Input3.fbx"sv,
+                                       "--out-dir=/out"sv};
+    const auto command = get_as_convert_command(beecli::readCliArgs(args));
+    CHECK_EQ(u8toexe(command.inputFile), dummyInput);
+    CHECK_EQ(command.inputFiles.size(), 3);
+    CHECK_EQ(u8toexe(command.inputFiles[1]), "/Input2.fbx"s);
+    CHECK_EQ(u8toexe(command.inputFiles[2]), "/Input3.fbx"s);
+    CHECK_EQ(command.jobs, 4);
+    CHECK_EQ(u8toexe(command.outDir), "/out"s);
+  }
+
+  { // --out is ambiguous for multiple inputs
+    std::vector<std::string_view> args{dummyArg0, dummyInput, "/Input2.fbx"sv,
+                                       "--out=/a.gltf"sv};
+    CHECK_UNARY_FALSE(beecli::readCliArgs(args).has_value());
+  }
+}
+
+{ // --cache-dir
+  CHECK_EQ(u8toexe(read_cli_args_with_dummy_and(std::span<std::string_view>{})
+                       .cacheDir),
+           ""s);
+  CHECK_EQ(u8toexe(read_cli_args_with_dummy_and("--cache-dir=/cache").cacheDir),
+           "/cache"s);
+}
+
+{ // --glb
+  test_boolean_arg<&bee::ConvertOptions::glb>("glb");
+}
+
+{ // --buffer-partition
+  {
+    const auto bufferPartition =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.bufferPartition;
+    CHECK_UNARY_FALSE(bufferPartition.per_mesh);
+    CHECK_UNARY_FALSE(bufferPartition.per_animation);
+    CHECK_UNARY_FALSE(bufferPartition.per_image);
+    CHECK_EQ(bufferPartition.max_buffer_size, 0);
+  }
+
+  {
+    std::vector<std::string_view> args{"--buffer-partition=mesh,image"sv,
+                                       "--max-buffer-size=1048576"sv};
+    const auto bufferPartition =
+        read_cli_args_with_dummy_and(args).convertOptions.bufferPartition;
+    CHECK_UNARY(bufferPartition.per_mesh);
+    CHECK_UNARY_FALSE(bufferPartition.per_animation);
+    CHECK_UNARY(bufferPartition.per_image);
+    CHECK_EQ(bufferPartition.max_buffer_size, 1048576);
+  }
+
+  {
+    std::vector<std::string_view> args{dummyArg0, dummyInput,
+                                       "--buffer-partition=meshes"sv};
+    CHECK_UNARY_FALSE(beecli::readCliArgs(args).has_value());
+  }
+}
+
+{ // --mesh-threads
+  CHECK_EQ(read_cli_args_with_dummy_and(std::span<std::string_view>{})
+               .convertOptions.mesh_threads,
+           0);
+  CHECK_EQ(read_cli_args_with_dummy_and("--mesh-threads=1")
+               .convertOptions.mesh_threads,
+           1);
+}
+
+{ // Server
+  {
+    std::vector<std::string_view> args{dummyArg0, "--server"sv};
+    const auto command = beecli::readCliArgs(args);
+    CHECK(command.has_value());
+    CHECK(std::holds_alternative<beecli::ServerCommand>(*command));
+    const auto &serverCommand = std::get<beecli::ServerCommand>(*command);
+    CHECK_EQ(serverCommand.socket, std::nullopt);
+    CHECK_EQ(serverCommand.jobs, 0);
+  }
+
+  {
+    std::vector<std::string_view> args{dummyArg0, "--server"sv,
+                                       "--socket=/tmp/conv.sock"sv, "--jobs=2"sv};
+    const auto command = beecli::readCliArgs(args);
+    CHECK(command.has_value());
+    CHECK(std::holds_alternative<beecli::ServerCommand>(*command));
+    const auto &serverCommand = std::get<beecli::ServerCommand>(*command);
+    CHECK_EQ(u8toexe(serverCommand.socket.value_or(u8"")), "/tmp/conv.sock"s);
+    CHECK_EQ(serverCommand.jobs, 2);
+  }
+}
+
+{ // --sparse-morph-*
+  {
+    const auto sparseMorphTargets =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.sparseMorphTargets;
+    CHECK_EQ(sparseMorphTargets.epsilon, 0);
+    CHECK_EQ(sparseMorphTargets.max_size_ratio, 1);
+  }
+
+  {
+    std::vector<std::string_view> args{"--sparse-morph-epsilon=0.001"sv,
+                                       "--sparse-morph-max-ratio=0.5"sv};
+    const auto sparseMorphTargets =
+        read_cli_args_with_dummy_and(args).convertOptions.sparseMorphTargets;
+    CHECK_EQ(sparseMorphTargets.epsilon, doctest::Approx(0.001));
+    CHECK_EQ(sparseMorphTargets.max_size_ratio, doctest::Approx(0.5));
+  }
+}
+
+{ // --mesh-optimization
+  {
+    const auto meshOptimization =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.meshOptimization;
+    CHECK_UNARY_FALSE(meshOptimization.vertex_cache);
+    CHECK_EQ(meshOptimization.overdraw_threshold, 0);
+    CHECK_UNARY_FALSE(meshOptimization.vertex_fetch);
+  }
+
+  {
+    std::vector<std::string_view> args{
+        "--mesh-optimization=vertex-cache,overdraw,vertex-fetch"sv};
+    const auto meshOptimization =
+        read_cli_args_with_dummy_and(args).convertOptions.meshOptimization;
+    CHECK_UNARY(meshOptimization.vertex_cache);
+    CHECK_EQ(meshOptimization.overdraw_threshold, doctest::Approx(1.05));
+    CHECK_UNARY(meshOptimization.vertex_fetch);
+  }
+
+  { // The threshold only applies along with the overdraw optimization
+    std::vector<std::string_view> args{"--overdraw-threshold=1.2"sv};
+    CHECK_EQ(read_cli_args_with_dummy_and(args)
+                 .convertOptions.meshOptimization.overdraw_threshold,
+             0);
+    args.push_back("--mesh-optimization=overdraw"sv);
+    CHECK_EQ(read_cli_args_with_dummy_and(args)
+                 .convertOptions.meshOptimization.overdraw_threshold,
+             doctest::Approx(1.2));
+  }
+
+  {
+    std::vector<std::string_view> args{dummyArg0, dummyInput,
+                                       "--mesh-optimization=strip"sv};
+    CHECK_UNARY_FALSE(beecli::readCliArgs(args).has_value());
+  }
+}
+
+{ // --quantize*
+  {
+    const auto meshQuantization =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.meshQuantization;
+    CHECK_EQ(meshQuantization.position_bits, 0);
+    CHECK_EQ(meshQuantization.normal_bits, 0);
+    CHECK_EQ(meshQuantization.uv_bits, 0);
+    CHECK_EQ(meshQuantization.color_bits, 0);
+  }
+
+  {
+    const auto meshQuantization = read_cli_args_with_dummy_and("--quantize"sv)
+                                      .convertOptions.meshQuantization;
+    CHECK_EQ(meshQuantization.position_bits, 16);
+    CHECK_EQ(meshQuantization.normal_bits, 8);
+    CHECK_EQ(meshQuantization.uv_bits, 16);
+    CHECK_EQ(meshQuantization.color_bits, 8);
+  }
+
+  { // Bits override the presets of --quantize, or set them alone
+    std::vector<std::string_view> args{"--quantize"sv,
+                                       "--quantize-position-bits=14"sv,
+                                       "--quantize-normal-bits=0"sv};
+    auto meshQuantization =
+        read_cli_args_with_dummy_and(args).convertOptions.meshQuantization;
+    CHECK_EQ(meshQuantization.position_bits, 14);
+    CHECK_EQ(meshQuantization.normal_bits, 0);
+    CHECK_EQ(meshQuantization.uv_bits, 16);
+    CHECK_EQ(meshQuantization.color_bits, 8);
+
+    meshQuantization = read_cli_args_with_dummy_and("--quantize-uv-bits=12"sv)
+                           .convertOptions.meshQuantization;
+    CHECK_EQ(meshQuantization.position_bits, 0);
+    CHECK_EQ(meshQuantization.uv_bits, 12);
+  }
+}
+
+{ // --meshopt-*
+  {
+    const auto meshoptCompression =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.meshoptCompression;
+    CHECK_UNARY_FALSE(meshoptCompression.enabled);
+    CHECK_UNARY_FALSE(meshoptCompression.fallback);
+    CHECK_UNARY_FALSE(meshoptCompression.octahedral_normals);
+    CHECK_EQ(meshoptCompression.quaternion_bits, 0);
+    CHECK_EQ(meshoptCompression.exponential_bits, 0);
+  }
+
+  {
+    std::vector<std::string_view> args{
+        "--meshopt-compression"sv, "--meshopt-fallback"sv,
+        "--meshopt-octahedral"sv, "--meshopt-quaternion-bits=12"sv,
+        "--meshopt-exponential-bits=15"sv};
+    const auto meshoptCompression =
+        read_cli_args_with_dummy_and(args).convertOptions.meshoptCompression;
+    CHECK_UNARY(meshoptCompression.enabled);
+    CHECK_UNARY(meshoptCompression.fallback);
+    CHECK_UNARY(meshoptCompression.octahedral_normals);
+    CHECK_EQ(meshoptCompression.quaternion_bits, 12);
+    CHECK_EQ(meshoptCompression.exponential_bits, 15);
+  }
+}
+
+{ // --lod-*
+  {
+    const auto levelsOfDetail =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.levelsOfDetail;
+    CHECK_UNARY(levelsOfDetail.levels.empty());
+  }
+
+  {
+    std::vector<std::string_view> args{"--lod-ratios=0.5,0.25"sv,
+                                       "--lod-errors=0.01,0.02"sv,
+                                       "--lod-screen-error=0.002"sv};
+    const auto levelsOfDetail =
+        read_cli_args_with_dummy_and(args).convertOptions.levelsOfDetail;
+    REQUIRE_EQ(levelsOfDetail.levels.size(), 2);
+    CHECK_EQ(levelsOfDetail.levels[0].ratio, doctest::Approx(0.5));
+    CHECK_EQ(levelsOfDetail.levels[0].max_error, doctest::Approx(0.01));
+    CHECK_EQ(levelsOfDetail.levels[1].ratio, doctest::Approx(0.25));
+    CHECK_EQ(levelsOfDetail.levels[1].max_error, doctest::Approx(0.02));
+    CHECK_EQ(levelsOfDetail.screen_error, doctest::Approx(0.002));
+  }
+
+  { // Levels beyond the errors aren't bounded by an error
+    const auto levelsOfDetail =
+        read_cli_args_with_dummy_and("--lod-ratios=0.5,0.25"sv)
+            .convertOptions.levelsOfDetail;
+    REQUIRE_EQ(levelsOfDetail.levels.size(), 2);
+    CHECK_EQ(levelsOfDetail.levels[1].ratio, doctest::Approx(0.25));
+    CHECK_EQ(levelsOfDetail.levels[1].max_error, 1);
+    CHECK_EQ(levelsOfDetail.screen_error, doctest::Approx(0.001));
+  }
+
+  { // Levels beyond the ratios simplify as far as their error allows
+    std::vector<std::string_view> args{"--lod-ratios=0.5"sv,
+                                       "--lod-errors=0.01,0.05"sv};
+    const auto levelsOfDetail =
+        read_cli_args_with_dummy_and(args).convertOptions.levelsOfDetail;
+    REQUIRE_EQ(levelsOfDetail.levels.size(), 2);
+    CHECK_EQ(levelsOfDetail.levels[0].ratio, doctest::Approx(0.5));
+    CHECK_EQ(levelsOfDetail.levels[1].ratio, 0);
+    CHECK_EQ(levelsOfDetail.levels[1].max_error, doctest::Approx(0.05));
+  }
+}
+
+{ // --draco*
+  {
+    const auto dracoCompression =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.dracoCompression;
+    CHECK_UNARY_FALSE(dracoCompression.enabled);
+    CHECK_UNARY_FALSE(dracoCompression.fallback);
+    CHECK_EQ(dracoCompression.position_bits, 11);
+    CHECK_EQ(dracoCompression.normal_bits, 8);
+    CHECK_EQ(dracoCompression.uv_bits, 10);
+    CHECK_EQ(dracoCompression.color_bits, 8);
+    CHECK_EQ(dracoCompression.generic_bits, 8);
+    CHECK_EQ(dracoCompression.speed, 3);
+  }
+
+  {
+    std::vector<std::string_view> args{
+        "--draco"sv,
+        "--draco-fallback"sv,
+        "--draco-position-bits=14"sv,
+        "--draco-normal-bits=10"sv,
+        "--draco-uv-bits=12"sv,
+        "--draco-color-bits=0"sv,
+        "--draco-generic-bits=6"sv,
+        "--draco-speed=7"sv};
+    const auto dracoCompression =
+        read_cli_args_with_dummy_and(args).convertOptions.dracoCompression;
+    CHECK_UNARY(dracoCompression.enabled);
+    CHECK_UNARY(dracoCompression.fallback);
+    CHECK_EQ(dracoCompression.position_bits, 14);
+    CHECK_EQ(dracoCompression.normal_bits, 10);
+    CHECK_EQ(dracoCompression.uv_bits, 12);
+    CHECK_EQ(dracoCompression.color_bits, 0);
+    CHECK_EQ(dracoCompression.generic_bits, 6);
+    CHECK_EQ(dracoCompression.speed, 7);
+  }
+}
+
+{ // --gpu-instancing*
+  {
+    const auto gpuInstancing =
+        read_cli_args_with_dummy_and(std::span<std::string_view>{})
+            .convertOptions.gpuInstancing;
+    CHECK_UNARY_FALSE(gpuInstancing.enabled);
+    CHECK_EQ(gpuInstancing.min_instances, 2);
+  }
+
+  {
+    std::vector<std::string_view> args{"--gpu-instancing"sv,
+                                       "--gpu-instancing-min=16"sv};
+    const auto gpuInstancing =
+        read_cli_args_with_dummy_and(args).convertOptions.gpuInstancing;
+    CHECK_UNARY(gpuInstancing.enabled);
+    CHECK_EQ(gpuInstancing.min_instances, 16);
+  }
+}
+}
@@ -0,0 +1,171 @@
+#include "Server.h"
+#include <chrono>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std::literals;
+
+namespace {
+std::string u8toexe(std::u8string_view u8sv_) {
+  return std::string{u8sv_.begin(), u8sv_.end()};
+}
+} // namespace
+
+TEST_CASE("Server job options") {
+  { // Values
+    const auto args = beecli::job_options_to_args(bee::Json{
+        {"glb", true},
+        {"no-flip-v", false},
+        {"animation-bake-rate", 60},
+        {"out", "/out/a.gltf"},
+        {"texture-search-locations", {"/a", "/b"}},
+        {"fbm-dir", nullptr},
+    });
+    // Object keys are iterated in lexicographical order.
+    const std::vector<std::string> expected{
+        "--animation-bake-rate=60",
+        "--glb=true",
+        "--no-flip-v=false",
+        "--out=/out/a.gltf",
+        "--texture-search-locations=/a,/b",
+    };
+    CHECK_EQ(args, expected);
+  }
+
+  { // Options that don't apply to a single job
+    for (const auto option : {"log-file", "jobs", "more-input-files",
+                              "server", "socket", "input-file"}) {
+      CHECK_THROWS_AS(beecli::job_options_to_args(bee::Json{{option, "x"}}),
+                      std::runtime_error);
+    }
+  }
+
+  CHECK_THROWS_AS(beecli::job_options_to_args(bee::Json::array()),
+                  std::runtime_error);
+  CHECK_THROWS_AS(
+      beecli::job_options_to_args(bee::Json{{"out", bee::Json::object()}}),
+      std::runtime_error);
+}
+
+TEST_CASE("Server job request") {
+  {
+    const auto cliArgs = beecli::read_server_job_args(bee::Json{
+        {"id", 1},
+        {"input", "/Input.fbx"},
+        {"options",
+         {{"out", "/out/Input.glb"}, {"verbose", true}, {"unit-conversion",
+                                                        "disabled"}}},
+    });
+    CHECK_EQ(u8toexe(cliArgs.inputFile), "/Input.fbx"s);
+    CHECK_EQ(cliArgs.inputFiles.size(), 1);
+    CHECK_EQ(u8toexe(cliArgs.outFile), "/out/Input.glb"s);
+    CHECK_EQ(cliArgs.convertOptions.verbose, true);
+    CHECK_EQ(cliArgs.convertOptions.unitConversion,
+             bee::ConvertOptions::UnitConversion::disabled);
+  }
+
+  { // Options are optional
+    const auto cliArgs =
+        beecli::read_server_job_args(bee::Json{{"input", "/Input.fbx"}});
+    CHECK_EQ(u8toexe(cliArgs.inputFile), "/Input.fbx"s);
+  }
+
+  { // Missing input
+    CHECK_THROWS_AS(beecli::read_server_job_args(bee::Json::object()),
+                    std::runtime_error);
+  }
+
+  { // Unknown option
+    CHECK_THROWS_AS(beecli::read_server_job_args(bee::Json{
+                        {"input", "/Input.fbx"}, {"options", {{"foo", 1}}}}),
+                    std::runtime_error);
+  }
+
+  { // Bad option value
+    CHECK_THROWS_AS(
+        beecli::read_server_job_args(bee::Json{
+            {"input", "/Input.fbx"}, {"options", {{"image-path-mode", "foo"}}}}),
+        std::runtime_error);
+  }
+}
+
+#ifndef _WIN32
+TEST_CASE("Server socket") {
+  const auto socketPath = std::filesystem::temp_directory_path() /
+                          u8"FBX-glTF-conv-test" / u8"server.sock";
+  std::filesystem::create_directories(socketPath.parent_path());
+  beecli::ServerCommand command;
+  command.socket = socketPath.u8string();
+  command.jobs = 1;
+  std::optional<int> exitCode;
+  std::thread server{[&]() { exitCode = beecli::run_server(command); }};
+
+  // Connects once the server listens.
+  const auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const auto socketPathString = socketPath.string();
+  std::copy(socketPathString.begin(), socketPathString.end(),
+            address.sun_path);
+  bool connected = false;
+  for (int attempt = 0; !connected && attempt < 500; ++attempt) {
+    connected = ::connect(fd, reinterpret_cast<const sockaddr *>(&address),
+                          sizeof(address)) == 0;
+    if (!connected) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+  }
+  if (!connected) {
+    server.detach();
+  }
+  REQUIRE_UNARY(connected);
+
+  const std::string_view requests =
+      "{\"id\": 1, \"input\": \"a.fbx\", \"options\": {\"foo\": 1}}\n"
+      "not JSON\n"
+      "{\"id\": 2, \"shutdown\": true}\n"
+      "{\"id\": 3, \"input\": \"a.fbx\"}\n";
+  CHECK_EQ(::send(fd, requests.data(), requests.size(), 0),
+           static_cast<ssize_t>(requests.size()));
+
+  // The jobs taken are responded before the server closes the connection.
+  std::string responses;
+  std::array<char, 4096> chunk;
+  for (ssize_t nRead = 0;
+       (nRead = ::recv(fd, chunk.data(), chunk.size(), 0)) > 0;) {
+    responses.append(chunk.data(), static_cast<std::size_t>(nRead));
+  }
+  ::close(fd);
+  server.join();
+  CHECK_EQ(exitCode, 0);
+  CHECK_UNARY_FALSE(std::filesystem::exists(socketPath));
+
+  std::map<std::string, bee::Json> responsesById;
+  for (auto lineEnd = responses.find('\n'); lineEnd != std::string::npos;
+       lineEnd = responses.find('\n')) {
+    const auto response = bee::Json::parse(responses.substr(0, lineEnd));
+    responsesById.emplace(response["id"].dump(), response);
+    responses.erase(0, lineEnd + 1);
+  }
+  CHECK_UNARY(responses.empty());
+  // Nothing after the shutdown request is taken.
+  REQUIRE_EQ(responsesById.size(), 3);
+  // The options are read by the worker picking the job up.
+  CHECK_EQ(responsesById["1"]["ok"], false);
+  CHECK_EQ(responsesById["1"]["messages"], bee::Json::array());
+  CHECK_EQ(responsesById["null"]["ok"], false);
+  const bee::Json shutdownResponse{{"id", 2}, {"ok", true}};
+  CHECK_EQ(responsesById["2"], shutdownResponse);
+}
+#endif
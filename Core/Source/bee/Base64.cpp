@@ -0,0 +1,291 @@
+#include <bee/Base64.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||            \
+    defined(_M_IX86)
+#define BEE_BASE64_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(BEE_BASE64_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BEE_TARGET(isa_) __attribute__((target(isa_)))
+#else
+#define BEE_TARGET(isa_)
+#endif
+
+namespace bee {
+namespace {
+constexpr char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/// <summary>
+/// Inputs this large are split into chunks encoded on several threads.
+/// </summary>
+constexpr std::size_t parallelThreshold = 4 * 1024 * 1024;
+
+/// <summary>
+/// Threads aren't given less than this.
+/// </summary>
+constexpr std::size_t minChunkSize = 1024 * 1024;
+
+using Kernel = std::size_t (*)(const std::uint8_t *in_,
+                               std::size_t size_,
+                               char *out_);
+
+/// <summary>
+/// Encodes the whole 3-byte groups and the padded tail.
+/// </summary>
+void encode_scalar(const std::uint8_t *in_, std::size_t size_, char *out_) {
+  for (; size_ >= 3; size_ -= 3, in_ += 3, out_ += 4) {
+    const auto group = (static_cast<std::uint32_t>(in_[0]) << 16) |
+                       (static_cast<std::uint32_t>(in_[1]) << 8) | in_[2];
+    out_[0] = alphabet[(group >> 18) & 0x3F];
+    out_[1] = alphabet[(group >> 12) & 0x3F];
+    out_[2] = alphabet[(group >> 6) & 0x3F];
+    out_[3] = alphabet[group & 0x3F];
+  }
+  if (size_ != 0) {
+    const auto group = (static_cast<std::uint32_t>(in_[0]) << 16) |
+                       (size_ == 2 ? static_cast<std::uint32_t>(in_[1]) << 8
+                                   : 0u);
+    out_[0] = alphabet[(group >> 18) & 0x3F];
+    out_[1] = alphabet[(group >> 12) & 0x3F];
+    out_[2] = size_ == 2 ? alphabet[(group >> 6) & 0x3F] : '=';
+    out_[3] = '=';
+  }
+}
+
+#ifdef BEE_BASE64_X86
+// The vector kernels follow Wojciech Muła's SIMD base64 encoding:
+// http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+// Each 16-byte lane takes 12 input bytes and produces 16 chars.
+
+/// <summary>
+/// Splits the 3-byte groups, placed in 4-byte slots by a shuffle,
+/// into one 6-bit index per byte.
+/// </summary>
+BEE_TARGET("ssse3") __m128i split_sextets(__m128i in_) {
+  in_ = _mm_shuffle_epi8(
+      in_, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const auto t0 = _mm_and_si128(in_, _mm_set1_epi32(0x0FC0FC00));
+  const auto t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const auto t2 = _mm_and_si128(in_, _mm_set1_epi32(0x003F03F0));
+  const auto t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+/// <summary>
+/// Maps 6-bit indices to the alphabet by adding a per-range offset.
+/// </summary>
+BEE_TARGET("ssse3") __m128i lookup(__m128i indices_) {
+  auto reduced = _mm_subs_epu8(indices_, _mm_set1_epi8(51));
+  const auto less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices_);
+  reduced = _mm_or_si128(reduced, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const auto offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offsets, reduced), indices_);
+}
+
+BEE_TARGET("ssse3")
+std::size_t encode_ssse3(const std::uint8_t *in_,
+                         std::size_t size_,
+                         char *out_) {
+  std::size_t consumed = 0;
+  // Loads 16 bytes for every 12 consumed.
+  for (; size_ - consumed >= 16; consumed += 12, out_ += 16) {
+    const auto in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in_ + consumed));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out_),
+                     lookup(split_sextets(in)));
+  }
+  return consumed;
+}
+
+BEE_TARGET("avx2")
+std::size_t encode_avx2(const std::uint8_t *in_,
+                        std::size_t size_,
+                        char *out_) {
+  const auto shuffle = _mm256_set_epi8(
+      10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, //
+      10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+  const auto offsets = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+  std::size_t consumed = 0;
+  // Each lane loads 16 bytes: the second one starts 12 bytes after the first.
+  for (; size_ - consumed >= 28; consumed += 24, out_ += 32) {
+    const auto low =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(in_ + consumed));
+    const auto high = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(in_ + consumed + 12));
+    auto in = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+
+    in = _mm256_shuffle_epi8(in, shuffle);
+    const auto t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00));
+    const auto t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const auto t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0));
+    const auto t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const auto indices = _mm256_or_si256(t1, t3);
+
+    auto reduced = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const auto less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    reduced =
+        _mm256_or_si256(reduced, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    const auto chars =
+        _mm256_add_epi8(_mm256_shuffle_epi8(offsets, reduced), indices);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out_), chars);
+  }
+  return consumed;
+}
+
+bool cpu_supports_avx2() {
+#ifdef _MSC_VER
+  std::array<int, 4> info;
+  __cpuid(info.data(), 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info.data(), 1);
+  const auto osxsave = (info[2] & (1 << 27)) != 0;
+  const auto avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info.data(), 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool cpu_supports_ssse3() {
+#ifdef _MSC_VER
+  std::array<int, 4> info;
+  __cpuid(info.data(), 1);
+  return (info[2] & (1 << 9)) != 0;
+#else
+  return __builtin_cpu_supports("ssse3");
+#endif
+}
+#endif
+
+Kernel select_kernel() {
+#ifdef BEE_BASE64_X86
+  if (cpu_supports_avx2()) {
+    return &encode_avx2;
+  }
+  if (cpu_supports_ssse3()) {
+    return &encode_ssse3;
+  }
+#endif
+  return nullptr;
+}
+
+/// <summary>
+/// Encodes the bytes `[begin_, end_)` of the segments.
+/// Groups of 3 bytes straddling two segments are gathered first.
+/// </summary>
+void encode_segments(std::span<const SegmentedBuffer::Segment> segments_,
+                     std::size_t begin_,
+                     std::size_t end_,
+                     char *out_) {
+  std::array<std::byte, 3> carry;
+  std::size_t nCarry = 0;
+  std::size_t segmentBegin = 0;
+  for (const auto &segment : segments_) {
+    const auto segmentEnd = segmentBegin + segment.size();
+    if (segmentEnd <= begin_) {
+      segmentBegin = segmentEnd;
+      continue;
+    }
+    if (segmentBegin >= end_) {
+      break;
+    }
+    const auto pieceBegin = std::max(segmentBegin, begin_);
+    const auto pieceEnd = std::min(segmentEnd, end_);
+    auto piece =
+        segment.subspan(pieceBegin - segmentBegin, pieceEnd - pieceBegin);
+    segmentBegin = segmentEnd;
+
+    if (nCarry != 0) {
+      const auto nTaken = std::min(3 - nCarry, piece.size());
+      std::copy_n(piece.begin(), nTaken, carry.begin() + nCarry);
+      nCarry += nTaken;
+      piece = piece.subspan(nTaken);
+      if (nCarry != 3) {
+        continue;
+      }
+      base64_encode(carry, out_);
+      out_ += 4;
+      nCarry = 0;
+    }
+
+    const auto nWhole = piece.size() / 3 * 3;
+    base64_encode(piece.first(nWhole), out_);
+    out_ += nWhole / 3 * 4;
+    nCarry = piece.size() - nWhole;
+    std::copy_n(piece.begin() + nWhole, nCarry, carry.begin());
+  }
+  if (nCarry != 0) {
+    base64_encode(std::span{carry}.first(nCarry), out_);
+  }
+}
+} // namespace
+
+void base64_encode(std::span<const std::byte> data_, char *out_) {
+  static const auto kernel = select_kernel();
+
+  auto in = reinterpret_cast<const std::uint8_t *>(data_.data());
+  auto size = data_.size();
+  if (kernel) {
+    const auto consumed = kernel(in, size, out_);
+    in += consumed;
+    size -= consumed;
+    out_ += consumed / 3 * 4;
+  }
+  encode_scalar(in, size, out_);
+}
+
+void base64_append(std::string &out_, const SegmentedBuffer &buffer_) {
+  const auto size = buffer_.size();
+  const auto outBegin = out_.size();
+  out_.resize(outBegin + base64_encoded_size(size));
+  const auto out = out_.data() + outBegin;
+
+  const auto segments = std::span{buffer_.segments()};
+  if (size < parallelThreshold) {
+    encode_segments(segments, 0, size, out);
+    return;
+  }
+
+  const auto nThreads = std::min<std::size_t>(
+      std::max(1u, std::thread::hardware_concurrency()), size / minChunkSize);
+  // Chunks, but the last, are whole 3-byte groups so they encode without
+  // padding, and right where they'd be if encoded in one go.
+  const auto chunkSize = (size / nThreads + 2) / 3 * 3;
+  std::vector<std::thread> threads;
+  threads.reserve(nThreads - 1);
+  for (std::size_t begin = chunkSize; begin < size; begin += chunkSize) {
+    const auto end = std::min(size, begin + chunkSize);
+    threads.emplace_back([segments, begin, end, out]() {
+      encode_segments(segments, begin, end, out + begin / 3 * 4);
+    });
+  }
+  encode_segments(segments, 0, std::min(size, chunkSize), out);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+} // namespace bee
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <bee/SegmentedBuffer.h>
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace bee {
+/// <summary>
+/// Length of the padded base64(RFC 4648) encoding of `size_` bytes.
+/// </summary>
+constexpr std::size_t base64_encoded_size(std::size_t size_) {
+  return (size_ + 2) / 3 * 4;
+}
+
+/// <summary>
+/// Encodes into `out_`, which shall have room for
+/// `base64_encoded_size(data_.size())` chars.
+/// Uses AVX2 or SSSE3 if the CPU supports them.
+/// </summary>
+BEE_API void base64_encode(std::span<const std::byte> data_, char *out_);
+
+/// <summary>
+/// Appends the encoding of the buffer to `out_`.
+/// Large buffers are encoded in chunks on several threads.
+/// </summary>
+BEE_API void base64_append(std::string &out_, const SegmentedBuffer &buffer_);
+} // namespace bee
@@ -7,6 +7,7 @@
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace bee {
@@ -17,13 +18,18 @@ template <typename Element_> struct FbxMeshAttributeLayout {
   FbxMeshAttributeLayout() = default;
 
   FbxMeshAttributeLayout(std::uint32_t offset_, Element_ element_)
-      : offset(offset_), element(element_) {
+      : offset(offset_), element(std::move(element_)) {
   }
 };
 
 struct FbxMeshVertexLayout {
   std::uint32_t size = sizeof(NeutralVertexComponent) * 3;
 
+  /// <summary>
+  /// Size of the attributes but the shapes', which are laid out last.
+  /// </summary>
+  std::uint32_t baseSize = sizeof(NeutralVertexComponent) * 3;
+
   std::optional<FbxMeshAttributeLayout<
       FbxLayerElementAccessor<fbxsdk::FbxLayerElementNormal::ArrayElementType>>>
       normal;
@@ -51,7 +57,7 @@ struct FbxMeshVertexLayout {
   std::optional<Skinning> skinning;
 
   struct ShapeLayout {
-    FbxMeshAttributeLayout<fbxsdk::FbxVector4 *> constrolPoints;
+    FbxMeshAttributeLayout<std::vector<fbxsdk::FbxVector4>> constrolPoints;
 
     std::optional<FbxMeshAttributeLayout<FbxLayerElementAccessor<
         fbxsdk::FbxLayerElementNormal::ArrayElementType>>>
@@ -62,4 +68,4 @@ struct FbxMeshVertexLayout {
 
   std::unordered_map<std::string, std::uint32_t> uv_channel_index_map;
 };
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
@@ -82,6 +82,8 @@ void SceneConverter::_convertAnimation(fbxsdk::FbxScene &fbx_scene_) {
     fx::gltf::Animation glTFAnimation;
     const auto animName = _convertName(animStack->GetName());
     glTFAnimation.name = animName;
+    const auto bufferIndex =
+        _partitionBuffer(_options.bufferPartition.per_animation, animName);
 
     _log(Logger::Level::verbose,
          fmt::format("Take {}: {}s", animName,
@@ -92,7 +94,8 @@ void SceneConverter::_convertAnimation(fbxsdk::FbxScene &fbx_scene_) {
          iAnimLayer < nAnimLayers; ++iAnimLayer) {
       const auto animLayer =
           animStack->GetMember<fbxsdk::FbxAnimLayer>(iAnimLayer);
-      _convertAnimationLayer(glTFAnimation, *animLayer, fbx_scene_, animRange);
+      _convertAnimationLayer(glTFAnimation, *animLayer, fbx_scene_, animRange,
+                             bufferIndex);
     }
     if (!glTFAnimation.samplers.empty()) {
       _glTFBuilder.add(&fx::gltf::Document::animations,
@@ -174,13 +177,14 @@ void SceneConverter::_convertAnimationLayer(
     fx::gltf::Animation &glTF_animation_,
     fbxsdk::FbxAnimLayer &fbx_anim_layer_,
     fbxsdk::FbxScene &fbx_scene_,
-    const AnimRange &anim_range_) {
+    const AnimRange &anim_range_,
+    GLTFBuilder::XXIndex buffer_index_) {
   const auto nNodes = fbx_scene_.GetNodeCount();
   for (std::remove_const_t<decltype(nNodes)> iNode = 0; iNode < nNodes;
        ++iNode) {
     auto fbxNode = fbx_scene_.GetNode(iNode);
     _convertAnimationLayer(glTF_animation_, fbx_anim_layer_, *fbxNode,
-                           anim_range_);
+                           anim_range_, buffer_index_);
   }
 }
 
@@ -188,15 +192,16 @@ void SceneConverter::_convertAnimationLayer(
     fx::gltf::Animation &glTF_animation_,
     fbxsdk::FbxAnimLayer &fbx_anim_layer_,
     fbxsdk::FbxNode &fbx_node_,
-    const AnimRange &anim_range_) {
+    const AnimRange &anim_range_,
+    GLTFBuilder::XXIndex buffer_index_) {
   if (_options.export_trs_animation) {
     _extractTrsAnimation(glTF_animation_, fbx_anim_layer_, fbx_node_,
-                         anim_range_);
+                         anim_range_, buffer_index_);
   }
 
   if (_options.export_blend_shape_animation) {
     _extractWeightsAnimation(glTF_animation_, fbx_anim_layer_, fbx_node_,
-                             anim_range_);
+                             anim_range_, buffer_index_);
   }
 }
 
@@ -204,7 +209,8 @@ void SceneConverter::_extractWeightsAnimation(
     fx::gltf::Animation &glTF_animation_,
     fbxsdk::FbxAnimLayer &fbx_anim_layer_,
     fbxsdk::FbxNode &fbx_node_,
-    const AnimRange &anim_range_) {
+    const AnimRange &anim_range_,
+    GLTFBuilder::XXIndex buffer_index_) {
   auto rNodeBumpMeta = _nodeDumpMetaMap.find(&fbx_node_);
   if (rNodeBumpMeta == _nodeDumpMetaMap.end()) {
     return;
@@ -248,7 +254,7 @@ void SceneConverter::_extractWeightsAnimation(
                      }))) {
       if (first) {
         _writeMorphAnimtion(glTF_animation_, *first, nodeBumpMeta.glTFNodeIndex,
-                            fbx_node_);
+                            fbx_node_, buffer_index_);
       }
     } else {
       _log(Logger::Level::warning,
@@ -261,12 +267,17 @@ void SceneConverter::_extractWeightsAnimation(
 void SceneConverter::_writeMorphAnimtion(fx::gltf::Animation &glTF_animation_,
                                          const MorphAnimation &morph_animtion_,
                                          std::uint32_t glTF_node_index_,
-                                         const fbxsdk::FbxNode &fbx_node_) {
+                                         const fbxsdk::FbxNode &fbx_node_,
+                                         GLTFBuilder::XXIndex buffer_index_) {
+  // Morph animations are not reduced.
+  _stats.keyframes_baked += morph_animtion_.times.size();
+  _stats.keyframes_kept += morph_animtion_.times.size();
+
   auto timeAccessorIndex = _glTFBuilder.createAccessor<
       fx::gltf::Accessor::Type::Scalar,
       fx::gltf::Accessor::ComponentType::Float,
       DirectSpreader<decltype(morph_animtion_.times)::value_type>>(
-      std::span{morph_animtion_.times}, 0, 0, true);
+      std::span{morph_animtion_.times}, 0, buffer_index_, true);
   _glTFBuilder.get(&fx::gltf::Document::accessors)[timeAccessorIndex].name =
       fmt::format("{}/weights/Input", fbx_node_.GetName());
 
@@ -274,7 +285,7 @@ void SceneConverter::_writeMorphAnimtion(fx::gltf::Animation &glTF_animation_,
       fx::gltf::Accessor::Type::Scalar,
       fx::gltf::Accessor::ComponentType::Float,
       DirectSpreader<decltype(morph_animtion_.values)::value_type>>(
-      morph_animtion_.values, 0, 0);
+      morph_animtion_.values, 0, buffer_index_);
   _glTFBuilder.get(&fx::gltf::Document::accessors)[weightsAccessorIndex].name =
       fmt::format("{}/weights/Output", fbx_node_.GetName());
 
@@ -402,7 +413,8 @@ SceneConverter::_extractWeightsAnimation(
 void SceneConverter::_extractTrsAnimation(fx::gltf::Animation &glTF_animation_,
                                           fbxsdk::FbxAnimLayer &fbx_anim_layer_,
                                           fbxsdk::FbxNode &fbx_node_,
-                                          const AnimRange &anim_range_) {
+                                          const AnimRange &anim_range_,
+                                          GLTFBuilder::XXIndex buffer_index_) {
   const auto glTFNodeIndex = _getNodeMap(fbx_node_);
   if (!glTFNodeIndex) {
     return;
@@ -449,19 +461,25 @@ void SceneConverter::_extractTrsAnimation(fx::gltf::Animation &glTF_animation_,
     }
   }
 
+  const auto countKeyframes = [&]() {
+    return translations.times.size() + rotations.times.size() +
+           scales.times.size();
+  };
+  _stats.keyframes_baked += countKeyframes();
   translations.reduceLinearKeys(
       _applyUnitScaleFactor(_options.animation_position_error_multiplier));
   rotations.reduceLinearKeys(defaultEplislon);
   scales.reduceLinearKeys(_options.animation_scale_error_multiplier);
+  _stats.keyframes_kept += countKeyframes();
 
-  auto addChannel = [&glTF_animation_, glTFNodeIndex, this,
+  auto addChannel = [&glTF_animation_, glTFNodeIndex, buffer_index_, this,
                      &fbx_node_](const auto &track_, std::string_view path_,
                                  std::uint32_t value_accessor_index_) {
     const auto timeAccessorIndex = _glTFBuilder.createAccessor<
         fx::gltf::Accessor::Type::Scalar,
         fx::gltf::Accessor::ComponentType::Float,
         DirectSpreader<typename decltype(track_.times)::value_type>>(
-        track_.times, 0, 0, true);
+        track_.times, 0, buffer_index_, true);
     _glTFBuilder.get(&fx::gltf::Document::accessors)[timeAccessorIndex].name =
         fmt::format("{}/{}/Input", fbx_node_.GetName(), path_);
 
@@ -481,26 +499,48 @@ void SceneConverter::_extractTrsAnimation(fx::gltf::Animation &glTF_animation_,
 
   using ComponentType =
       GLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Float>;
+  const auto &meshoptCompression = _options.meshoptCompression;
+  const auto vec3Filter = meshoptCompression.enabled &&
+                                  meshoptCompression.exponential_bits != 0
+                              ? MeshoptFilter::exponential
+                              : MeshoptFilter::none;
   if (isTranslationAnimated) {
     auto valueAccessorIndex =
         _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
                                     fx::gltf::Accessor::ComponentType::Float,
-                                    FbxVec3Spreader>(translations.values, 0, 0);
+                                    FbxVec3Spreader>(
+            translations.values, 0, buffer_index_, false, vec3Filter,
+            meshoptCompression.exponential_bits);
     addChannel(translations, "translation", valueAccessorIndex);
   }
   if (isRotationAnimated) {
-    auto valueAccessorIndex =
-        _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec4,
-                                    fx::gltf::Accessor::ComponentType::Float,
-                                    FbxQuatSpreader>(rotations.values, 0, 0);
+    GLTFBuilder::XXIndex valueAccessorIndex = 0;
+    if (meshoptCompression.enabled && meshoptCompression.quaternion_bits != 0) {
+      // The quaternion filter takes normalized shorts.
+      valueAccessorIndex = _glTFBuilder.createAccessor<
+          fx::gltf::Accessor::Type::Vec4,
+          fx::gltf::Accessor::ComponentType::Short, FbxQuatSnormSpreader>(
+          rotations.values, 0, buffer_index_, false, MeshoptFilter::quaternion,
+          meshoptCompression.quaternion_bits);
+      _glTFBuilder.get(&fx::gltf::Document::accessors)[valueAccessorIndex]
+          .normalized = true;
+    } else {
+      valueAccessorIndex =
+          _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec4,
+                                      fx::gltf::Accessor::ComponentType::Float,
+                                      FbxQuatSpreader>(rotations.values, 0,
+                                                       buffer_index_);
+    }
     addChannel(rotations, "rotation", valueAccessorIndex);
   }
   if (isScaleAnimated) {
     auto valueAccessorIndex =
         _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
                                     fx::gltf::Accessor::ComponentType::Float,
-                                    FbxVec3Spreader>(scales.values, 0, 0);
+                                    FbxVec3Spreader>(
+            scales.values, 0, buffer_index_, false, vec3Filter,
+            meshoptCompression.exponential_bits);
     addChannel(scales, "scale", valueAccessorIndex);
   }
 }
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
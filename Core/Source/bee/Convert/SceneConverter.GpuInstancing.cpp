@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <bee/Convert/SceneConverter.h>
+#include <bee/Convert/fbxsdk/Spreader.h>
+#include <fmt/format.h>
+
+namespace bee {
+void SceneConverter::_findGpuInstances() {
+  // Joints are moved by skins, so they stay nodes of their own.
+  std::unordered_set<const fbxsdk::FbxNode *> joints;
+  const auto nClusters = _fbxScene.GetSrcObjectCount<fbxsdk::FbxCluster>();
+  for (std::remove_const_t<decltype(nClusters)> iCluster = 0;
+       iCluster < nClusters; ++iCluster) {
+    if (const auto link =
+            _fbxScene.GetSrcObject<fbxsdk::FbxCluster>(iCluster)->GetLink()) {
+      joints.insert(link);
+    }
+  }
+
+  std::vector<fbxsdk::FbxAnimLayer *> animLayers;
+  const auto nAnimStacks = _fbxScene.GetSrcObjectCount<fbxsdk::FbxAnimStack>();
+  for (std::remove_const_t<decltype(nAnimStacks)> iAnimStack = 0;
+       iAnimStack < nAnimStacks; ++iAnimStack) {
+    const auto animStack =
+        _fbxScene.GetSrcObject<fbxsdk::FbxAnimStack>(iAnimStack);
+    const auto nAnimLayers = animStack->GetMemberCount<fbxsdk::FbxAnimLayer>();
+    for (std::remove_const_t<decltype(nAnimLayers)> iAnimLayer = 0;
+         iAnimLayer < nAnimLayers; ++iAnimLayer) {
+      animLayers.push_back(
+          animStack->GetMember<fbxsdk::FbxAnimLayer>(iAnimLayer));
+    }
+  }
+
+  // A node may be collapsed if it's a leaf holding only meshes, which nothing
+  // deforms, moves or transforms geometrically, so that its transform is all
+  // an instance needs.
+  const auto getInstancingKey = [&](fbxsdk::FbxNode &fbx_node_)
+      -> std::optional<MeshInstancingKey> {
+    if (fbx_node_.GetChildCount() != 0 || joints.contains(&fbx_node_)) {
+      return {};
+    }
+    if (std::get<0>(_getGeometrixTransform(fbx_node_)) !=
+        fbxsdk::FbxMatrix{}) {
+      return {};
+    }
+    for (const auto animLayer : animLayers) {
+      if (fbx_node_.LclTranslation.IsAnimated(animLayer) ||
+          fbx_node_.LclRotation.IsAnimated(animLayer) ||
+          fbx_node_.LclScaling.IsAnimated(animLayer)) {
+        return {};
+      }
+    }
+
+    std::unordered_set<fbxsdk::FbxMesh *> meshes;
+    for (auto nNodeAttributes = fbx_node_.GetNodeAttributeCount(),
+              iNodeAttribute = 0;
+         iNodeAttribute < nNodeAttributes; ++iNodeAttribute) {
+      const auto nodeAttribute =
+          fbx_node_.GetNodeAttributeByIndex(iNodeAttribute);
+      if (nodeAttribute->GetAttributeType() !=
+          fbxsdk::FbxNodeAttribute::EType::eMesh) {
+        return {};
+      }
+      const auto mesh = static_cast<fbxsdk::FbxMesh *>(nodeAttribute);
+      if (mesh->GetDeformerCount() != 0) {
+        return {};
+      }
+      const auto splitted = _splitMeshesResult.equal_range(mesh);
+      if (splitted.first != splitted.second) {
+        for (auto iter = splitted.first; iter != splitted.second; ++iter) {
+          meshes.insert(iter->second);
+        }
+      } else {
+        meshes.insert(mesh);
+      }
+    }
+    if (meshes.empty()) {
+      return {};
+    }
+    return MeshInstancingKey{std::move(meshes), fbx_node_};
+  };
+
+  const auto minInstances =
+      std::max<std::uint32_t>(_options.gpuInstancing.min_instances, 2);
+  std::vector<fbxsdk::FbxNode *> parents{_fbxScene.GetRootNode()};
+  while (!parents.empty()) {
+    auto &parent = *parents.back();
+    parents.pop_back();
+
+    std::unordered_map<MeshInstancingKey, std::vector<fbxsdk::FbxNode *>>
+        groups;
+    const auto nChildren = parent.GetChildCount();
+    for (auto iChild = 0; iChild < nChildren; ++iChild) {
+      auto &child = *parent.GetChild(iChild);
+      if (child.GetChildCount() != 0) {
+        parents.push_back(&child);
+      } else if (auto key = getInstancingKey(child)) {
+        groups[std::move(*key)].push_back(&child);
+      }
+    }
+
+    for (auto &[key, fbxNodes] : groups) {
+      if (fbxNodes.size() < minInstances) {
+        continue;
+      }
+      _gpuInstancedNodes.insert(fbxNodes.begin() + 1, fbxNodes.end());
+      _gpuInstances.emplace(fbxNodes.front(), std::move(fbxNodes));
+    }
+  }
+
+  if (_options.verbose && !_gpuInstances.empty()) {
+    _log(Logger::Level::verbose,
+         fmt::format("Collapsed {} nodes into {} instanced ones",
+                     _gpuInstancedNodes.size() + _gpuInstances.size(),
+                     _gpuInstances.size()));
+  }
+}
+
+void SceneConverter::_convertGpuInstances(
+    const std::vector<fbxsdk::FbxNode *> &fbx_nodes_,
+    GLTFBuilder::XXIndex glTF_node_index_,
+    GLTFBuilder::XXIndex glTF_mesh_node_index_,
+    const std::optional<PositionQuantization> &dequantization_) {
+  // The mesh node may scale quantized positions back, which then comes first.
+  std::optional<fbxsdk::FbxAMatrix> dequantization;
+  if (dequantization_) {
+    const auto &[offset, scale] = *dequantization_;
+    dequantization.emplace(fbxsdk::FbxVector4{offset[0], offset[1], offset[2]},
+                           fbxsdk::FbxVector4{},
+                           fbxsdk::FbxVector4{scale, scale, scale});
+  }
+
+  std::vector<fbxsdk::FbxVector4> translations;
+  std::vector<fbxsdk::FbxQuaternion> rotations;
+  std::vector<fbxsdk::FbxVector4> scales;
+  bool isTranslated = false;
+  bool isRotated = false;
+  bool isScaled = false;
+  for (const auto fbxNode : fbx_nodes_) {
+    const auto localTransform = fbxNode->EvaluateLocalTransform();
+    fbxsdk::FbxAMatrix transform{_applyUnitScaleFactorV3(localTransform.GetT()),
+                                 localTransform.GetR(), localTransform.GetS()};
+    if (dequantization) {
+      transform = transform * *dequantization;
+    }
+
+    const auto &translation = translations.emplace_back(transform.GetT());
+    isTranslated = isTranslated || !translation.IsZero(3);
+
+    auto &rotation = rotations.emplace_back(transform.GetQ());
+    rotation.Normalize();
+    isRotated = isRotated || rotation.Compare(fbxsdk::FbxQuaternion{});
+
+    const auto &scale = scales.emplace_back(transform.GetS());
+    isScaled = isScaled || scale[0] != 1. || scale[1] != 1. || scale[2] != 1.;
+  }
+
+  const auto name =
+      _glTFBuilder.get(&fx::gltf::Document::nodes)[glTF_node_index_].name;
+  auto attributes = Json::object();
+  const auto nameAccessor = [this, &name](GLTFBuilder::XXIndex accessor_index_,
+                                          std::string_view attribute_) {
+    _glTFBuilder.get(&fx::gltf::Document::accessors)[accessor_index_].name =
+        fmt::format("{}/Instances/{}", name, attribute_);
+    return accessor_index_;
+  };
+  // Instances need an attribute, even if they're all in place.
+  if (isTranslated || (!isRotated && !isScaled)) {
+    attributes["TRANSLATION"] = nameAccessor(
+        _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
+                                    fx::gltf::Accessor::ComponentType::Float,
+                                    FbxVec3Spreader>(translations, 0, 0),
+        "Translation");
+  }
+  if (isRotated) {
+    attributes["ROTATION"] = nameAccessor(
+        _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec4,
+                                    fx::gltf::Accessor::ComponentType::Float,
+                                    FbxQuatSpreader>(rotations, 0, 0),
+        "Rotation");
+  }
+  if (isScaled) {
+    attributes["SCALE"] = nameAccessor(
+        _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Vec3,
+                                    fx::gltf::Accessor::ComponentType::Float,
+                                    FbxVec3Spreader>(scales, 0, 0),
+        "Scale");
+  }
+
+  // The instances carry the transforms, the node's own included.
+  auto &glTFNodes = _glTFBuilder.get(&fx::gltf::Document::nodes);
+  for (const auto glTFNodeIndex : {glTF_node_index_, glTF_mesh_node_index_}) {
+    auto &glTFNode = glTFNodes[glTFNodeIndex];
+    glTFNode.translation = {0, 0, 0};
+    glTFNode.rotation = {0, 0, 0, 1};
+    glTFNode.scale = {1, 1, 1};
+  }
+  glTFNodes[glTF_mesh_node_index_]
+      .extensionsAndExtras["extensions"]["EXT_mesh_gpu_instancing"]
+                          ["attributes"] = std::move(attributes);
+
+  // Readers not supporting it would draw a single instance.
+  _glTFBuilder.requireExtension("EXT_mesh_gpu_instancing");
+}
+} // namespace bee
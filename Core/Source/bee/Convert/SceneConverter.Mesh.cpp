@@ -3,9 +3,20 @@
 #include <bee/Convert/SceneConverter.h>
 #include <bee/Convert/fbxsdk/Spreader.h>
 #include <bee/Convert/fbxsdk/String.h>
+#include <bee/DracoCompression.h>
+#include <bee/MeshOptimization.h>
+#include <bee/MeshSimplification.h>
 #include <bee/UntypedVertex.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <fmt/format.h>
 #include <range/v3/all.hpp>
+#include <thread>
+#include <utility>
 
 namespace bee {
 /// <summary>
@@ -23,25 +34,341 @@ void to_json(nlohmann::json &j_, const MultiMaterialLayersError &error_) {
 }
 
 template <typename Dst_, typename Src_, std::size_t N_>
-static void untypedVertexCopy(std::byte *out_, const std::byte *in_) {
-  auto in = reinterpret_cast<const Src_ *>(in_);
-  auto out = reinterpret_cast<Dst_ *>(out_);
-  for (int i = 0; i < N_; ++i) {
-    out[i] = static_cast<Dst_>(in[i]);
+static void untypedVertexCopy(std::byte *out_,
+                              std::size_t out_stride_,
+                              const std::byte *in_,
+                              std::size_t in_stride_,
+                              std::size_t count_) {
+  for (std::size_t iVertex = 0; iVertex < count_;
+       ++iVertex, out_ += out_stride_, in_ += in_stride_) {
+    auto in = reinterpret_cast<const Src_ *>(in_);
+    auto out = reinterpret_cast<Dst_ *>(out_);
+    for (std::size_t i = 0; i < N_; ++i) {
+      out[i] = static_cast<Dst_>(in[i]);
+    }
   }
 }
 
 template <typename Dst_, typename Src_>
-static std::function<void(std::byte *out_, const std::byte *in_)>
-makeUntypedVertexCopyN(std::size_t n_) {
-  return [n_](std::byte *out_, const std::byte *in_) {
-    auto in = reinterpret_cast<const Src_ *>(in_);
+static auto makeUntypedVertexCopyN(std::size_t n_) {
+  switch (n_) {
+  case 1:
+    return untypedVertexCopy<Dst_, Src_, 1>;
+  case 2:
+    return untypedVertexCopy<Dst_, Src_, 2>;
+  case 3:
+    return untypedVertexCopy<Dst_, Src_, 3>;
+  default:
+    assert(n_ == 4);
+    return untypedVertexCopy<Dst_, Src_, 4>;
+  }
+}
+
+/// <summary>
+/// Stores floats within [-1, 1], or [0, 1] if `Dst_` is unsigned, as
+/// normalized integers. They're rounded to `Bits_` bits first, so that the
+/// rest of the bits are left for compression to squeeze.
+/// </summary>
+template <typename Dst_, std::size_t N_, std::uint32_t Bits_>
+static void untypedVertexQuantize(std::byte *out_,
+                                  std::size_t out_stride_,
+                                  const std::byte *in_,
+                                  std::size_t in_stride_,
+                                  std::size_t count_) {
+  constexpr auto isSigned = std::is_signed_v<Dst_>;
+  constexpr auto maxStored =
+      static_cast<double>(std::numeric_limits<Dst_>::max());
+  constexpr auto maxQuantized = static_cast<double>(
+      isSigned ? (1u << (std::max(Bits_, 2u) - 1)) - 1 : (1u << Bits_) - 1);
+  for (std::size_t iVertex = 0; iVertex < count_;
+       ++iVertex, out_ += out_stride_, in_ += in_stride_) {
+    auto in = reinterpret_cast<const float *>(in_);
     auto out = reinterpret_cast<Dst_ *>(out_);
-    for (int i = 0; i < n_; ++i) {
-      out[i] = static_cast<Dst_>(in[i]);
+    for (std::size_t i = 0; i < N_; ++i) {
+      const auto value =
+          std::clamp(static_cast<double>(in[i]), isSigned ? -1.0 : 0.0, 1.0);
+      out[i] = static_cast<Dst_>(
+          std::round(std::round(value * maxQuantized) / maxQuantized *
+                     maxStored));
+    }
+  }
+}
+
+template <typename Dst_, std::size_t N_, std::uint32_t... Bits_>
+static auto
+makeUntypedVertexQuantize(std::uint32_t bits_,
+                          std::integer_sequence<std::uint32_t, Bits_...>) {
+  constexpr std::array writers = {untypedVertexQuantize<Dst_, N_, Bits_ + 1>...};
+  return writers[std::clamp<std::uint32_t>(bits_, 1, writers.size()) - 1];
+}
+
+template <typename Dst_, std::size_t N_>
+static auto makeUntypedVertexQuantize(std::uint32_t bits_) {
+  return makeUntypedVertexQuantize<Dst_, N_>(
+      bits_, std::make_integer_sequence<std::uint32_t, sizeof(Dst_) * 8>{});
+}
+
+/// <summary>
+/// The component type and the writer of a channel of `N_` floats quantized
+/// to `bits_`, or kept float if 0.
+/// </summary>
+template <std::size_t N_>
+static std::pair<fx::gltf::Accessor::ComponentType,
+                 void (*)(std::byte *, std::size_t, const std::byte *,
+                          std::size_t, std::size_t)>
+makeQuantizedChannel(std::uint32_t bits_, bool signed_) {
+  using ComponentType = fx::gltf::Accessor::ComponentType;
+  if (bits_ == 0) {
+    return {ComponentType::Float, untypedVertexCopy<float, float, N_>};
+  } else if (bits_ <= 8 && signed_) {
+    return {ComponentType::Byte,
+            makeUntypedVertexQuantize<std::int8_t, N_>(bits_)};
+  } else if (bits_ <= 8) {
+    return {ComponentType::UnsignedByte,
+            makeUntypedVertexQuantize<std::uint8_t, N_>(bits_)};
+  } else if (signed_) {
+    return {ComponentType::Short,
+            makeUntypedVertexQuantize<std::int16_t, N_>(bits_)};
+  } else {
+    return {ComponentType::UnsignedShort,
+            makeUntypedVertexQuantize<std::uint16_t, N_>(bits_)};
+  }
+}
+
+/// <summary>
+/// Reads a component as channel writers wrote it; not normalized, as
+/// accessor bounds aren't either.
+/// </summary>
+static double readComponent(const std::byte *data_,
+                            fx::gltf::Accessor::ComponentType component_type_) {
+  const auto read = [data_]<typename T_>(T_) {
+    T_ value;
+    std::memcpy(&value, data_, sizeof(value));
+    return static_cast<double>(value);
+  };
+  switch (component_type_) {
+  case fx::gltf::Accessor::ComponentType::Byte:
+    return read(std::int8_t{});
+  case fx::gltf::Accessor::ComponentType::UnsignedByte:
+    return read(std::uint8_t{});
+  case fx::gltf::Accessor::ComponentType::Short:
+    return read(std::int16_t{});
+  case fx::gltf::Accessor::ComponentType::UnsignedShort:
+    return read(std::uint16_t{});
+  case fx::gltf::Accessor::ComponentType::UnsignedInt:
+    return read(std::uint32_t{});
+  default:
+    assert(component_type_ == fx::gltf::Accessor::ComponentType::Float);
+    return read(float{});
+  }
+}
+
+/// <summary>
+/// Sets the bounds of an accessor to those of the `count_` elements written
+/// at `data_`, `stride_` bytes apart, and zero if `include_zero_`.
+/// </summary>
+static void setWrittenBounds(fx::gltf::Accessor &accessor_,
+                             const std::byte *data_,
+                             std::size_t stride_,
+                             std::size_t count_,
+                             bool include_zero_) {
+  const auto nComponents = countComponents(accessor_.type);
+  const auto componentSize = countBytes(accessor_.componentType);
+  constexpr auto infinity = std::numeric_limits<double>::infinity();
+  std::vector<double> minValue(nComponents, include_zero_ ? 0.0 : infinity);
+  std::vector<double> maxValue(nComponents, include_zero_ ? 0.0 : -infinity);
+  for (std::size_t iElement = 0; iElement < count_; ++iElement) {
+    for (std::uint32_t i = 0; i < nComponents; ++i) {
+      const auto value = readComponent(
+          data_ + stride_ * iElement + componentSize * i, accessor_.componentType);
+      minValue[i] = std::min(value, minValue[i]);
+      maxValue[i] = std::max(value, maxValue[i]);
     }
+  }
+  accessor_.min.assign(minValue.begin(), minValue.end());
+  accessor_.max.assign(maxValue.begin(), maxValue.end());
+}
+/// <summary>
+/// Pending primitives are converted once their polygon vertices reach this,
+/// so that the snapshots of a large scene aren't all held at once.
+/// </summary>
+constexpr std::size_t maxPendingPolygonVertices = 1 << 20;
+
+/// <summary>
+/// Polygon vertices are assembled this many at a time, attribute by
+/// attribute, before being deduplicated.
+/// </summary>
+constexpr std::size_t vertexBlockSize = 256;
+
+static FbxLayerElementAccessParams
+makeAccessParams(std::span<const int> polygon_vertices_,
+                 std::size_t polygon_vertex_) {
+  FbxLayerElementAccessParams params;
+  params.controlPointIndex = polygon_vertices_[polygon_vertex_];
+  params.polygonVertexIndex = static_cast<int>(polygon_vertex_);
+  params.polygonIndex = static_cast<int>(polygon_vertex_ / 3);
+  return params;
+}
+
+/// <summary>
+/// Whether every attribute of a polygon vertex is determined by its control
+/// point, so that the referenced control points are the unique vertices.
+/// That is, whether each layer element is mapped by control point or all
+/// same, or reads alike at all polygon vertices of a control point, as
+/// normals mapped by polygon vertex whose index array follows the control
+/// points do.
+/// </summary>
+/// <param name="control_point_vertices_">
+/// The number of each control point.
+/// </param>
+/// <param name="vertex_polygon_vertices_">
+/// The first polygon vertex of each numbered control point.
+/// </param>
+static bool
+isPerControlPoint(const FbxMeshVertexLayout &vertex_layout_,
+                  std::span<const int> polygon_vertices_,
+                  std::span<const std::uint32_t> control_point_vertices_,
+                  std::span<const std::size_t> vertex_polygon_vertices_,
+                  const FbxLayerElementCounts &counts_) {
+  const auto isElementPerControlPoint = [&](const auto &element_) {
+    if (element_.mapping() == FbxLayerElementMapping::controlPoint ||
+        element_.mapping() == FbxLayerElementMapping::constant) {
+      return true;
+    }
+    return element_.visit(counts_, [&](auto read_) {
+      for (std::size_t iPolygonVertex = 0;
+           iPolygonVertex < polygon_vertices_.size(); ++iPolygonVertex) {
+        const auto iFirstPolygonVertex = vertex_polygon_vertices_
+            [control_point_vertices_[polygon_vertices_[iPolygonVertex]]];
+        if (iFirstPolygonVertex != iPolygonVertex &&
+            !(read_(makeAccessParams(polygon_vertices_, iPolygonVertex)) ==
+              read_(makeAccessParams(polygon_vertices_,
+                                     iFirstPolygonVertex)))) {
+          return false;
+        }
+      }
+      return true;
+    });
   };
+
+  if (vertex_layout_.normal &&
+      !isElementPerControlPoint(vertex_layout_.normal->element)) {
+    return false;
+  }
+  for (const auto &uv : vertex_layout_.uvs) {
+    if (!isElementPerControlPoint(uv.element)) {
+      return false;
+    }
+  }
+  for (const auto &color : vertex_layout_.colors) {
+    if (!isElementPerControlPoint(color.element)) {
+      return false;
+    }
+  }
+  for (const auto &shape : vertex_layout_.shapes) {
+    if (shape.normal && vertex_layout_.normal &&
+        !isElementPerControlPoint(shape.normal->element)) {
+      return false;
+    }
+  }
+  // Skin influences and shape positions are per control point already.
+  return true;
+}
+
+/// <summary>
+/// Size of the dedup key of the vertices. See `_assembleVertices()`.
+/// </summary>
+static std::uint32_t vertexKeySize(const FbxMeshVertexLayout &vertex_layout_) {
+  return vertex_layout_.baseSize +
+         (vertex_layout_.shapes.empty() ? 0 : sizeof(std::int32_t));
+}
+
+/// <summary>
+/// Vertex sizes of the common layouts, without shapes: P, PN, PNT, PNTT and
+/// PNT with 4 joints. `_assembleVertices()` is specialized for them.
+/// </summary>
+constexpr std::uint32_t pVertexSize = sizeof(NeutralVertexComponent) * 3;
+constexpr std::uint32_t pnVertexSize =
+    pVertexSize + sizeof(NeutralNormalComponent) * 3;
+constexpr std::uint32_t pntVertexSize =
+    pnVertexSize + sizeof(NeutralUVComponent) * 2;
+constexpr std::uint32_t pnttVertexSize =
+    pntVertexSize + sizeof(NeutralUVComponent) * 2;
+constexpr std::uint32_t pntj4VertexSize =
+    pntVertexSize + (sizeof(NeutralVertexJointComponent) +
+                     sizeof(NeutralVertexWeightComponent)) *
+                        4;
+
+/// <summary>
+/// The vertices whose channel, of `component_count_` floats `in_offset_`
+/// bytes into each vertex, isn't zero: it has a component beyond
+/// `epsilon_`. That is, the vertices a morph target moves.
+/// </summary>
+static std::vector<std::uint32_t>
+findMovedVertices(const std::byte *vertices_,
+                  std::size_t vertex_size_,
+                  std::uint32_t vertex_count_,
+                  std::size_t in_offset_,
+                  std::uint32_t component_count_,
+                  float epsilon_) {
+  static_assert(std::is_same_v<NeutralVertexComponent, float> &&
+                std::is_same_v<NeutralNormalComponent, float>);
+  std::vector<std::uint32_t> movedVertices;
+  for (std::uint32_t iVertex = 0; iVertex < vertex_count_; ++iVertex) {
+    const auto delta = reinterpret_cast<const float *>(
+        vertices_ + vertex_size_ * iVertex + in_offset_);
+    for (std::uint32_t i = 0; i < component_count_; ++i) {
+      if (std::abs(delta[i]) > epsilon_) {
+        movedVertices.push_back(iVertex);
+        break;
+      }
+    }
+  }
+  return movedVertices;
 }
+
+/// <summary>
+/// The vertex rows as simplified. Normals and colors count half as much as
+/// UVs and skin weights; morph target deltas count as positions do.
+/// Vertices collapse only onto those of the same joints.
+/// </summary>
+static SimplificationVertices
+makeSimplificationVertices(const FbxMeshVertexLayout &vertex_layout_,
+                           const std::byte *vertices_,
+                           std::uint32_t vertex_count_) {
+  static_assert(std::is_same_v<NeutralNormalComponent, float> &&
+                std::is_same_v<NeutralUVComponent, float> &&
+                std::is_same_v<NeutralVertexColorComponent, float> &&
+                std::is_same_v<NeutralVertexWeightComponent, float>);
+  SimplificationVertices vertices;
+  vertices.data = vertices_;
+  vertices.size = vertex_layout_.size;
+  vertices.count = vertex_count_;
+  auto &attributes = vertices.attributes;
+  if (vertex_layout_.normal) {
+    attributes.push_back({vertex_layout_.normal->offset, 3, 0.5f});
+  }
+  for (const auto &uvLayout : vertex_layout_.uvs) {
+    attributes.push_back({uvLayout.offset, 2});
+  }
+  for (const auto &colorLayout : vertex_layout_.colors) {
+    attributes.push_back({colorLayout.offset, 4, 0.5f});
+  }
+  if (const auto &skinning = vertex_layout_.skinning) {
+    attributes.push_back({skinning->weights, skinning->channelCount});
+    vertices.shared.emplace_back(skinning->joints,
+                                 sizeof(NeutralVertexJointComponent) *
+                                     skinning->channelCount);
+  }
+  for (const auto &shape : vertex_layout_.shapes) {
+    attributes.push_back({shape.constrolPoints.offset, 3, 1, true});
+    if (shape.normal) {
+      attributes.push_back({shape.normal->offset, 3, 0.5f});
+    }
+  }
+  return vertices;
+}
+
 std::optional<SceneConverter::ConvertMeshResult>
 SceneConverter::_convertNodeMeshes(
     FbxNodeDumpMeta &node_meta_,
@@ -83,15 +410,15 @@ SceneConverter::_convertNodeMeshes(
   }
 
   std::optional<NodeMeshesSkinData> nodeMeshesSkinData;
-  nodeMeshesSkinData = _extractNodeMeshesSkinData(fbx_meshes_);
+  if (_options.export_skin) {
+    nodeMeshesSkinData = _extractNodeMeshesSkinData(fbx_meshes_);
+  }
 
   FbxNodeMeshesBumpMeta myMeta;
   if (_options.export_blend_shape) {
     myMeta.blendShapeMeta = _extractNodeMeshesBlendShape(fbx_meshes_);
   }
 
-  std::optional<std::uint32_t> glTFSkinIndex;
-
   fx::gltf::Mesh glTFMesh;
   if (_options.preserve_mesh_instances) {
     glTFMesh.name = _makeMeshName(fbx_meshes_);
@@ -105,36 +432,8 @@ SceneConverter::_convertNodeMeshes(
     }
   }
 
-  for (decltype(fbx_meshes_.size()) iFbxMesh = 0; iFbxMesh < fbx_meshes_.size();
-       ++iFbxMesh) {
-    const auto fbxMesh = fbx_meshes_[iFbxMesh];
-
-    std::vector<fbxsdk::FbxShape *> fbxShapes;
-    if (myMeta.blendShapeMeta) {
-      fbxShapes = myMeta.blendShapeMeta->blendShapeDatas[iFbxMesh].getShapes();
-    }
-
-    std::span<MeshSkinData::InfluenceChannel> skinInfluenceChannels;
-    if (nodeMeshesSkinData) {
-      skinInfluenceChannels = nodeMeshesSkinData->meshChannels[iFbxMesh];
-    }
-
-    MaterialUsage materialUsage;
-    auto glTFPrimitive = _convertMeshAsPrimitive(
-        *fbxMesh, glTFMesh.name, vertexTransformX, normalTransformX, fbxShapes,
-        skinInfluenceChannels, materialUsage);
-
-    if (const auto fbxMaterialIndex = _getTheUniqueMaterial(*fbxMesh); fbxMaterialIndex >= 0) {
-      if (const auto fbxMaterial = fbx_node_.GetMaterial(fbxMaterialIndex)) {
-        if (const auto glTFMaterialIndex =
-                _convertMaterial(*fbxMaterial, materialUsage)) {
-          glTFPrimitive.material = *glTFMaterialIndex;
-        }
-      }
-    }
-
-    glTFMesh.primitives.emplace_back(std::move(glTFPrimitive));
-  }
+  const auto bufferIndex =
+      _partitionBuffer(_options.bufferPartition.per_mesh, glTFMesh.name);
 
   if (myMeta.blendShapeMeta &&
       !myMeta.blendShapeMeta->blendShapeDatas.empty()) {
@@ -150,16 +449,87 @@ SceneConverter::_convertNodeMeshes(
     glTFMesh.extensionsAndExtras["extras"]["targetNames"] = fbxShapeNames;
   }
 
+  // The primitives are filled by `_convertPendingPrimitives()`.
+  glTFMesh.primitives.resize(fbx_meshes_.size());
+  const auto meshName = glTFMesh.name;
+  std::vector<fx::gltf::Mesh> glTFLevelMeshes;
+  for (std::size_t iLevel = 0;
+       iLevel < _options.levelsOfDetail.levels.size(); ++iLevel) {
+    auto &glTFLevelMesh = glTFLevelMeshes.emplace_back(glTFMesh);
+    glTFLevelMesh.name = fmt::format("{}/LOD{}", meshName, iLevel + 1);
+  }
   const auto glTFMeshIndex =
       _glTFBuilder.add(&fx::gltf::Document::meshes, std::move(glTFMesh));
+  if (!glTFLevelMeshes.empty()) {
+    auto &meshLevelsOfDetail = _meshLevelsOfDetail[glTFMeshIndex];
+    meshLevelsOfDetail.errors.resize(glTFLevelMeshes.size());
+    for (auto &glTFLevelMesh : glTFLevelMeshes) {
+      meshLevelsOfDetail.meshes.push_back(_glTFBuilder.add(
+          &fx::gltf::Document::meshes, std::move(glTFLevelMesh)));
+    }
+  }
+
+  const auto positionQuantization =
+      _options.meshQuantization.position_bits
+          ? _getPositionQuantization(fbx_meshes_, myMeta.blendShapeMeta,
+                                     vertexTransformX)
+          : std::nullopt;
 
   ConvertMeshResult convertMeshResult;
   convertMeshResult.glTFMeshIndex = glTFMeshIndex;
+  if (positionQuantization) {
+    if (nodeMeshesSkinData) {
+      // The node's transform doesn't apply to skinned meshes, the joints'
+      // do: bind the quantized positions instead.
+      const auto &[offset, scale] = *positionQuantization;
+      const fbxsdk::FbxAMatrix dequantization{
+          fbxsdk::FbxVector4{offset[0], offset[1], offset[2]},
+          fbxsdk::FbxVector4{}, fbxsdk::FbxVector4{scale, scale, scale}};
+      for (auto &bone : nodeMeshesSkinData->bones) {
+        bone.inverseBindMatrix = bone.inverseBindMatrix * dequantization;
+      }
+    } else {
+      convertMeshResult.dequantization = positionQuantization;
+    }
+  }
   if (nodeMeshesSkinData) {
-    const auto glTFSkinIndex = _createGLTFSkin(*nodeMeshesSkinData);
+    const auto glTFSkinIndex =
+        _createGLTFSkin(*nodeMeshesSkinData, bufferIndex);
     convertMeshResult.glTFSkinIndex = glTFSkinIndex;
   }
 
+  for (decltype(fbx_meshes_.size()) iFbxMesh = 0; iFbxMesh < fbx_meshes_.size();
+       ++iFbxMesh) {
+    const auto fbxMesh = fbx_meshes_[iFbxMesh];
+
+    std::vector<fbxsdk::FbxShape *> fbxShapes;
+    if (myMeta.blendShapeMeta) {
+      fbxShapes = myMeta.blendShapeMeta->blendShapeDatas[iFbxMesh].getShapes();
+    }
+
+    std::vector<MeshSkinData::InfluenceChannel> skinInfluenceChannels;
+    if (nodeMeshesSkinData) {
+      skinInfluenceChannels =
+          std::move(nodeMeshesSkinData->meshChannels[iFbxMesh]);
+    }
+
+    auto &pendingPrimitive = _pendingPrimitives.emplace_back();
+    pendingPrimitive.glTFMeshIndex = glTFMeshIndex;
+    pendingPrimitive.primitiveIndex = iFbxMesh;
+    pendingPrimitive.bufferIndex = bufferIndex;
+    pendingPrimitive.snapshot = _snapshotMesh(
+        *fbxMesh, meshName, vertexTransformX, normalTransformX, fbxShapes,
+        std::move(skinInfluenceChannels));
+    pendingPrimitive.snapshot.positionQuantization = positionQuantization;
+    pendingPrimitive.materialUsage.texture_context.channel_index_map =
+        pendingPrimitive.snapshot.vertexLayout.uv_channel_index_map;
+    if (const auto fbxMaterialIndex = _getTheUniqueMaterial(*fbxMesh); fbxMaterialIndex >= 0) {
+      pendingPrimitive.fbxMaterial = fbx_node_.GetMaterial(fbxMaterialIndex);
+    }
+    _pendingPolygonVertices +=
+        pendingPrimitive.snapshot.polygonVertices.size();
+  }
+
   myMeta.meshes = fbx_meshes_;
   node_meta_.meshes = myMeta;
 
@@ -168,9 +538,217 @@ SceneConverter::_convertNodeMeshes(
     _meshInstanceMap.emplace(*meshInstancingKey, convertMeshResult);
   }
 
+  if (_pendingPolygonVertices >= maxPendingPolygonVertices) {
+    _convertPendingPrimitives();
+  }
+
   return convertMeshResult;
 }
 
+void SceneConverter::_convertPendingPrimitives() {
+  if (_pendingPrimitives.empty()) {
+    return;
+  }
+
+  const auto assemble = [this](std::size_t index_) {
+    auto &pendingPrimitive = _pendingPrimitives[index_];
+    // What's kept is handed over to this thread's counters at commit, see
+    // `AllocationTracker`.
+    const auto liveBefore = AllocationTracker::live();
+    pendingPrimitive.packed = _assemblePrimitive(pendingPrimitive.snapshot);
+    pendingPrimitive.packedBytes =
+        std::max<std::int64_t>(0, AllocationTracker::live() - liveBefore);
+    AllocationTracker::deallocated(
+        static_cast<std::size_t>(pendingPrimitive.packedBytes));
+  };
+  if (_pendingPrimitives.size() > 1 && !_threadPool) {
+    auto threads = _options.mesh_threads;
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // The converting thread takes part as well.
+    _threadPool = std::make_unique<ThreadPool>(threads - 1);
+  }
+  if (_threadPool) {
+    _threadPool->parallel_for(_pendingPrimitives.size(), assemble);
+  } else {
+    assemble(0);
+  }
+
+  for (auto &pendingPrimitive : _pendingPrimitives) {
+    auto &packed = *pendingPrimitive.packed;
+    AllocationTracker::allocated(
+        static_cast<std::size_t>(pendingPrimitive.packedBytes));
+    _stats.polygon_vertices += packed.polygonVertexCount;
+    _stats.unique_vertices += packed.uniqueVertexCount;
+
+    auto glTFPrimitive =
+        _commitPrimitive(packed, pendingPrimitive.bufferIndex);
+    if (pendingPrimitive.fbxMaterial) {
+      auto &materialUsage = pendingPrimitive.materialUsage;
+      materialUsage.hasTransparentVertex = packed.hasTransparentVertex;
+      if (const auto glTFMaterialIndex =
+              _convertMaterial(*pendingPrimitive.fbxMaterial, materialUsage)) {
+        glTFPrimitive.material = *glTFMaterialIndex;
+      }
+    }
+
+    auto &glTFMeshes = _glTFBuilder.get(&fx::gltf::Document::meshes);
+    if (!packed.levelsOfDetail.empty()) {
+      // The levels differ from the primitive by their indices only.
+      auto &meshLevelsOfDetail =
+          _meshLevelsOfDetail.at(pendingPrimitive.glTFMeshIndex);
+      for (std::size_t iLevel = 0; iLevel < packed.levelsOfDetail.size();
+           ++iLevel) {
+        const auto &[indices, error] = packed.levelsOfDetail[iLevel];
+        auto &glTFLevelPrimitive =
+            glTFMeshes[meshLevelsOfDetail.meshes[iLevel]]
+                .primitives[pendingPrimitive.primitiveIndex];
+        glTFLevelPrimitive = glTFPrimitive;
+        glTFLevelPrimitive.indices = indices;
+        if (packed.dracoCompression) {
+          // They're drawn from the uncompressed vertices.
+          glTFLevelPrimitive.extensionsAndExtras.erase("extensions");
+        }
+        auto &meshError = meshLevelsOfDetail.errors[iLevel];
+        meshError = std::max(meshError, error);
+      }
+    }
+    glTFMeshes[pendingPrimitive.glTFMeshIndex]
+        .primitives[pendingPrimitive.primitiveIndex] = std::move(glTFPrimitive);
+  }
+
+  _pendingPrimitives.clear();
+  _pendingPolygonVertices = 0;
+}
+
+void SceneConverter::_convertLevelsOfDetail() {
+  for (const auto glTFNodeIndex : _levelOfDetailNodes) {
+    auto &glTFNodes = _glTFBuilder.get(&fx::gltf::Document::nodes);
+    const auto &meshLevelsOfDetail =
+        _meshLevelsOfDetail.at(glTFNodes[glTFNodeIndex].mesh);
+
+    // Level nodes stand in for the node, so they're placed as it is, but
+    // aren't in the hierarchy: readers put them beside it.
+    std::vector<fx::gltf::Node> glTFLevelNodes;
+    for (std::size_t iLevel = 0; iLevel < meshLevelsOfDetail.meshes.size();
+         ++iLevel) {
+      const auto &glTFNode = glTFNodes[glTFNodeIndex];
+      auto &glTFLevelNode = glTFLevelNodes.emplace_back();
+      glTFLevelNode.name = fmt::format("{}/LOD{}", glTFNode.name, iLevel + 1);
+      glTFLevelNode.matrix = glTFNode.matrix;
+      glTFLevelNode.translation = glTFNode.translation;
+      glTFLevelNode.rotation = glTFNode.rotation;
+      glTFLevelNode.scale = glTFNode.scale;
+      glTFLevelNode.skin = glTFNode.skin;
+      glTFLevelNode.weights = glTFNode.weights;
+      if (glTFNode.extensionsAndExtras.contains("extensions")) {
+        // Such as the instances, which draw each level too.
+        glTFLevelNode.extensionsAndExtras["extensions"] =
+            glTFNode.extensionsAndExtras.at("extensions");
+      }
+      glTFLevelNode.mesh =
+          static_cast<std::int32_t>(meshLevelsOfDetail.meshes[iLevel]);
+    }
+
+    auto ids = Json::array();
+    for (auto &glTFLevelNode : glTFLevelNodes) {
+      ids.push_back(_glTFBuilder.add(&fx::gltf::Document::nodes,
+                                     std::move(glTFLevelNode)));
+    }
+
+    // The screen coverage down to which each level is used: that at which
+    // the error of the next one is within `screen_error`.
+    auto coverages = Json::array();
+    float coverage = 1;
+    for (const auto error : meshLevelsOfDetail.errors) {
+      if (error > 0) {
+        coverage =
+            std::min(coverage, _options.levelsOfDetail.screen_error / error);
+      }
+      coverages.push_back(coverage);
+    }
+    coverages.push_back(0);
+
+    auto &glTFNode =
+        _glTFBuilder.get(&fx::gltf::Document::nodes)[glTFNodeIndex];
+    glTFNode.extensionsAndExtras["extensions"]["MSFT_lod"]["ids"] = ids;
+    glTFNode.extensionsAndExtras["extras"]["MSFT_screencoverage"] = coverages;
+  }
+  if (!_levelOfDetailNodes.empty()) {
+    _glTFBuilder.useExtension("MSFT_lod");
+  }
+}
+
+std::optional<SceneConverter::PositionQuantization>
+SceneConverter::_getPositionQuantization(
+    const std::vector<fbxsdk::FbxMesh *> &fbx_meshes_,
+    const std::optional<FbxNodeMeshesBumpMeta::BlendShapeDumpMeta>
+        &blend_shape_meta_,
+    const fbxsdk::FbxMatrix *vertex_transform_) const {
+  const auto transform = [this, vertex_transform_](
+                             const fbxsdk::FbxVector4 &control_point_) {
+    auto position = _applyUnitScaleFactorV3(control_point_);
+    if (vertex_transform_) {
+      position = vertex_transform_->MultNormalize(position);
+    }
+    return position;
+  };
+
+  constexpr auto infinity = std::numeric_limits<double>::infinity();
+  std::array<double, 3> minPosition{infinity, infinity, infinity};
+  std::array<double, 3> maxPosition{-infinity, -infinity, -infinity};
+  // Shape deltas are quantized with the same scale, but not offset.
+  double maxDelta = 0.0;
+  for (std::size_t iFbxMesh = 0; iFbxMesh < fbx_meshes_.size(); ++iFbxMesh) {
+    const auto &fbxMesh = *fbx_meshes_[iFbxMesh];
+    const auto nControlPoints = fbxMesh.GetControlPointsCount();
+    const auto controlPoints = fbxMesh.GetControlPoints();
+    std::vector<fbxsdk::FbxVector4> positions(nControlPoints);
+    for (int iControlPoint = 0; iControlPoint < nControlPoints;
+         ++iControlPoint) {
+      const auto position = transform(controlPoints[iControlPoint]);
+      positions[iControlPoint] = position;
+      for (int iAxis = 0; iAxis < 3; ++iAxis) {
+        minPosition[iAxis] = std::min(minPosition[iAxis], position[iAxis]);
+        maxPosition[iAxis] = std::max(maxPosition[iAxis], position[iAxis]);
+      }
+    }
+
+    if (!blend_shape_meta_) {
+      continue;
+    }
+    for (const auto fbxShape :
+         blend_shape_meta_->blendShapeDatas[iFbxMesh].getShapes()) {
+      const auto shapeControlPoints = fbxShape->GetControlPoints();
+      const auto nShapeControlPoints =
+          std::min(nControlPoints, fbxShape->GetControlPointsCount());
+      for (int iControlPoint = 0; iControlPoint < nShapeControlPoints;
+           ++iControlPoint) {
+        const auto delta = transform(shapeControlPoints[iControlPoint]) -
+                           positions[iControlPoint];
+        for (int iAxis = 0; iAxis < 3; ++iAxis) {
+          maxDelta = std::max(maxDelta, std::abs(delta[iAxis]));
+        }
+      }
+    }
+  }
+
+  if (minPosition[0] > maxPosition[0]) {
+    return {};
+  }
+
+  PositionQuantization positionQuantization;
+  double scale = maxDelta;
+  for (int iAxis = 0; iAxis < 3; ++iAxis) {
+    positionQuantization.offset[iAxis] =
+        (minPosition[iAxis] + maxPosition[iAxis]) / 2;
+    scale = std::max(scale, (maxPosition[iAxis] - minPosition[iAxis]) / 2);
+  }
+  positionQuantization.scale = scale == 0.0 ? 1.0 : scale;
+  return positionQuantization;
+}
+
 std::string SceneConverter::_makeMeshName(const std::vector<fbxsdk::FbxMesh *> &fbx_meshes_) const {
   assert(!fbx_meshes_.empty());
 
@@ -228,192 +806,510 @@ SceneConverter::_getGeometrixTransform(const fbxsdk::FbxNode &fbx_node_) {
   return {vertexTransform, normalTransformIT};
 }
 
-fx::gltf::Primitive SceneConverter::_convertMeshAsPrimitive(
+SceneConverter::MeshSnapshot SceneConverter::_snapshotMesh(
     fbxsdk::FbxMesh &fbx_mesh_,
     std::string_view mesh_name_,
-    fbxsdk::FbxMatrix *vertex_transform_,
-    fbxsdk::FbxMatrix *normal_transform_,
+    const fbxsdk::FbxMatrix *vertex_transform_,
+    const fbxsdk::FbxMatrix *normal_transform_,
     std::span<fbxsdk::FbxShape *> fbx_shapes_,
-    std::span<MeshSkinData::InfluenceChannel> skin_influence_channels_,
-    MaterialUsage &material_usage_) {
-  const auto vertexLayout =
+    std::vector<MeshSkinData::InfluenceChannel> &&skin_influence_channels_) {
+  MeshSnapshot snapshot;
+  snapshot.name = mesh_name_;
+  snapshot.vertexLayout =
       _getFbxMeshVertexLayout(fbx_mesh_, fbx_shapes_, skin_influence_channels_);
-  material_usage_.texture_context.channel_index_map =
-      vertexLayout.uv_channel_index_map;
 
-  const auto vertexSize = vertexLayout.size;
+  const auto nControlPoints = fbx_mesh_.GetControlPointsCount();
+  const auto controlPoints = fbx_mesh_.GetControlPoints();
+  snapshot.controlPoints.assign(controlPoints, controlPoints + nControlPoints);
 
-  using UniqueVertexIndex = std::uint32_t;
+  const auto nMeshPolygonVertices = fbx_mesh_.GetPolygonVertexCount();
+  const auto meshPolygonVertices = fbx_mesh_.GetPolygonVertices();
+  snapshot.polygonVertices.assign(meshPolygonVertices,
+                                  meshPolygonVertices + nMeshPolygonVertices);
 
-  UntypedVertexVector untypedVertexAllocator{vertexSize};
-  std::unordered_map<UntypedVertex, UniqueVertexIndex, UntypedVertexHasher,
-                     UntypedVertexEqual>
-      uniqueVertices({}, 0, UntypedVertexHasher{},
-                     UntypedVertexEqual{vertexSize});
+  if (vertex_transform_) {
+    snapshot.vertexTransform = *vertex_transform_;
+  }
+  if (normal_transform_) {
+    snapshot.normalTransform = *normal_transform_;
+  }
+  snapshot.skinInfluenceChannels = std::move(skin_influence_channels_);
+  snapshot.targetCount = static_cast<std::uint32_t>(fbx_shapes_.size());
+  return snapshot;
+}
+
+SceneConverter::PackedPrimitive
+SceneConverter::_assemblePrimitive(const MeshSnapshot &snapshot_) const {
+  const auto &vertexLayout = snapshot_.vertexLayout;
+
+  // There are at most as many unique vertices as polygon vertices.
+  UntypedVertexVector untypedVertexAllocator{
+      vertexLayout.size, snapshot_.polygonVertices.size(), &_vertexArenas};
   bool hasTransparentVertex = false;
+  std::vector<std::uint32_t> indices;
+  switch (vertexKeySize(vertexLayout)) {
+  case pVertexSize:
+    indices = _assembleVertices<pVertexSize>(snapshot_, untypedVertexAllocator,
+                                             hasTransparentVertex);
+    break;
+  case pnVertexSize:
+    indices = _assembleVertices<pnVertexSize>(
+        snapshot_, untypedVertexAllocator, hasTransparentVertex);
+    break;
+  case pntVertexSize:
+    indices = _assembleVertices<pntVertexSize>(
+        snapshot_, untypedVertexAllocator, hasTransparentVertex);
+    break;
+  case pnttVertexSize:
+    indices = _assembleVertices<pnttVertexSize>(
+        snapshot_, untypedVertexAllocator, hasTransparentVertex);
+    break;
+  case pntj4VertexSize:
+    indices = _assembleVertices<pntj4VertexSize>(
+        snapshot_, untypedVertexAllocator, hasTransparentVertex);
+    break;
+  default:
+    indices = _assembleVertices<0>(snapshot_, untypedVertexAllocator,
+                                   hasTransparentVertex);
+    break;
+  }
 
-  const auto nMeshPolygonVertices = fbx_mesh_.GetPolygonVertexCount();
-  const auto meshPolygonVertices = fbx_mesh_.GetPolygonVertices();
-  const auto controlPoints = fbx_mesh_.GetControlPoints();
-  auto stagingVertex = untypedVertexAllocator.allocate();
-  const auto processPolygonVertex =
-      [&](const FbxLayerElementAccessParams &vertex_access_params_)
-      -> UniqueVertexIndex {
-    const auto iControlPoint = vertex_access_params_.controlPointIndex;
-    auto [stagingVertexData, stagingVertexIndex] = stagingVertex;
+  const auto nUniqueVertices = untypedVertexAllocator.size();
+  const auto uniqueVerticesData = untypedVertexAllocator.data();
+
+  // All attributes, skin and shapes included, are in the vertex rows, so
+  // reordering the rows keeps them together.
+  const auto &meshOptimization = _options.meshOptimization;
+  if (meshOptimization.vertex_cache) {
+    optimize_vertex_cache(indices, nUniqueVertices);
+  }
+  if (meshOptimization.overdraw_threshold > 0) {
+    // Positions come first.
+    optimize_overdraw(indices, uniqueVerticesData.data(), vertexLayout.size,
+                      nUniqueVertices, meshOptimization.overdraw_threshold);
+  }
+  if (meshOptimization.vertex_fetch) {
+    optimize_vertex_fetch(indices, uniqueVerticesData.data(),
+                          vertexLayout.size, nUniqueVertices);
+  }
+
+  // Each level indexes the same vertices, simplified from the full
+  // triangles. Every primitive has every level, if only as the full one.
+  std::vector<std::pair<std::vector<std::uint32_t>, float>> levelsOfDetail;
+  if (const auto &levels = _options.levelsOfDetail.levels; !levels.empty()) {
+    const auto simplificationVertices = makeSimplificationVertices(
+        vertexLayout, uniqueVerticesData.data(), nUniqueVertices);
+    float error = 0;
+    for (const auto &level : levels) {
+      auto levelIndices = indices;
+      if (indices.size() % 3 == 0) {
+        const auto targetIndexCount =
+            static_cast<std::size_t>(indices.size() * level.ratio) / 3 * 3;
+        // Errors of the levels are kept increasing.
+        error = std::max(error,
+                         simplify_mesh(levelIndices, simplificationVertices,
+                                       targetIndexCount, level.max_error));
+        if (meshOptimization.vertex_cache) {
+          optimize_vertex_cache(levelIndices, nUniqueVertices);
+        }
+      }
+      levelsOfDetail.emplace_back(std::move(levelIndices), error);
+    }
+  }
+
+  const auto &meshQuantization = _options.meshQuantization;
+  VertexQuantization vertexQuantization;
+  if (snapshot_.positionQuantization) {
+    const auto &[offset, scale] = *snapshot_.positionQuantization;
+    for (std::uint32_t iVertex = 0; iVertex < nUniqueVertices; ++iVertex) {
+      auto vertex = uniqueVerticesData.data() +
+                    std::size_t{vertexLayout.size} * iVertex;
+      auto position = reinterpret_cast<NeutralVertexComponent *>(vertex);
+      for (int iAxis = 0; iAxis < 3; ++iAxis) {
+        position[iAxis] = static_cast<NeutralVertexComponent>(
+            (position[iAxis] - offset[iAxis]) / scale);
+      }
+      for (const auto &shape : vertexLayout.shapes) {
+        auto delta = reinterpret_cast<NeutralVertexComponent *>(
+            vertex + shape.constrolPoints.offset);
+        for (int iAxis = 0; iAxis < 3; ++iAxis) {
+          delta[iAxis] = static_cast<NeutralVertexComponent>(delta[iAxis] / scale);
+        }
+      }
+    }
+    vertexQuantization.position = meshQuantization.position_bits;
+  }
+  if (vertexLayout.normal) {
+    vertexQuantization.normal = meshQuantization.normal_bits;
+  }
+  for (const auto &uvLayout : vertexLayout.uvs) {
+    // Only UVs within [0, 1] fit unsigned normalized integers; the others,
+    // such as tiling ones, are kept float.
+    bool normalized = meshQuantization.uv_bits != 0;
+    for (std::uint32_t iVertex = 0; normalized && iVertex < nUniqueVertices;
+         ++iVertex) {
+      auto uv = reinterpret_cast<const NeutralUVComponent *>(
+          uniqueVerticesData.data() + std::size_t{vertexLayout.size} * iVertex +
+          uvLayout.offset);
+      normalized = uv[0] >= 0 && uv[0] <= 1 && uv[1] >= 0 && uv[1] <= 1;
+    }
+    vertexQuantization.uvs.push_back(normalized ? meshQuantization.uv_bits
+                                                : 0);
+  }
+  vertexQuantization.color = meshQuantization.color_bits;
+
+  auto bulks = _typeVertices(vertexLayout, vertexQuantization);
+  if (_options.meshoptCompression.enabled) {
+    // Channels compress better, and may be filtered, each in its own buffer
+    // view.
+    std::list<VertexBulk> channelBulks;
+    for (const auto &bulk : bulks) {
+      for (const auto &channel : bulk.channels) {
+        auto &channelBulk = channelBulks.emplace_back();
+        channelBulk.morphTargetHint = bulk.morphTargetHint;
+        channelBulk.vertexBuffer = bulk.vertexBuffer;
+        channelBulk.addChannel(channel.name, channel.type,
+                               channel.componentType,
+                               static_cast<std::uint32_t>(channel.inOffset),
+                               channel.writer, channel.target,
+                               channel.normalized);
+      }
+    }
+    bulks = std::move(channelBulks);
+  }
+  auto packed = _createPrimitive(
+      bulks, snapshot_.targetCount, nUniqueVertices, uniqueVerticesData.data(),
+      vertexLayout.size, indices, snapshot_.name, _options.sparseMorphTargets,
+      _options.meshoptCompression);
+  for (std::size_t iLevel = 0; iLevel < levelsOfDetail.size(); ++iLevel) {
+    const auto &[levelIndices, error] = levelsOfDetail[iLevel];
+    // Levels simplifying no further share the indices of the one before.
+    const auto previousIndices =
+        iLevel == 0 ? packed.primitive.indices
+                    : packed.levelsOfDetail.back().indices;
+    const auto levelName = fmt::format("{}/LOD{}", snapshot_.name, iLevel + 1);
+    const auto indices =
+        levelIndices.size() == packed.accessors[previousIndices].count
+            ? static_cast<std::uint32_t>(previousIndices)
+            : _createIndices(packed, levelIndices, levelName);
+    packed.levelsOfDetail.push_back({indices, error});
+  }
+  if (_options.dracoCompression.enabled && indices.size() % 3 == 0) {
+    _compressPrimitiveDraco(packed, nUniqueVertices, indices, snapshot_.name,
+                            _options.dracoCompression);
+  }
+  packed.hasTransparentVertex = hasTransparentVertex;
+  // Normalized unsigned bytes and shorts are core glTF for UVs and colors,
+  // not for positions and normals.
+  packed.quantized =
+      vertexQuantization.position != 0 || vertexQuantization.normal != 0;
+  packed.polygonVertexCount = indices.size();
+  packed.uniqueVertexCount = nUniqueVertices;
+  return packed;
+}
 
-    fbxsdk::FbxVector4 transformedBasePosition;
-    fbxsdk::FbxVector4 transformedBaseNormal;
+template <std::uint32_t VertexSize_>
+std::vector<std::uint32_t>
+SceneConverter::_assembleVertices(const MeshSnapshot &snapshot_,
+                                  UntypedVertexVector &vertices_,
+                                  bool &has_transparent_vertex_) const {
+  const auto &vertexLayout = snapshot_.vertexLayout;
+  const auto vertexTransform =
+      snapshot_.vertexTransform ? &*snapshot_.vertexTransform : nullptr;
+  const auto normalTransform =
+      snapshot_.normalTransform ? &*snapshot_.normalTransform : nullptr;
+  const auto &skinInfluenceChannels = snapshot_.skinInfluenceChannels;
+
+  // The dedup key is the vertex but its shapes, followed by the control
+  // point index if there are shapes. Their deltas are then assembled for the
+  // unique vertices only.
+  const bool hasShapes = !vertexLayout.shapes.empty();
+  const std::size_t keySize =
+      VertexSize_ ? VertexSize_ : vertexKeySize(vertexLayout);
+  assert(keySize == vertexKeySize(vertexLayout));
+  std::optional<UntypedVertexVector> keyVertices;
+  if (hasShapes) {
+    keyVertices.emplace(static_cast<std::uint32_t>(keySize),
+                        snapshot_.polygonVertices.size(), &_vertexArenas);
+  }
+  auto &uniqueKeys = keyVertices ? *keyVertices : vertices_;
+
+  using UniqueVertexIndex = std::uint32_t;
+
+  const auto nMeshPolygonVertices = snapshot_.polygonVertices.size();
+  const auto &meshPolygonVertices = snapshot_.polygonVertices;
+  const auto &controlPoints = snapshot_.controlPoints;
+  const FbxLayerElementCounts layerElementCounts{
+      controlPoints.size(), nMeshPolygonVertices,
+      (nMeshPolygonVertices + 2) / 3};
+
+  // Number the control points in the order they're first referenced. If
+  // every attribute is per control point, those are the unique vertices and
+  // are assembled from their first polygon vertex, with no hashing at all.
+  constexpr auto noVertex = std::numeric_limits<UniqueVertexIndex>::max();
+  std::vector<UniqueVertexIndex> controlPointVertices(controlPoints.size(),
+                                                      noVertex);
+  std::vector<std::size_t> vertexPolygonVertices;
+  for (std::size_t iPolygonVertex = 0; iPolygonVertex < nMeshPolygonVertices;
+       ++iPolygonVertex) {
+    const auto iControlPoint = meshPolygonVertices[iPolygonVertex];
+    if (iControlPoint < 0 ||
+        static_cast<std::size_t>(iControlPoint) >= controlPoints.size()) {
+      vertexPolygonVertices.clear();
+      controlPointVertices.clear();
+      break;
+    }
+    if (controlPointVertices[iControlPoint] == noVertex) {
+      controlPointVertices[iControlPoint] =
+          static_cast<UniqueVertexIndex>(vertexPolygonVertices.size());
+      vertexPolygonVertices.push_back(iPolygonVertex);
+    }
+  }
+  std::optional<UntypedVertexTable<VertexSize_>> uniqueVertices;
+  if (controlPointVertices.empty() ||
+      !isPerControlPoint(vertexLayout, meshPolygonVertices,
+                         controlPointVertices, vertexPolygonVertices,
+                         layerElementCounts)) {
+    vertexPolygonVertices.clear();
+    uniqueVertices.emplace(uniqueKeys, keySize, nMeshPolygonVertices);
+  }
+  const auto nAssembledVertices =
+      uniqueVertices ? nMeshPolygonVertices : vertexPolygonVertices.size();
+  const auto firstVertex = uniqueKeys.size();
+
+  // Staging vertices of the block, written attribute by attribute.
+  std::vector<std::byte> stagingVertices(keySize * vertexBlockSize);
+  const auto stagingVertex = [&stagingVertices, keySize](
+                                 std::size_t index_, std::uint32_t offset_) {
+    return stagingVertices.data() + keySize * index_ + offset_;
+  };
+  std::vector<FbxLayerElementAccessParams> accessParams(vertexBlockSize);
+
+  std::vector<UniqueVertexIndex> indices(nMeshPolygonVertices);
+  for (std::size_t iFirstVertex = 0; iFirstVertex < nAssembledVertices;
+       iFirstVertex += vertexBlockSize) {
+    const auto nBlockVertices =
+        std::min(vertexBlockSize, nAssembledVertices - iFirstVertex);
+
+    for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+      accessParams[iVertex] = makeAccessParams(
+          meshPolygonVertices,
+          uniqueVertices ? iFirstVertex + iVertex
+                         : vertexPolygonVertices[iFirstVertex + iVertex]);
+    }
 
     // Position
-    {
-      auto position = _applyUnitScaleFactorV3(controlPoints[iControlPoint]);
-      if (vertex_transform_) {
-        position = vertex_transform_->MultNormalize(position);
+    for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+      auto position = _applyUnitScaleFactorV3(
+          controlPoints[accessParams[iVertex].controlPointIndex]);
+      if (vertexTransform) {
+        position = vertexTransform->MultNormalize(position);
       }
-      transformedBasePosition = position;
-      auto pPosition =
-          reinterpret_cast<NeutralVertexComponent *>(stagingVertexData);
-      FbxVec3Spreader::spread(position, pPosition);
+      FbxVec3Spreader::spread(position,
+                              reinterpret_cast<NeutralVertexComponent *>(
+                                  stagingVertex(iVertex, 0)));
     }
 
     // Normal
     if (vertexLayout.normal) {
-      auto [offset, element] = *vertexLayout.normal;
-      auto normal = element(vertex_access_params_);
-      if (normal_transform_) {
-        normal = normal_transform_->MultNormalize(normal);
-      }
-      transformedBaseNormal = normal;
-      auto pNormal = reinterpret_cast<NeutralNormalComponent *>(
-          stagingVertexData + offset);
-      FbxVec3Spreader::spread(normal, pNormal);
+      const auto &[offset, element] = *vertexLayout.normal;
+      element.visit(layerElementCounts, [&](auto read_) {
+        for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+          auto normal = read_(accessParams[iVertex]);
+          if (normalTransform) {
+            normal = normalTransform->MultNormalize(normal);
+          }
+          FbxVec3Spreader::spread(normal,
+                                  reinterpret_cast<NeutralNormalComponent *>(
+                                      stagingVertex(iVertex, offset)));
+        }
+      });
     }
 
     // UV
-    for (auto [offset, element] : vertexLayout.uvs) {
-      auto uv = element(vertex_access_params_);
-      if (!_options.noFlipV) {
-        uv[1] = 1.0 - uv[1];
-      }
-      auto pUV =
-          reinterpret_cast<NeutralUVComponent *>(stagingVertexData + offset);
-      FbxVec2Spreader::spread(uv, pUV);
+    for (const auto &[offset, element] : vertexLayout.uvs) {
+      element.visit(layerElementCounts, [&](auto read_) {
+        for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+          auto uv = read_(accessParams[iVertex]);
+          if (!_options.noFlipV) {
+            uv[1] = 1.0 - uv[1];
+          }
+          FbxVec2Spreader::spread(uv, reinterpret_cast<NeutralUVComponent *>(
+                                          stagingVertex(iVertex, offset)));
+        }
+      });
     }
 
     // Vertex color
-    for (auto [offset, element] : vertexLayout.colors) {
-      auto color = element(vertex_access_params_);
-      if (!hasTransparentVertex && color.mAlpha != 1.0) {
-        hasTransparentVertex = true;
-      }
-      auto pColor = reinterpret_cast<NeutralVertexColorComponent *>(
-          stagingVertexData + offset);
-      FbxColorSpreader::spread(color, pColor);
+    for (const auto &[offset, element] : vertexLayout.colors) {
+      element.visit(layerElementCounts, [&](auto read_) {
+        for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+          auto color = read_(accessParams[iVertex]);
+          if (!has_transparent_vertex_ && color.mAlpha != 1.0) {
+            has_transparent_vertex_ = true;
+          }
+          FbxColorSpreader::spread(
+              color, reinterpret_cast<NeutralVertexColorComponent *>(
+                         stagingVertex(iVertex, offset)));
+        }
+      });
     }
 
     // Skinning
     if (vertexLayout.skinning) {
-      auto [nChannels, jointsOffset, weightsOffset] = *vertexLayout.skinning;
-      auto pJoints = reinterpret_cast<NeutralVertexJointComponent *>(
-          stagingVertexData + jointsOffset);
-      auto pWeights = reinterpret_cast<NeutralVertexWeightComponent *>(
-          stagingVertexData + weightsOffset);
-      for (decltype(nChannels) iChannel = 0; iChannel < nChannels; ++iChannel) {
-        pJoints[iChannel] =
-            skin_influence_channels_[iChannel].joints[iControlPoint];
-        pWeights[iChannel] =
-            skin_influence_channels_[iChannel].weights[iControlPoint];
+      const auto [nChannels, jointsOffset, weightsOffset] =
+          *vertexLayout.skinning;
+      for (std::uint32_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+        const auto &[joints, weights] = skinInfluenceChannels[iChannel];
+        const auto jointOffset = static_cast<std::uint32_t>(
+            jointsOffset + sizeof(NeutralVertexJointComponent) * iChannel);
+        const auto weightOffset = static_cast<std::uint32_t>(
+            weightsOffset + sizeof(NeutralVertexWeightComponent) * iChannel);
+        for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+          const auto iControlPoint = accessParams[iVertex].controlPointIndex;
+          *reinterpret_cast<NeutralVertexJointComponent *>(
+              stagingVertex(iVertex, jointOffset)) = joints[iControlPoint];
+          *reinterpret_cast<NeutralVertexWeightComponent *>(
+              stagingVertex(iVertex, weightOffset)) = weights[iControlPoint];
+        }
       }
     }
 
-    // Shapes
-    for (auto &[controlPoints, normalElement] : vertexLayout.shapes) {
-      {
-        auto shapePosition =
-            _applyUnitScaleFactorV3(controlPoints.element[iControlPoint]);
-        if (vertex_transform_) {
-          shapePosition = vertex_transform_->MultNormalize(shapePosition);
-        }
-        auto shapeDiff = shapePosition - transformedBasePosition;
-        auto pPosition = reinterpret_cast<NeutralVertexComponent *>(
-            stagingVertexData + controlPoints.offset);
-        FbxVec3Spreader::spread(shapeDiff, pPosition);
+    // Control point
+    if (hasShapes) {
+      for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+        *reinterpret_cast<std::int32_t *>(
+            stagingVertex(iVertex, vertexLayout.baseSize)) =
+            accessParams[iVertex].controlPointIndex;
       }
+    }
 
-      if (normalElement && vertexLayout.normal) {
-        auto [offset, element] = *normalElement;
-        auto normal = element(vertex_access_params_);
-        if (normal_transform_) {
-          normal = normal_transform_->MultNormalize(normal);
+    // Dedup
+    for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+      if (uniqueVertices) {
+        const auto [index, added] =
+            uniqueVertices->insert(stagingVertex(iVertex, 0));
+        indices[iFirstVertex + iVertex] = index;
+        if (added && hasShapes) {
+          vertexPolygonVertices.push_back(iFirstVertex + iVertex);
         }
-        auto normalDiff = normal - transformedBaseNormal;
-        auto pNormal = reinterpret_cast<NeutralNormalComponent *>(
-            stagingVertexData + offset);
-        FbxVec3Spreader::spread(normalDiff, pNormal);
+      } else {
+        const auto vertex = std::get<0>(uniqueKeys.allocate());
+        std::memcpy(vertex, stagingVertex(iVertex, 0), keySize);
       }
     }
+  }
 
-    auto [rInserted, success] =
-        uniqueVertices.try_emplace(stagingVertexData, stagingVertexIndex);
-    auto [insertedVertex, uniqueVertexIndex] = *rInserted;
-    if (success) {
-      stagingVertex = untypedVertexAllocator.allocate();
+  if (!uniqueVertices) {
+    for (std::size_t iPolygonVertex = 0; iPolygonVertex < nMeshPolygonVertices;
+         ++iPolygonVertex) {
+      indices[iPolygonVertex] =
+          firstVertex +
+          controlPointVertices[meshPolygonVertices[iPolygonVertex]];
     }
+  }
 
-    return uniqueVertexIndex;
-  };
-
-  std::vector<UniqueVertexIndex> indices(nMeshPolygonVertices);
-  for (std::remove_const_t<decltype(nMeshPolygonVertices)> iPolygonVertex = 0;
-       iPolygonVertex < nMeshPolygonVertices; ++iPolygonVertex) {
-    const auto iControlPoint = meshPolygonVertices[iPolygonVertex];
-    FbxLayerElementAccessParams params;
-    params.controlPointIndex = iControlPoint;
-    params.polygonVertexIndex = iPolygonVertex;
-    params.polygonIndex = iPolygonVertex / 3;
-    indices[iPolygonVertex] = processPolygonVertex(params);
+  if (keyVertices) {
+    _assembleShapes(snapshot_, *keyVertices, vertexPolygonVertices, vertices_);
   }
 
-  untypedVertexAllocator.pop_back();
-  const auto nUniqueVertices = untypedVertexAllocator.size();
-  auto uniqueVerticesData = untypedVertexAllocator.merge();
-
-  // Debug blend shape data
-  /*std::vector<std::vector<std::array<NeutralVertexComponent, 3>>>
-      shapePositions;
-  std::vector<std::vector<std::array<NeutralNormalComponent, 3>>>
-      shapeNormals;
-  if (!vertexLayout.shapes.empty()) {
-    shapePositions.resize(nUniqueVertices);
-    shapeNormals.resize(nUniqueVertices);
-    for (std::remove_const_t<decltype(nUniqueVertices)> iVertex = 0;
-         iVertex < nUniqueVertices; ++iVertex) {
-      shapePositions[iVertex].resize(vertexLayout.shapes.size());
-      shapeNormals[iVertex].resize(vertexLayout.shapes.size());
-      for (int iShape = 0; iShape < vertexLayout.shapes.size(); ++iShape) {
-        auto p = reinterpret_cast<NeutralVertexComponent *>(
-            uniqueVerticesData.get() + vertexLayout.size * iVertex +
-            vertexLayout.shapes[iShape].constrolPoints.offset);
-        shapePositions[iVertex][iShape] = {p[0], p[1], p[2]};
-        if (vertexLayout.shapes[iShape].normal) {
-          auto n = reinterpret_cast<NeutralNormalComponent *>(
-              uniqueVerticesData.get() + vertexLayout.size * iVertex +
-              vertexLayout.shapes[iShape].normal->offset);
-          shapeNormals[iVertex][iShape] = {n[0], n[1], n[2]};
-        }
+  return indices;
+}
+
+void SceneConverter::_assembleShapes(
+    const MeshSnapshot &snapshot_,
+    UntypedVertexVector &key_vertices_,
+    std::span<const std::size_t> vertex_polygon_vertices_,
+    UntypedVertexVector &vertices_) const {
+  const auto &vertexLayout = snapshot_.vertexLayout;
+  const auto vertexTransform =
+      snapshot_.vertexTransform ? &*snapshot_.vertexTransform : nullptr;
+  const auto normalTransform =
+      snapshot_.normalTransform ? &*snapshot_.normalTransform : nullptr;
+
+  const auto nMeshPolygonVertices = snapshot_.polygonVertices.size();
+  const auto &meshPolygonVertices = snapshot_.polygonVertices;
+  const auto &controlPoints = snapshot_.controlPoints;
+  const FbxLayerElementCounts layerElementCounts{
+      controlPoints.size(), nMeshPolygonVertices,
+      (nMeshPolygonVertices + 2) / 3};
+
+  std::vector<UntypedVertex> blockVertices(vertexBlockSize);
+  std::vector<FbxLayerElementAccessParams> accessParams(vertexBlockSize);
+  // Kept in double precision for the deltas.
+  std::vector<fbxsdk::FbxVector4> transformedBasePositions(vertexBlockSize);
+  std::vector<fbxsdk::FbxVector4> transformedBaseNormals(
+      vertexLayout.normal ? vertexBlockSize : 0);
+
+  const auto nVertices = vertex_polygon_vertices_.size();
+  for (std::size_t iFirstVertex = 0; iFirstVertex < nVertices;
+       iFirstVertex += vertexBlockSize) {
+    const auto nBlockVertices =
+        std::min(vertexBlockSize, nVertices - iFirstVertex);
+
+    for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+      const auto iKeyVertex =
+          static_cast<std::uint32_t>(iFirstVertex + iVertex);
+      accessParams[iVertex] = makeAccessParams(
+          meshPolygonVertices, vertex_polygon_vertices_[iKeyVertex]);
+      blockVertices[iVertex] = std::get<0>(vertices_.allocate());
+      std::memcpy(blockVertices[iVertex], key_vertices_[iKeyVertex],
+                  vertexLayout.baseSize);
+    }
+
+    for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+      auto position = _applyUnitScaleFactorV3(
+          controlPoints[accessParams[iVertex].controlPointIndex]);
+      if (vertexTransform) {
+        position = vertexTransform->MultNormalize(position);
       }
+      transformedBasePositions[iVertex] = position;
     }
-  }*/
 
-  auto bulks = _typeVertices(vertexLayout);
-  auto glTFPrimitive = _createPrimitive(
-      bulks, static_cast<std::uint32_t>(fbx_shapes_.size()), nUniqueVertices,
-      uniqueVerticesData.get(), vertexLayout.size, indices, mesh_name_);
+    if (vertexLayout.normal) {
+      vertexLayout.normal->element.visit(layerElementCounts, [&](auto read_) {
+        for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+          auto normal = read_(accessParams[iVertex]);
+          if (normalTransform) {
+            normal = normalTransform->MultNormalize(normal);
+          }
+          transformedBaseNormals[iVertex] = normal;
+        }
+      });
+    }
 
-  material_usage_.hasTransparentVertex = hasTransparentVertex;
+    for (const auto &[shapeControlPoints, normalElement] :
+         vertexLayout.shapes) {
+      for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+        auto shapePosition = _applyUnitScaleFactorV3(
+            shapeControlPoints
+                .element[accessParams[iVertex].controlPointIndex]);
+        if (vertexTransform) {
+          shapePosition = vertexTransform->MultNormalize(shapePosition);
+        }
+        auto shapeDiff = shapePosition - transformedBasePositions[iVertex];
+        FbxVec3Spreader::spread(
+            shapeDiff, reinterpret_cast<NeutralVertexComponent *>(
+                           blockVertices[iVertex] + shapeControlPoints.offset));
+      }
 
-  return glTFPrimitive;
+      if (normalElement && vertexLayout.normal) {
+        const auto &[offset, element] = *normalElement;
+        element.visit(layerElementCounts, [&](auto read_) {
+          for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+            auto normal = read_(accessParams[iVertex]);
+            if (normalTransform) {
+              normal = normalTransform->MultNormalize(normal);
+            }
+            auto normalDiff = normal - transformedBaseNormals[iVertex];
+            FbxVec3Spreader::spread(normalDiff,
+                                    reinterpret_cast<NeutralNormalComponent *>(
+                                        blockVertices[iVertex] + offset));
+          }
+        });
+      }
+    }
+  }
 }
 
 FbxMeshVertexLayout SceneConverter::_getFbxMeshVertexLayout(
@@ -477,14 +1373,19 @@ FbxMeshVertexLayout SceneConverter::_getFbxMeshVertexLayout(
     vertexLaytout.size += sizeof(NeutralVertexWeightComponent) * nChannels;
   }
 
+  vertexLaytout.baseSize = vertexLaytout.size;
+
   vertexLaytout.shapes.reserve(fbx_shapes_.size());
   for (std::remove_cv_t<decltype(fbx_shapes_.size())> iShape = 0;
        iShape < fbx_shapes_.size(); ++iShape) {
     auto fbxShape = fbx_shapes_[iShape];
     FbxMeshVertexLayout::ShapeLayout shapeLayout;
 
-    shapeLayout.constrolPoints = {vertexLaytout.size,
-                                  fbxShape->GetControlPoints()};
+    const auto shapeControlPoints = fbxShape->GetControlPoints();
+    shapeLayout.constrolPoints = {
+        vertexLaytout.size,
+        {shapeControlPoints,
+         shapeControlPoints + fbxShape->GetControlPointsCount()}};
     vertexLaytout.size += sizeof(NeutralVertexComponent) * 3;
 
     if (auto normalLayer = fbxShape->GetElementNormal()) {
@@ -498,22 +1399,164 @@ FbxMeshVertexLayout SceneConverter::_getFbxMeshVertexLayout(
   return vertexLaytout;
 }
 
-fx::gltf::Primitive
+SceneConverter::PackedPrimitive
 SceneConverter::_createPrimitive(std::list<VertexBulk> &bulks_,
                                  std::uint32_t target_count_,
                                  std::uint32_t vertex_count_,
                                  std::byte *untyped_vertices_,
                                  std::uint32_t vertex_size_,
                                  std::span<std::uint32_t> indices_,
-                                 std::string_view primitive_name_) {
-  fx::gltf::Primitive glTFPrimitive;
+                                 std::string_view primitive_name_,
+                                 const ConvertOptions::SparseMorphTargets
+                                     &sparse_morph_targets_,
+                                 const ConvertOptions::MeshoptCompression
+                                     &meshopt_compression_) {
+  PackedPrimitive packed;
+  auto &glTFPrimitive = packed.primitive;
   glTFPrimitive.targets.resize(target_count_);
 
-  for (const auto &bulk : bulks_) {
-    auto [bufferViewData, bufferViewIndex] =
-        _glTFBuilder.createBufferView(bulk.stride * vertex_count_, 0, 0);
-    auto &glTFBufferView =
-        _glTFBuilder.get(&fx::gltf::Document::bufferViews)[bufferViewIndex];
+  const auto addAccessor = [&packed](fx::gltf::Accessor &&accessor_) {
+    const auto index = static_cast<std::uint32_t>(packed.accessors.size());
+    packed.accessors.push_back(std::move(accessor_));
+    return index;
+  };
+
+  const auto addBufferView = [&packed](std::size_t size_,
+                                       std::uint32_t align_,
+                                       std::string &&name_,
+                                       MeshoptEncoding meshopt_encoding_) {
+    const auto index = static_cast<std::uint32_t>(packed.bufferViews.size());
+    auto &packedBufferView = packed.bufferViews.emplace_back();
+    packedBufferView.data = GLTFBuilder::allocateBufferView(size_);
+    packedBufferView.align = align_;
+    packedBufferView.bufferView.name = std::move(name_);
+    packedBufferView.meshoptEncoding = meshopt_encoding_;
+    return index;
+  };
+
+  for (auto &bulk : bulks_) {
+    if (bulk.morphTargetHint) {
+      // Target channels leaving most vertices in place are written sparse,
+      // the others stay interleaved in the bulk.
+      bool sparse = false;
+      for (auto rChannel = bulk.channels.begin();
+           rChannel != bulk.channels.end();) {
+        const auto &channel = *rChannel;
+        const auto movedVertices = findMovedVertices(
+            untyped_vertices_, vertex_size_, vertex_count_, channel.inOffset,
+            countComponents(channel.type), sparse_morph_targets_.epsilon);
+        const auto indexComponentType =
+            movedVertices.empty() ||
+                    movedVertices.back() <=
+                        std::numeric_limits<std::uint8_t>::max()
+                ? fx::gltf::Accessor::ComponentType::UnsignedByte
+            : movedVertices.back() <= std::numeric_limits<std::uint16_t>::max()
+                ? fx::gltf::Accessor::ComponentType::UnsignedShort
+                : fx::gltf::Accessor::ComponentType::UnsignedInt;
+        const auto valueSize = countBytes(channel.type, channel.componentType);
+        const auto indexSize = countBytes(indexComponentType);
+        const auto sparseSize =
+            movedVertices.size() * std::size_t{indexSize + valueSize};
+        const auto denseSize = std::size_t{vertex_count_} * valueSize;
+        if (!(static_cast<double>(sparseSize) <
+              sparse_morph_targets_.max_size_ratio * denseSize)) {
+          ++rChannel;
+          continue;
+        }
+
+        const auto accessorName = fmt::format(
+            "{0}/Target-{1}/{2}", primitive_name_, *channel.target,
+            channel.name);
+        fx::gltf::Accessor glTFAccessor;
+        glTFAccessor.name = accessorName;
+        glTFAccessor.count = vertex_count_;
+        glTFAccessor.type = channel.type;
+        glTFAccessor.componentType = channel.componentType;
+        glTFAccessor.normalized = channel.normalized;
+        // Without a buffer view, the unlisted vertices are zero.
+        const std::byte *values = nullptr;
+        if (!movedVertices.empty()) {
+          const auto nMoved = static_cast<std::uint32_t>(movedVertices.size());
+          const auto indicesView = addBufferView(
+              std::size_t{nMoved} * indexSize, indexSize,
+              accessorName + "/Indices",
+              MeshoptEncoding{MeshoptMode::indices, indexSize});
+          const auto valuesView = addBufferView(
+              std::size_t{nMoved} * valueSize, 4, accessorName + "/Values",
+              MeshoptEncoding{MeshoptMode::attributes, valueSize});
+          const auto indicesData = packed.bufferViews[indicesView].data.data();
+          const auto valuesData = packed.bufferViews[valuesView].data.data();
+          values = valuesData;
+          for (std::uint32_t iMoved = 0; iMoved < nMoved;) {
+            // Moved vertices next to each other are written at once.
+            auto iRunEnd = iMoved + 1;
+            while (iRunEnd < nMoved &&
+                   movedVertices[iRunEnd] == movedVertices[iRunEnd - 1] + 1) {
+              ++iRunEnd;
+            }
+            channel.writer(valuesData + std::size_t{valueSize} * iMoved,
+                           valueSize,
+                           untyped_vertices_ +
+                               std::size_t{vertex_size_} *
+                                   movedVertices[iMoved] +
+                               channel.inOffset,
+                           vertex_size_, iRunEnd - iMoved);
+            iMoved = iRunEnd;
+          }
+          for (std::uint32_t iMoved = 0; iMoved < nMoved; ++iMoved) {
+            const auto index = movedVertices[iMoved];
+            switch (indexSize) {
+            case 1:
+              indicesData[iMoved] = static_cast<std::byte>(index);
+              break;
+            case 2:
+              reinterpret_cast<std::uint16_t *>(indicesData)[iMoved] =
+                  static_cast<std::uint16_t>(index);
+              break;
+            default:
+              reinterpret_cast<std::uint32_t *>(indicesData)[iMoved] = index;
+              break;
+            }
+          }
+          glTFAccessor.sparse.count = static_cast<std::int32_t>(nMoved);
+          glTFAccessor.sparse.indices.bufferView = indicesView;
+          glTFAccessor.sparse.indices.componentType = indexComponentType;
+          glTFAccessor.sparse.values.bufferView = valuesView;
+        }
+
+        if (channel.name == "POSITION") {
+          // Dropped deltas count as zero.
+          setWrittenBounds(glTFAccessor, values, valueSize,
+                           movedVertices.size(),
+                           movedVertices.size() < vertex_count_);
+        }
+
+        glTFPrimitive.targets[*channel.target].emplace(
+            channel.name, addAccessor(std::move(glTFAccessor)));
+        rChannel = bulk.channels.erase(rChannel);
+        sparse = true;
+      }
+      if (sparse) {
+        bulk.stride = 0;
+        for (auto &channel : bulk.channels) {
+          channel.outOffset = bulk.stride;
+          bulk.stride +=
+              VertexBulk::alignedBytes(channel.type, channel.componentType);
+        }
+      }
+      if (bulk.channels.empty()) {
+        continue;
+      }
+    }
+
+    const auto bufferViewIndex =
+        static_cast<std::uint32_t>(packed.bufferViews.size());
+    auto &packedBufferView = packed.bufferViews.emplace_back();
+    packedBufferView.data = GLTFBuilder::allocateBufferView(
+        std::size_t{bulk.stride} * vertex_count_);
+    packedBufferView.align = 4;
+    const auto bufferViewData = packedBufferView.data.data();
+    auto &glTFBufferView = packedBufferView.bufferView;
     if (bulk.morphTargetHint) {
       glTFBufferView.name =
           fmt::format("{}/Target-{}", primitive_name_, *bulk.morphTargetHint);
@@ -525,14 +1568,37 @@ SceneConverter::_createPrimitive(std::list<VertexBulk> &bulks_,
     }
     glTFBufferView.byteStride = bulk.stride;
 
-    for (const auto &channel : bulk.channels) {
-      for (decltype(vertex_count_) iVertex = 0; iVertex < vertex_count_;
-           ++iVertex) {
-        channel.writer(
-            bufferViewData + bulk.stride * iVertex + channel.outOffset,
-            untyped_vertices_ + vertex_size_ * iVertex + channel.inOffset);
+    auto &meshoptEncoding = packedBufferView.meshoptEncoding.emplace(
+        MeshoptEncoding{MeshoptMode::attributes, bulk.stride});
+    // Filters are lossy and pay off only when compressed; even uncompressed
+    // bulks may hold a single channel, such as a target of positions only.
+    if (meshopt_compression_.enabled && bulk.channels.size() == 1) {
+      const auto &channel = bulk.channels.front();
+      if (channel.name == "NORMAL" && !channel.target && channel.normalized &&
+          meshopt_compression_.octahedral_normals) {
+        meshoptEncoding.filter = MeshoptFilter::octahedral;
+        meshoptEncoding.filterBits = countBytes(channel.componentType) * 8;
+      } else if (channel.name == "POSITION" &&
+                 channel.componentType ==
+                     fx::gltf::Accessor::ComponentType::Float &&
+                 meshopt_compression_.exponential_bits != 0) {
+        meshoptEncoding.filter = MeshoptFilter::exponential;
+        meshoptEncoding.filterBits = meshopt_compression_.exponential_bits;
       }
+    }
 
+    for (const auto &channel : bulk.channels) {
+      channel.writer(bufferViewData + channel.outOffset, bulk.stride,
+                     untyped_vertices_ + channel.inOffset, vertex_size_,
+                     vertex_count_);
+    }
+    if (meshoptEncoding.filter != MeshoptFilter::none) {
+      // Written as readers decode it, so that bounds match.
+      encode_meshopt_filter(packedBufferView.data, meshoptEncoding);
+      decode_meshopt_filter(packedBufferView.data, meshoptEncoding);
+    }
+
+    for (const auto &channel : bulk.channels) {
       fx::gltf::Accessor glTFAccessor;
       glTFAccessor.name = fmt::format(
           "{0}{1}/{2}", primitive_name_,
@@ -543,35 +1609,14 @@ SceneConverter::_createPrimitive(std::list<VertexBulk> &bulks_,
       glTFAccessor.count = vertex_count_;
       glTFAccessor.type = channel.type;
       glTFAccessor.componentType = channel.componentType;
+      glTFAccessor.normalized = channel.normalized;
 
       if (channel.name == "POSITION") {
-        std::array<NeutralVertexComponent, 3> minPos, maxPos;
-        std::fill(minPos.begin(), minPos.end(),
-                  std::numeric_limits<NeutralVertexComponent>::infinity());
-        std::fill(maxPos.begin(), maxPos.end(),
-                  -std::numeric_limits<NeutralVertexComponent>::infinity());
-        for (decltype(vertex_count_) iVertex = 0; iVertex < vertex_count_;
-             ++iVertex) {
-          auto pPosition = reinterpret_cast<const NeutralVertexComponent *>(
-              untyped_vertices_ + vertex_size_ * iVertex + channel.inOffset);
-          for (auto i = 0; i < 3; ++i) {
-            minPos[i] = std::min(pPosition[i], minPos[i]);
-            maxPos[i] = std::max(pPosition[i], maxPos[i]);
-          }
-        }
-        auto typeCast = [](NeutralVertexComponent v_) {
-          return static_cast<float>(v_);
-        };
-        glTFAccessor.min.resize(minPos.size());
-        std::transform(minPos.begin(), minPos.end(), glTFAccessor.min.begin(),
-                       typeCast);
-        glTFAccessor.max.resize(maxPos.size());
-        std::transform(maxPos.begin(), maxPos.end(), glTFAccessor.max.begin(),
-                       typeCast);
+        setWrittenBounds(glTFAccessor, bufferViewData + channel.outOffset,
+                         bulk.stride, vertex_count_, false);
       }
 
-      auto glTFAccessorIndex = _glTFBuilder.add(&fx::gltf::Document::accessors,
-                                                std::move(glTFAccessor));
+      auto glTFAccessorIndex = addAccessor(std::move(glTFAccessor));
 
       if (!channel.target) {
         glTFPrimitive.attributes.emplace(channel.name, glTFAccessorIndex);
@@ -583,84 +1628,273 @@ SceneConverter::_createPrimitive(std::list<VertexBulk> &bulks_,
     }
   }
 
-  {
-    using IndexUnit = GLTFComponentTypeStorage<
-        fx::gltf::Accessor::ComponentType::UnsignedInt>;
-    // Check if index data can be stored using 16-bit integers
-    auto useUint16 =
-        std::all_of(indices_.begin(), indices_.end(), [](auto index) {
-          return index <= std::numeric_limits<std::uint16_t>::max();
-        });
-    auto [bufferViewData, bufferViewIndex] = _glTFBuilder.createBufferView(
-        useUint16
-            ? static_cast<std::uint32_t>(indices_.size() * sizeof(uint16_t))
-            : static_cast<std::uint32_t>(indices_.size() * sizeof(uint32_t)),
-        0, 0);
-    if (useUint16) {
-      std::transform(indices_.begin(), indices_.end(),
-                     reinterpret_cast<std::uint16_t *>(bufferViewData),
-                     [](auto val) { return static_cast<std::uint16_t>(val); });
-    } else {
-      std::transform(indices_.begin(), indices_.end(),
-                     reinterpret_cast<std::uint32_t *>(bufferViewData),
-                     [](auto val) { return static_cast<std::uint32_t>(val); });
-    }
-    auto &glTFBufferView =
-        _glTFBuilder.get(&fx::gltf::Document::bufferViews)[bufferViewIndex];
-    glTFBufferView.target =
-        fx::gltf::BufferView::TargetType::ElementArrayBuffer;
-
-    fx::gltf::Accessor glTFAccessor;
-    glTFAccessor.name = fmt::format("{0}/INDICES", primitive_name_);
-    glTFAccessor.bufferView = bufferViewIndex;
-    glTFAccessor.count = static_cast<std::uint32_t>(indices_.size());
-    glTFAccessor.type = fx::gltf::Accessor::Type::Scalar;
-    if (useUint16) {
-      // Set the component type to UnsignedShort if possible
-      glTFAccessor.componentType =
-          fx::gltf::Accessor::ComponentType::UnsignedShort;
-    } else {
-      // Otherwise, use UnsignedInt
-      glTFAccessor.componentType =
-          fx::gltf::Accessor::ComponentType::UnsignedInt;
+  glTFPrimitive.indices = _createIndices(packed, indices_, primitive_name_);
+
+  return packed;
+}
+
+std::uint32_t
+SceneConverter::_createIndices(PackedPrimitive &packed_,
+                               std::span<const std::uint32_t> indices_,
+                               std::string_view primitive_name_) {
+  // Check if index data can be stored using 16-bit integers
+  auto useUint16 =
+      std::all_of(indices_.begin(), indices_.end(), [](auto index) {
+        return index <= std::numeric_limits<std::uint16_t>::max();
+      });
+  const auto bufferViewIndex =
+      static_cast<std::uint32_t>(packed_.bufferViews.size());
+  auto &packedBufferView = packed_.bufferViews.emplace_back();
+  packedBufferView.data = GLTFBuilder::allocateBufferView(
+      useUint16 ? indices_.size() * sizeof(uint16_t)
+                : indices_.size() * sizeof(uint32_t));
+  packedBufferView.align = static_cast<std::uint32_t>(
+      useUint16 ? sizeof(std::uint16_t) : sizeof(std::uint32_t));
+  const auto bufferViewData = packedBufferView.data.data();
+  if (useUint16) {
+    std::transform(indices_.begin(), indices_.end(),
+                   reinterpret_cast<std::uint16_t *>(bufferViewData),
+                   [](auto val) { return static_cast<std::uint16_t>(val); });
+  } else {
+    std::transform(indices_.begin(), indices_.end(),
+                   reinterpret_cast<std::uint32_t *>(bufferViewData),
+                   [](auto val) { return static_cast<std::uint32_t>(val); });
+  }
+  packedBufferView.bufferView.target =
+      fx::gltf::BufferView::TargetType::ElementArrayBuffer;
+  packedBufferView.meshoptEncoding =
+      MeshoptEncoding{MeshoptMode::triangles, packedBufferView.align};
+
+  fx::gltf::Accessor glTFAccessor;
+  glTFAccessor.name = fmt::format("{0}/INDICES", primitive_name_);
+  glTFAccessor.bufferView = bufferViewIndex;
+  glTFAccessor.count = static_cast<std::uint32_t>(indices_.size());
+  glTFAccessor.type = fx::gltf::Accessor::Type::Scalar;
+  if (useUint16) {
+    // Set the component type to UnsignedShort if possible
+    glTFAccessor.componentType =
+        fx::gltf::Accessor::ComponentType::UnsignedShort;
+  } else {
+    // Otherwise, use UnsignedInt
+    glTFAccessor.componentType =
+        fx::gltf::Accessor::ComponentType::UnsignedInt;
+  }
+
+  const auto index = static_cast<std::uint32_t>(packed_.accessors.size());
+  packed_.accessors.push_back(std::move(glTFAccessor));
+  return index;
+}
+
+void SceneConverter::_compressPrimitiveDraco(
+    PackedPrimitive &packed_,
+    std::uint32_t vertex_count_,
+    std::span<const std::uint32_t> indices_,
+    std::string_view primitive_name_,
+    const ConvertOptions::DracoCompression &options_) {
+  auto &glTFPrimitive = packed_.primitive;
+  std::vector<DracoAttribute> attributes;
+  std::vector<std::uint32_t> compressedAccessors;
+  for (const auto &[name, accessorIndex] : glTFPrimitive.attributes) {
+    const auto &accessor = packed_.accessors[accessorIndex];
+    const auto &packedBufferView = packed_.bufferViews[accessor.bufferView];
+    auto &attribute = attributes.emplace_back();
+    attribute.name = name;
+    attribute.data = packedBufferView.data.data() + accessor.byteOffset;
+    attribute.componentType = accessor.componentType;
+    attribute.components = countComponents(accessor.type);
+    attribute.byteStride =
+        packedBufferView.bufferView.byteStride != 0
+            ? packedBufferView.bufferView.byteStride
+            : countBytes(accessor.componentType) * attribute.components;
+    attribute.normalized = accessor.normalized;
+    compressedAccessors.push_back(accessorIndex);
+  }
+
+  // The vertices stored beside the compressed ones, the fallback's or the
+  // targets', have to match those decoded, so they're kept in order.
+  const auto fallback = options_.fallback || !packed_.levelsOfDetail.empty();
+  DracoEncoding encoding;
+  encoding.positionBits = options_.position_bits;
+  encoding.normalBits = options_.normal_bits;
+  encoding.uvBits = options_.uv_bits;
+  encoding.colorBits = options_.color_bits;
+  encoding.genericBits = options_.generic_bits;
+  encoding.speed = options_.speed;
+  encoding.preserveOrder = fallback || !glTFPrimitive.targets.empty();
+  const auto dracoMesh =
+      encode_draco(attributes, vertex_count_, indices_, encoding);
+
+  auto &dracoCompression = packed_.dracoCompression.emplace();
+  dracoCompression.fallback = fallback;
+  dracoCompression.bufferView =
+      static_cast<std::uint32_t>(packed_.bufferViews.size());
+  for (std::size_t iAttribute = 0; iAttribute < attributes.size();
+       ++iAttribute) {
+    dracoCompression.attributes.emplace(attributes[iAttribute].name,
+                                        dracoMesh.attributeIds[iAttribute]);
+  }
+  auto &packedBufferView = packed_.bufferViews.emplace_back();
+  packedBufferView.data =
+      GLTFBuilder::allocateBufferView(dracoMesh.data.size());
+  std::copy(dracoMesh.data.begin(), dracoMesh.data.end(),
+            packedBufferView.data.data());
+  packedBufferView.align = 4;
+  packedBufferView.bufferView.name =
+      fmt::format("{}/KHR_draco_mesh_compression", primitive_name_);
+
+  // Accessors of the compressed data describe what it decodes to, and have
+  // no data of their own without a fallback.
+  const auto indicesAccessorIndex =
+      static_cast<std::uint32_t>(glTFPrimitive.indices);
+  compressedAccessors.push_back(indicesAccessorIndex);
+  for (const auto accessorIndex : compressedAccessors) {
+    auto &accessor = packed_.accessors[accessorIndex];
+    accessor.count = accessorIndex == indicesAccessorIndex
+                         ? dracoMesh.indexCount
+                         : dracoMesh.vertexCount;
+    if (!fallback) {
+      accessor.bufferView = -1;
+      accessor.byteOffset = 0;
     }
+  }
+  if (fallback) {
+    return;
+  }
 
-    auto glTFAccessorIndex = _glTFBuilder.add(&fx::gltf::Document::accessors,
-                                              std::move(glTFAccessor));
-    glTFPrimitive.indices = glTFAccessorIndex;
+  // Drops the buffer views left unused.
+  std::vector<bool> used(packed_.bufferViews.size(), false);
+  used[dracoCompression.bufferView] = true;
+  for (const auto &accessor : packed_.accessors) {
+    if (accessor.bufferView >= 0) {
+      used[accessor.bufferView] = true;
+    }
+    if (!accessor.sparse.empty()) {
+      used[accessor.sparse.indices.bufferView] = true;
+      used[accessor.sparse.values.bufferView] = true;
+    }
+  }
+  std::vector<std::uint32_t> remap(packed_.bufferViews.size());
+  std::uint32_t nKept = 0;
+  for (std::size_t iBufferView = 0; iBufferView < used.size(); ++iBufferView) {
+    if (used[iBufferView]) {
+      remap[iBufferView] = nKept;
+      if (nKept != iBufferView) {
+        packed_.bufferViews[nKept] =
+            std::move(packed_.bufferViews[iBufferView]);
+      }
+      ++nKept;
+    }
+  }
+  packed_.bufferViews.erase(packed_.bufferViews.begin() + nKept,
+                            packed_.bufferViews.end());
+  for (auto &accessor : packed_.accessors) {
+    if (accessor.bufferView >= 0) {
+      accessor.bufferView = remap[accessor.bufferView];
+    }
+    if (!accessor.sparse.empty()) {
+      accessor.sparse.indices.bufferView =
+          remap[accessor.sparse.indices.bufferView];
+      accessor.sparse.values.bufferView =
+          remap[accessor.sparse.values.bufferView];
+    }
+  }
+  dracoCompression.bufferView = remap[dracoCompression.bufferView];
+}
+
+fx::gltf::Primitive
+SceneConverter::_commitPrimitive(PackedPrimitive &packed_,
+                                 GLTFBuilder::XXIndex buffer_index_) {
+  const auto firstBufferView = static_cast<std::uint32_t>(
+      _glTFBuilder.get(&fx::gltf::Document::bufferViews).size());
+  for (auto &[bufferView, data, align, meshoptEncoding] :
+       packed_.bufferViews) {
+    _glTFBuilder.addBufferView(std::move(bufferView), std::move(data), align,
+                               buffer_index_, meshoptEncoding);
   }
 
+  const auto firstAccessor = static_cast<std::uint32_t>(
+      _glTFBuilder.get(&fx::gltf::Document::accessors).size());
+  for (auto &accessor : packed_.accessors) {
+    if (accessor.bufferView >= 0) {
+      accessor.bufferView += firstBufferView;
+    }
+    if (!accessor.sparse.empty()) {
+      accessor.sparse.indices.bufferView += firstBufferView;
+      accessor.sparse.values.bufferView += firstBufferView;
+    }
+    _glTFBuilder.add(&fx::gltf::Document::accessors, std::move(accessor));
+  }
+
+  auto glTFPrimitive = std::move(packed_.primitive);
+  for (auto &[name, accessor] : glTFPrimitive.attributes) {
+    accessor += firstAccessor;
+  }
+  for (auto &target : glTFPrimitive.targets) {
+    for (auto &[name, accessor] : target) {
+      accessor += firstAccessor;
+    }
+  }
+  glTFPrimitive.indices += firstAccessor;
+  for (auto &levelOfDetail : packed_.levelsOfDetail) {
+    levelOfDetail.indices += firstAccessor;
+  }
+  if (packed_.dracoCompression) {
+    const auto &[bufferView, attributes, fallback] = *packed_.dracoCompression;
+    auto &extension =
+        glTFPrimitive
+            .extensionsAndExtras["extensions"]["KHR_draco_mesh_compression"];
+    extension["bufferView"] = firstBufferView + bufferView;
+    extension["attributes"] = attributes;
+    if (fallback) {
+      _glTFBuilder.useExtension("KHR_draco_mesh_compression");
+    } else {
+      _glTFBuilder.requireExtension("KHR_draco_mesh_compression");
+    }
+  }
+
+  if (packed_.quantized) {
+    _glTFBuilder.requireExtension("KHR_mesh_quantization");
+  }
   return glTFPrimitive;
 }
 
 std::list<SceneConverter::VertexBulk>
-SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
+SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_,
+                              const VertexQuantization &vertex_quantization_) {
+  static_assert(std::is_same_v<NeutralVertexComponent, float> &&
+                    std::is_same_v<NeutralNormalComponent, float> &&
+                    std::is_same_v<NeutralUVComponent, float> &&
+                    std::is_same_v<NeutralVertexColorComponent, float>,
+                "Quantized channels are written from floats.");
+
   std::list<VertexBulk> bulks;
 
   auto &defaultBulk = bulks.emplace_back();
   defaultBulk.vertexBuffer = true;
 
   {
-    defaultBulk.addChannel(
-        "POSITION",                               // name
-        fx::gltf::Accessor::Type::Vec3,           // type
-        fx::gltf::Accessor::ComponentType::Float, // component type
-        0,                                        // in offset
-        untypedVertexCopy<
-            GLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Float>,
-            NeutralVertexComponent, 3> // writer
+    const auto [componentType, writer] =
+        makeQuantizedChannel<3>(vertex_quantization_.position, true);
+    defaultBulk.addChannel("POSITION",                      // name
+                           fx::gltf::Accessor::Type::Vec3,  // type
+                           componentType,                   // component type
+                           0,                               // in offset
+                           writer,                          // writer
+                           {},                              // target index
+                           vertex_quantization_.position != 0 // normalized
     );
   }
 
   if (vertex_layout_.normal) {
-    defaultBulk.addChannel(
-        "NORMAL",                                 // name
-        fx::gltf::Accessor::Type::Vec3,           // type
-        fx::gltf::Accessor::ComponentType::Float, // component type
-        vertex_layout_.normal->offset,            // in offset
-        untypedVertexCopy<
-            GLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Float>,
-            NeutralNormalComponent, 3> // writer
+    const auto [componentType, writer] =
+        makeQuantizedChannel<3>(vertex_quantization_.normal, true);
+    defaultBulk.addChannel("NORMAL",                        // name
+                           fx::gltf::Accessor::Type::Vec3,  // type
+                           componentType,                   // component type
+                           vertex_layout_.normal->offset,   // in offset
+                           writer,                          // writer
+                           {},                              // target index
+                           vertex_quantization_.normal != 0 // normalized
     );
   }
 
@@ -668,14 +1902,17 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
     auto nUV = vertex_layout_.uvs.size();
     for (decltype(nUV) iUV = 0; iUV < nUV; ++iUV) {
       auto &uvLayout = vertex_layout_.uvs[iUV];
-      defaultBulk.addChannel(
-          "TEXCOORD_" + std::to_string(iUV),        // name
-          fx::gltf::Accessor::Type::Vec2,           // type
-          fx::gltf::Accessor::ComponentType::Float, // component type
-          uvLayout.offset,                          // in offset
-          untypedVertexCopy<GLTFComponentTypeStorage<
-                                fx::gltf::Accessor::ComponentType::Float>,
-                            NeutralUVComponent, 2> // writer
+      const auto bits = iUV < vertex_quantization_.uvs.size()
+                            ? vertex_quantization_.uvs[iUV]
+                            : 0;
+      const auto [componentType, writer] = makeQuantizedChannel<2>(bits, false);
+      defaultBulk.addChannel("TEXCOORD_" + std::to_string(iUV), // name
+                             fx::gltf::Accessor::Type::Vec2,    // type
+                             componentType,   // component type
+                             uvLayout.offset, // in offset
+                             writer,          // writer
+                             {},              // target index
+                             bits != 0        // normalized
       );
     }
   }
@@ -684,14 +1921,15 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
     auto nColor = vertex_layout_.colors.size();
     for (decltype(nColor) iColor = 0; iColor < nColor; ++iColor) {
       auto &colorLayout = vertex_layout_.colors[iColor];
-      defaultBulk.addChannel(
-          "COLOR_" + std::to_string(iColor),        // name
-          fx::gltf::Accessor::Type::Vec4,           // type
-          fx::gltf::Accessor::ComponentType::Float, // component type
-          colorLayout.offset,                       // in offset
-          untypedVertexCopy<GLTFComponentTypeStorage<
-                                fx::gltf::Accessor::ComponentType::Float>,
-                            NeutralVertexColorComponent, 4> // writer
+      const auto [componentType, writer] =
+          makeQuantizedChannel<4>(vertex_quantization_.color, false);
+      defaultBulk.addChannel("COLOR_" + std::to_string(iColor), // name
+                             fx::gltf::Accessor::Type::Vec4,    // type
+                             componentType,                 // component type
+                             colorLayout.offset,            // in offset
+                             writer,                        // writer
+                             {},                            // target index
+                             vertex_quantization_.color != 0 // normalized
       );
     }
   }
@@ -739,18 +1977,21 @@ SceneConverter::_typeVertices(const FbxMeshVertexLayout &vertex_layout_) {
     shapeBulk.morphTargetHint = static_cast<GLTFBuilder::XXIndex>(iShape);
 
     {
-      shapeBulk.addChannel(
-          "POSITION",                               // name
-          fx::gltf::Accessor::Type::Vec3,           // type
-          fx::gltf::Accessor::ComponentType::Float, // component type
-          shape.constrolPoints.offset,              // in offset
-          untypedVertexCopy<GLTFComponentTypeStorage<
-                                fx::gltf::Accessor::ComponentType::Float>,
-                            NeutralVertexComponent, 3>, // writer
-          static_cast<std::uint32_t>(iShape)            // target index
+      // Deltas are scaled as positions are, see `PositionQuantization`.
+      const auto [componentType, writer] =
+          makeQuantizedChannel<3>(vertex_quantization_.position, true);
+      shapeBulk.addChannel("POSITION",                         // name
+                           fx::gltf::Accessor::Type::Vec3,     // type
+                           componentType,                      // component type
+                           shape.constrolPoints.offset,        // in offset
+                           writer,                             // writer
+                           static_cast<std::uint32_t>(iShape), // target index
+                           vertex_quantization_.position != 0  // normalized
       );
     }
 
+    // Normal deltas may exceed [-1, 1], they're kept float.
+
     if (shape.normal) {
       shapeBulk.addChannel(
           "NORMAL",                                 // name
@@ -825,4 +2066,4 @@ int SceneConverter::_getTheUniqueMaterial(fbxsdk::FbxMesh &fbx_mesh_) {
 
   return -1;
 }
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
@@ -314,7 +314,8 @@ SceneConverter::_extractSkinData(const fbxsdk::FbxMesh &fbx_mesh_) {
 }
 
 std::uint32_t
-SceneConverter::_createGLTFSkin(const NodeMeshesSkinData &skin_data_) {
+SceneConverter::_createGLTFSkin(const NodeMeshesSkinData &skin_data_,
+                                GLTFBuilder::XXIndex buffer_index_) {
   fx::gltf::Skin glTFSkin;
   glTFSkin.name = skin_data_.name;
   glTFSkin.joints.resize(skin_data_.bones.size());
@@ -326,7 +327,7 @@ SceneConverter::_createGLTFSkin(const NodeMeshesSkinData &skin_data_) {
       _glTFBuilder.createAccessor<fx::gltf::Accessor::Type::Mat4,
                                   fx::gltf::Accessor::ComponentType::Float,
                                   MeshSkinData::Bone::IBMSpreader>(
-          skin_data_.bones, 0, 0);
+          skin_data_.bones, 0, buffer_index_);
   auto &ibmAccessor =
       _glTFBuilder.get(&fx::gltf::Document::accessors)[ibmAccessorIndex];
   ibmAccessor.name = fmt::format("{}/InverseBindMatrices", skin_data_.name);
@@ -336,4 +337,4 @@ SceneConverter::_createGLTFSkin(const NodeMeshesSkinData &skin_data_) {
       _glTFBuilder.add(&fx::gltf::Document::skins, std::move(glTFSkin));
   return glTFSkinIndex;
 }
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
@@ -1,8 +1,9 @@
 
 #include "./fbxsdk/String.h"
+#include <algorithm>
+#include <bee/Base64.h>
 #include <bee/Convert/SceneConverter.h>
 #include <bee/polyfills/filesystem.h>
-#include <cppcodec/base64_default_rfc4648.hpp>
 #include <fmt/format.h>
 #include <glm/gtx/euler_angles.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
@@ -311,11 +312,14 @@ void SceneConverter::_convertTextureUVTransform(
   }
 }
 
+namespace {
+const std::array<std::string, 3> validImageExtensions{".jpg", ".jpeg", ".png"};
+}
+
 bool SceneConverter::_hasValidImageExtension(
     const bee::filesystem::path &path_) {
   const auto extName = path_.extension().string();
-  const std::array<std::string, 3> validExtensions{".jpg", ".jpeg", ".png"};
-  return std::any_of(validExtensions.begin(), validExtensions.end(),
+  return std::any_of(validImageExtensions.begin(), validImageExtensions.end(),
                      [&extName](const std::string &valid_extension_) {
                        return std::equal(
                            valid_extension_.begin(), valid_extension_.end(),
@@ -342,16 +346,28 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertTextureSource(
     imageFilePath = imageFileName;
   }
 
+  const auto exists = [&imageFilePath] {
+    std::error_code err;
+    const auto status = fs::status(*imageFilePath, err);
+    return !err && status.type() == fs::file_type::regular;
+  };
+  if (imageFilePath && _hasValidImageExtension(*imageFilePath) && !exists()) {
+    _addUnresolvedFile(*imageFilePath);
+  }
+
   if (imageFilePath && !_options.textureResolution.disabled) {
-    const auto exists = [&imageFilePath] {
-      std::error_code err;
-      const auto status = fs::status(*imageFilePath, err);
-      return !err && status.type() == fs::file_type::regular;
-    };
     if (!_hasValidImageExtension(*imageFilePath) || !exists()) {
-      auto image = _searchImage(imageFilePath->stem().string());
+      const auto stem = imageFilePath->stem().string();
+      auto image = _searchImage(stem);
       if (image) {
         imageFilePath = image;
+      } else {
+        // Any of these appearing would be found.
+        for (const auto &location : _options.textureResolution.locations) {
+          for (const auto &extension : validImageExtensions) {
+            _addUnresolvedFile(fs::path{location} / (stem + extension));
+          }
+        }
       }
     }
   }
@@ -360,6 +376,17 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertTextureSource(
     imageFilePath.reset();
   }
 
+  if (imageFilePath) {
+    std::error_code err;
+    if (fs::is_regular_file(*imageFilePath, err)) {
+      auto referencedFile = imageFilePath->lexically_normal().u8string();
+      if (std::find(_referencedFiles.begin(), _referencedFiles.end(),
+                    referencedFile) == _referencedFiles.end()) {
+        _referencedFiles.push_back(std::move(referencedFile));
+      }
+    }
+  }
+
   fx::gltf::Image glTFImage;
   glTFImage.name = imageName;
   bool hasSource = false;
@@ -401,6 +428,14 @@ std::optional<GLTFBuilder::XXIndex> SceneConverter::_convertTextureSource(
   return glTFImageIndex;
 }
 
+void SceneConverter::_addUnresolvedFile(const bee::filesystem::path &path_) {
+  auto unresolvedFile = path_.lexically_normal().u8string();
+  if (std::find(_unresolvedFiles.begin(), _unresolvedFiles.end(),
+                unresolvedFile) == _unresolvedFiles.end()) {
+    _unresolvedFiles.push_back(std::move(unresolvedFile));
+  }
+}
+
 std::optional<std::string>
 SceneConverter::_searchImage(const std::string_view name_) {
   namespace fs = bee::filesystem;
@@ -470,6 +505,7 @@ SceneConverter::_processPath(const bee::filesystem::path &path_) {
     if (err) {
       return {};
     }
+    _copiedFiles.push_back(target.u8string());
     return toRelative(target);
   }
   case ConvertOptions::PathMode::embedded: {
@@ -490,16 +526,20 @@ SceneConverter::_processPath(const bee::filesystem::path &path_) {
     // Always output as buffer view.
     // TODO: is data uri meaningful in embedded mode?
     if (true) {
-      auto [bufferViewData, bufferViewIndex] = _glTFBuilder.createBufferView(
-          static_cast<std::uint32_t>(fileContent.size()), 0, 0);
+      const auto bufferIndex = _partitionBuffer(
+          _options.bufferPartition.per_image,
+          forceTreatAsPlain(normalizedPath.filename().u8string()));
+      auto [bufferViewData, bufferViewIndex] =
+          _glTFBuilder.createBufferView(fileContent.size(), 0, bufferIndex);
       std::memcpy(bufferViewData, fileContent.data(), fileContent.size());
       return std::make_pair(bufferViewIndex, mimeType);
     }
-    const auto base64Data = cppcodec::base64_rfc4648::encode(
-        reinterpret_cast<const char *>(fileContent.data()), fileContent.size());
-    const auto chars = fmt::format("data:{};base64,{}",
-                                   forceTreatAsPlain(mimeType), base64Data);
-    return std::u8string(reinterpret_cast<const char8_t *>(chars.data()));
+    auto dataUri = u8"data:" + mimeType + u8";base64,";
+    const auto prefixSize = dataUri.size();
+    dataUri.resize(prefixSize + base64_encoded_size(fileContent.size()));
+    base64_encode(std::as_bytes(std::span{fileContent}),
+                  reinterpret_cast<char *>(dataUri.data() + prefixSize));
+    return dataUri;
   }
   case ConvertOptions::PathMode::prefer_relative: {
     const auto relativePath =
@@ -576,4 +616,4 @@ SceneConverter::_convertWrapMode(fbxsdk::FbxTexture::EWrapMode fbx_wrap_mode_) {
     return fx::gltf::Sampler::WrappingMode::ClampToEdge;
   }
 }
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
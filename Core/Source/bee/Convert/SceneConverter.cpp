@@ -70,12 +70,23 @@ SceneConverter::SceneConverter(fbxsdk::FbxManager &fbx_manager_,
 
 void SceneConverter::convert() {
   _prepareScene();
-  _announceNodes(_fbxScene);
-  for (auto fbxNode : _anncouncedfbxNodes) {
-    _convertNode(*fbxNode);
+  if (_options.gpuInstancing.enabled) {
+    _findGpuInstances();
+  }
+  {
+    ScopedPhase phase{_stats.convert_nodes};
+    _announceNodes(_fbxScene);
+    for (auto fbxNode : _anncouncedfbxNodes) {
+      _convertNode(*fbxNode);
+    }
+    _convertPendingPrimitives();
+    _convertLevelsOfDetail();
+    _convertScene(_fbxScene);
+  }
+  {
+    ScopedPhase phase{_stats.convert_animation};
+    _convertAnimation(_fbxScene);
   }
-  _convertScene(_fbxScene);
-  _convertAnimation(_fbxScene);
 }
 
 void to_json(Json &j_, bee::Logger::Level level_) {
@@ -100,6 +111,8 @@ fbxsdk::FbxGeometryConverter &SceneConverter::_getGeometryConverter() {
 }
 
 void SceneConverter::_prepareScene() {
+  std::optional<ScopedPhase> convertScenePhase{_stats.convert_scene};
+
   // Convert axis system
   fbxsdk::FbxAxisSystem::OpenGL.ConvertScene(&_fbxScene);
 
@@ -128,14 +141,23 @@ void SceneConverter::_prepareScene() {
     }
   }
 
+  convertScenePhase.reset();
+
   // Save Original mesh name
   _traverseNodes(_fbxScene.GetRootNode());
 
   // Trianglute the whole scene
-  _fbxGeometryConverter.Triangulate(&_fbxScene, true);
+  {
+    ScopedPhase phase{_stats.triangulate};
+    _fbxGeometryConverter.Triangulate(&_fbxScene, true);
+  }
 
   // Split meshes per material
-  _splitMeshesResult = split_meshes_per_material(_fbxScene, _fbxGeometryConverter);
+  {
+    ScopedPhase phase{_stats.split_meshes};
+    _splitMeshesResult =
+        split_meshes_per_material(_fbxScene, _fbxGeometryConverter);
+  }
   if (_options.verbose) {
     for (const auto &splitItem : _splitMeshesResult) {
       _log(Logger::Level::verbose, fmt::format("Splitted {} into {}", splitItem.first->GetNameWithNameSpacePrefix().Buffer(), splitItem.second->GetNameWithNameSpacePrefix().Buffer()));
@@ -171,6 +193,9 @@ void SceneConverter::_announceNodes(const fbxsdk::FbxScene &fbx_scene_) {
 }
 
 void SceneConverter::_announceNode(fbxsdk::FbxNode &fbx_node_) {
+  if (_gpuInstancedNodes.contains(&fbx_node_)) {
+    return;
+  }
   _anncouncedfbxNodes.push_back(&fbx_node_);
   fx::gltf::Node glTFNode;
   auto glTFNodeIndex =
@@ -202,6 +227,11 @@ std::string SceneConverter::_convertName(const char *fbx_name_) {
   return fbx_name_;
 }
 
+GLTFBuilder::XXIndex SceneConverter::_partitionBuffer(bool separate_,
+                                                      std::string_view name_) {
+  return separate_ ? _glTFBuilder.createBuffer(name_) : 0;
+}
+
 bee::filesystem::path
 SceneConverter::_convertFileName(const char *fbx_file_name_) {
   std::u8string u8name{reinterpret_cast<const char8_t *>(fbx_file_name_)};
@@ -255,7 +285,11 @@ SceneConverter::_convertScene(fbxsdk::FbxScene &fbx_scene_) {
   auto rootNode = fbx_scene_.GetRootNode();
   auto nChildren = rootNode->GetChildCount();
   for (auto iChild = 0; iChild < nChildren; ++iChild) {
-    auto glTFNodeIndex = _getNodeMap(*rootNode->GetChild(iChild));
+    const auto fbxChild = rootNode->GetChild(iChild);
+    if (_gpuInstancedNodes.contains(fbxChild)) {
+      continue;
+    }
+    auto glTFNodeIndex = _getNodeMap(*fbxChild);
     assert(glTFNodeIndex);
     glTFScene.nodes.push_back(*glTFNodeIndex);
   }
@@ -276,7 +310,12 @@ void SceneConverter::_convertNode(fbxsdk::FbxNode &fbx_node_) {
 
   auto nChildren = fbx_node_.GetChildCount();
   for (auto iChild = 0; iChild < nChildren; ++iChild) {
-    auto glTFNodeIndex = _getNodeMap(*fbx_node_.GetChild(iChild));
+    const auto fbxChild = fbx_node_.GetChild(iChild);
+    if (_gpuInstancedNodes.contains(fbxChild)) {
+      // It's drawn as an instance of the node it's collapsed into.
+      continue;
+    }
+    auto glTFNodeIndex = _getNodeMap(*fbxChild);
     assert(glTFNodeIndex);
     glTFNode.children.push_back(*glTFNodeIndex);
   }
@@ -397,12 +436,38 @@ void SceneConverter::_convertNode(fbxsdk::FbxNode &fbx_node_) {
 
     const auto convertMeshResult =
         _convertNodeMeshes(nodeBumpData, splittedMeshes, fbx_node_);
-    if (convertMeshResult) {
+    if (convertMeshResult && convertMeshResult->dequantization) {
+      // The node's own transform may be animated; the mesh is scaled back
+      // by a child instead, which morph animations target then.
+      const auto &[offset, scale] = *convertMeshResult->dequantization;
+      fx::gltf::Node glTFMeshNode;
+      glTFMeshNode.name = fmt::format("{}/Dequantized", nodeName);
+      glTFMeshNode.mesh = convertMeshResult->glTFMeshIndex;
+      for (int iAxis = 0; iAxis < 3; ++iAxis) {
+        glTFMeshNode.translation[iAxis] = static_cast<float>(offset[iAxis]);
+        glTFMeshNode.scale[iAxis] = static_cast<float>(scale);
+      }
+      const auto glTFMeshNodeIndex =
+          _glTFBuilder.add(&fx::gltf::Document::nodes, std::move(glTFMeshNode));
+      _glTFBuilder.get(&fx::gltf::Document::nodes)[glTFNodeIndex]
+          .children.push_back(glTFMeshNodeIndex);
+      nodeBumpData.glTFNodeIndex = glTFMeshNodeIndex;
+    } else if (convertMeshResult) {
       glTFNode.mesh = convertMeshResult->glTFMeshIndex;
       if (convertMeshResult->glTFSkinIndex) {
         glTFNode.skin = *convertMeshResult->glTFSkinIndex;
       }
     }
+    if (const auto gpuInstances = _gpuInstances.find(&fbx_node_);
+        convertMeshResult && gpuInstances != _gpuInstances.end()) {
+      _convertGpuInstances(gpuInstances->second, glTFNodeIndex,
+                           nodeBumpData.glTFNodeIndex,
+                           convertMeshResult->dequantization);
+    }
+    if (convertMeshResult &&
+        _meshLevelsOfDetail.contains(convertMeshResult->glTFMeshIndex)) {
+      _levelOfDetailNodes.push_back(nodeBumpData.glTFNodeIndex);
+    }
   }
 
   _nodeDumpMetaMap.emplace(&fbx_node_, nodeBumpData);
@@ -411,4 +476,4 @@ void SceneConverter::_convertNode(fbxsdk::FbxNode &fbx_node_) {
 std::string SceneConverter::_getName(fbxsdk::FbxNode &fbx_node_) {
   return fbx_string_to_utf8_checked(fbx_node_.GetName());
 }
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
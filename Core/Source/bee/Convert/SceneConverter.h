@@ -9,15 +9,21 @@
 #include <bee/Converter.h>
 #include <bee/GLTFBuilder.h>
 #include <bee/GLTFUtilities.h>
+#include <bee/Memory.h>
+#include <bee/ThreadPool.h>
+#include <bee/UntypedVertex.h>
 #include <bee/polyfills/filesystem.h>
+#include <array>
 #include <compare>
 #include <fbxsdk.h>
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 namespace bee {
@@ -39,6 +45,31 @@ public:
 
   void convert();
 
+  /// <summary>
+  /// Texture images resolved during conversion.
+  /// </summary>
+  const std::vector<std::u8string> &referencedFiles() const {
+    return _referencedFiles;
+  }
+
+  /// <summary>
+  /// Texture images looked for during conversion but not found.
+  /// </summary>
+  const std::vector<std::u8string> &unresolvedFiles() const {
+    return _unresolvedFiles;
+  }
+
+  /// <summary>
+  /// Images copied beside the output in `PathMode::copy`.
+  /// </summary>
+  const std::vector<std::u8string> &copiedFiles() const {
+    return _copiedFiles;
+  }
+
+  const ConvertStats &stats() const {
+    return _stats;
+  }
+
 private:
   std::map<fbxsdk::FbxNode *, std::string> nodeMeshMap;
 
@@ -128,14 +159,36 @@ private:
     std::optional<FbxNodeMeshesBumpMeta> meshes;
   };
 
+  /// <summary>
+  /// Positions are stored as `(position - offset) / scale`, within [-1, 1],
+  /// so that they may be normalized integers. See
+  /// `ConvertOptions::MeshQuantization`.
+  /// </summary>
+  struct PositionQuantization {
+    std::array<double, 3> offset;
+    double scale;
+  };
+
   struct ConvertMeshResult {
     GLTFBuilder::XXIndex glTFMeshIndex;
     std::optional<GLTFBuilder::XXIndex> glTFSkinIndex;
+    /// <summary>
+    /// The transform the node has to scale quantized positions back with.
+    /// Skinned meshes have it in their inverse bind matrices instead.
+    /// </summary>
+    std::optional<PositionQuantization> dequantization;
   };
 
   struct VertexBulk {
-    using ChannelWriter =
-        std::function<void(std::byte *out_, const std::byte *in_)>;
+    /// <summary>
+    /// Writes the channel of `count_` vertices, `in_stride_` and
+    /// `out_stride_` bytes apart.
+    /// </summary>
+    using ChannelWriter = void (*)(std::byte *out_,
+                                   std::size_t out_stride_,
+                                   const std::byte *in_,
+                                   std::size_t in_stride_,
+                                   std::size_t count_);
 
     struct Channel {
       std::string name;
@@ -145,6 +198,7 @@ private:
       std::uint32_t outOffset;
       ChannelWriter writer;
       std::optional<std::uint32_t> target;
+      bool normalized;
     };
 
     std::optional<std::uint32_t> morphTargetHint;
@@ -157,10 +211,21 @@ private:
                     fx::gltf::Accessor::ComponentType component_type_,
                     std::uint32_t in_offset_,
                     ChannelWriter writer_,
-                    std::optional<std::uint32_t> target_ = {}) {
+                    std::optional<std::uint32_t> target_ = {},
+                    bool normalized_ = false) {
       channels.emplace_back(Channel{name_, type_, component_type_, in_offset_,
-                                    stride, writer_, target_});
-      stride += countBytes(type_, component_type_);
+                                    stride, writer_, target_, normalized_});
+      stride += alignedBytes(type_, component_type_);
+    }
+
+    /// <summary>
+    /// Bytes a channel takes in a vertex. Vertex attributes start at 4-byte
+    /// boundaries, which matters to quantized ones.
+    /// </summary>
+    static std::uint32_t
+    alignedBytes(fx::gltf::Accessor::Type type_,
+                 fx::gltf::Accessor::ComponentType component_type_) {
+      return (countBytes(type_, component_type_) + 3) / 4 * 4;
     }
   };
 
@@ -250,6 +315,99 @@ private:
     MaterialUsage _usage;
   };
 
+  /// <summary>
+  /// What a primitive is made of, copied out of the FBX SDK so that
+  /// `_assemblePrimitive()` may run on any thread.
+  /// </summary>
+  struct MeshSnapshot {
+    std::string name;
+    FbxMeshVertexLayout vertexLayout;
+    std::vector<fbxsdk::FbxVector4> controlPoints;
+    std::vector<int> polygonVertices;
+    std::optional<fbxsdk::FbxMatrix> vertexTransform;
+    std::optional<fbxsdk::FbxMatrix> normalTransform;
+    std::vector<MeshSkinData::InfluenceChannel> skinInfluenceChannels;
+    std::uint32_t targetCount = 0;
+    std::optional<PositionQuantization> positionQuantization;
+  };
+
+  /// <summary>
+  /// Bits each attribute of a primitive is quantized to, or 0 to keep it
+  /// float. See `ConvertOptions::MeshQuantization`.
+  /// </summary>
+  struct VertexQuantization {
+    std::uint32_t position = 0;
+    std::uint32_t normal = 0;
+    std::vector<std::uint32_t> uvs;
+    std::uint32_t color = 0;
+  };
+
+  /// <summary>
+  /// A primitive whose buffer views are filled but not yet added to the
+  /// glTF builder. Its accessors index `bufferViews`, and its attributes,
+  /// targets and indices index `accessors`, until `_commitPrimitive()`.
+  /// </summary>
+  struct PackedPrimitive {
+    struct BufferView {
+      fx::gltf::BufferView bufferView;
+      TrackedBytes data;
+      std::uint32_t align = 0;
+      std::optional<MeshoptEncoding> meshoptEncoding;
+    };
+
+    std::vector<BufferView> bufferViews;
+    std::vector<fx::gltf::Accessor> accessors;
+    fx::gltf::Primitive primitive;
+    bool hasTransparentVertex = false;
+    /// <summary>
+    /// Whether it needs `KHR_mesh_quantization`.
+    /// </summary>
+    bool quantized = false;
+    std::size_t polygonVertexCount = 0;
+    std::size_t uniqueVertexCount = 0;
+
+    /// <summary>
+    /// A simplified level: the indices accessor drawing it instead of those
+    /// of `primitive`, and its error, relative to the extent of the mesh.
+    /// </summary>
+    struct LevelOfDetail {
+      std::uint32_t indices;
+      float error;
+    };
+
+    std::vector<LevelOfDetail> levelsOfDetail;
+
+    /// <summary>
+    /// The buffer view of the `KHR_draco_mesh_compression` data and the id
+    /// of each attribute in it, if compressed.
+    /// </summary>
+    struct DracoCompression {
+      std::uint32_t bufferView;
+      std::map<std::string, std::uint32_t> attributes;
+      bool fallback;
+    };
+
+    std::optional<DracoCompression> dracoCompression;
+  };
+
+  /// <summary>
+  /// A primitive of a glTF mesh added already, awaiting
+  /// `_convertPendingPrimitives()`.
+  /// </summary>
+  struct PendingPrimitive {
+    GLTFBuilder::XXIndex glTFMeshIndex;
+    std::size_t primitiveIndex;
+    GLTFBuilder::XXIndex bufferIndex;
+    MeshSnapshot snapshot;
+    fbxsdk::FbxSurfaceMaterial *fbxMaterial = nullptr;
+    MaterialUsage materialUsage;
+    std::optional<PackedPrimitive> packed;
+    /// <summary>
+    /// Tracked bytes `packed` holds, allocated on whichever thread packed it.
+    /// </summary>
+    std::int64_t packedBytes = 0;
+  };
+
   GLTFBuilder &_glTFBuilder;
   fbxsdk::FbxManager &_fbxManager;
   fbxsdk::FbxGeometryConverter _fbxGeometryConverter;
@@ -271,7 +429,43 @@ private:
   std::unordered_map<const fbxsdk::FbxNode *, FbxNodeDumpMeta> _nodeDumpMetaMap;
   std::optional<fbxsdk::FbxDouble> _unitScaleFactor = 1.0;
   std::unordered_map<MeshInstancingKey, ConvertMeshResult> _meshInstanceMap;
+  /// <summary>
+  /// The simplified meshes of a mesh, and the error of each, the most of
+  /// its primitives'. See `ConvertOptions::LevelsOfDetail`.
+  /// </summary>
+  struct MeshLevelsOfDetail {
+    std::vector<GLTFBuilder::XXIndex> meshes;
+    std::vector<float> errors;
+  };
+  std::unordered_map<GLTFBuilder::XXIndex, MeshLevelsOfDetail>
+      _meshLevelsOfDetail;
+  /// <summary>
+  /// Nodes of meshes having levels of detail, in the order converted.
+  /// </summary>
+  std::vector<GLTFBuilder::XXIndex> _levelOfDetailNodes;
+  /// <summary>
+  /// Nodes drawing, with `EXT_mesh_gpu_instancing`, the nodes collapsed into
+  /// them, themselves first. See `ConvertOptions::GpuInstancing`.
+  /// </summary>
+  std::unordered_map<const fbxsdk::FbxNode *, std::vector<fbxsdk::FbxNode *>>
+      _gpuInstances;
+  /// <summary>
+  /// Nodes collapsed into another, which have no glTF node of their own.
+  /// </summary>
+  std::unordered_set<const fbxsdk::FbxNode *> _gpuInstancedNodes;
   SplitMeshesResult _splitMeshesResult;
+  std::vector<std::u8string> _referencedFiles;
+  std::vector<std::u8string> _unresolvedFiles;
+  std::vector<std::u8string> _copiedFiles;
+  std::vector<PendingPrimitive> _pendingPrimitives;
+  std::size_t _pendingPolygonVertices = 0;
+  std::unique_ptr<ThreadPool> _threadPool;
+  /// <summary>
+  /// Storage of the vertices being assembled, reused from one primitive to
+  /// the next.
+  /// </summary>
+  mutable VirtualArenaPool _vertexArenas;
+  ConvertStats _stats;
 
   inline fbxsdk::FbxVector4
   _applyUnitScaleFactorV3(const fbxsdk::FbxVector4 &v_) const {
@@ -322,6 +516,14 @@ private:
 
   GLTFBuilder::XXIndex _convertScene(fbxsdk::FbxScene &fbx_scene_);
 
+  /// <summary>
+  /// The buffer to put the data of a mesh, an animation or an image in:
+  /// a new one named `name_` if `separate_`, per
+  /// `ConvertOptions::bufferPartition`; otherwise the shared buffer 0.
+  /// </summary>
+  GLTFBuilder::XXIndex _partitionBuffer(bool separate_,
+                                        std::string_view name_);
+
   void _convertNode(fbxsdk::FbxNode &fbx_node_);
 
   std::string _getName(fbxsdk::FbxNode &fbx_node_);
@@ -338,30 +540,129 @@ private:
   std::tuple<fbxsdk::FbxMatrix, fbxsdk::FbxMatrix>
   _getGeometrixTransform(const fbxsdk::FbxNode &fbx_node_);
 
-  fx::gltf::Primitive _convertMeshAsPrimitive(
+  /// <summary>
+  /// Copies what the primitive of `fbx_mesh_` is made of.
+  /// Runs on the FBX SDK's thread.
+  /// </summary>
+  MeshSnapshot _snapshotMesh(
       fbxsdk::FbxMesh &fbx_mesh_,
       std::string_view mesh_name_,
-      fbxsdk::FbxMatrix *vertex_transform_,
-      fbxsdk::FbxMatrix *normal_transform_,
+      const fbxsdk::FbxMatrix *vertex_transform_,
+      const fbxsdk::FbxMatrix *normal_transform_,
       std::span<fbxsdk::FbxShape *> fbx_shapes_,
-      std::span<MeshSkinData::InfluenceChannel> skin_influence_channels_,
-      MaterialUsage &material_usage_);
+      std::vector<MeshSkinData::InfluenceChannel> &&skin_influence_channels_);
+
+  /// <summary>
+  /// Assembles and dedups the vertices then packs them.
+  /// Touches neither the FBX SDK nor the glTF builder, so that primitives
+  /// may be assembled on several threads.
+  /// </summary>
+  PackedPrimitive _assemblePrimitive(const MeshSnapshot &snapshot_) const;
+
+  /// <summary>
+  /// Assembles the polygon vertices into `vertices_`, deduplicated, and
+  /// returns the index of each polygon vertex's.
+  /// `VertexSize_` is the size of the dedup key if known at compile time,
+  /// or 0.
+  /// </summary>
+  template <std::uint32_t VertexSize_>
+  std::vector<std::uint32_t>
+  _assembleVertices(const MeshSnapshot &snapshot_,
+                    UntypedVertexVector &vertices_,
+                    bool &has_transparent_vertex_) const;
+
+  /// <summary>
+  /// Appends to `vertices_` each of `key_vertices_`, deduplicated without
+  /// their shapes, followed by the shape deltas at the polygon vertex it was
+  /// assembled from.
+  /// </summary>
+  void _assembleShapes(const MeshSnapshot &snapshot_,
+                       UntypedVertexVector &key_vertices_,
+                       std::span<const std::size_t> vertex_polygon_vertices_,
+                       UntypedVertexVector &vertices_) const;
+
+  /// <summary>
+  /// Assembles the pending primitives on the thread pool, then commits them
+  /// to the glTF builder in the order they were queued, so that the output
+  /// doesn't depend on the number of threads.
+  /// </summary>
+  void _convertPendingPrimitives();
+
+  /// <summary>
+  /// Adds a node for each level of detail of the mesh of each node in
+  /// `_levelOfDetailNodes`, which `MSFT_lod` lists.
+  /// </summary>
+  void _convertLevelsOfDetail();
+
+  /// <summary>
+  /// Fills `_gpuInstances`, see `ConvertOptions::GpuInstancing`.
+  /// </summary>
+  void _findGpuInstances();
+
+  /// <summary>
+  /// Writes the transforms of `fbx_nodes_` as the instances of the node
+  /// holding their mesh, that of the first, which then has none of its own.
+  /// </summary>
+  void _convertGpuInstances(
+      const std::vector<fbxsdk::FbxNode *> &fbx_nodes_,
+      GLTFBuilder::XXIndex glTF_node_index_,
+      GLTFBuilder::XXIndex glTF_mesh_node_index_,
+      const std::optional<PositionQuantization> &dequantization_);
+
+  /// <summary>
+  /// Adds the buffer views and accessors of `packed_` to the glTF builder.
+  /// Those of its levels of detail are updated as its primitive's.
+  /// </summary>
+  fx::gltf::Primitive _commitPrimitive(PackedPrimitive &packed_,
+                                       GLTFBuilder::XXIndex buffer_index_);
 
   FbxMeshVertexLayout _getFbxMeshVertexLayout(
       fbxsdk::FbxMesh &fbx_mesh_,
       std::span<fbxsdk::FbxShape *> fbx_shapes_,
       std::span<MeshSkinData::InfluenceChannel> skin_influence_channels_);
 
-  fx::gltf::Primitive _createPrimitive(std::list<VertexBulk> &bulks_,
-                                       std::uint32_t target_count_,
-                                       std::uint32_t vertex_count_,
-                                       std::byte *untyped_vertices_,
-                                       std::uint32_t vertex_size_,
-                                       std::span<std::uint32_t> indices_,
-                                       std::string_view primitive_name_);
+  static PackedPrimitive _createPrimitive(
+      std::list<VertexBulk> &bulks_,
+      std::uint32_t target_count_,
+      std::uint32_t vertex_count_,
+      std::byte *untyped_vertices_,
+      std::uint32_t vertex_size_,
+      std::span<std::uint32_t> indices_,
+      std::string_view primitive_name_,
+      const ConvertOptions::SparseMorphTargets &sparse_morph_targets_,
+      const ConvertOptions::MeshoptCompression &meshopt_compression_);
+
+  /// <summary>
+  /// Adds the indices to `packed_` as a buffer view and accessor, returning
+  /// that accessor.
+  /// </summary>
+  static std::uint32_t _createIndices(PackedPrimitive &packed_,
+                                      std::span<const std::uint32_t> indices_,
+                                      std::string_view primitive_name_);
+
+  /// <summary>
+  /// Compresses the attributes and indices of `packed_` with Draco. Without
+  /// a fallback, the buffer views left unused are dropped.
+  /// </summary>
+  static void
+  _compressPrimitiveDraco(PackedPrimitive &packed_,
+                          std::uint32_t vertex_count_,
+                          std::span<const std::uint32_t> indices_,
+                          std::string_view primitive_name_,
+                          const ConvertOptions::DracoCompression &options_);
 
-  std::list<VertexBulk>
-  _typeVertices(const FbxMeshVertexLayout &vertex_layout_);
+  static std::list<VertexBulk>
+  _typeVertices(const FbxMeshVertexLayout &vertex_layout_,
+                const VertexQuantization &vertex_quantization_);
+
+  /// <summary>
+  /// The bounds positions, shapes' included, are quantized within.
+  /// </summary>
+  std::optional<PositionQuantization> _getPositionQuantization(
+      const std::vector<fbxsdk::FbxMesh *> &fbx_meshes_,
+      const std::optional<FbxNodeMeshesBumpMeta::BlendShapeDumpMeta>
+          &blend_shape_meta_,
+      const fbxsdk::FbxMatrix *vertex_transform_) const;
 
   int _getTheUniqueMaterial(fbxsdk::FbxMesh &fbx_mesh_);
 
@@ -384,7 +685,8 @@ private:
   std::optional<MeshSkinData>
   _extractSkinData(const fbxsdk::FbxMesh &fbx_mesh_);
 
-  std::uint32_t _createGLTFSkin(const NodeMeshesSkinData &skin_data_);
+  std::uint32_t _createGLTFSkin(const NodeMeshesSkinData &skin_data_,
+                                GLTFBuilder::XXIndex buffer_index_);
 
   std::optional<FbxBlendShapeData>
   _extractdBlendShapeData(const fbxsdk::FbxMesh &fbx_mesh_);
@@ -450,6 +752,8 @@ private:
 
   std::optional<std::string> _searchImage(const std::string_view name_);
 
+  void _addUnresolvedFile(const bee::filesystem::path &path_);
+
   using BufferViewIndexAndMimeType =
       std::pair<GLTFBuilder::XXIndex, std::u8string>;
 
@@ -473,22 +777,26 @@ private:
   void _convertAnimationLayer(fx::gltf::Animation &glTF_animation_,
                               fbxsdk::FbxAnimLayer &fbx_anim_layer_,
                               fbxsdk::FbxScene &fbx_scene_,
-                              const AnimRange &anim_range_);
+                              const AnimRange &anim_range_,
+                              GLTFBuilder::XXIndex buffer_index_);
 
   void _convertAnimationLayer(fx::gltf::Animation &glTF_animation_,
                               fbxsdk::FbxAnimLayer &fbx_anim_layer_,
                               fbxsdk::FbxNode &fbx_node_,
-                              const AnimRange &anim_range_);
+                              const AnimRange &anim_range_,
+                              GLTFBuilder::XXIndex buffer_index_);
 
   void _extractWeightsAnimation(fx::gltf::Animation &glTF_animation_,
                                 fbxsdk::FbxAnimLayer &fbx_anim_layer_,
                                 fbxsdk::FbxNode &fbx_node_,
-                                const AnimRange &anim_range_);
+                                const AnimRange &anim_range_,
+                                GLTFBuilder::XXIndex buffer_index_);
 
   void _writeMorphAnimtion(fx::gltf::Animation &glTF_animation_,
                            const MorphAnimation &morph_animtion_,
                            std::uint32_t glTF_node_index_,
-                           const fbxsdk::FbxNode &fbx_node_);
+                           const fbxsdk::FbxNode &fbx_node_,
+                           GLTFBuilder::XXIndex buffer_index_);
 
   std::optional<MorphAnimation>
   _extractWeightsAnimation(fbxsdk::FbxAnimLayer &fbx_anim_layer_,
@@ -500,6 +808,7 @@ private:
   void _extractTrsAnimation(fx::gltf::Animation &glTF_animation_,
                             fbxsdk::FbxAnimLayer &fbx_anim_layer_,
                             fbxsdk::FbxNode &fbx_node_,
-                            const AnimRange &anim_range_);
+                            const AnimRange &anim_range_,
+                            GLTFBuilder::XXIndex buffer_index_);
 };
 } // namespace bee
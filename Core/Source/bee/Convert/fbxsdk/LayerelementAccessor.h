@@ -1,8 +1,10 @@
-
 #pragma once
 
+#include <cstddef>
 #include <fbxsdk.h>
-#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 namespace bee {
 struct FbxLayerElementAccessParams {
@@ -11,45 +13,214 @@ struct FbxLayerElementAccessParams {
   int polygonIndex = 0;
 };
 
+/// <summary>
+/// What a layer element is looked up by.
+/// </summary>
+enum class FbxLayerElementMapping {
+  controlPoint,
+  polygonVertex,
+  polygon,
+  /// <summary>
+  /// `eAllSame` or `eNone`: every polygon vertex reads the same value.
+  /// </summary>
+  constant,
+};
+
+/// <summary>
+/// Number of control points, polygon vertices and polygons of a mesh, that
+/// is, the number of elements a layer element is supposed to map.
+/// </summary>
+struct FbxLayerElementCounts {
+  std::size_t controlPoints = 0;
+  std::size_t polygonVertices = 0;
+  std::size_t polygons = 0;
+};
+
 template <typename Value_>
-using FbxLayerElementAccessor =
-    std::function<Value_(const FbxLayerElementAccessParams &params_)>;
-
-template <typename Value>
-std::function<Value(const FbxLayerElementAccessParams &params_)>
-create_mapping_mode_visitor(
-    fbxsdk::FbxLayerElement::EMappingMode mapping_mode_,
-    std::function<Value(int index_)> reference_mode_visitor_,
-    Value default_value_ = {}) {
+std::shared_ptr<const std::vector<Value_>> copyLayerElementArray(
+    const fbxsdk::FbxLayerElementArrayTemplate<Value_> &array_) {
+  const auto nElements = array_.GetCount();
+  auto result = std::make_shared<std::vector<Value_>>();
+  result->reserve(nElements);
+  for (int iElement = 0; iElement < nElements; ++iElement) {
+    result->push_back(array_.GetAt(iElement));
+  }
+  return result;
+}
+
+/// <summary>
+/// Reads a layer element per polygon vertex.
+///
+/// The accessor reads from copies of the layer element's arrays, so that it
+/// may be called from any thread once created: the FBX SDK's arrays are
+/// not safe to read concurrently.
+///
+/// `operator()` resolves the mapping and reference mode on each call and
+/// checks bounds: out of range indices read the default value, as the FBX
+/// SDK's do. Hot loops should go through `visit()` instead, which hands them
+/// a reader specialized for the mapping and reference mode.
+/// </summary>
+template <typename Value_> class FbxLayerElementAccessor {
+public:
+  using value_type = Value_;
+
+  FbxLayerElementAccessor(Value_ constant_ = {})
+      : _mapping(FbxLayerElementMapping::constant), _constant(constant_),
+        _defaultValue(constant_) {
+  }
+
+  /// <param name="index_">Null if the reference mode is `eDirect`.</param>
+  FbxLayerElementAccessor(FbxLayerElementMapping mapping_,
+                          std::shared_ptr<const std::vector<Value_>> direct_,
+                          std::shared_ptr<const std::vector<int>> index_,
+                          Value_ default_value_)
+      : _mapping(mapping_), _direct(std::move(direct_)),
+        _index(std::move(index_)), _defaultValue(default_value_) {
+    if (_index) {
+      _indicesInRange = true;
+      for (const auto index : *_index) {
+        if (index < 0 || static_cast<std::size_t>(index) >= _direct->size()) {
+          _indicesInRange = false;
+          break;
+        }
+      }
+    }
+    if (_mapping == FbxLayerElementMapping::constant) {
+      _constant = _lookup(0);
+    }
+  }
+
+  FbxLayerElementMapping mapping() const {
+    return _mapping;
+  }
+
+  Value_ operator()(const FbxLayerElementAccessParams &params_) const {
+    switch (_mapping) {
+    case FbxLayerElementMapping::controlPoint:
+      return _lookup(params_.controlPointIndex);
+    case FbxLayerElementMapping::polygonVertex:
+      return _lookup(params_.polygonVertexIndex);
+    case FbxLayerElementMapping::polygon:
+      return _lookup(params_.polygonIndex);
+    default:
+      return _constant;
+    }
+  }
+
+  /// <summary>
+  /// Calls `visitor_(reader)` once, where `reader(params)` reads as
+  /// `operator()` does. If every element of `counts_` is in range, `reader`
+  /// is specialized for the mapping and reference mode and skips the bounds
+  /// checks; otherwise it's `operator()` itself.
+  /// </summary>
+  template <typename Visitor_>
+  decltype(auto) visit(const FbxLayerElementCounts &counts_,
+                       Visitor_ &&visitor_) const {
+    using Mapping = FbxLayerElementMapping;
+    if (!_covers(counts_)) {
+      return visitor_([this](const FbxLayerElementAccessParams &params_) {
+        return (*this)(params_);
+      });
+    }
+    switch (_mapping) {
+    case Mapping::controlPoint:
+      return _index ? visitor_(_reader<Mapping::controlPoint, true>())
+                    : visitor_(_reader<Mapping::controlPoint, false>());
+    case Mapping::polygonVertex:
+      return _index ? visitor_(_reader<Mapping::polygonVertex, true>())
+                    : visitor_(_reader<Mapping::polygonVertex, false>());
+    case Mapping::polygon:
+      return _index ? visitor_(_reader<Mapping::polygon, true>())
+                    : visitor_(_reader<Mapping::polygon, false>());
+    default:
+      return visitor_(_reader<Mapping::constant, false>());
+    }
+  }
+
+private:
+  FbxLayerElementMapping _mapping;
+  std::shared_ptr<const std::vector<Value_>> _direct;
+  std::shared_ptr<const std::vector<int>> _index;
+  bool _indicesInRange = false;
+  Value_ _constant;
+  Value_ _defaultValue;
+
+  Value_ _lookup(int index_) const {
+    const auto at = [](const auto &array_, int index_, auto default_value_) {
+      return index_ >= 0 && static_cast<std::size_t>(index_) < array_.size()
+                 ? array_[index_]
+                 : default_value_;
+    };
+    if (_index) {
+      const auto directIndex = at(*_index, index_, -1);
+      return at(*_direct, directIndex, _defaultValue);
+    } else {
+      return at(*_direct, index_, _defaultValue);
+    }
+  }
+
+  bool _covers(const FbxLayerElementCounts &counts_) const {
+    std::size_t count = 0;
+    switch (_mapping) {
+    case FbxLayerElementMapping::controlPoint:
+      count = counts_.controlPoints;
+      break;
+    case FbxLayerElementMapping::polygonVertex:
+      count = counts_.polygonVertices;
+      break;
+    case FbxLayerElementMapping::polygon:
+      count = counts_.polygons;
+      break;
+    default:
+      return true;
+    }
+    return _index ? (_indicesInRange && _index->size() >= count)
+                  : _direct->size() >= count;
+  }
+
+  template <FbxLayerElementMapping Mapping_, bool Indexed_>
+  auto _reader() const {
+    return [direct = _direct ? _direct->data() : nullptr,
+            index = _index ? _index->data() : nullptr,
+            constant = _constant](const FbxLayerElementAccessParams &params_) {
+      if constexpr (Mapping_ == FbxLayerElementMapping::constant) {
+        return constant;
+      } else {
+        int i = 0;
+        if constexpr (Mapping_ == FbxLayerElementMapping::controlPoint) {
+          i = params_.controlPointIndex;
+        } else if constexpr (Mapping_ ==
+                             FbxLayerElementMapping::polygonVertex) {
+          i = params_.polygonVertexIndex;
+        } else {
+          i = params_.polygonIndex;
+        }
+        if constexpr (Indexed_) {
+          return direct[index[i]];
+        } else {
+          return direct[i];
+        }
+      }
+    };
+  }
+};
+
+inline FbxLayerElementMapping
+toFbxLayerElementMapping(fbxsdk::FbxLayerElement::EMappingMode mapping_mode_) {
   switch (mapping_mode_) {
     using EMappingMode = fbxsdk::FbxLayerElement::EMappingMode;
   case EMappingMode::eByControlPoint:
-    return
-        [reference_mode_visitor_](const FbxLayerElementAccessParams &params_) {
-          return reference_mode_visitor_(params_.controlPointIndex);
-        };
+    return FbxLayerElementMapping::controlPoint;
   case EMappingMode::eByPolygonVertex:
-    return
-        [reference_mode_visitor_](const FbxLayerElementAccessParams &params_) {
-          return reference_mode_visitor_(params_.polygonVertexIndex);
-        };
+    return FbxLayerElementMapping::polygonVertex;
   case EMappingMode::eByPolygon:
-    return
-        [reference_mode_visitor_](const FbxLayerElementAccessParams &params_) {
-          return reference_mode_visitor_(params_.polygonIndex);
-        };
+    return FbxLayerElementMapping::polygon;
   case EMappingMode::eByEdge:
     throw std::runtime_error("Unsupported mapping mode: ByEdge");
     break;
-  case EMappingMode::eAllSame: {
-    auto first = reference_mode_visitor_(0);
-    return
-        [first](const FbxLayerElementAccessParams &params_) { return first; };
-  }
+  case EMappingMode::eAllSame:
   case EMappingMode::eNone:
-    return [default_value_](const FbxLayerElementAccessParams &params_) {
-      return default_value_;
-    };
+    return FbxLayerElementMapping::constant;
   default:
     throw std::runtime_error("Unknown mapping mode");
   }
@@ -61,27 +232,25 @@ template <typename Value_,
 FbxLayerElementAccessor<Value_> makeFbxLayerElementAccessor(
     const fbxsdk::FbxLayerElementTemplate<Value_> &layer_element_,
     Value_ default_value_ = Value_{}) {
+  const auto mapping =
+      toFbxLayerElementMapping(layer_element_.GetMappingMode());
+  if (layer_element_.GetMappingMode() == fbxsdk::FbxLayerElement::eNone) {
+    return FbxLayerElementAccessor<Value_>{default_value_};
+  }
 
-  const auto getVal = [&layer_element_]() -> std::function<Value_(int i_)> {
-    using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
-    const auto referenceMode = layer_element_.GetReferenceMode();
-    if (referenceMode == EReferenceMode::eDirect) {
-      auto &directArray = layer_element_.GetDirectArray();
-      return [&directArray](int index_) { return directArray[index_]; };
-    } else if (referenceMode == EReferenceMode::eIndexToDirect ||
-               referenceMode == EReferenceMode::eIndex) {
-      auto &directArray = layer_element_.GetDirectArray();
-      auto &indexArray = layer_element_.GetIndexArray();
-      return [&directArray, &indexArray](int index_) {
-        return directArray[indexArray[index_]];
-      };
-    } else {
-      throw std::runtime_error("Unknown reference mode");
-    }
-  }();
-
-  return create_mapping_mode_visitor(layer_element_.GetMappingMode(), getVal,
-                                     default_value_);
+  using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
+  const auto referenceMode = layer_element_.GetReferenceMode();
+  if (referenceMode == EReferenceMode::eDirect) {
+    return {mapping, copyLayerElementArray(layer_element_.GetDirectArray()),
+            nullptr, default_value_};
+  } else if (referenceMode == EReferenceMode::eIndexToDirect ||
+             referenceMode == EReferenceMode::eIndex) {
+    return {mapping, copyLayerElementArray(layer_element_.GetDirectArray()),
+            copyLayerElementArray(layer_element_.GetIndexArray()),
+            default_value_};
+  } else {
+    throw std::runtime_error("Unknown reference mode");
+  }
 }
 
 /// <summary>
@@ -94,24 +263,24 @@ inline FbxLayerElementAccessor<int> makeLayerElementMaterialAccessor(
 
   constexpr Value default_value_ = -1;
 
-  const auto getVal = [&layer_element_]() -> std::function<Value(int i_)> {
-    using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
-    auto &indexArray = layer_element_.GetIndexArray();
-
-    // >> this type of Layer element should have its reference mode set to
-    // >> `eIndexToDirect`.
-    // If we encountered such violation, we return a null material.
-    using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
-    const auto referenceMode = layer_element_.GetReferenceMode();
-    if (!(referenceMode == EReferenceMode::eIndexToDirect ||
-          referenceMode == EReferenceMode::eIndex)) {
-      return [&indexArray](int index_) { return -1; };
-    }
+  const auto mapping =
+      toFbxLayerElementMapping(layer_element_.GetMappingMode());
+  if (layer_element_.GetMappingMode() == fbxsdk::FbxLayerElement::eNone) {
+    return FbxLayerElementAccessor<Value>{default_value_};
+  }
 
-    return [&indexArray](int index_) { return indexArray[index_]; };
-  }();
+  // >> this type of Layer element should have its reference mode set to
+  // >> `eIndexToDirect`.
+  // If we encountered such violation, we return a null material.
+  using EReferenceMode = fbxsdk::FbxLayerElement::EReferenceMode;
+  const auto referenceMode = layer_element_.GetReferenceMode();
+  if (!(referenceMode == EReferenceMode::eIndexToDirect ||
+        referenceMode == EReferenceMode::eIndex)) {
+    return FbxLayerElementAccessor<Value>{default_value_};
+  }
 
-  return create_mapping_mode_visitor(layer_element_.GetMappingMode(), getVal,
-                                     default_value_);
+  // The material indices are the values themselves.
+  return {mapping, copyLayerElementArray(layer_element_.GetIndexArray()),
+          nullptr, default_value_};
 }
-} // namespace bee
\ No newline at end of file
+} // namespace bee
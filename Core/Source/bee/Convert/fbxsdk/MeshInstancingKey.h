@@ -28,6 +28,11 @@ private:
 template <>
 struct std::hash<bee::MeshInstancingKey> {
   std::size_t operator()(const bee::MeshInstancingKey &key_) const noexcept {
-    return key_._meshes.size();
+    // Order independent, as the set is.
+    std::size_t hash = 0;
+    for (const auto mesh : key_._meshes) {
+      hash += std::hash<fbxsdk::FbxMesh *>{}(mesh);
+    }
+    return hash;
   }
 };
\ No newline at end of file
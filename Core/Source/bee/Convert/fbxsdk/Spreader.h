@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <cmath>
 #include <fbxsdk.h>
+#include <limits>
 #include <type_traits>
 
 namespace bee {
@@ -25,6 +27,23 @@ struct FbxVec3Spreader : ArraySpreader<fbxsdk::FbxVector4, int, 3> {};
 
 struct FbxQuatSpreader : ArraySpreader<fbxsdk::FbxQuaternion, int, 4> {};
 
+/// <summary>
+/// Spreads unit quaternions as normalized integers.
+/// </summary>
+struct FbxQuatSnormSpreader {
+  using type = fbxsdk::FbxQuaternion;
+
+  constexpr static int size = 4;
+
+  template <typename TargetTy_>
+  static void spread(const type &in_, TargetTy_ *out_) {
+    constexpr auto max = std::numeric_limits<TargetTy_>::max();
+    for (std::remove_const_t<decltype(size)> i = 0; i < size; ++i) {
+      out_[i] = static_cast<TargetTy_>(std::lround(in_[i] * max));
+    }
+  }
+};
+
 struct FbxColorSpreader : ArraySpreader<fbxsdk::FbxColor, int, 4> {};
 
 struct FbxAMatrixSpreader {
@@ -40,4 +59,4 @@ struct FbxAMatrixSpreader {
     }
   }
 };
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
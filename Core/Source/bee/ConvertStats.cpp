@@ -0,0 +1,86 @@
+#include <bee/ConvertStats.h>
+#include <bee/Memory.h>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace bee {
+namespace {
+double thread_cpu_seconds() {
+#ifdef _WIN32
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  if (!::GetThreadTimes(::GetCurrentThread(), &creationTime, &exitTime,
+                        &kernelTime, &userTime)) {
+    return 0.0;
+  }
+  const auto toTicks = [](const FILETIME &time_) {
+    return (static_cast<std::uint64_t>(time_.dwHighDateTime) << 32) |
+           time_.dwLowDateTime;
+  };
+  // In 100-nanosecond intervals.
+  return static_cast<double>(toTicks(kernelTime) + toTicks(userTime)) * 1e-7;
+#else
+  timespec time;
+  if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    return 0.0;
+  }
+  return static_cast<double>(time.tv_sec) +
+         static_cast<double>(time.tv_nsec) * 1e-9;
+#endif
+}
+} // namespace
+
+void to_json(nlohmann::json &j_, const ConvertStats::Phase &phase_) {
+  j_ = nlohmann::json{
+      {"wall", phase_.wall},
+      {"cpu", phase_.cpu},
+      {"peakRss", phase_.peak_rss},
+      {"peakAllocated", phase_.peak_allocated},
+  };
+}
+
+void to_json(nlohmann::json &j_, const ConvertStats &stats_) {
+  j_ = nlohmann::json{
+      {"phases",
+       {
+           {"import", stats_.import},
+           {"convertScene", stats_.convert_scene},
+           {"triangulate", stats_.triangulate},
+           {"splitMeshes", stats_.split_meshes},
+           {"convertNodes", stats_.convert_nodes},
+           {"convertAnimation", stats_.convert_animation},
+           {"build", stats_.build},
+           {"serialize", stats_.serialize},
+       }},
+      {"counters",
+       {
+           {"polygonVertices", stats_.polygon_vertices},
+           {"uniqueVertices", stats_.unique_vertices},
+           {"keyframesBaked", stats_.keyframes_baked},
+           {"keyframesKept", stats_.keyframes_kept},
+           {"bufferBytes", stats_.buffer_bytes},
+       }},
+  };
+}
+
+ScopedPhase::ScopedPhase(ConvertStats::Phase &phase_)
+    : _phase(phase_), _wallStart(std::chrono::steady_clock::now()),
+      _cpuStart(thread_cpu_seconds()),
+      _outerPeakAllocated(AllocationTracker::reset_peak()) {
+}
+
+ScopedPhase::~ScopedPhase() {
+  _phase.wall += std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - _wallStart)
+                     .count();
+  _phase.cpu += thread_cpu_seconds() - _cpuStart;
+  const auto peakAllocated = AllocationTracker::peak();
+  _phase.peak_allocated = std::max(_phase.peak_allocated, peakAllocated);
+  _phase.peak_rss = std::max(_phase.peak_rss, peak_rss());
+  AllocationTracker::merge_peak(_outerPeakAllocated);
+}
+} // namespace bee
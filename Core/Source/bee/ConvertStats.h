@@ -0,0 +1,126 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <bee/polyfills/json.h>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Where a conversion spent its time, and how much it processed.
+/// </summary>
+struct ConvertStats {
+  /// <summary>
+  /// Time spent in a phase, in seconds, and memory used by then, in bytes.
+  /// CPU time and allocations are of the converting thread only.
+  /// </summary>
+  struct Phase {
+    double wall = 0.0;
+    double cpu = 0.0;
+
+    /// <summary>
+    /// Peak resident set size of the process by the end of the phase.
+    /// It never decreases, so the phase where it jumps is the one to look at.
+    /// </summary>
+    std::uint64_t peak_rss = 0;
+
+    /// <summary>
+    /// High-water mark, during the phase, of bytes allocated by the FBX SDK
+    /// and by the converter's vertex and buffer storage.
+    /// </summary>
+    std::int64_t peak_allocated = 0;
+  };
+
+  /// <summary>
+  /// `FbxImporter::Import()`.
+  /// </summary>
+  Phase import;
+
+  /// <summary>
+  /// Axis system and unit conversion(`FbxAxisSystem::ConvertScene()` etc.).
+  /// </summary>
+  Phase convert_scene;
+
+  /// <summary>
+  /// `FbxGeometryConverter::Triangulate()`.
+  /// </summary>
+  Phase triangulate;
+
+  /// <summary>
+  /// `split_meshes_per_material()`.
+  /// </summary>
+  Phase split_meshes;
+
+  /// <summary>
+  /// Converting nodes, including their meshes, skins and materials.
+  /// </summary>
+  Phase convert_nodes;
+
+  /// <summary>
+  /// Baking and reducing animations.
+  /// </summary>
+  Phase convert_animation;
+
+  /// <summary>
+  /// `GLTFBuilder::build()`, plus encoding or writing buffers.
+  /// </summary>
+  Phase build;
+
+  /// <summary>
+  /// Serializing the glTF document into JSON.
+  /// </summary>
+  Phase serialize;
+
+  /// <summary>
+  /// Polygon vertices of all meshes.
+  /// </summary>
+  std::uint64_t polygon_vertices = 0;
+
+  /// <summary>
+  /// Vertices emitted after merging identical polygon vertices.
+  /// </summary>
+  std::uint64_t unique_vertices = 0;
+
+  /// <summary>
+  /// Keyframes sampled at the bake rate, over all animation channels.
+  /// </summary>
+  std::uint64_t keyframes_baked = 0;
+
+  /// <summary>
+  /// Keyframes left after reducing linear keys.
+  /// </summary>
+  std::uint64_t keyframes_kept = 0;
+
+  /// <summary>
+  /// Byte length of each glTF buffer.
+  /// </summary>
+  std::vector<std::uint64_t> buffer_bytes;
+};
+
+BEE_API void to_json(nlohmann::json &j_, const ConvertStats::Phase &phase_);
+
+BEE_API void to_json(nlohmann::json &j_, const ConvertStats &stats_);
+
+/// <summary>
+/// Measures its lifetime into a phase:
+/// adds the wall and CPU time elapsed and raises the memory high-water marks.
+/// May be nested.
+/// </summary>
+class BEE_API ScopedPhase {
+public:
+  explicit ScopedPhase(ConvertStats::Phase &phase_);
+
+  ScopedPhase(const ScopedPhase &) = delete;
+
+  ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+  ~ScopedPhase();
+
+private:
+  ConvertStats::Phase &_phase;
+  std::chrono::steady_clock::time_point _wallStart;
+  double _cpuStart;
+  std::int64_t _outerPeakAllocated;
+};
+} // namespace bee
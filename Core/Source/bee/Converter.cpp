@@ -1,99 +1,225 @@
 
+#include <bee/Base64.h>
 #include <bee/Convert/SceneConverter.h>
 #include <bee/Convert/fbxsdk/ObjectDestroyer.h>
 #include <bee/Convert/fbxsdk/String.h>
 #include <bee/Converter.h>
+#include <bee/DracoCompression.h>
+#include <bee/GLTFJsonWriter.h>
+#include <bee/Memory.h>
 #include <bee/polyfills/filesystem.h>
 #include <bee/polyfills/json.h>
-#include <cppcodec/base64_default_rfc4648.hpp>
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <fbxsdk.h>
 #include <fmt/format.h>
 #include <iostream>
 #include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
 
 namespace bee {
+/// <summary>
+/// Counts the FBX SDK's allocations in `AllocationTracker`.
+/// The hooks forward to the handlers installed before them, so blocks
+/// allocated before hooking are still freed by the allocator they come from.
+/// </summary>
+class FbxAllocationHooks {
+public:
+  /// <summary>
+  /// Must be called before the FBX SDK allocates anything that's measured,
+  /// that is, before creating the first manager.
+  /// </summary>
+  static void install() {
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+      _malloc = fbxsdk::FbxGetMallocHandler();
+      _calloc = fbxsdk::FbxGetCallocHandler();
+      _realloc = fbxsdk::FbxGetReallocHandler();
+      _free = fbxsdk::FbxGetFreeHandler();
+      fbxsdk::FbxSetMallocHandler(&_mallocHook);
+      fbxsdk::FbxSetCallocHandler(&_callocHook);
+      fbxsdk::FbxSetReallocHandler(&_reallocHook);
+      fbxsdk::FbxSetFreeHandler(&_freeHook);
+    });
+  }
+
+private:
+  static inline fbxsdk::FbxMallocProc _malloc = nullptr;
+  static inline fbxsdk::FbxCallocProc _calloc = nullptr;
+  static inline fbxsdk::FbxReallocProc _realloc = nullptr;
+  static inline fbxsdk::FbxFreeProc _free = nullptr;
+
+  /// <summary>
+  /// The free handler isn't told the size, so both sides count the usable
+  /// size of the block instead of the requested one.
+  /// </summary>
+  static std::size_t _blockSize(void *block_) {
+#ifdef _WIN32
+    return ::_msize(block_);
+#elif defined(__APPLE__)
+    return ::malloc_size(block_);
+#else
+    return ::malloc_usable_size(block_);
+#endif
+  }
+
+  static void *_mallocHook(std::size_t size_) {
+    const auto block = _malloc(size_);
+    if (block) {
+      AllocationTracker::allocated(_blockSize(block));
+    }
+    return block;
+  }
+
+  static void *_callocHook(std::size_t count_, std::size_t size_) {
+    const auto block = _calloc(count_, size_);
+    if (block) {
+      AllocationTracker::allocated(_blockSize(block));
+    }
+    return block;
+  }
+
+  static void *_reallocHook(void *block_, std::size_t size_) {
+    const auto oldSize = block_ ? _blockSize(block_) : 0;
+    const auto block = _realloc(block_, size_);
+    if (block) {
+      AllocationTracker::deallocated(oldSize);
+      AllocationTracker::allocated(_blockSize(block));
+    } else if (size_ == 0) {
+      AllocationTracker::deallocated(oldSize);
+    }
+    return block;
+  }
+
+  static void _freeHook(void *block_) {
+    if (block_) {
+      AllocationTracker::deallocated(_blockSize(block_));
+    }
+    _free(block_);
+  }
+};
+
 class Converter {
 public:
-  Converter(const ConvertOptions &options_) {
+  Converter() {
+    FbxAllocationHooks::install();
     _fbxManager = fbxsdk::FbxManager::Create();
     if (!_fbxManager) {
       throw std::runtime_error("Failed to initialize FBX SDK.");
     }
-
-    if (options_.fbmDir) {
-      // TODO: use `FBXImporter::SetEmbeddingExtractionFolder`
-      std::string fbmDirCStr{options_.fbmDir->data(),
-                             options_.fbmDir->data() + options_.fbmDir->size()};
-      auto &xRefManager = _fbxManager->GetXRefManager();
-      if (!xRefManager.AddXRefProject(
-              fbxsdk::FbxXRefManager::sEmbeddedFileProject,
-              fbmDirCStr.data())) {
-        if (options_.logger) {
-          (*options_.logger)(Logger::Level::warning,
-                             u8"Failed to set .fbm dir");
-        }
-      }
-    }
+    _fbxManager->SetIOSettings(
+        fbxsdk::FbxIOSettings::Create(_fbxManager, IOSROOT));
   }
 
+  Converter(const Converter &) = delete;
+
+  Converter &operator=(const Converter &) = delete;
+
   ~Converter() {
     _fbxManager->Destroy();
   }
 
   GLTFBuilder _convert(std::u8string_view file_,
-                       const ConvertOptions &options_) {
+                       const ConvertOptions &options_,
+                       glTF_output *output_ = nullptr) {
+    if (options_.dracoCompression.enabled && !is_draco_available()) {
+      throw std::invalid_argument(
+          "KHR_draco_mesh_compression needs a build with BEE_WITH_DRACO.");
+    }
+
     GLTFBuilder glTFBuilder;
 
-    auto fbxScene = _import(file_, options_, glTFBuilder);
+    EmbeddedFileProjectScope embeddedFileProjectScope{*_fbxManager, options_};
+    ConvertStats::Phase importPhase;
+    fbxsdk::FbxScene *fbxScene = nullptr;
+    {
+      ScopedPhase phase{importPhase};
+      fbxScene = _import(file_, options_, glTFBuilder);
+    }
     FbxObjectDestroyer fbxSceneDestroyer{fbxScene};
     SceneConverter sceneConverter{*_fbxManager, *fbxScene, options_, file_,
                                   glTFBuilder};
     sceneConverter.convert();
+    if (output_) {
+      output_->referenced_files = sceneConverter.referencedFiles();
+      output_->unresolved_files = sceneConverter.unresolvedFiles();
+      output_->copied_files = sceneConverter.copiedFiles();
+      output_->stats = sceneConverter.stats();
+      output_->stats.import = importPhase;
+    }
     return glTFBuilder;
   }
 
   glTF_output BEE_API convert(std::u8string_view file_,
                               const ConvertOptions &options_) {
 
-    auto glTFBuilder = _convert(file_, options_);
+    glTF_output output;
+    auto glTFBuilder = _convert(file_, options_, &output);
+    std::optional<ScopedPhase> buildPhase{output.stats.build};
     GLTFBuilder::BuildOptions buildOptions;
     buildOptions.generator = "FBX-glTF-conv";
     buildOptions.copyright =
         "Copyright (c) 2018-2020 Chukong Technologies Inc.";
+    buildOptions.maxBufferSize = options_.bufferPartition.max_buffer_size;
+    if (options_.meshoptCompression.enabled) {
+      auto &meshoptCompression = buildOptions.meshoptCompression.emplace();
+      meshoptCompression.fallback = options_.meshoptCompression.fallback;
+      meshoptCompression.threads =
+          options_.mesh_threads != 0
+              ? options_.mesh_threads
+              : std::max(1u, std::thread::hardware_concurrency());
+    }
     auto glTFBuildResult = glTFBuilder.build(buildOptions);
     auto &glTFDocument = glTFBuilder.document();
 
-    GLTFWriter defaultWriter;
-    auto glTFWriter = options_.writer ? options_.writer : &defaultWriter;
+    for (const auto &buffer : glTFBuildResult.buffers) {
+      output.stats.buffer_bytes.push_back(buffer.size());
+    }
 
-    std::optional<std::vector<std::byte>> glbStoredBuffer;
+    std::optional<SegmentedBuffer> glbStoredBuffer;
     {
       const auto nBuffers =
           static_cast<std::uint32_t>(glTFDocument.buffers.size());
       for (std::remove_const_t<decltype(nBuffers)> iBuffer = 0;
            iBuffer < nBuffers; ++iBuffer) {
         auto &glTFBuffer = glTFDocument.buffers[iBuffer];
-        const auto &bufferData = glTFBuildResult.buffers[iBuffer];
+        auto &bufferSegments = glTFBuildResult.buffers[iBuffer];
         if (options_.glb && iBuffer == 0) {
-          glbStoredBuffer.emplace(bufferData);
+          // Written segment by segment along with the JSON.
+          glbStoredBuffer = std::move(bufferSegments);
+          continue;
+        }
+        if (bufferSegments.size() != glTFBuffer.byteLength) {
+          // A fallback buffer without data.
           continue;
         }
         std::optional<std::string> uri;
-        if (!options_.useDataUriForBuffers) {
-          auto u8Uri = glTFWriter->buffer(bufferData.data(), bufferData.size(),
-                                          iBuffer, nBuffers != 1);
+        if (!options_.useDataUriForBuffers && options_.writer) {
+          auto u8Uri =
+              options_.writer->buffer(bufferSegments, iBuffer, nBuffers != 1);
           if (u8Uri) {
             uri = std::string{u8Uri->begin(), u8Uri->end()};
           }
         }
         if (!uri) {
-          auto base64Data = cppcodec::base64_rfc4648::encode(
-              reinterpret_cast<const char *>(bufferData.data()),
-              bufferData.size());
-          uri = "data:application/octet-stream;base64," + base64Data;
+          uri = "data:application/octet-stream;base64,";
+          base64_append(*uri, bufferSegments);
         }
-        glTFBuffer.uri = *uri;
+        glTFBuffer.uri = std::move(*uri);
+        // Written already.
+        bufferSegments = {};
       }
     }
 
@@ -104,21 +230,103 @@ public:
       }
     }
 
-    nlohmann::json glTFJson;
-    fx::gltf::to_json(glTFJson, glTFDocument);
+    buildPhase.reset();
 
-    return {glTFJson, glbStoredBuffer};
+    {
+      ScopedPhase phase{output.stats.serialize};
+      output.json_text =
+          to_gltf_json(glTFDocument, options_.glb || options_.compact_json);
+    }
+
+    output.glb_stored_buffer = std::move(glbStoredBuffer);
+    return output;
   }
 
 private:
+  /// <summary>
+  /// The manager outlives conversions so the `.fbm` dir is registered per conversion.
+  /// </summary>
+  class EmbeddedFileProjectScope {
+  public:
+    EmbeddedFileProjectScope(fbxsdk::FbxManager &manager_,
+                             const ConvertOptions &options_)
+        : _manager(manager_) {
+      if (!options_.fbmDir) {
+        return;
+      }
+      // TODO: use `FBXImporter::SetEmbeddingExtractionFolder`
+      std::string fbmDirCStr{options_.fbmDir->data(),
+                             options_.fbmDir->data() + options_.fbmDir->size()};
+      auto &xRefManager = _manager.GetXRefManager();
+      if (xRefManager.AddXRefProject(
+              fbxsdk::FbxXRefManager::sEmbeddedFileProject,
+              fbmDirCStr.data())) {
+        _added = true;
+      } else if (options_.logger) {
+        (*options_.logger)(Logger::Level::warning, u8"Failed to set .fbm dir");
+      }
+    }
+
+    EmbeddedFileProjectScope(const EmbeddedFileProjectScope &) = delete;
+
+    ~EmbeddedFileProjectScope() {
+      if (_added) {
+        _manager.GetXRefManager().RemoveXRefProject(
+            fbxsdk::FbxXRefManager::sEmbeddedFileProject);
+      }
+    }
+
+  private:
+    fbxsdk::FbxManager &_manager;
+    bool _added = false;
+  };
+
+  /// <summary>
+  /// Which parts of the FBX file the requested outputs need to be imported.
+  /// The others are skipped, saving import time and memory.
+  /// Every import sets all of them since the IO settings, like the manager,
+  /// are shared by successive conversions.
+  /// </summary>
+  struct ImportProfile {
+    bool animation = true;
+
+    /// <summary>
+    /// Blend shapes.
+    /// </summary>
+    bool shapes = true;
+
+    /// <summary>
+    /// Skin deformers and their clusters.
+    /// </summary>
+    bool links = true;
+
+    /// <summary>
+    /// Whether to extract embedded media, such as textures, into files.
+    /// </summary>
+    bool embeddedMedia = true;
+
+    static ImportProfile from(const ConvertOptions &options_) {
+      ImportProfile profile;
+      profile.shapes = options_.export_blend_shape;
+      profile.links = options_.export_skin;
+      // Weights animations target blend shapes.
+      profile.animation = options_.export_trs_animation ||
+                          (options_.export_blend_shape &&
+                           options_.export_blend_shape_animation);
+      // Only the file name is output in `PathMode::strip`, which is the same
+      // whether or not the media is extracted.
+      profile.embeddedMedia =
+          options_.fbmDir.has_value() ||
+          options_.pathMode != ConvertOptions::PathMode::strip;
+      return profile;
+    }
+  };
+
   fbxsdk::FbxManager *_fbxManager = nullptr;
 
   FbxScene *_import(std::u8string_view file_,
                     const ConvertOptions &options_,
                     GLTFBuilder &glTFBuilder_) {
-    auto ioSettings = fbxsdk::FbxIOSettings::Create(_fbxManager, IOSROOT);
-    _fbxManager->SetIOSettings(ioSettings);
-
     auto fbxImporter = fbxsdk::FbxImporter::Create(_fbxManager, "");
     FbxObjectDestroyer fbxImporterDestroyer{fbxImporter};
 
@@ -132,6 +340,16 @@ private:
     }
 
     if (fbxImporter->IsFBX()) {
+      const auto importProfile = ImportProfile::from(options_);
+      if (options_.verbose && options_.logger) {
+        (*options_.logger)(
+            Logger::Level::verbose,
+            fmt::format("Import profile: animation {}, shapes {}, skins {}, "
+                        "embedded media {}",
+                        importProfile.animation, importProfile.shapes,
+                        importProfile.links, importProfile.embeddedMedia));
+      }
+
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_MODEL_COUNT, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_DEVICE_COUNT, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_CHARACTER_COUNT,
@@ -145,25 +363,29 @@ private:
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_PIVOT, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_GLOBAL_SETTINGS,
       // true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_CHARACTER, true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_CONSTRAINT, true);
+      // Characters, constraints, gobos and audio are never converted.
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_CHARACTER, false);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_CONSTRAINT, false);
       // fbxImporter->GetIOSettings()->SetBoolProp(
       //    IMP_FBX_MERGE_LAYER_AND_TIMEWARP, true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_GOBO, true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_SHAPE, true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_LINK, true);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_GOBO, false);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_SHAPE,
+                                                importProfile.shapes);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_LINK,
+                                                importProfile.links);
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_MATERIAL, true);
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_TEXTURE, true);
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_MODEL, true);
-      // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_AUDIO, true);
-      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_ANIMATION, true);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_AUDIO, false);
+      fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_ANIMATION,
+                                                importProfile.animation);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_PASSWORD, true);
       // fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_PASSWORD_ENABLE,
       // true);
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_CURRENT_TAKE_NAME,
                                                 true);
       fbxImporter->GetIOSettings()->SetBoolProp(IMP_FBX_EXTRACT_EMBEDDED_DATA,
-                                                true);
+                                                importProfile.embeddedMedia);
     }
 
     if (options_.export_fbx_file_header_info) {
@@ -229,10 +451,157 @@ private:
 
 glTF_output BEE_API convert(std::u8string_view file_,
                             const ConvertOptions &options_) {
-  Converter converter(options_);
+  Converter converter;
   return converter.convert(file_, options_);
 }
 
+class BatchConverter::Impl {
+public:
+  Impl(std::uint32_t threads_) {
+    if (threads_ == 0) {
+      threads_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Jobs run side by side, so they share the hardware threads rather than
+    // each taking them all.
+    if (threads_ > 1) {
+      _meshThreads =
+          std::max(1u, std::thread::hardware_concurrency() / threads_);
+    }
+    _workers.reserve(threads_);
+    for (std::uint32_t iThread = 0; iThread < threads_; ++iThread) {
+      _workers.emplace_back([this]() { _work(); });
+    }
+  }
+
+  ~Impl() {
+    {
+      std::unique_lock lock{_mutex};
+      _stopping = true;
+    }
+    _jobAvailable.notify_all();
+    for (auto &worker : _workers) {
+      worker.join();
+    }
+  }
+
+  std::uint32_t threads() const {
+    return static_cast<std::uint32_t>(_workers.size());
+  }
+
+  void post(Preparer prepare_, Callback callback_) {
+    {
+      std::unique_lock lock{_mutex};
+      _jobs.emplace_back(Job{std::move(prepare_), std::move(callback_)});
+      ++_unfinished;
+    }
+    _jobAvailable.notify_one();
+  }
+
+  void wait() {
+    std::unique_lock lock{_mutex};
+    _allFinished.wait(lock, [this]() { return _unfinished == 0; });
+  }
+
+private:
+  struct Job {
+    Preparer prepare;
+    Callback callback;
+  };
+
+  /// <summary>
+  /// Mesh threads of jobs asking for the hardware threads, 0 if they're all
+  /// theirs.
+  /// </summary>
+  std::uint32_t _meshThreads = 0;
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _jobAvailable;
+  std::condition_variable _allFinished;
+  std::deque<Job> _jobs;
+  std::size_t _unfinished = 0;
+  bool _stopping = false;
+
+  void _work() {
+    // Created lazily, on the worker thread itself, and kept across jobs.
+    std::optional<Converter> converter;
+
+    while (true) {
+      std::optional<Job> job;
+      {
+        std::unique_lock lock{_mutex};
+        _jobAvailable.wait(lock,
+                           [this]() { return _stopping || !_jobs.empty(); });
+        if (_jobs.empty()) {
+          return;
+        }
+        job.emplace(std::move(_jobs.front()));
+        _jobs.pop_front();
+      }
+
+      std::optional<glTF_output> output;
+      std::exception_ptr error;
+      try {
+        ConvertOptions options;
+        if (const auto file = job->prepare(options)) {
+          if (options.mesh_threads == 0) {
+            options.mesh_threads = _meshThreads;
+          }
+          if (!converter) {
+            converter.emplace();
+          }
+          output = converter->convert(*file, options);
+        }
+      } catch (...) {
+        error = std::current_exception();
+      }
+
+      if (job->callback && (output || error)) {
+        job->callback(std::move(output), error);
+      }
+
+      {
+        std::unique_lock lock{_mutex};
+        --_unfinished;
+        if (_unfinished == 0) {
+          _allFinished.notify_all();
+        }
+      }
+    }
+  }
+};
+
+BatchConverter::BatchConverter(std::uint32_t threads_)
+    : _impl(std::make_unique<Impl>(threads_)) {
+}
+
+BatchConverter::~BatchConverter() {
+  _impl->wait();
+}
+
+std::uint32_t BatchConverter::threads() const {
+  return _impl->threads();
+}
+
+void BatchConverter::post(std::u8string_view file_,
+                          const ConvertOptions &options_,
+                          Callback callback_) {
+  _impl->post(
+      [file = std::u8string{file_}, options = options_](
+          ConvertOptions &prepared_) -> std::optional<std::u8string> {
+        prepared_ = options;
+        return file;
+      },
+      std::move(callback_));
+}
+
+void BatchConverter::post(Preparer prepare_, Callback callback_) {
+  _impl->post(std::move(prepare_), std::move(callback_));
+}
+
+void BatchConverter::wait() {
+  _impl->wait();
+}
+
 /// <summary>
 /// Expose for testing only.
 /// </summary>
@@ -241,7 +610,7 @@ glTF_output BEE_API convert(std::u8string_view file_,
 /// <returns></returns>
 GLTFBuilder BEE_API _convert_test(std::u8string_view file_,
                                   const ConvertOptions &options_) {
-  Converter converter(options_);
+  Converter converter;
   return converter._convert(file_, options_);
 }
 } // namespace bee
@@ -2,7 +2,13 @@
 #pragma once
 
 #include <bee/BEE_API.h>
+#include <bee/ConvertStats.h>
+#include <bee/SegmentedBuffer.h>
 #include <bee/polyfills/json.h>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -17,6 +23,18 @@ public:
                                               bool multi_) {
     return {};
   }
+
+  /// <summary>
+  /// Writes a buffer given as the segments it's made of, which may be passed
+  /// to a gather write as they are.
+  /// By default, joins them and calls the overload above.
+  /// </summary>
+  virtual std::optional<std::u8string> buffer(const SegmentedBuffer &buffer_,
+                                              std::uint32_t index_,
+                                              bool multi_) {
+    const auto data = buffer_.join();
+    return buffer(data.data(), data.size(), index_, multi_);
+  }
 };
 
 using Json = nlohmann::json;
@@ -62,8 +80,43 @@ struct ConvertOptions {
 
   bool glb = false;
 
+  /// <summary>
+  /// Whether to write the glTF JSON without whitespace.
+  /// It's always so in GLB.
+  /// </summary>
+  bool compact_json = false;
+
   bool useDataUriForBuffers = true;
 
+  /// <summary>
+  /// How buffer views are partitioned into buffers, so that a runtime may
+  /// fetch, and release, geometry, animation clips and images on their own.
+  /// By default, everything goes into one buffer.
+  /// </summary>
+  struct BufferPartition {
+    /// <summary>
+    /// Each mesh's vertices, indices and skin go into a buffer of their own.
+    /// </summary>
+    bool per_mesh = false;
+
+    /// <summary>
+    /// Each animation's keyframes go into a buffer of their own.
+    /// </summary>
+    bool per_animation = false;
+
+    /// <summary>
+    /// Each embedded image goes into a buffer of its own.
+    /// </summary>
+    bool per_image = false;
+
+    /// <summary>
+    /// Buffers are split, between buffer views, so as not to exceed this many
+    /// bytes. A buffer view larger than that gets a buffer of its own.
+    /// 0 means 2GB. Buffer views larger than 4GB fail the conversion.
+    /// </summary>
+    std::uint32_t max_buffer_size = 0;
+  } bufferPartition;
+
   UnitConversion unitConversion = UnitConversion::geometryLevel;
 
   bool noFlipV = false;
@@ -139,6 +192,189 @@ struct ConvertOptions {
 
   bool export_blend_shape_animation = true;
 
+  /// <summary>
+  /// Morph target attributes moving few vertices are written as sparse
+  /// accessors, which list the moved vertices only.
+  /// </summary>
+  struct SparseMorphTargets {
+    /// <summary>
+    /// Deltas whose components are all within this are taken as zero.
+    /// </summary>
+    float epsilon = 0;
+
+    /// <summary>
+    /// An attribute is written sparse if that takes less than this fraction
+    /// of the bytes of the dense form. 0 disables sparse accessors.
+    /// </summary>
+    float max_size_ratio = 1;
+  } sparseMorphTargets;
+
+  /// <summary>
+  /// Reordering of the triangles and vertices of each primitive, once
+  /// deduplicated, for the GPU to draw them faster. All off by default.
+  /// </summary>
+  struct MeshOptimization {
+    /// <summary>
+    /// Orders triangles so that the post-transform vertex cache hits.
+    /// </summary>
+    bool vertex_cache = false;
+
+    /// <summary>
+    /// If not 0, orders clusters of triangles so that the outer ones are
+    /// drawn first, as long as cache misses stay within this ratio of those
+    /// before, such as 1.05.
+    /// </summary>
+    float overdraw_threshold = 0;
+
+    /// <summary>
+    /// Orders vertices as triangles first use them.
+    /// </summary>
+    bool vertex_fetch = false;
+  } meshOptimization;
+
+  /// <summary>
+  /// Simplified versions of each mesh, coarser from one level to the next,
+  /// written as nodes the `MSFT_lod` extension lists on the node of the mesh.
+  /// </summary>
+  struct LevelsOfDetail {
+    struct Level {
+      /// <summary>
+      /// The fraction of the triangles of the full mesh to simplify down to.
+      /// 0 means as far as the error allows.
+      /// </summary>
+      float ratio = 0.5f;
+
+      /// <summary>
+      /// The most the surface may move, relative to the extent of the mesh.
+      /// </summary>
+      float max_error = 0.01f;
+    };
+
+    /// <summary>
+    /// None by default.
+    /// </summary>
+    std::vector<Level> levels;
+
+    /// <summary>
+    /// The error, relative to the height of the screen, at which a level
+    /// gives way to the next. Each level's `MSFT_screencoverage` follows.
+    /// </summary>
+    float screen_error = 0.001f;
+  } levelsOfDetail;
+
+  /// <summary>
+  /// Vertex attributes stored as normalized integers rather than floats, as
+  /// `KHR_mesh_quantization` allows. Each is the number of bits kept: up to 8
+  /// are stored in bytes, up to 16 in shorts. 0, the default, keeps floats.
+  /// </summary>
+  struct MeshQuantization {
+    /// <summary>
+    /// Positions and morph target position deltas. They're quantized within
+    /// the bounds of their mesh, which a child of its node scales back, or
+    /// the inverse bind matrices if skinned.
+    /// </summary>
+    std::uint32_t position_bits = 0;
+
+    std::uint32_t normal_bits = 0;
+
+    /// <summary>
+    /// UV sets reaching out of [0, 1] in a primitive stay float there.
+    /// </summary>
+    std::uint32_t uv_bits = 0;
+
+    std::uint32_t color_bits = 0;
+  } meshQuantization;
+
+  /// <summary>
+  /// Buffer views compressed as `EXT_meshopt_compression` allows.
+  /// </summary>
+  struct MeshoptCompression {
+    /// <summary>
+    /// Compresses vertex, index and animation buffer views. Vertex attributes
+    /// then get a buffer view each, which compresses better.
+    /// </summary>
+    bool enabled = false;
+
+    /// <summary>
+    /// Keeps the uncompressed buffer views in fallback buffers, for readers
+    /// not supporting the extension, which is then not required.
+    /// </summary>
+    bool fallback = false;
+
+    /// <summary>
+    /// Stores normals octahedral. Only quantized normals are.
+    /// </summary>
+    bool octahedral_normals = false;
+
+    /// <summary>
+    /// If not 0, rotation keys are stored as normalized shorts, of which the
+    /// quaternion filter keeps these many bits, up to 16.
+    /// </summary>
+    std::uint32_t quaternion_bits = 0;
+
+    /// <summary>
+    /// If not 0, float positions, morph target position deltas, and
+    /// translation and scale keys keep these many mantissa bits, up to 24,
+    /// with the exponential filter.
+    /// </summary>
+    std::uint32_t exponential_bits = 0;
+  } meshoptCompression;
+
+  /// <summary>
+  /// Primitives compressed as `KHR_draco_mesh_compression` allows. Needs a
+  /// build with `BEE_WITH_DRACO`; converting fails otherwise.
+  /// </summary>
+  struct DracoCompression {
+    /// <summary>
+    /// Compresses the indices and attributes of each primitive. Morph
+    /// targets, which the extension doesn't cover, are kept as they are, and
+    /// the vertices are then kept in order for them to match.
+    /// </summary>
+    bool enabled = false;
+
+    /// <summary>
+    /// Keeps the uncompressed attributes and indices too, for readers not
+    /// supporting the extension, which is then not required. Primitives
+    /// having levels of detail always keep them, for the levels to use.
+    /// </summary>
+    bool fallback = false;
+
+    /// <summary>
+    /// Bits float attributes are quantized to. 0 keeps them lossless.
+    /// Generic ones are the others, such as skin weights.
+    /// </summary>
+    std::uint32_t position_bits = 11;
+
+    std::uint32_t normal_bits = 8;
+
+    std::uint32_t uv_bits = 10;
+
+    std::uint32_t color_bits = 8;
+
+    std::uint32_t generic_bits = 8;
+
+    /// <summary>
+    /// From 0, the smallest, to 10, the fastest to encode and decode.
+    /// </summary>
+    int speed = 3;
+  } dracoCompression;
+
+  /// <summary>
+  /// Collapses leaf nodes instancing the same meshes under the same parent,
+  /// see `preserve_mesh_instances`, into one node drawing them all with the
+  /// `EXT_mesh_gpu_instancing` glTF extension, which is then required. Nodes
+  /// animated, skinned, morphed, used as joints or having geometric
+  /// transforms are kept as they are.
+  /// </summary>
+  struct GpuInstancing {
+    bool enabled = false;
+
+    /// <summary>
+    /// The fewest nodes worth collapsing.
+    /// </summary>
+    std::uint32_t min_instances = 2;
+  } gpuInstancing;
+
   Logger *logger = nullptr;
 
   bool verbose = false;
@@ -146,15 +382,118 @@ struct ConvertOptions {
   bool export_fbx_file_header_info = false;
 
   bool export_raw_materials = false;
+
+  /// <summary>
+  /// Threads assembling, simplifying and compressing mesh primitives, and
+  /// compressing buffer views, the converting one included. 0 means the number of hardware threads.
+  /// The output is the same whatever the number.
+  /// </summary>
+  std::uint32_t mesh_threads = 0;
 };
 
 struct glTF_output {
-  Json json;
+  /// <summary>
+  /// The glTF JSON, serialized as the document is walked.
+  /// </summary>
+  std::string json_text;
+
+  /// <summary>
+  /// The GLB's BIN chunk, if `ConvertOptions::glb`.
+  /// It's left in segments, see `write_glb()`.
+  /// </summary>
+  std::optional<SegmentedBuffer> glb_stored_buffer;
+
+  /// <summary>
+  /// Files, other than the input file, the output depends on.
+  /// These are the resolved texture images.
+  /// </summary>
+  std::vector<std::u8string> referenced_files;
+
+  /// <summary>
+  /// Paths texture images were looked for at but not found, which the output
+  /// would reference instead, were they added.
+  /// </summary>
+  std::vector<std::u8string> unresolved_files;
+
+  /// <summary>
+  /// Files written beside the output, other than buffers passed to
+  /// `GLTFWriter`. These are the images copied in `PathMode::copy`.
+  /// </summary>
+  std::vector<std::u8string> copied_files;
 
-  std::optional<std::vector<std::byte>> glb_stored_buffer;
+  ConvertStats stats;
 };
 
 glTF_output BEE_API convert(std::u8string_view file_,
                             const ConvertOptions &options_);
 
-} // namespace bee
\ No newline at end of file
+/// <summary>
+/// Converts many files on a fixed pool of worker threads.
+/// Each worker owns a long-lived FBX manager which is created on first use
+/// and reused by every job that worker picks up afterwards,
+/// so the FBX SDK start-up cost is paid once per thread rather than once per file.
+/// </summary>
+class BEE_API BatchConverter {
+public:
+  /// <summary>
+  /// Invoked on the worker thread once a job finished.
+  /// Exactly one of `output_` and `error_` is set.
+  /// </summary>
+  using Callback = std::function<void(std::optional<glTF_output> &&output_,
+                                      std::exception_ptr error_)>;
+
+  /// <summary>
+  /// Invoked on the worker thread right before a job is converted, so that
+  /// whatever is slow to prepare doesn't hold up posting.
+  /// Returns the file to convert and sets `options_`, or returns nothing if
+  /// there's nothing to convert, in which case the callback isn't invoked.
+  /// What it throws is passed to the callback.
+  /// </summary>
+  using Preparer =
+      std::function<std::optional<std::u8string>(ConvertOptions &options_)>;
+
+  /// <param name="threads_">
+  /// Number of worker threads. 0 means the number of hardware threads.
+  /// </param>
+  explicit BatchConverter(std::uint32_t threads_ = 0);
+
+  BatchConverter(const BatchConverter &) = delete;
+
+  BatchConverter &operator=(const BatchConverter &) = delete;
+
+  /// <summary>
+  /// Waits for all posted jobs then stops the workers.
+  /// </summary>
+  ~BatchConverter();
+
+  std::uint32_t threads() const;
+
+  /// <summary>
+  /// Queues a conversion job.
+  /// The options are copied, but what they point to(writer, logger, fbm dir)
+  /// must outlive the job and must not be shared with other in-flight jobs
+  /// unless it's thread safe.
+  /// With several workers, a `mesh_threads` of 0 means the hardware threads
+  /// divided among the workers.
+  /// </summary>
+  void post(std::u8string_view file_,
+            const ConvertOptions &options_,
+            Callback callback_);
+
+  /// <summary>
+  /// Queues a job prepared by `prepare_` once a worker picks it up.
+  /// What the options point to is as `post()` of a file requires.
+  /// </summary>
+  void post(Preparer prepare_, Callback callback_);
+
+  /// <summary>
+  /// Blocks until every posted job has finished.
+  /// </summary>
+  void wait();
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> _impl;
+};
+
+} // namespace bee
\ No newline at end of file
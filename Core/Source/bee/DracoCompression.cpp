@@ -0,0 +1,129 @@
+#include <bee/DracoCompression.h>
+#include <stdexcept>
+
+#ifdef BEE_WITH_DRACO
+#include <draco/compression/encode.h>
+#include <draco/mesh/mesh.h>
+#endif
+
+namespace bee {
+#ifdef BEE_WITH_DRACO
+namespace {
+draco::DataType
+toDracoDataType(fx::gltf::Accessor::ComponentType component_type_) {
+  switch (component_type_) {
+  case fx::gltf::Accessor::ComponentType::Byte:
+    return draco::DT_INT8;
+  case fx::gltf::Accessor::ComponentType::UnsignedByte:
+    return draco::DT_UINT8;
+  case fx::gltf::Accessor::ComponentType::Short:
+    return draco::DT_INT16;
+  case fx::gltf::Accessor::ComponentType::UnsignedShort:
+    return draco::DT_UINT16;
+  case fx::gltf::Accessor::ComponentType::UnsignedInt:
+    return draco::DT_UINT32;
+  case fx::gltf::Accessor::ComponentType::Float:
+    return draco::DT_FLOAT32;
+  default:
+    throw std::invalid_argument("Not a vertex attribute component type.");
+  }
+}
+
+draco::GeometryAttribute::Type toDracoAttributeType(const std::string &name_) {
+  if (name_ == "POSITION") {
+    return draco::GeometryAttribute::POSITION;
+  } else if (name_ == "NORMAL") {
+    return draco::GeometryAttribute::NORMAL;
+  } else if (name_.starts_with("TEXCOORD_")) {
+    return draco::GeometryAttribute::TEX_COORD;
+  } else if (name_.starts_with("COLOR_")) {
+    return draco::GeometryAttribute::COLOR;
+  } else {
+    return draco::GeometryAttribute::GENERIC;
+  }
+}
+} // namespace
+
+bool is_draco_available() {
+  return true;
+}
+
+DracoMesh encode_draco(std::span<const DracoAttribute> attributes_,
+                       std::uint32_t vertex_count_,
+                       std::span<const std::uint32_t> indices_,
+                       const DracoEncoding &encoding_) {
+  draco::Mesh mesh;
+  mesh.set_num_points(vertex_count_);
+  const auto nFaces = indices_.size() / 3;
+  mesh.SetNumFaces(nFaces);
+  for (std::size_t iFace = 0; iFace < nFaces; ++iFace) {
+    mesh.SetFace(draco::FaceIndex(static_cast<std::uint32_t>(iFace)),
+                 {draco::PointIndex(indices_[3 * iFace]),
+                  draco::PointIndex(indices_[3 * iFace + 1]),
+                  draco::PointIndex(indices_[3 * iFace + 2])});
+  }
+
+  DracoMesh result;
+  for (const auto &attribute : attributes_) {
+    const auto dataType = toDracoDataType(attribute.componentType);
+    draco::GeometryAttribute geometryAttribute;
+    geometryAttribute.Init(
+        toDracoAttributeType(attribute.name), nullptr,
+        static_cast<std::uint8_t>(attribute.components), dataType,
+        attribute.normalized,
+        draco::DataTypeLength(dataType) * attribute.components, 0);
+    const auto attributeId =
+        mesh.AddAttribute(geometryAttribute, true, vertex_count_);
+    auto pointAttribute = mesh.attribute(attributeId);
+    for (std::uint32_t iVertex = 0; iVertex < vertex_count_; ++iVertex) {
+      pointAttribute->SetAttributeValue(
+          draco::AttributeValueIndex(iVertex),
+          attribute.data + std::size_t{attribute.byteStride} * iVertex);
+    }
+    result.attributeIds.push_back(pointAttribute->unique_id());
+  }
+
+  draco::Encoder encoder;
+  encoder.SetSpeedOptions(encoding_.speed, encoding_.speed);
+  encoder.SetEncodingMethod(encoding_.preserveOrder
+                                ? draco::MESH_SEQUENTIAL_ENCODING
+                                : draco::MESH_EDGEBREAKER_ENCODING);
+  // Quantization applies to float attributes; 0 keeps them lossless.
+  const auto setQuantization = [&encoder](draco::GeometryAttribute::Type type_,
+                                          std::uint32_t bits_) {
+    if (bits_ != 0) {
+      encoder.SetAttributeQuantization(type_, static_cast<int>(bits_));
+    }
+  };
+  setQuantization(draco::GeometryAttribute::POSITION, encoding_.positionBits);
+  setQuantization(draco::GeometryAttribute::NORMAL, encoding_.normalBits);
+  setQuantization(draco::GeometryAttribute::TEX_COORD, encoding_.uvBits);
+  setQuantization(draco::GeometryAttribute::COLOR, encoding_.colorBits);
+  setQuantization(draco::GeometryAttribute::GENERIC, encoding_.genericBits);
+
+  draco::EncoderBuffer buffer;
+  if (const auto status = encoder.EncodeMeshToBuffer(mesh, &buffer);
+      !status.ok()) {
+    throw std::runtime_error("Draco failed to encode: " +
+                             status.error_msg_string());
+  }
+  const auto data = reinterpret_cast<const std::byte *>(buffer.data());
+  result.data.assign(data, data + buffer.size());
+  result.vertexCount = static_cast<std::uint32_t>(encoder.num_encoded_points());
+  result.indexCount =
+      static_cast<std::uint32_t>(encoder.num_encoded_faces() * 3);
+  return result;
+}
+#else
+bool is_draco_available() {
+  return false;
+}
+
+DracoMesh encode_draco(std::span<const DracoAttribute>,
+                       std::uint32_t,
+                       std::span<const std::uint32_t>,
+                       const DracoEncoding &) {
+  throw std::runtime_error("Built without Draco, see BEE_WITH_DRACO.");
+}
+#endif
+} // namespace bee
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fx/gltf.h>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Whether the Draco encoder is built in, see `BEE_WITH_DRACO`.
+/// </summary>
+bool is_draco_available();
+
+/// <summary>
+/// A vertex attribute of a primitive to compress.
+/// </summary>
+struct DracoAttribute {
+  /// <summary>
+  /// The glTF attribute semantic, such as `POSITION` or `JOINTS_0`.
+  /// </summary>
+  std::string name;
+
+  const std::byte *data = nullptr;
+
+  std::uint32_t byteStride = 0;
+
+  fx::gltf::Accessor::ComponentType componentType =
+      fx::gltf::Accessor::ComponentType::Float;
+
+  std::uint32_t components = 0;
+
+  bool normalized = false;
+};
+
+/// <summary>
+/// How float attributes are quantized, and how hard to compress.
+/// </summary>
+struct DracoEncoding {
+  std::uint32_t positionBits = 11;
+
+  std::uint32_t normalBits = 8;
+
+  std::uint32_t uvBits = 10;
+
+  std::uint32_t colorBits = 8;
+
+  /// <summary>
+  /// Bits of other float attributes, such as skin weights.
+  /// </summary>
+  std::uint32_t genericBits = 8;
+
+  /// <summary>
+  /// From 0, the smallest, to 10, the fastest to encode and decode.
+  /// </summary>
+  int speed = 3;
+
+  /// <summary>
+  /// Keeps the vertices in order, rather than reordering them along the
+  /// triangles, which compresses better, so that data stored beside the
+  /// compressed one, such as morph targets, still matches the decoded one.
+  /// </summary>
+  bool preserveOrder = false;
+};
+
+struct DracoMesh {
+  std::vector<std::byte> data;
+
+  /// <summary>
+  /// The id of each attribute in the compressed data, in the order given.
+  /// </summary>
+  std::vector<std::uint32_t> attributeIds;
+
+  /// <summary>
+  /// Vertices and indices the compressed data decodes to.
+  /// </summary>
+  std::uint32_t vertexCount = 0;
+
+  std::uint32_t indexCount = 0;
+};
+
+/// <summary>
+/// Compresses a triangle list primitive as the `KHR_draco_mesh_compression`
+/// glTF extension stores it.
+/// </summary>
+/// <exception cref="std::runtime_error">
+/// Not `is_draco_available()`, or the encoder failed.
+/// </exception>
+DracoMesh encode_draco(std::span<const DracoAttribute> attributes_,
+                       std::uint32_t vertex_count_,
+                       std::span<const std::uint32_t> indices_,
+                       const DracoEncoding &encoding_);
+} // namespace bee
@@ -0,0 +1,88 @@
+#include <bee/GLBWriter.h>
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace bee {
+namespace {
+// https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html#binary-gltf-layout
+constexpr std::uint32_t glbMagic = 0x46546C67u;
+constexpr std::uint32_t glbVersion = 2u;
+constexpr std::uint32_t jsonChunkType = 0x4E4F534Au;
+constexpr std::uint32_t binChunkType = 0x004E4942u;
+constexpr std::uint64_t headerSize = 4 + 4 + 4;
+constexpr std::uint64_t chunkHeaderSize = 4 + 4;
+
+std::uint64_t align4(std::uint64_t size_) {
+  return (size_ + 3) / 4 * 4;
+}
+
+/// <summary>
+/// Stores `value_` at `out_`, little endian as GLB is.
+/// </summary>
+void store_u32(std::byte *out_, std::uint32_t value_) {
+  for (int i = 0; i < 4; ++i) {
+    out_[i] = static_cast<std::byte>((value_ >> (8 * i)) & 0xFF);
+  }
+}
+
+constexpr std::array<std::byte, 3> jsonPadding{
+    std::byte{0x20}, std::byte{0x20}, std::byte{0x20}};
+
+constexpr std::array<std::byte, 3> binPadding{};
+} // namespace
+
+std::uint64_t glb_size(std::string_view json_text_,
+                       const SegmentedBuffer *bin_) {
+  auto size = headerSize + chunkHeaderSize + align4(json_text_.size());
+  if (bin_) {
+    size += chunkHeaderSize + align4(bin_->size());
+  }
+  return size;
+}
+
+void write_glb(OutputFile &file_,
+               std::string_view json_text_,
+               const SegmentedBuffer *bin_) {
+  const auto size = glb_size(json_text_, bin_);
+  if (size > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::runtime_error("The GLB exceeds 4GB.");
+  }
+
+  std::vector<std::span<const std::byte>> segments;
+  segments.reserve(6 + (bin_ ? bin_->segments().size() : 0));
+
+  const auto jsonChunkSize = align4(json_text_.size());
+  std::array<std::byte, headerSize + chunkHeaderSize> header;
+  store_u32(header.data(), glbMagic);
+  store_u32(header.data() + 4, glbVersion);
+  store_u32(header.data() + 8, static_cast<std::uint32_t>(size));
+  store_u32(header.data() + 12, static_cast<std::uint32_t>(jsonChunkSize));
+  store_u32(header.data() + 16, jsonChunkType);
+  segments.emplace_back(header);
+  segments.push_back(
+      std::as_bytes(std::span{json_text_.data(), json_text_.size()}));
+  // >> This chunk MUST be padded with trailing Space chars (0x20) to satisfy
+  // >> alignment requirements.
+  segments.push_back(std::span{jsonPadding}.first(
+      static_cast<std::size_t>(jsonChunkSize - json_text_.size())));
+
+  std::array<std::byte, chunkHeaderSize> binChunkHeader;
+  if (bin_) {
+    const auto binSize = bin_->size();
+    const auto binChunkSize = align4(binSize);
+    store_u32(binChunkHeader.data(), static_cast<std::uint32_t>(binChunkSize));
+    store_u32(binChunkHeader.data() + 4, binChunkType);
+    segments.emplace_back(binChunkHeader);
+    segments.insert(segments.end(), bin_->segments().begin(),
+                    bin_->segments().end());
+    // >> This chunk MUST be padded with trailing zeros (0x00) to satisfy
+    // >> alignment requirements.
+    segments.push_back(std::span{binPadding}.first(
+        static_cast<std::size_t>(binChunkSize - binSize)));
+  }
+
+  file_.write(segments);
+}
+} // namespace bee
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <bee/OutputFile.h>
+#include <bee/SegmentedBuffer.h>
+#include <cstdint>
+#include <string_view>
+
+namespace bee {
+/// <summary>
+/// Size of the GLB holding the JSON and the BIN chunk, padding included.
+/// </summary>
+BEE_API std::uint64_t glb_size(std::string_view json_text_,
+                               const SegmentedBuffer *bin_);
+
+/// <summary>
+/// Writes a GLB: the header, the JSON chunk and then, if any, the BIN chunk
+/// segment by segment, in one gather write. The sizes are computed beforehand
+/// so nothing is assembled in memory.
+/// </summary>
+/// <param name="bin_">The BIN chunk's content. May be null.</param>
+/// <exception cref="std::runtime_error">
+/// The GLB exceeds 4GB, or writing failed.
+/// </exception>
+BEE_API void write_glb(OutputFile &file_,
+                       std::string_view json_text_,
+                       const SegmentedBuffer *bin_);
+} // namespace bee
@@ -1,6 +1,9 @@
 
 #include <bee/GLTFBuilder.h>
+#include <bee/ThreadPool.h>
 #include <cassert>
+#include <fmt/format.h>
+#include <stdexcept>
 
 namespace bee {
 GLTFBuilder::GLTFBuilder() {
@@ -17,59 +20,211 @@ GLTFBuilder::BuildResult GLTFBuilder::build(BuildOptions options) {
     _glTFDocument.asset.generator = *options.generator;
   }
 
-  const auto nBuffers = static_cast<std::uint32_t>(_bufferKeeps.size());
-  _glTFDocument.buffers.resize(nBuffers);
-  buildResult.buffers.resize(nBuffers);
-  for (std::remove_const_t<decltype(nBuffers)> iBuffer = 0; iBuffer < nBuffers;
-       ++iBuffer) {
-    const auto &bufferKeep = _bufferKeeps[iBuffer];
-    std::uint32_t bufferByteLength = 0;
-    for (const auto &bufferViewKeep : bufferKeep.bufferViews) {
-      bufferByteLength +=
-          static_cast<std::uint32_t>(bufferViewKeep.data.size());
-    }
+  const auto &meshoptCompression = options.meshoptCompression;
+  if (meshoptCompression) {
+    _compressBufferViews(meshoptCompression->threads);
+  }
+
+  const auto getPadding = [](std::uint64_t offset_, std::size_t align_) {
+    const auto misalignment = align_ > 1 ? offset_ % align_ : 0;
+    return misalignment != 0 ? align_ - misalignment : 0;
+  };
+  const auto addBuffer = [this, &buildResult](const std::string &name_) {
+    fx::gltf::Buffer glTFBuffer;
+    glTFBuffer.name = name_;
+    buildResult.buffers.emplace_back();
+    return add(&fx::gltf::Document::buffers, std::move(glTFBuffer));
+  };
 
-    std::vector<std::byte> bufferStorage(bufferByteLength);
-    std::uint32_t bufferOffset = 0;
-    for (const auto &bufferViewKeep : bufferKeep.bufferViews) {
+  const auto maxBufferSize = options.maxBufferSize != 0
+                                 ? std::uint64_t{options.maxBufferSize}
+                                 : defaultMaxBufferSize;
+  for (auto &bufferKeep : _bufferKeeps) {
+    // The glTF buffer the views are being put in; a new one is started when
+    // the size limit would be exceeded.
+    // Offsets stay within 32 bits: a buffer only grows past `maxBufferSize`
+    // when it has a single view, and views are within `maxBufferViewSize`.
+    std::optional<XXIndex> glTFBufferIndex;
+    std::uint64_t bufferOffset = 0;
+    // The fallback buffer of the one above, once it has compressed views.
+    std::optional<XXIndex> fallbackBufferIndex;
+    std::uint64_t fallbackOffset = 0;
+    for (auto &bufferViewKeep : bufferKeep.bufferViews) {
       auto &bufferView = _glTFDocument.bufferViews[bufferViewKeep.index];
-      auto bufferViewSize =
-          static_cast<std::uint32_t>(bufferViewKeep.data.size());
-      bufferView.byteOffset = bufferOffset;
-      bufferView.buffer = iBuffer;
-      std::memcpy(bufferStorage.data() + bufferOffset,
-                  bufferViewKeep.data.data(), bufferViewSize);
-      bufferOffset += bufferViewSize;
-    }
-    buildResult.buffers[iBuffer] = std::move(bufferStorage);
+      const bool compressed = !bufferViewKeep.compressed.empty();
+      auto &stored =
+          compressed ? bufferViewKeep.compressed : bufferViewKeep.data;
+      const std::uint64_t storedSize = stored.size();
+      // Compressed data is read byte by byte, but kept 4-byte aligned.
+      auto padding =
+          getPadding(bufferOffset, compressed ? 4 : bufferViewKeep.align);
+      auto fallbackPadding =
+          compressed ? getPadding(fallbackOffset, bufferViewKeep.align) : 0;
+      if (glTFBufferIndex &&
+          (bufferOffset + padding + storedSize > maxBufferSize ||
+           (compressed && fallbackBufferIndex &&
+            fallbackOffset + fallbackPadding + bufferViewKeep.data.size() >
+                maxBufferSize))) {
+        glTFBufferIndex.reset();
+        fallbackBufferIndex.reset();
+      }
+      if (!glTFBufferIndex) {
+        glTFBufferIndex = addBuffer(bufferKeep.name);
+        bufferOffset = 0;
+        padding = 0;
+      }
+      if (compressed && !fallbackBufferIndex) {
+        fallbackBufferIndex = addBuffer(bufferKeep.name);
+        _glTFDocument.buffers[*fallbackBufferIndex]
+            .extensionsAndExtras["extensions"]["EXT_meshopt_compression"] = {
+            {"fallback", true}};
+        fallbackOffset = 0;
+        fallbackPadding = 0;
+      }
 
-    fx::gltf::Buffer glTFBuffer;
-    glTFBuffer.byteLength = bufferByteLength;
-    _glTFDocument.buffers[iBuffer] = glTFBuffer;
+      auto &bufferStorage = buildResult.buffers[*glTFBufferIndex];
+      if (padding != 0) {
+        bufferStorage.pad(padding);
+        bufferOffset += padding;
+      }
+      const auto storedOffset = bufferOffset;
+      bufferStorage.append(std::move(stored));
+      bufferOffset += storedSize;
+      _glTFDocument.buffers[*glTFBufferIndex].byteLength =
+          static_cast<std::uint32_t>(bufferOffset);
+
+      if (!compressed) {
+        bufferView.byteOffset = static_cast<std::uint32_t>(storedOffset);
+        bufferView.buffer = *glTFBufferIndex;
+        continue;
+      }
+
+      // The buffer view itself is in the fallback buffer.
+      const auto &encoding = *bufferViewKeep.meshoptEncoding;
+      const std::uint64_t bufferViewSize = bufferViewKeep.data.size();
+      fallbackOffset += fallbackPadding;
+      if (meshoptCompression->fallback) {
+        auto &fallbackStorage = buildResult.buffers[*fallbackBufferIndex];
+        fallbackStorage.pad(fallbackPadding);
+        fallbackStorage.append(std::move(bufferViewKeep.data));
+      } else {
+        bufferViewKeep.data = {};
+      }
+      bufferView.byteOffset = static_cast<std::uint32_t>(fallbackOffset);
+      bufferView.buffer = *fallbackBufferIndex;
+      fallbackOffset += bufferViewSize;
+      _glTFDocument.buffers[*fallbackBufferIndex].byteLength =
+          static_cast<std::uint32_t>(fallbackOffset);
+
+      auto &extension = bufferView.extensionsAndExtras["extensions"]
+                                                      ["EXT_meshopt_compression"];
+      extension = {{"buffer", *glTFBufferIndex},
+                   {"byteOffset", storedOffset},
+                   {"byteLength", storedSize},
+                   {"byteStride", encoding.byteStride},
+                   {"count", bufferViewSize / encoding.byteStride},
+                   {"mode", to_string(encoding.mode)}};
+      if (encoding.filter != MeshoptFilter::none) {
+        extension["filter"] = to_string(encoding.filter);
+      }
+      if (meshoptCompression->fallback) {
+        useExtension("EXT_meshopt_compression");
+      } else {
+        requireExtension("EXT_meshopt_compression");
+      }
+    }
+    bufferKeep.bufferViews.clear();
   }
 
   return buildResult;
 }
 
+void GLTFBuilder::_compressBufferViews(std::uint32_t threads_) {
+  std::vector<BufferViewKeep *> bufferViewKeeps;
+  for (auto &bufferKeep : _bufferKeeps) {
+    for (auto &bufferViewKeep : bufferKeep.bufferViews) {
+      if (bufferViewKeep.meshoptEncoding &&
+          is_meshopt_encodable(*bufferViewKeep.meshoptEncoding,
+                               bufferViewKeep.data.size())) {
+        bufferViewKeeps.push_back(&bufferViewKeep);
+      }
+    }
+  }
+
+  // What's kept is handed over to this thread's counters, see
+  // `AllocationTracker`.
+  std::vector<std::size_t> compressedSizes(bufferViewKeeps.size());
+  const auto compress = [&bufferViewKeeps,
+                         &compressedSizes](std::size_t index_) {
+    auto &bufferViewKeep = *bufferViewKeeps[index_];
+    const auto &encoding = *bufferViewKeep.meshoptEncoding;
+    encode_meshopt_filter(bufferViewKeep.data, encoding);
+    const auto compressed = encode_meshopt(bufferViewKeep.data, encoding);
+    decode_meshopt_filter(bufferViewKeep.data, encoding);
+    if (compressed.size() < bufferViewKeep.data.size()) {
+      bufferViewKeep.compressed.assign(compressed.begin(), compressed.end());
+      compressedSizes[index_] = bufferViewKeep.compressed.capacity();
+      AllocationTracker::deallocated(compressedSizes[index_]);
+    }
+  };
+  ThreadPool threadPool{std::max(threads_, 1u) - 1};
+  threadPool.parallel_for(bufferViewKeeps.size(), compress);
+  for (const auto size : compressedSizes) {
+    AllocationTracker::allocated(size);
+  }
+}
+
+GLTFBuilder::XXIndex GLTFBuilder::createBuffer(std::string_view name_) {
+  const auto index = static_cast<XXIndex>(_bufferKeeps.size());
+  auto &bufferKeep = _bufferKeeps.emplace_back();
+  bufferKeep.name = name_;
+  return index;
+}
+
 const GLTFBuilder::BufferViewInfo GLTFBuilder::createBufferView(
-    std::uint32_t byte_length_, std::uint32_t align_, XXIndex buffer_) {
+    std::size_t byte_length_,
+    std::uint32_t align_,
+    XXIndex buffer_,
+    std::optional<MeshoptEncoding> meshopt_encoding_) {
+  auto data = allocateBufferView(byte_length_);
+  // Moving the vector keeps its storage.
+  auto pData = data.data();
+  BufferViewInfo bufferViewInfo;
+  bufferViewInfo.data = pData;
+  bufferViewInfo.index = addBufferView({}, std::move(data), align_, buffer_,
+                                       meshopt_encoding_);
+  return bufferViewInfo;
+}
+
+TrackedBytes GLTFBuilder::allocateBufferView(std::size_t byte_length_) {
+  // Checked before anything is allocated.
+  if (byte_length_ > maxBufferViewSize) {
+    throw std::runtime_error(fmt::format(
+        "A buffer view of {} bytes exceeds the 4GB limit of glTF buffers.",
+        byte_length_));
+  }
+  return TrackedBytes(byte_length_);
+}
+
+GLTFBuilder::XXIndex
+GLTFBuilder::addBufferView(fx::gltf::BufferView buffer_view_,
+                           TrackedBytes data_,
+                           std::uint32_t align_,
+                           XXIndex buffer_,
+                           std::optional<MeshoptEncoding> meshopt_encoding_) {
   assert(buffer_ < _bufferKeeps.size());
+  assert(data_.size() <= maxBufferViewSize);
   auto &bufferKeep = _bufferKeeps[buffer_];
   auto index = static_cast<std::uint32_t>(_glTFDocument.bufferViews.size());
-  fx::gltf::BufferView bufferView;
-  bufferView.byteLength = byte_length_;
-  _glTFDocument.bufferViews.push_back(std::move(bufferView));
-  std::vector<std::byte> data(byte_length_);
-  auto pData = data.data();
+  buffer_view_.byteLength = static_cast<std::uint32_t>(data_.size());
+  _glTFDocument.bufferViews.push_back(std::move(buffer_view_));
   BufferViewKeep bufferViewKeep;
   bufferViewKeep.index = index;
   bufferViewKeep.align = align_;
-  bufferViewKeep.data = std::move(data);
+  bufferViewKeep.data = std::move(data_);
+  bufferViewKeep.meshoptEncoding = meshopt_encoding_;
   bufferKeep.bufferViews.push_back(std::move(bufferViewKeep));
-  BufferViewInfo bufferViewInfo;
-  bufferViewInfo.data = pData;
-  bufferViewInfo.index = index;
-  return bufferViewInfo;
+  return index;
 }
 
 void GLTFBuilder::useExtension(std::string_view extension_name_) {
@@ -91,4 +246,4 @@ void GLTFBuilder::requireExtension(std::string_view extension_name_) {
     _glTFDocument.extensionsRequired.push_back(std::move(extName));
   }
 }
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
@@ -2,8 +2,13 @@
 #pragma once
 
 #include <bee/GLTFUtilities.h>
+#include <bee/Memory.h>
+#include <bee/MeshoptCompression.h>
+#include <bee/SegmentedBuffer.h>
 #include <cstddef>
+#include <cstdint>
 #include <fx/gltf.h>
+#include <limits>
 #include <list>
 #include <optional>
 #include <span>
@@ -31,15 +36,62 @@ public:
     XXIndex index;
   };
 
+  /// <summary>
+  /// Byte lengths and offsets are 32-bit in glTF, so no buffer view may be
+  /// larger than this.
+  /// </summary>
+  static constexpr std::uint64_t maxBufferViewSize =
+      std::numeric_limits<std::uint32_t>::max();
+
+  /// <summary>
+  /// Buffers are split beyond this size if `BuildOptions::maxBufferSize` is 0:
+  /// 2GB is the most many runtimes allocate for one array buffer, and keeps
+  /// the BIN chunk of a GLB, whose total length is 32-bit, well within 4GB.
+  /// </summary>
+  static constexpr std::uint64_t defaultMaxBufferSize = std::uint64_t{1}
+                                                        << 31;
+
   GLTFBuilder();
 
   struct BuildOptions {
     std::optional<std::string> copyright;
     std::optional<std::string> generator;
+
+    /// <summary>
+    /// See `ConvertOptions::BufferPartition::max_buffer_size`.
+    /// 0 means `defaultMaxBufferSize`.
+    /// </summary>
+    std::uint32_t maxBufferSize = 0;
+
+    struct MeshoptCompression {
+      /// <summary>
+      /// Whether the fallback buffers hold the uncompressed buffer views,
+      /// for readers not supporting the extension, which is then used but
+      /// not required.
+      /// </summary>
+      bool fallback = false;
+
+      /// <summary>
+      /// Threads encoding buffer views, the building one included.
+      /// </summary>
+      std::uint32_t threads = 1;
+    };
+
+    /// <summary>
+    /// Compresses the buffer views having a `MeshoptEncoding` with
+    /// `EXT_meshopt_compression`, when that makes them smaller.
+    /// Their compressed data is put in the buffers, and the uncompressed one
+    /// in a fallback buffer along each.
+    /// </summary>
+    std::optional<MeshoptCompression> meshoptCompression;
   };
 
   struct BuildResult {
-    std::vector<std::vector<std::byte>> buffers;
+    /// <summary>
+    /// Each buffer's buffer views, in order.
+    /// Fallback buffers without data are empty, unlike their byte length.
+    /// </summary>
+    std::vector<SegmentedBuffer> buffers;
   };
 
   fx::gltf::Document &document() {
@@ -50,29 +102,85 @@ public:
     return _glTFDocument;
   }
 
-  BuildResult build(BuildOptions options = {});
+  /// <summary>
+  /// Assigns buffer views their offsets, padding them to their alignment,
+  /// and moves their storage into the result without copying.
+  /// Buffers having no buffer view are dropped, so the glTF buffer indices
+  /// may differ from those passed to `createBufferView()`.
+  /// Shall be called once.
+  /// </summary>
+  BuildResult build(BuildOptions options);
 
-  const BufferViewInfo createBufferView(std::uint32_t byte_length_,
-                                        std::uint32_t align_,
-                                        XXIndex buffer_);
+  /// <summary>
+  /// Adds a buffer buffer views may be created in, besides buffer 0 which
+  /// always exists.
+  /// </summary>
+  XXIndex createBuffer(std::string_view name_);
 
+  /// <param name="align_">
+  /// The byte offset's alignment in the buffer. 0 means no requirement.
+  /// </param>
+  /// <exception cref="std::runtime_error">
+  /// `byte_length_` exceeds `maxBufferViewSize`.
+  /// </exception>
+  const BufferViewInfo
+  createBufferView(std::size_t byte_length_,
+                   std::uint32_t align_,
+                   XXIndex buffer_,
+                   std::optional<MeshoptEncoding> meshopt_encoding_ = {});
+
+  /// <summary>
+  /// Allocates the data of a buffer view to be added later by
+  /// `addBufferView()`, so that it may be filled on another thread.
+  /// </summary>
+  /// <exception cref="std::runtime_error">
+  /// `byte_length_` exceeds `maxBufferViewSize`.
+  /// </exception>
+  static TrackedBytes allocateBufferView(std::size_t byte_length_);
+
+  /// <summary>
+  /// Adds a buffer view whose data was filled already.
+  /// Its byte length is that of `data_`; its buffer and byte offset are
+  /// assigned by `build()`.
+  /// </summary>
+  /// <param name="data_">
+  /// Allocated by `allocateBufferView()`.
+  /// </param>
+  /// <param name="meshopt_encoding_">
+  /// How the buffer view may be compressed, see
+  /// `BuildOptions::meshoptCompression`.
+  /// </param>
+  XXIndex addBufferView(fx::gltf::BufferView buffer_view_,
+                        TrackedBytes data_,
+                        std::uint32_t align_,
+                        XXIndex buffer_,
+                        std::optional<MeshoptEncoding> meshopt_encoding_ = {});
+
+  /// <param name="meshopt_filter_">
+  /// The filter the accessor's buffer view is compressed with, if it is.
+  /// </param>
   template <fx::gltf::Accessor::Type Type_,
             fx::gltf::Accessor::ComponentType ComponentType_,
             typename Spreader_>
   XXIndex createAccessor(std::span<const typename Spreader_::type> values_,
                          std::uint32_t align_,
                          std::uint32_t buffer_index_,
-                         bool min_max_ = false) {
+                         bool min_max_ = false,
+                         MeshoptFilter meshopt_filter_ = MeshoptFilter::none,
+                         std::uint32_t meshopt_filter_bits_ = 0) {
     using SourceTy = typename Spreader_::type;
     using TargetTy = GLTFComponentTypeStorage<ComponentType_>;
 
     constexpr auto nComponents = countComponents(Type_);
     static_assert(Spreader_::size == nComponents);
 
-    auto [bufferViewData, bufferViewIndex] =
-        createBufferView(countBytes(ComponentType_) * nComponents *
-                             static_cast<std::uint32_t>(values_.size()),
-                         align_, buffer_index_);
+    auto [bufferViewData, bufferViewIndex] = createBufferView(
+        std::size_t{countBytes(ComponentType_)} * nComponents *
+            values_.size(),
+        std::max(align_, countBytes(ComponentType_)), buffer_index_,
+        MeshoptEncoding{MeshoptMode::attributes,
+                        countBytes(Type_, ComponentType_), meshopt_filter_,
+                        meshopt_filter_bits_});
     for (decltype(values_.size()) i = 0; i < values_.size(); ++i) {
       Spreader_::spread(values_[i],
                         reinterpret_cast<TargetTy *>(bufferViewData) +
@@ -141,15 +249,27 @@ private:
   struct BufferViewKeep {
     std::size_t index;
     std::size_t align;
-    std::vector<std::byte> data;
+    TrackedBytes data;
+    std::optional<MeshoptEncoding> meshoptEncoding;
+    /// <summary>
+    /// The data compressed, if smaller.
+    /// </summary>
+    TrackedBytes compressed;
   };
 
   struct BufferKeep {
+    std::string name;
     std::list<BufferViewKeep> bufferViews;
   };
 
   fx::gltf::Document _glTFDocument;
   std::vector<BufferKeep> _bufferKeeps;
   std::list<ImageData> _images;
+
+  /// <summary>
+  /// Fills the `compressed` of buffer views, and filters their `data` as
+  /// decoders do.
+  /// </summary>
+  void _compressBufferViews(std::uint32_t threads_);
 };
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
@@ -0,0 +1,670 @@
+#include <bee/GLTFJsonWriter.h>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace bee {
+namespace {
+/// <summary>
+/// Text is handed to the stream, if any, in pieces of about this size.
+/// </summary>
+constexpr std::size_t flushThreshold = 64 * 1024;
+
+class GLTFJsonWriter {
+public:
+  GLTFJsonWriter(std::string &out_, std::ostream *stream_, bool compact_)
+      : _out(out_), _stream(stream_), _compact(compact_) {
+  }
+
+  void write(const fx::gltf::Document &document_) {
+    _beginObject();
+    // Unlike `fx::gltf::to_json()`, which sorts members, the asset and the
+    // extensions go first so readers peeking at the head find them.
+    _field("asset", document_.asset);
+    _field("extensionsUsed", document_.extensionsUsed);
+    _field("extensionsRequired", document_.extensionsRequired);
+    _field("accessors", document_.accessors);
+    _field("animations", document_.animations);
+    _field("buffers", document_.buffers);
+    _field("bufferViews", document_.bufferViews);
+    _field("cameras", document_.cameras);
+    _field("images", document_.images);
+    _field("materials", document_.materials);
+    _field("meshes", document_.meshes);
+    _field("nodes", document_.nodes);
+    _field("samplers", document_.samplers);
+    _field("scene", document_.scene, -1);
+    _field("scenes", document_.scenes);
+    _field("skins", document_.skins);
+    _field("textures", document_.textures);
+    _extensions(document_.extensionsAndExtras);
+    _endObject();
+    _flush();
+  }
+
+private:
+  std::string &_out;
+  std::ostream *_stream;
+  bool _compact;
+  /// <summary>
+  /// Per open object or array, whether nothing has been written into it yet.
+  /// </summary>
+  std::vector<bool> _empty;
+
+  void _flush() {
+    if (_stream) {
+      _stream->write(_out.data(), static_cast<std::streamsize>(_out.size()));
+      _out.clear();
+    }
+  }
+
+  void _newLine() {
+    if (!_compact) {
+      _out.push_back('\n');
+      _out.append(2 * _empty.size(), ' ');
+    }
+  }
+
+  /// <summary>
+  /// Separates the next member or element from the previous one.
+  /// </summary>
+  void _next() {
+    if (!_empty.back()) {
+      _out.push_back(',');
+    }
+    _empty.back() = false;
+    _newLine();
+  }
+
+  void _begin(char bracket_) {
+    if (_stream && _out.size() >= flushThreshold) {
+      _flush();
+    }
+    _out.push_back(bracket_);
+    _empty.push_back(true);
+  }
+
+  void _end(char bracket_) {
+    const auto empty = _empty.back();
+    _empty.pop_back();
+    if (!empty) {
+      _newLine();
+    }
+    _out.push_back(bracket_);
+  }
+
+  void _beginObject() {
+    _begin('{');
+  }
+
+  void _endObject() {
+    _end('}');
+  }
+
+  void _key(std::string_view key_) {
+    _next();
+    _string(key_);
+    _out.append(_compact ? ":" : ": ");
+  }
+
+  void _string(std::string_view value_) {
+    constexpr char hexDigits[] = "0123456789abcdef";
+    _out.push_back('"');
+    for (const auto c : value_) {
+      switch (c) {
+      case '"':
+        _out.append("\\\"");
+        break;
+      case '\\':
+        _out.append("\\\\");
+        break;
+      case '\b':
+        _out.append("\\b");
+        break;
+      case '\f':
+        _out.append("\\f");
+        break;
+      case '\n':
+        _out.append("\\n");
+        break;
+      case '\r':
+        _out.append("\\r");
+        break;
+      case '\t':
+        _out.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          _out.append("\\u00");
+          _out.push_back(hexDigits[c >> 4]);
+          _out.push_back(hexDigits[c & 0xF]);
+        } else {
+          _out.push_back(c);
+        }
+        break;
+      }
+    }
+    _out.push_back('"');
+  }
+
+  template <typename Number_> void _number(Number_ value_) {
+    std::array<char, 32> chars;
+    const auto result =
+        std::to_chars(chars.data(), chars.data() + chars.size(), value_);
+    _out.append(chars.data(), result.ptr);
+  }
+
+  void _value(bool value_) {
+    _out.append(value_ ? "true" : "false");
+  }
+
+  void _value(std::int32_t value_) {
+    _number(value_);
+  }
+
+  void _value(std::uint32_t value_) {
+    _number(value_);
+  }
+
+  void _value(float value_) {
+    if (!std::isfinite(value_)) {
+      // As nlohmann does.
+      _out.append("null");
+      return;
+    }
+    _number(value_);
+  }
+
+  void _value(const std::string &value_) {
+    _string(value_);
+  }
+
+  template <typename Enum_>
+  requires std::is_enum_v<Enum_>
+  void _value(Enum_ value_) {
+    _number(static_cast<std::underlying_type_t<Enum_>>(value_));
+  }
+
+  void _value(fx::gltf::Accessor::ComponentType value_) {
+    if (value_ == fx::gltf::Accessor::ComponentType::None) {
+      throw fx::gltf::invalid_gltf_document(
+          "Unknown accessor.componentType value");
+    }
+    _number(static_cast<std::uint16_t>(value_));
+  }
+
+  void _value(fx::gltf::Accessor::Type value_) {
+    using Type = fx::gltf::Accessor::Type;
+    switch (value_) {
+    case Type::Scalar:
+      _string("SCALAR");
+      break;
+    case Type::Vec2:
+      _string("VEC2");
+      break;
+    case Type::Vec3:
+      _string("VEC3");
+      break;
+    case Type::Vec4:
+      _string("VEC4");
+      break;
+    case Type::Mat2:
+      _string("MAT2");
+      break;
+    case Type::Mat3:
+      _string("MAT3");
+      break;
+    case Type::Mat4:
+      _string("MAT4");
+      break;
+    default:
+      throw fx::gltf::invalid_gltf_document("Unknown accessor.type value");
+    }
+  }
+
+  void _value(fx::gltf::Animation::Sampler::Type value_) {
+    using Type = fx::gltf::Animation::Sampler::Type;
+    switch (value_) {
+    case Type::Linear:
+      _string("LINEAR");
+      break;
+    case Type::Step:
+      _string("STEP");
+      break;
+    case Type::CubicSpline:
+      _string("CUBICSPLINE");
+      break;
+    }
+  }
+
+  void _value(fx::gltf::Camera::Type value_) {
+    using Type = fx::gltf::Camera::Type;
+    switch (value_) {
+    case Type::Orthographic:
+      _string("orthographic");
+      break;
+    case Type::Perspective:
+      _string("perspective");
+      break;
+    default:
+      throw fx::gltf::invalid_gltf_document("Unknown camera.type value");
+    }
+  }
+
+  void _value(fx::gltf::Material::AlphaMode value_) {
+    using AlphaMode = fx::gltf::Material::AlphaMode;
+    switch (value_) {
+    case AlphaMode::Opaque:
+      _string("OPAQUE");
+      break;
+    case AlphaMode::Mask:
+      _string("MASK");
+      break;
+    case AlphaMode::Blend:
+      _string("BLEND");
+      break;
+    }
+  }
+
+  template <typename Element_>
+  void _value(const std::vector<Element_> &value_) {
+    _begin('[');
+    for (const auto &element : value_) {
+      _next();
+      _value(element);
+    }
+    _end(']');
+  }
+
+  template <typename Element_, std::size_t N_>
+  void _value(const std::array<Element_, N_> &value_) {
+    _begin('[');
+    for (const auto &element : value_) {
+      _next();
+      _value(element);
+    }
+    _end(']');
+  }
+
+  void _value(const fx::gltf::Attributes &value_) {
+    // Sorted, as the map `fx::gltf::to_json()` goes through is,
+    // so the output doesn't depend on the hash table's order.
+    std::vector<const fx::gltf::Attributes::value_type *> attributes;
+    attributes.reserve(value_.size());
+    for (const auto &attribute : value_) {
+      attributes.push_back(&attribute);
+    }
+    std::sort(attributes.begin(), attributes.end(),
+              [](const auto *lhs_, const auto *rhs_) {
+                return lhs_->first < rhs_->first;
+              });
+    _beginObject();
+    for (const auto *attribute : attributes) {
+      _key(attribute->first);
+      _value(attribute->second);
+    }
+    _endObject();
+  }
+
+  /// <summary>
+  /// Writes the member if it isn't `empty()`, as `fx::gltf` does for strings,
+  /// arrays and objects which may be omitted entirely.
+  /// </summary>
+  template <typename Value_>
+  void _field(std::string_view key_, const Value_ &value_) {
+    if (!value_.empty()) {
+      _key(key_);
+      _value(value_);
+    }
+  }
+
+  /// <summary>
+  /// Writes the member unless it's the default.
+  /// </summary>
+  template <typename Value_>
+  void _field(std::string_view key_,
+              const Value_ &value_,
+              const std::type_identity_t<Value_> &default_) {
+    if (value_ != default_) {
+      _key(key_);
+      _value(value_);
+    }
+  }
+
+  /// <summary>
+  /// Writes `extensions` and `extras`, the only members left as JSON.
+  /// </summary>
+  void _extensions(const nlohmann::json &extensionsAndExtras_) {
+    if (!extensionsAndExtras_.is_object()) {
+      return;
+    }
+    for (const auto &[key, value] : extensionsAndExtras_.items()) {
+      _key(key);
+      if (_compact) {
+        _out.append(value.dump());
+        continue;
+      }
+      // Re-indents the nested lines at the current depth. Newlines within
+      // strings are escaped, so each raw one starts a line.
+      const auto text = value.dump(2);
+      const auto indent = 2 * _empty.size();
+      for (const auto c : text) {
+        _out.push_back(c);
+        if (c == '\n') {
+          _out.append(indent, ' ');
+        }
+      }
+    }
+  }
+
+  void _value(const fx::gltf::Accessor::Sparse::Indices &value_) {
+    _beginObject();
+    _field("bufferView", value_.bufferView, static_cast<std::uint32_t>(-1));
+    _field("byteOffset", value_.byteOffset, 0u);
+    _field("componentType", value_.componentType,
+           fx::gltf::Accessor::ComponentType::None);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Accessor::Sparse::Values &value_) {
+    _beginObject();
+    _field("bufferView", value_.bufferView, static_cast<std::uint32_t>(-1));
+    _field("byteOffset", value_.byteOffset, 0u);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Accessor::Sparse &value_) {
+    _beginObject();
+    _field("count", value_.count, -1);
+    _field("indices", value_.indices);
+    _field("values", value_.values);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Accessor &value_) {
+    _beginObject();
+    _field("bufferView", value_.bufferView, -1);
+    _field("byteOffset", value_.byteOffset, 0u);
+    _field("componentType", value_.componentType,
+           fx::gltf::Accessor::ComponentType::None);
+    _field("count", value_.count, static_cast<std::uint32_t>(-1));
+    _field("max", value_.max);
+    _field("min", value_.min);
+    _field("name", value_.name);
+    _field("normalized", value_.normalized, false);
+    _field("sparse", value_.sparse);
+    _field("type", value_.type, fx::gltf::Accessor::Type::None);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Animation::Channel::Target &value_) {
+    _beginObject();
+    _field("node", value_.node, -1);
+    _field("path", value_.path);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Animation::Channel &value_) {
+    _beginObject();
+    _field("sampler", value_.sampler, -1);
+    _field("target", value_.target);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Animation::Sampler &value_) {
+    _beginObject();
+    _field("input", value_.input, -1);
+    _field("interpolation", value_.interpolation,
+           fx::gltf::Animation::Sampler::Type::Linear);
+    _field("output", value_.output, -1);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Animation &value_) {
+    _beginObject();
+    _field("channels", value_.channels);
+    _field("name", value_.name);
+    _field("samplers", value_.samplers);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Asset &value_) {
+    _beginObject();
+    _field("copyright", value_.copyright);
+    _field("generator", value_.generator);
+    _field("minVersion", value_.minVersion);
+    _field("version", value_.version);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Buffer &value_) {
+    _beginObject();
+    _field("byteLength", value_.byteLength, 0u);
+    _field("name", value_.name);
+    _field("uri", value_.uri);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::BufferView &value_) {
+    _beginObject();
+    _field("buffer", value_.buffer, -1);
+    _field("byteLength", value_.byteLength, 0u);
+    _field("byteOffset", value_.byteOffset, 0u);
+    _field("byteStride", value_.byteStride, 0u);
+    _field("name", value_.name);
+    _field("target", value_.target, fx::gltf::BufferView::TargetType::None);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Camera::Orthographic &value_) {
+    namespace defaults = fx::gltf::defaults;
+    _beginObject();
+    _field("xmag", value_.xmag, defaults::FloatSentinel);
+    _field("ymag", value_.ymag, defaults::FloatSentinel);
+    _field("zfar", value_.zfar, -defaults::FloatSentinel);
+    _field("znear", value_.znear, -defaults::FloatSentinel);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Camera::Perspective &value_) {
+    _beginObject();
+    _field("aspectRatio", value_.aspectRatio, 0.0f);
+    _field("yfov", value_.yfov, 0.0f);
+    _field("zfar", value_.zfar, 0.0f);
+    _field("znear", value_.znear, 0.0f);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Camera &value_) {
+    using Type = fx::gltf::Camera::Type;
+    _beginObject();
+    _field("name", value_.name);
+    _field("type", value_.type, Type::None);
+    _extensions(value_.extensionsAndExtras);
+    if (value_.type == Type::Perspective) {
+      _field("perspective", value_.perspective);
+    } else if (value_.type == Type::Orthographic) {
+      _field("orthographic", value_.orthographic);
+    }
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Image &value_) {
+    _beginObject();
+    // Either the buffer view or the URI is written, even if the view is 0.
+    _field("bufferView", value_.bufferView, value_.uri.empty() ? -1 : 0);
+    _field("mimeType", value_.mimeType);
+    _field("name", value_.name);
+    _field("uri", value_.uri);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _textureFields(const fx::gltf::Material::Texture &value_) {
+    _field("index", value_.index, -1);
+    _field("texCoord", value_.texCoord, 0);
+  }
+
+  void _value(const fx::gltf::Material::Texture &value_) {
+    _beginObject();
+    _textureFields(value_);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Material::NormalTexture &value_) {
+    _beginObject();
+    _textureFields(value_);
+    _field("scale", value_.scale, fx::gltf::defaults::IdentityScalar);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Material::OcclusionTexture &value_) {
+    _beginObject();
+    _textureFields(value_);
+    _field("strength", value_.strength, fx::gltf::defaults::IdentityScalar);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Material::PBRMetallicRoughness &value_) {
+    namespace defaults = fx::gltf::defaults;
+    _beginObject();
+    _field("baseColorFactor", value_.baseColorFactor, defaults::IdentityVec4);
+    _field("baseColorTexture", value_.baseColorTexture);
+    _field("metallicFactor", value_.metallicFactor, defaults::IdentityScalar);
+    _field("metallicRoughnessTexture", value_.metallicRoughnessTexture);
+    _field("roughnessFactor", value_.roughnessFactor,
+           defaults::IdentityScalar);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Material &value_) {
+    namespace defaults = fx::gltf::defaults;
+    _beginObject();
+    _field("alphaCutoff", value_.alphaCutoff, defaults::MaterialAlphaCutoff);
+    _field("alphaMode", value_.alphaMode,
+           fx::gltf::Material::AlphaMode::Opaque);
+    _field("doubleSided", value_.doubleSided, defaults::MaterialDoubleSided);
+    _field("emissiveTexture", value_.emissiveTexture);
+    _field("emissiveFactor", value_.emissiveFactor, defaults::NullVec3);
+    _field("name", value_.name);
+    _field("normalTexture", value_.normalTexture);
+    _field("occlusionTexture", value_.occlusionTexture);
+    _field("pbrMetallicRoughness", value_.pbrMetallicRoughness);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Primitive &value_) {
+    _beginObject();
+    _field("attributes", value_.attributes);
+    _field("indices", value_.indices, -1);
+    _field("material", value_.material, -1);
+    _field("mode", value_.mode, fx::gltf::Primitive::Mode::Triangles);
+    _field("targets", value_.targets);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Mesh &value_) {
+    _beginObject();
+    _field("name", value_.name);
+    _field("primitives", value_.primitives);
+    _field("weights", value_.weights);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Node &value_) {
+    namespace defaults = fx::gltf::defaults;
+    _beginObject();
+    _field("camera", value_.camera, -1);
+    _field("children", value_.children);
+    _field("matrix", value_.matrix, defaults::IdentityMatrix);
+    _field("mesh", value_.mesh, -1);
+    _field("name", value_.name);
+    _field("rotation", value_.rotation, defaults::IdentityRotation);
+    _field("scale", value_.scale, defaults::IdentityVec3);
+    _field("skin", value_.skin, -1);
+    _field("translation", value_.translation, defaults::NullVec3);
+    _field("weights", value_.weights);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Sampler &value_) {
+    using Sampler = fx::gltf::Sampler;
+    // An empty sampler is still written, as `{}`.
+    _beginObject();
+    _field("name", value_.name);
+    _field("magFilter", value_.magFilter, Sampler::MagFilter::None);
+    _field("minFilter", value_.minFilter, Sampler::MinFilter::None);
+    _field("wrapS", value_.wrapS, Sampler::WrappingMode::Repeat);
+    _field("wrapT", value_.wrapT, Sampler::WrappingMode::Repeat);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Scene &value_) {
+    _beginObject();
+    _field("name", value_.name);
+    _field("nodes", value_.nodes);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Skin &value_) {
+    _beginObject();
+    _field("inverseBindMatrices", value_.inverseBindMatrices, -1);
+    _field("name", value_.name);
+    _field("skeleton", value_.skeleton, -1);
+    _field("joints", value_.joints);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+
+  void _value(const fx::gltf::Texture &value_) {
+    _beginObject();
+    _field("name", value_.name);
+    _field("sampler", value_.sampler, -1);
+    _field("source", value_.source, -1);
+    _extensions(value_.extensionsAndExtras);
+    _endObject();
+  }
+};
+} // namespace
+
+void write_gltf_json(std::ostream &stream_,
+                     const fx::gltf::Document &document_,
+                     bool compact_) {
+  std::string buffer;
+  buffer.reserve(flushThreshold + flushThreshold / 4);
+  GLTFJsonWriter{buffer, &stream_, compact_}.write(document_);
+}
+
+std::string to_gltf_json(const fx::gltf::Document &document_, bool compact_) {
+  std::string text;
+  GLTFJsonWriter{text, nullptr, compact_}.write(document_);
+  return text;
+}
+} // namespace bee
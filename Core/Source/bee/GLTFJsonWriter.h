@@ -0,0 +1,32 @@
+#pragma once
+
+#include <fx/gltf.h>
+#include <ostream>
+#include <string>
+
+namespace bee {
+/// <summary>
+/// Serializes the document into glTF JSON as it walks it, instead of building
+/// the whole `nlohmann::json` of `fx::gltf::to_json()` first. Members are
+/// omitted under the same conditions. Only `extensionsAndExtras` go through
+/// nlohmann.
+///
+/// Floats are written in their shortest round-trip form as floats, e.g. `0.1`
+/// rather than the `0.10000000149011612` of their promotion to double.
+/// </summary>
+/// <param name="compact_">
+/// Whether to omit all whitespace. Otherwise, indents by 2 spaces as
+/// `nlohmann::json::dump(2)` does.
+/// </param>
+/// <exception cref="fx::gltf::invalid_gltf_document">
+/// An accessor's component type or type is unset.
+/// </exception>
+void write_gltf_json(std::ostream &stream_,
+                     const fx::gltf::Document &document_,
+                     bool compact_);
+
+/// <summary>
+/// Like `write_gltf_json()` but into a string.
+/// </summary>
+std::string to_gltf_json(const fx::gltf::Document &document_, bool compact_);
+} // namespace bee
@@ -69,8 +69,12 @@ struct GetGLTFComponentTypeStorage<
     fx::gltf::Accessor::ComponentType::UnsignedShort> {
   using type = std::uint16_t;
 };
+template <>
+struct GetGLTFComponentTypeStorage<fx::gltf::Accessor::ComponentType::Short> {
+  using type = std::int16_t;
+};
 
 template <fx::gltf::Accessor::ComponentType Component_>
 using GLTFComponentTypeStorage =
     typename GetGLTFComponentTypeStorage<Component_>::type;
-} // namespace bee
\ No newline at end of file
+} // namespace bee
\ No newline at end of file
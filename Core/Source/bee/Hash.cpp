@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <bee/Hash.h>
+#include <bit>
+#include <cstring>
+
+namespace bee {
+namespace {
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t prime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5ULL;
+
+std::uint64_t read_u64(const std::byte *p_) {
+  std::uint64_t value;
+  std::memcpy(&value, p_, sizeof(value));
+  if constexpr (std::endian::native == std::endian::big) {
+    value = ((value & 0x00000000000000FFULL) << 56) |
+            ((value & 0x000000000000FF00ULL) << 40) |
+            ((value & 0x0000000000FF0000ULL) << 24) |
+            ((value & 0x00000000FF000000ULL) << 8) |
+            ((value & 0x000000FF00000000ULL) >> 8) |
+            ((value & 0x0000FF0000000000ULL) >> 24) |
+            ((value & 0x00FF000000000000ULL) >> 40) |
+            ((value & 0xFF00000000000000ULL) >> 56);
+  }
+  return value;
+}
+
+std::uint32_t read_u32(const std::byte *p_) {
+  return static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(p_[0])) |
+         (static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(p_[1]))
+          << 8) |
+         (static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(p_[2]))
+          << 16) |
+         (static_cast<std::uint32_t>(std::to_integer<std::uint8_t>(p_[3]))
+          << 24);
+}
+
+std::uint64_t round(std::uint64_t accumulator_, std::uint64_t lane_) {
+  accumulator_ += lane_ * prime2;
+  accumulator_ = std::rotl(accumulator_, 31);
+  return accumulator_ * prime1;
+}
+
+std::uint64_t merge_accumulator(std::uint64_t hash_,
+                                std::uint64_t accumulator_) {
+  hash_ ^= round(0, accumulator_);
+  return hash_ * prime1 + prime4;
+}
+
+void consume_stripe(std::array<std::uint64_t, 4> &accumulators_,
+                    const std::byte *stripe_) {
+  for (int iLane = 0; iLane < 4; ++iLane) {
+    accumulators_[iLane] =
+        round(accumulators_[iLane], read_u64(stripe_ + 8 * iLane));
+  }
+}
+} // namespace
+
+Hasher64::Hasher64(std::uint64_t seed_)
+    : _accumulators{seed_ + prime1 + prime2, seed_ + prime2, seed_,
+                    seed_ - prime1},
+      _seed(seed_) {
+}
+
+Hasher64 &Hasher64::update(std::span<const std::byte> data_) {
+  _totalLength += data_.size();
+
+  auto p = data_.data();
+  auto remain = data_.size();
+
+  if (_stripeSize != 0) {
+    const auto nFill = std::min(remain, _stripe.size() - _stripeSize);
+    std::memcpy(_stripe.data() + _stripeSize, p, nFill);
+    _stripeSize += nFill;
+    p += nFill;
+    remain -= nFill;
+    if (_stripeSize != _stripe.size()) {
+      return *this;
+    }
+    consume_stripe(_accumulators, _stripe.data());
+    _stripeSize = 0;
+  }
+
+  for (; remain >= _stripe.size();
+       p += _stripe.size(), remain -= _stripe.size()) {
+    consume_stripe(_accumulators, p);
+  }
+
+  if (remain != 0) {
+    std::memcpy(_stripe.data(), p, remain);
+    _stripeSize = remain;
+  }
+
+  return *this;
+}
+
+Hasher64 &Hasher64::update(std::uint64_t value_) {
+  std::array<std::byte, sizeof(value_)> bytes;
+  for (std::size_t iByte = 0; iByte < bytes.size(); ++iByte) {
+    bytes[iByte] = static_cast<std::byte>((value_ >> (8 * iByte)) & 0xFF);
+  }
+  return update(bytes);
+}
+
+std::uint64_t Hasher64::digest() const {
+  std::uint64_t hash = 0;
+  if (_totalLength >= _stripe.size()) {
+    hash = std::rotl(_accumulators[0], 1) + std::rotl(_accumulators[1], 7) +
+           std::rotl(_accumulators[2], 12) + std::rotl(_accumulators[3], 18);
+    for (const auto accumulator : _accumulators) {
+      hash = merge_accumulator(hash, accumulator);
+    }
+  } else {
+    hash = _seed + prime5;
+  }
+
+  hash += _totalLength;
+
+  auto p = _stripe.data();
+  auto remain = _stripeSize;
+  for (; remain >= 8; p += 8, remain -= 8) {
+    hash ^= round(0, read_u64(p));
+    hash = std::rotl(hash, 27) * prime1 + prime4;
+  }
+  if (remain >= 4) {
+    hash ^= static_cast<std::uint64_t>(read_u32(p)) * prime1;
+    hash = std::rotl(hash, 23) * prime2 + prime3;
+    p += 4;
+    remain -= 4;
+  }
+  for (; remain != 0; ++p, --remain) {
+    hash ^= std::to_integer<std::uint8_t>(*p) * prime5;
+    hash = std::rotl(hash, 11) * prime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= prime2;
+  hash ^= hash >> 29;
+  hash *= prime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+std::uint64_t hash64(std::span<const std::byte> data_, std::uint64_t seed_) {
+  return Hasher64{seed_}.update(data_).digest();
+}
+} // namespace bee
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <bee/BEE_API.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#if !defined(__SIZEOF_INT128__) && defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace bee {
+/// <summary>
+/// Incremental 64-bit xxHash(XXH64).
+/// It's not cryptographic, but is fast enough to hash whole input files and
+/// good enough to tell apart their contents.
+/// </summary>
+class BEE_API Hasher64 {
+public:
+  explicit Hasher64(std::uint64_t seed_ = 0);
+
+  Hasher64 &update(std::span<const std::byte> data_);
+
+  Hasher64 &update(std::string_view data_) {
+    return update(std::as_bytes(std::span{data_.data(), data_.size()}));
+  }
+
+  /// <summary>
+  /// Hashes the value's bytes. Handy to hash lengths or flags.
+  /// </summary>
+  Hasher64 &update(std::uint64_t value_);
+
+  /// <summary>
+  /// The hash of all data fed so far. Feeding can continue after this.
+  /// </summary>
+  std::uint64_t digest() const;
+
+private:
+  std::array<std::uint64_t, 4> _accumulators;
+  std::uint64_t _seed;
+  std::uint64_t _totalLength = 0;
+  std::array<std::byte, 32> _stripe;
+  std::size_t _stripeSize = 0;
+};
+
+BEE_API std::uint64_t hash64(std::span<const std::byte> data_,
+                             std::uint64_t seed_ = 0);
+
+/// <summary>
+/// The high and low halves of the 128-bit product, xor-ed.
+/// </summary>
+inline std::uint64_t mul_fold64(std::uint64_t a_, std::uint64_t b_) {
+#if defined(__SIZEOF_INT128__)
+  const auto product = static_cast<unsigned __int128>(a_) * b_;
+  return static_cast<std::uint64_t>(product) ^
+         static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  std::uint64_t high = 0;
+  const auto low = _umul128(a_, b_, &high);
+  return low ^ high;
+#else
+  const std::uint64_t aLow = a_ & 0xFFFFFFFFULL;
+  const std::uint64_t aHigh = a_ >> 32;
+  const std::uint64_t bLow = b_ & 0xFFFFFFFFULL;
+  const std::uint64_t bHigh = b_ >> 32;
+  const std::uint64_t lowLow = aLow * bLow;
+  const std::uint64_t lowHigh = aLow * bHigh;
+  const std::uint64_t highLow = aHigh * bLow;
+  const std::uint64_t highHigh = aHigh * bHigh;
+  const std::uint64_t middle =
+      (lowLow >> 32) + (lowHigh & 0xFFFFFFFFULL) + highLow;
+  const std::uint64_t low = (middle << 32) | (lowLow & 0xFFFFFFFFULL);
+  const std::uint64_t high = highHigh + (lowHigh >> 32) + (middle >> 32);
+  return low ^ high;
+#endif
+}
+
+/// <summary>
+/// Hashes short keys, such as vertices, in the style of wyhash: one
+/// multiply-fold per 16 bytes. Much faster than `hash64()` on keys of tens
+/// of bytes, and as well distributed for hash tables, but it reads words in
+/// native byte order, so its values are only meant for use in memory.
+/// </summary>
+inline std::uint64_t hash64_short(const std::byte *data_,
+                                  std::size_t size_,
+                                  std::uint64_t seed_ = 0) {
+  // https://github.com/wangyi-fudan/wyhash
+  constexpr std::uint64_t secret0 = 0xA0761D6478BD642FULL;
+  constexpr std::uint64_t secret1 = 0xE7037ED1A0B428DBULL;
+  constexpr std::uint64_t secret2 = 0x8EBC6AF09C88C6E3ULL;
+  const auto read = [data_](std::size_t offset_, std::size_t size_) {
+    std::uint64_t value = 0;
+    std::memcpy(&value, data_ + offset_, size_);
+    return value;
+  };
+
+  auto seed = seed_ ^ mul_fold64(seed_ ^ secret0, secret1);
+  std::size_t offset = 0;
+  for (; size_ - offset > 16; offset += 16) {
+    seed = mul_fold64(read(offset, 8) ^ secret1, read(offset + 8, 8) ^ seed);
+  }
+  const auto remain = size_ - offset;
+  std::uint64_t a = 0;
+  std::uint64_t b = 0;
+  if (remain > 8) {
+    a = read(offset, 8);
+    b = read(offset + 8, remain - 8);
+  } else {
+    a = read(offset, remain);
+  }
+  return mul_fold64(secret1 ^ size_,
+                    mul_fold64(a ^ secret1, b ^ seed ^ secret2));
+}
+} // namespace bee
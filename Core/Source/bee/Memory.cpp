@@ -0,0 +1,196 @@
+#include <bee/Memory.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#endif
+
+namespace bee {
+namespace {
+struct AllocationCounters {
+  std::int64_t live = 0;
+  std::int64_t peak = 0;
+};
+
+thread_local AllocationCounters allocationCounters;
+} // namespace
+
+void AllocationTracker::allocated(std::size_t size_) {
+  auto &counters = allocationCounters;
+  counters.live += static_cast<std::int64_t>(size_);
+  counters.peak = std::max(counters.peak, counters.live);
+}
+
+void AllocationTracker::deallocated(std::size_t size_) {
+  allocationCounters.live -= static_cast<std::int64_t>(size_);
+}
+
+std::int64_t AllocationTracker::live() {
+  return allocationCounters.live;
+}
+
+std::int64_t AllocationTracker::peak() {
+  return allocationCounters.peak;
+}
+
+std::int64_t AllocationTracker::reset_peak() {
+  auto &counters = allocationCounters;
+  return std::exchange(counters.peak, counters.live);
+}
+
+void AllocationTracker::merge_peak(std::int64_t peak_) {
+  auto &counters = allocationCounters;
+  counters.peak = std::max(counters.peak, peak_);
+}
+
+namespace {
+/// <summary>
+/// Pages are committed this many bytes at a time at least. A multiple of
+/// the page sizes around, 64KB pages of some ARM Linux included.
+/// </summary>
+constexpr std::size_t arenaCommitGranularity = std::size_t{64} << 10;
+
+std::size_t roundUpToCommitGranularity(std::size_t size_) {
+  return (size_ + arenaCommitGranularity - 1) / arenaCommitGranularity *
+         arenaCommitGranularity;
+}
+} // namespace
+
+VirtualArena::VirtualArena(std::size_t capacity_)
+    : _capacity(roundUpToCommitGranularity(std::max<std::size_t>(
+          capacity_, arenaCommitGranularity))) {
+#ifdef _WIN32
+  const auto data =
+      ::VirtualAlloc(nullptr, _capacity, MEM_RESERVE, PAGE_NOACCESS);
+  if (!data) {
+    throw std::bad_alloc{};
+  }
+#else
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+  flags |= MAP_NORESERVE;
+#endif
+  const auto data = ::mmap(nullptr, _capacity, PROT_NONE, flags, -1, 0);
+  if (data == MAP_FAILED) {
+    throw std::bad_alloc{};
+  }
+#endif
+  _data = static_cast<std::byte *>(data);
+}
+
+VirtualArena::~VirtualArena() {
+#ifdef _WIN32
+  ::VirtualFree(_data, 0, MEM_RELEASE);
+#else
+  ::munmap(_data, _capacity);
+#endif
+  AllocationTracker::deallocated(_committed);
+}
+
+void VirtualArena::trim(std::size_t keep_) {
+  const auto committed =
+      roundUpToCommitGranularity(std::max(keep_, _size));
+  if (committed >= _committed) {
+    return;
+  }
+  const auto decommitted = _committed - committed;
+  // If the pages can't be given back, they're kept as if asked to.
+#ifdef _WIN32
+  if (!::VirtualFree(_data + committed, decommitted, MEM_DECOMMIT)) {
+    return;
+  }
+#else
+  // Replacing the pages drops their contents and makes them inaccessible
+  // again, while keeping the range reserved.
+  if (::mmap(_data + committed, decommitted, PROT_NONE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1,
+             0) == MAP_FAILED) {
+    return;
+  }
+#endif
+  _committed = committed;
+  AllocationTracker::deallocated(decommitted);
+}
+
+void VirtualArena::_commit(std::size_t size_) {
+  if (size_ > _capacity) {
+    throw std::bad_alloc{};
+  }
+  // Committing twice as much each time keeps the number of calls small.
+  const auto committed = std::min(
+      _capacity, roundUpToCommitGranularity(std::max(size_, _committed * 2)));
+#ifdef _WIN32
+  if (!::VirtualAlloc(_data + _committed, committed - _committed, MEM_COMMIT,
+                      PAGE_READWRITE)) {
+    throw std::bad_alloc{};
+  }
+#else
+  if (::mprotect(_data + _committed, committed - _committed,
+                 PROT_READ | PROT_WRITE) != 0) {
+    throw std::bad_alloc{};
+  }
+#endif
+  AllocationTracker::allocated(committed - _committed);
+  _committed = committed;
+}
+
+std::unique_ptr<VirtualArena>
+VirtualArenaPool::acquire(std::size_t capacity_) {
+  {
+    std::unique_lock lock{_mutex};
+    const auto rArena =
+        std::find_if(_arenas.begin(), _arenas.end(),
+                     [capacity_](const std::unique_ptr<VirtualArena> &arena_) {
+                       return arena_->capacity() >= capacity_;
+                     });
+    if (rArena != _arenas.end()) {
+      auto arena = std::move(*rArena);
+      _arenas.erase(rArena);
+      return arena;
+    }
+  }
+  if (capacity_ < defaultCapacity) {
+    try {
+      return std::make_unique<VirtualArena>(defaultCapacity);
+    } catch (const std::bad_alloc &) {
+      // Address space may be limited, what's asked for may still fit.
+    }
+  }
+  return std::make_unique<VirtualArena>(capacity_);
+}
+
+void VirtualArenaPool::release(std::unique_ptr<VirtualArena> arena_) {
+  arena_->clear();
+  arena_->trim(maxKeptBytes);
+  std::unique_lock lock{_mutex};
+  _arenas.push_back(std::move(arena_));
+}
+
+std::uint64_t peak_rss() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters,
+                              sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#else
+  rusage usage;
+  if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+  // In kilobytes.
+  return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+} // namespace bee
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Counts bytes allocated through `TrackingAllocator` and the FBX SDK.
+///
+/// Counters are per thread, so that conversions running side by side on
+/// `BatchConverter` workers are measured separately. A block freed on another
+/// thread than it was allocated on is subtracted from that other thread's
+/// counter, which is why the live count is signed.
+/// </summary>
+class BEE_API AllocationTracker {
+public:
+  static void allocated(std::size_t size_);
+
+  static void deallocated(std::size_t size_);
+
+  /// <summary>
+  /// Bytes currently allocated by this thread.
+  /// </summary>
+  static std::int64_t live();
+
+  /// <summary>
+  /// The high-water mark of `live()` since the last `reset_peak()`.
+  /// </summary>
+  static std::int64_t peak();
+
+  /// <summary>
+  /// Restarts the high-water mark from the current live bytes.
+  /// </summary>
+  /// <returns>The previous high-water mark.</returns>
+  static std::int64_t reset_peak();
+
+  /// <summary>
+  /// Raises the high-water mark to at least `peak_`.
+  /// Used to resume an outer measurement after a nested one.
+  /// </summary>
+  static void merge_peak(std::int64_t peak_);
+};
+
+/// <summary>
+/// `std::allocator` reporting to `AllocationTracker`.
+/// </summary>
+template <typename T> class TrackingAllocator {
+public:
+  using value_type = T;
+
+  TrackingAllocator() noexcept = default;
+
+  template <typename U>
+  TrackingAllocator(const TrackingAllocator<U> &) noexcept {
+  }
+
+  T *allocate(std::size_t n_) {
+    const auto result = std::allocator<T>{}.allocate(n_);
+    AllocationTracker::allocated(sizeof(T) * n_);
+    return result;
+  }
+
+  void deallocate(T *p_, std::size_t n_) noexcept {
+    AllocationTracker::deallocated(sizeof(T) * n_);
+    std::allocator<T>{}.deallocate(p_, n_);
+  }
+
+  template <typename U>
+  bool operator==(const TrackingAllocator<U> &) const noexcept {
+    return true;
+  }
+};
+
+using TrackedBytes = std::vector<std::byte, TrackingAllocator<std::byte>>;
+
+/// <summary>
+/// Contiguous bytes in an address range reserved up front, whose pages are
+/// committed as the bytes grow. So growing never moves them, and pointers
+/// into them stay valid, without a copy or an allocation per block.
+/// Committed pages are reported to `AllocationTracker`.
+/// </summary>
+class BEE_API VirtualArena {
+public:
+  /// <param name="capacity_">
+  /// Bytes to reserve. It costs address space only.
+  /// </param>
+  /// <exception>`std::bad_alloc` if it can't be reserved.</exception>
+  explicit VirtualArena(std::size_t capacity_);
+
+  VirtualArena(const VirtualArena &) = delete;
+
+  VirtualArena &operator=(const VirtualArena &) = delete;
+
+  ~VirtualArena();
+
+  std::byte *data() const {
+    return _data;
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  std::size_t capacity() const {
+    return _capacity;
+  }
+
+  /// <summary>
+  /// Adds `size_` uninitialized bytes at the end.
+  /// </summary>
+  /// <exception>`std::bad_alloc` past the capacity.</exception>
+  std::byte *append(std::size_t size_) {
+    if (_size + size_ > _committed) {
+      _commit(_size + size_);
+    }
+    const auto result = _data + _size;
+    _size += size_;
+    return result;
+  }
+
+  /// <summary>
+  /// Removes `size_` bytes from the end.
+  /// </summary>
+  void pop(std::size_t size_) {
+    _size -= size_;
+  }
+
+  /// <summary>
+  /// Empties it. The committed pages are kept for what's appended next.
+  /// </summary>
+  void clear() {
+    _size = 0;
+  }
+
+  /// <summary>
+  /// Gives back the committed pages past the first `keep_` bytes, or those
+  /// past `size()` if more.
+  /// </summary>
+  void trim(std::size_t keep_);
+
+private:
+  std::byte *_data = nullptr;
+  std::size_t _size = 0;
+  std::size_t _committed = 0;
+  std::size_t _capacity = 0;
+
+  void _commit(std::size_t size_);
+};
+
+/// <summary>
+/// `VirtualArena`s kept for reuse, so that their reservation and committed
+/// pages serve one mesh after another. May be used from several threads.
+/// </summary>
+class BEE_API VirtualArenaPool {
+public:
+  /// <summary>
+  /// An empty arena of at least `capacity_` bytes.
+  /// </summary>
+  /// <exception>`std::bad_alloc` if `capacity_` can't be reserved.</exception>
+  std::unique_ptr<VirtualArena> acquire(std::size_t capacity_);
+
+  /// <summary>
+  /// Takes back an arena, keeping at most `maxKeptBytes` of it committed.
+  /// </summary>
+  void release(std::unique_ptr<VirtualArena> arena_);
+
+  /// <summary>
+  /// Capacity reserved for arenas, unless more is asked for, so that they
+  /// serve larger meshes later. If address space is short, as under
+  /// `ulimit -v`, only what's asked for is reserved.
+  /// </summary>
+  static constexpr std::size_t defaultCapacity =
+      sizeof(void *) >= 8 ? std::size_t{1} << 30 : std::size_t{1} << 26;
+
+  static constexpr std::size_t maxKeptBytes = std::size_t{64} << 20;
+
+private:
+  std::mutex _mutex;
+  std::vector<std::unique_ptr<VirtualArena>> _arenas;
+};
+
+/// <summary>
+/// The peak resident set size of the process so far, in bytes.
+/// 0 if not available.
+/// </summary>
+BEE_API std::uint64_t peak_rss();
+} // namespace bee
@@ -0,0 +1,404 @@
+#include <bee/MeshOptimization.h>
+#include <bee/Memory.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace bee {
+namespace {
+/// <summary>
+/// Size of the cache `optimize_vertex_cache()` models. Larger than those of
+/// actual GPUs, as the scores decay with the position anyway.
+/// </summary>
+constexpr std::uint32_t forsythCacheSize = 32;
+
+/// <summary>
+/// Valences scored separately; higher ones score as this one.
+/// </summary>
+constexpr std::uint32_t forsythMaxValence = 32;
+
+/// <summary>
+/// Size of the FIFO cache `optimize_overdraw()` simulates.
+/// </summary>
+constexpr std::uint32_t overdrawCacheSize = 16;
+
+/// <summary>
+/// Vertex scores of Forsyth's paper, by cache position and by number of
+/// triangles not emitted yet.
+/// </summary>
+struct ForsythScores {
+  std::array<float, forsythCacheSize> cache;
+  std::array<float, forsythMaxValence + 1> valence;
+
+  ForsythScores() {
+    constexpr float cacheDecayPower = 1.5f;
+    constexpr float lastTriangleScore = 0.75f;
+    constexpr float valenceBoostScale = 2.0f;
+    constexpr float valenceBoostPower = 0.5f;
+    for (std::uint32_t i = 0; i < forsythCacheSize; ++i) {
+      // The vertices of the last triangle are scored alike, so that the
+      // order it's been emitted in doesn't matter.
+      cache[i] = i < 3 ? lastTriangleScore
+                       : std::pow(1.0f - static_cast<float>(i - 3) /
+                                             (forsythCacheSize - 3),
+                                  cacheDecayPower);
+    }
+    valence[0] = 0;
+    for (std::uint32_t i = 1; i <= forsythMaxValence; ++i) {
+      // Favors vertices with few triangles left, so that they don't linger.
+      valence[i] =
+          valenceBoostScale * std::pow(static_cast<float>(i), -valenceBoostPower);
+    }
+  }
+
+  float operator()(std::int32_t cache_position_,
+                   std::uint32_t remaining_) const {
+    if (remaining_ == 0) {
+      return -1.0f;
+    }
+    return (cache_position_ >= 0 ? cache[cache_position_] : 0.0f) +
+           valence[std::min(remaining_, forsythMaxValence)];
+  }
+};
+
+/// <summary>
+/// Simulates drawing a triangle with a FIFO cache of `cache_size_` vertices,
+/// in which a vertex is if it's been added within the last `cache_size_`
+/// additions. Advancing `timestamp_` past `cache_size_` empties the cache.
+/// </summary>
+/// <returns>The number of vertices missing from the cache.</returns>
+std::uint32_t drawTriangle(const std::uint32_t *triangle_,
+                           std::uint32_t cache_size_,
+                           std::vector<std::uint32_t> &timestamps_,
+                           std::uint32_t &timestamp_) {
+  std::uint32_t misses = 0;
+  for (int i = 0; i < 3; ++i) {
+    auto &vertexTimestamp = timestamps_[triangle_[i]];
+    if (timestamp_ - vertexTimestamp > cache_size_) {
+      vertexTimestamp = timestamp_++;
+      ++misses;
+    }
+  }
+  return misses;
+}
+
+std::array<float, 3> readPosition(const std::byte *positions_,
+                                  std::size_t position_stride_,
+                                  std::uint32_t vertex_) {
+  std::array<float, 3> position;
+  std::memcpy(position.data(), positions_ + position_stride_ * vertex_,
+              sizeof(position));
+  return position;
+}
+} // namespace
+
+void optimize_vertex_cache(std::span<std::uint32_t> indices_,
+                           std::uint32_t vertex_count_) {
+  assert(indices_.size() % 3 == 0);
+  const auto nTriangles = indices_.size() / 3;
+  if (nTriangles < 2) {
+    return;
+  }
+
+  static const ForsythScores scores;
+
+  // The triangles not emitted yet of each vertex; those of vertex `v` are
+  // the first `remaining[v]` from `vertexTriangles[firstTriangles[v]]`.
+  std::vector<std::uint32_t> remaining(vertex_count_, 0);
+  for (const auto index : indices_) {
+    assert(index < vertex_count_);
+    ++remaining[index];
+  }
+  std::vector<std::size_t> firstTriangles(std::size_t{vertex_count_} + 1, 0);
+  std::inclusive_scan(remaining.begin(), remaining.end(),
+                      firstTriangles.begin() + 1, std::plus<std::size_t>{});
+  std::vector<std::uint32_t> vertexTriangles(indices_.size());
+  {
+    auto ends = firstTriangles;
+    for (std::size_t iIndex = 0; iIndex < indices_.size(); ++iIndex) {
+      vertexTriangles[ends[indices_[iIndex]]++] =
+          static_cast<std::uint32_t>(iIndex / 3);
+    }
+  }
+  const auto trianglesOf = [&](std::uint32_t vertex_) {
+    return std::span{vertexTriangles.data() + firstTriangles[vertex_],
+                     remaining[vertex_]};
+  };
+
+  std::vector<std::int32_t> cachePositions(vertex_count_, -1);
+  std::vector<float> vertexScores(vertex_count_);
+  for (std::uint32_t iVertex = 0; iVertex < vertex_count_; ++iVertex) {
+    vertexScores[iVertex] = scores(-1, remaining[iVertex]);
+  }
+  std::vector<float> triangleScores(nTriangles);
+  for (std::size_t iTriangle = 0; iTriangle < nTriangles; ++iTriangle) {
+    triangleScores[iTriangle] = vertexScores[indices_[3 * iTriangle]] +
+                                vertexScores[indices_[3 * iTriangle + 1]] +
+                                vertexScores[indices_[3 * iTriangle + 2]];
+  }
+  std::vector<bool> emitted(nTriangles, false);
+
+  std::vector<std::uint32_t> output;
+  output.reserve(indices_.size());
+  // The cache, followed by up to 3 vertices just pushed out of it.
+  std::array<std::uint32_t, forsythCacheSize + 3> cache, nextCache;
+  std::size_t cacheSize = 0;
+  auto bestTriangle = static_cast<std::size_t>(
+      std::max_element(triangleScores.begin(), triangleScores.end()) -
+      triangleScores.begin());
+  // Where to look for a triangle once the cache has none left.
+  std::size_t deadEndCursor = 0;
+  for (std::size_t nEmitted = 0; nEmitted < nTriangles; ++nEmitted) {
+    if (bestTriangle == nTriangles) {
+      while (emitted[deadEndCursor]) {
+        ++deadEndCursor;
+      }
+      bestTriangle = deadEndCursor;
+    }
+
+    const auto triangle = &indices_[3 * bestTriangle];
+    emitted[bestTriangle] = true;
+    output.insert(output.end(), triangle, triangle + 3);
+    for (int i = 0; i < 3; ++i) {
+      const auto triangles = trianglesOf(triangle[i]);
+      std::iter_swap(
+          std::find(triangles.begin(), triangles.end(), bestTriangle),
+          triangles.end() - 1);
+      --remaining[triangle[i]];
+    }
+
+    std::size_t nextCacheSize = 0;
+    for (int i = 0; i < 3; ++i) {
+      if (std::find(nextCache.begin(), nextCache.begin() + nextCacheSize,
+                    triangle[i]) == nextCache.begin() + nextCacheSize) {
+        nextCache[nextCacheSize++] = triangle[i];
+      }
+    }
+    for (std::size_t i = 0; i < cacheSize; ++i) {
+      const auto vertex = cache[i];
+      if (vertex != triangle[0] && vertex != triangle[1] &&
+          vertex != triangle[2]) {
+        nextCache[nextCacheSize++] = vertex;
+      }
+    }
+
+    for (std::size_t i = 0; i < nextCacheSize; ++i) {
+      const auto vertex = nextCache[i];
+      const auto cachePosition =
+          i < forsythCacheSize ? static_cast<std::int32_t>(i) : -1;
+      cachePositions[vertex] = cachePosition;
+      const auto score = scores(cachePosition, remaining[vertex]);
+      const auto delta = score - vertexScores[vertex];
+      vertexScores[vertex] = score;
+      for (const auto iTriangle : trianglesOf(vertex)) {
+        triangleScores[iTriangle] += delta;
+      }
+    }
+    cache = nextCache;
+    cacheSize = std::min<std::size_t>(nextCacheSize, forsythCacheSize);
+
+    bestTriangle = nTriangles;
+    auto bestScore = -std::numeric_limits<float>::infinity();
+    for (std::size_t i = 0; i < cacheSize; ++i) {
+      for (const auto iTriangle : trianglesOf(cache[i])) {
+        if (triangleScores[iTriangle] > bestScore) {
+          bestScore = triangleScores[iTriangle];
+          bestTriangle = iTriangle;
+        }
+      }
+    }
+  }
+
+  std::copy(output.begin(), output.end(), indices_.begin());
+}
+
+void optimize_overdraw(std::span<std::uint32_t> indices_,
+                       const std::byte *positions_,
+                       std::size_t position_stride_,
+                       std::uint32_t vertex_count_,
+                       float threshold_) {
+  assert(indices_.size() % 3 == 0);
+  const auto nTriangles = indices_.size() / 3;
+  if (nTriangles < 2) {
+    return;
+  }
+
+  std::vector<std::uint32_t> timestamps(vertex_count_, 0);
+  auto timestamp = overdrawCacheSize + 1;
+  const auto flushCache = [&timestamp]() {
+    timestamp += overdrawCacheSize + 1;
+  };
+
+  // Hard boundaries: triangles missing all their vertices, as where the
+  // vertex cache order had to start over.
+  std::vector<std::size_t> hardClusters;
+  for (std::size_t iTriangle = 0; iTriangle < nTriangles; ++iTriangle) {
+    const auto misses = drawTriangle(&indices_[3 * iTriangle],
+                                     overdrawCacheSize, timestamps, timestamp);
+    if (iTriangle == 0 || misses == 3) {
+      hardClusters.push_back(iTriangle);
+    }
+  }
+
+  // Soft boundaries: a cluster is cut as soon as its triangles so far, drawn
+  // from an empty cache, are within the threshold of the cluster's misses.
+  std::vector<std::size_t> clusters;
+  for (std::size_t iCluster = 0; iCluster < hardClusters.size(); ++iCluster) {
+    const auto start = hardClusters[iCluster];
+    const auto end = iCluster + 1 < hardClusters.size()
+                         ? hardClusters[iCluster + 1]
+                         : nTriangles;
+    flushCache();
+    std::uint32_t clusterMisses = 0;
+    for (auto iTriangle = start; iTriangle < end; ++iTriangle) {
+      clusterMisses += drawTriangle(&indices_[3 * iTriangle],
+                                    overdrawCacheSize, timestamps, timestamp);
+    }
+    const auto maxMissRatio =
+        threshold_ * static_cast<float>(clusterMisses) / (end - start);
+
+    clusters.push_back(start);
+    flushCache();
+    std::uint32_t misses = 0;
+    std::size_t triangles = 0;
+    for (auto iTriangle = start; iTriangle < end; ++iTriangle) {
+      misses += drawTriangle(&indices_[3 * iTriangle], overdrawCacheSize,
+                             timestamps, timestamp);
+      ++triangles;
+      if (static_cast<float>(misses) / triangles <= maxMissRatio) {
+        clusters.push_back(iTriangle + 1);
+        flushCache();
+        misses = 0;
+        triangles = 0;
+      }
+    }
+    // The last cut leaves the remaining triangles, often few and so with
+    // many misses, on their own; they're merged into the cluster before.
+    if (clusters.back() != start) {
+      clusters.pop_back();
+    }
+  }
+
+  // Clusters facing away from the mesh's center come first.
+  std::array<double, 3> meshCenter = {0, 0, 0};
+  for (const auto index : indices_) {
+    const auto position = readPosition(positions_, position_stride_, index);
+    for (int i = 0; i < 3; ++i) {
+      meshCenter[i] += position[i];
+    }
+  }
+  for (auto &component : meshCenter) {
+    component /= static_cast<double>(indices_.size());
+  }
+  std::vector<double> clusterKeys(clusters.size());
+  for (std::size_t iCluster = 0; iCluster < clusters.size(); ++iCluster) {
+    const auto end = iCluster + 1 < clusters.size() ? clusters[iCluster + 1]
+                                                    : nTriangles;
+    std::array<double, 3> center = {0, 0, 0};
+    std::array<double, 3> normal = {0, 0, 0};
+    double area = 0;
+    for (auto iTriangle = clusters[iCluster]; iTriangle < end; ++iTriangle) {
+      const auto a =
+          readPosition(positions_, position_stride_, indices_[3 * iTriangle]);
+      const auto b = readPosition(positions_, position_stride_,
+                                  indices_[3 * iTriangle + 1]);
+      const auto c = readPosition(positions_, position_stride_,
+                                  indices_[3 * iTriangle + 2]);
+      const std::array<double, 3> ab = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+      const std::array<double, 3> ac = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+      // Twice the area, along the face normal.
+      const std::array<double, 3> cross = {ab[1] * ac[2] - ab[2] * ac[1],
+                                           ab[2] * ac[0] - ab[0] * ac[2],
+                                           ab[0] * ac[1] - ab[1] * ac[0]};
+      const auto triangleArea = std::sqrt(
+          cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+      for (int i = 0; i < 3; ++i) {
+        center[i] += (a[i] + b[i] + c[i]) / 3 * triangleArea;
+        normal[i] += cross[i];
+      }
+      area += triangleArea;
+    }
+    const auto normalLength = std::sqrt(
+        normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    double key = 0;
+    if (area > 0 && normalLength > 0) {
+      for (int i = 0; i < 3; ++i) {
+        key += (center[i] / area - meshCenter[i]) * normal[i] / normalLength;
+      }
+    }
+    clusterKeys[iCluster] = key;
+  }
+
+  std::vector<std::size_t> clusterOrder(clusters.size());
+  std::iota(clusterOrder.begin(), clusterOrder.end(), std::size_t{0});
+  std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+                   [&clusterKeys](std::size_t lhs_, std::size_t rhs_) {
+                     return clusterKeys[lhs_] > clusterKeys[rhs_];
+                   });
+
+  std::vector<std::uint32_t> output;
+  output.reserve(indices_.size());
+  for (const auto iCluster : clusterOrder) {
+    const auto end = iCluster + 1 < clusters.size() ? clusters[iCluster + 1]
+                                                    : nTriangles;
+    output.insert(output.end(), indices_.begin() + 3 * clusters[iCluster],
+                  indices_.begin() + 3 * end);
+  }
+  std::copy(output.begin(), output.end(), indices_.begin());
+}
+
+void optimize_vertex_fetch(std::span<std::uint32_t> indices_,
+                           std::byte *vertices_,
+                           std::size_t vertex_size_,
+                           std::uint32_t vertex_count_) {
+  constexpr auto noVertex = std::numeric_limits<std::uint32_t>::max();
+  std::vector<std::uint32_t> newVertices(vertex_count_, noVertex);
+  std::uint32_t nNewVertices = 0;
+  for (auto &index : indices_) {
+    assert(index < vertex_count_);
+    if (newVertices[index] == noVertex) {
+      newVertices[index] = nNewVertices++;
+    }
+    index = newVertices[index];
+  }
+  if (nNewVertices == vertex_count_ &&
+      std::is_sorted(newVertices.begin(), newVertices.end())) {
+    return;
+  }
+  for (auto &newVertex : newVertices) {
+    if (newVertex == noVertex) {
+      newVertex = nNewVertices++;
+    }
+  }
+
+  const TrackedBytes oldVertices(vertices_,
+                                 vertices_ + vertex_size_ * vertex_count_);
+  for (std::uint32_t iVertex = 0; iVertex < vertex_count_; ++iVertex) {
+    std::memcpy(vertices_ + vertex_size_ * newVertices[iVertex],
+                oldVertices.data() + vertex_size_ * iVertex, vertex_size_);
+  }
+}
+
+float average_cache_miss_ratio(std::span<const std::uint32_t> indices_,
+                               std::uint32_t vertex_count_,
+                               std::uint32_t cache_size_) {
+  const auto nTriangles = indices_.size() / 3;
+  if (nTriangles == 0) {
+    return 0;
+  }
+  std::vector<std::uint32_t> timestamps(vertex_count_, 0);
+  auto timestamp = cache_size_ + 1;
+  std::size_t misses = 0;
+  for (std::size_t iTriangle = 0; iTriangle < nTriangles; ++iTriangle) {
+    misses +=
+        drawTriangle(&indices_[3 * iTriangle], cache_size_, timestamps,
+                     timestamp);
+  }
+  return static_cast<float>(misses) / nTriangles;
+}
+} // namespace bee
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace bee {
+/// <summary>
+/// Reorders the triangles of a triangle list so that consecutive triangles
+/// share vertices, for the GPU's post-transform vertex cache to hit more
+/// often. It's Tom Forsyth's "Linear-Speed Vertex Cache Optimisation":
+/// triangles are emitted greedily, picking the one whose vertices score the
+/// highest, by how recently they were used and how few triangles they have
+/// left.
+/// </summary>
+void optimize_vertex_cache(std::span<std::uint32_t> indices_,
+                           std::uint32_t vertex_count_);
+
+/// <summary>
+/// Reorders clusters of triangles, as left by `optimize_vertex_cache()`, so
+/// that those facing outwards from the mesh's center come first and occlude
+/// the rest, which then fail the depth test rather than being shaded.
+/// Clusters are where the vertex cache restarts, split further as long as
+/// each keeps its cache misses per triangle within `threshold_` times those
+/// of the whole, so that the cache efficiency isn't traded away.
+/// </summary>
+/// <param name="positions_">
+/// The position of each vertex, as 3 floats `position_stride_` bytes apart.
+/// </param>
+/// <param name="threshold_">
+/// Cache misses per triangle allowed, relative to those before; such as 1.05.
+/// </param>
+void optimize_overdraw(std::span<std::uint32_t> indices_,
+                       const std::byte *positions_,
+                       std::size_t position_stride_,
+                       std::uint32_t vertex_count_,
+                       float threshold_);
+
+/// <summary>
+/// Reorders the vertices, of `vertex_size_` bytes each, in the order the
+/// indices first use them, and updates the indices accordingly, so that
+/// vertices are fetched from memory sequentially.
+/// Unused vertices are moved last.
+/// </summary>
+void optimize_vertex_fetch(std::span<std::uint32_t> indices_,
+                           std::byte *vertices_,
+                           std::size_t vertex_size_,
+                           std::uint32_t vertex_count_);
+
+/// <summary>
+/// Average cache misses per triangle, or ACMR, of drawing the triangles
+/// with a FIFO post-transform cache of `cache_size_` vertices.
+/// 3 means no vertex is ever reused; 0.5 is about the best for a grid.
+/// </summary>
+float average_cache_miss_ratio(std::span<const std::uint32_t> indices_,
+                               std::uint32_t vertex_count_,
+                               std::uint32_t cache_size_ = 16);
+} // namespace bee
@@ -0,0 +1,632 @@
+#include <bee/MeshSimplification.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <unordered_map>
+
+namespace bee {
+namespace {
+using Vec3 = std::array<float, 3>;
+
+constexpr auto noVertex = std::numeric_limits<std::uint32_t>::max();
+
+/// <summary>
+/// How much more the planes along borders and seams weigh than those of
+/// triangles, so that they keep their shape.
+/// </summary>
+constexpr float boundaryWeight = 10.0f;
+
+Vec3 subtract(const Vec3 &a_, const Vec3 &b_) {
+  return {a_[0] - b_[0], a_[1] - b_[1], a_[2] - b_[2]};
+}
+
+Vec3 cross(const Vec3 &a_, const Vec3 &b_) {
+  return {a_[1] * b_[2] - a_[2] * b_[1], a_[2] * b_[0] - a_[0] * b_[2],
+          a_[0] * b_[1] - a_[1] * b_[0]};
+}
+
+float dot(const Vec3 &a_, const Vec3 &b_) {
+  return a_[0] * b_[0] + a_[1] * b_[1] + a_[2] * b_[2];
+}
+
+/// <summary>
+/// Normalizes the vector in place, returning its length before.
+/// </summary>
+float normalize(Vec3 &v_) {
+  const auto length = std::sqrt(dot(v_, v_));
+  if (length > 0) {
+    for (auto &component : v_) {
+      component /= length;
+    }
+  }
+  return length;
+}
+
+/// <summary>
+/// Sum of the squared distances to planes, weighted.
+/// </summary>
+struct Quadric {
+  // The symmetric 4x4 matrix: a00, a11, a22, a10, a20, a21, b0, b1, b2, c.
+  std::array<double, 10> m{};
+  double weight = 0;
+
+  /// <summary>
+  /// Adds the squared `normal_ · p + distance_`, whose normal needn't be a
+  /// unit one, leaving the weight for the caller to add.
+  /// </summary>
+  void addSquare(const Vec3 &normal_, double distance_, double weight_) {
+    const double x = normal_[0], y = normal_[1], z = normal_[2];
+    const auto d = distance_;
+    const std::array<double, 10> square = {
+        x * x, y * y, z * z, y * x, z * x, z * y, x * d, y * d, z * d, d * d};
+    for (std::size_t i = 0; i < m.size(); ++i) {
+      m[i] += square[i] * weight_;
+    }
+  }
+
+  void addPlane(const Vec3 &normal_, float distance_, float weight_) {
+    addSquare(normal_, distance_, weight_);
+    weight += weight_;
+  }
+
+  Quadric &operator+=(const Quadric &that_) {
+    for (std::size_t i = 0; i < m.size(); ++i) {
+      m[i] += that_.m[i];
+    }
+    weight += that_.weight;
+    return *this;
+  }
+
+  /// <summary>
+  /// The weighted sum of the squared distances of the point to the planes.
+  /// </summary>
+  double sum(const Vec3 &p_) const {
+    const double x = p_[0], y = p_[1], z = p_[2];
+    return m[0] * x * x + m[1] * y * y + m[2] * z * z +
+           2 * (m[3] * x * y + m[4] * x * z + m[5] * y * z) +
+           2 * (m[6] * x + m[7] * y + m[8] * z) + m[9];
+  }
+
+  /// <summary>
+  /// The mean squared distance of the point to the planes.
+  /// </summary>
+  double error(const Vec3 &p_) const {
+    return weight > 0 ? std::abs(sum(p_)) / weight : 0;
+  }
+};
+
+enum class VertexKind : std::uint8_t {
+  manifold,
+  /// <summary>
+  /// On a single mesh border.
+  /// </summary>
+  border,
+  /// <summary>
+  /// On a single attribute seam, which it shares its position with the
+  /// vertex across of.
+  /// </summary>
+  seam,
+  locked,
+};
+
+constexpr std::size_t kindCount = 4;
+
+/// <summary>
+/// Whether a vertex may collapse onto another, by kind.
+/// </summary>
+constexpr bool canCollapse[kindCount][kindCount] = {
+    {true, true, true, true},
+    {false, true, false, true},
+    {false, false, true, true},
+    {false, false, false, false},
+};
+
+/// <summary>
+/// Whether an edge between two kinds of vertices shows up both ways.
+/// </summary>
+constexpr bool hasOpposite[kindCount][kindCount] = {
+    {true, true, true, true},
+    {true, false, true, false},
+    {true, true, true, true},
+    {true, false, true, false},
+};
+
+/// <summary>
+/// Edges of each vertex, to the vertices after and before it in each of its
+/// triangles.
+/// </summary>
+class EdgeAdjacency {
+public:
+  struct Edge {
+    std::uint32_t next;
+    std::uint32_t prev;
+  };
+
+  EdgeAdjacency(std::span<const std::uint32_t> indices_,
+                const std::vector<std::uint32_t> &remap_)
+      : _offsets(remap_.size() + 1, 0), _edges(indices_.size()) {
+    for (const auto index : indices_) {
+      ++_offsets[remap_[index] + 1];
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+    auto fill = _offsets;
+    for (std::size_t i = 0; i < indices_.size(); i += 3) {
+      for (std::size_t k = 0; k < 3; ++k) {
+        const auto v = remap_[indices_[i + k]];
+        _edges[fill[v]++] = {remap_[indices_[i + (k + 1) % 3]],
+                             remap_[indices_[i + (k + 2) % 3]]};
+      }
+    }
+  }
+
+  std::span<const Edge> operator[](std::uint32_t vertex_) const {
+    return {_edges.data() + _offsets[vertex_],
+            _edges.data() + _offsets[vertex_ + 1]};
+  }
+
+  bool hasEdge(std::uint32_t from_, std::uint32_t to_) const {
+    const auto edges = (*this)[from_];
+    return std::any_of(edges.begin(), edges.end(),
+                       [to_](const Edge &edge_) { return edge_.next == to_; });
+  }
+
+private:
+  std::vector<std::size_t> _offsets;
+  std::vector<Edge> _edges;
+};
+
+struct PositionKey {
+  std::array<std::uint32_t, 3> bits;
+
+  bool operator==(const PositionKey &) const = default;
+
+  struct Hash {
+    std::size_t operator()(const PositionKey &key_) const noexcept {
+      std::size_t hash = 0;
+      for (const auto bits : key_.bits) {
+        hash = hash * 0x9e3779b1u + bits;
+      }
+      return hash;
+    }
+  };
+};
+
+struct Collapse {
+  std::uint32_t from;
+  std::uint32_t to;
+  bool bidirectional;
+  double error;
+};
+
+bool hasTriangleFlip(const Vec3 &a_,
+                     const Vec3 &b_,
+                     const Vec3 &c_,
+                     const Vec3 &d_) {
+  const auto ab = subtract(b_, a_);
+  return dot(cross(ab, subtract(c_, a_)), cross(ab, subtract(d_, a_))) <= 0;
+}
+} // namespace
+
+float simplify_mesh(std::vector<std::uint32_t> &indices_,
+                    const SimplificationVertices &vertices_,
+                    std::size_t target_index_count_,
+                    float target_error_) {
+  assert(indices_.size() % 3 == 0);
+  const auto nVertices = vertices_.count;
+  const auto vertex = [&vertices_](std::uint32_t index_) {
+    return vertices_.data + vertices_.size * index_;
+  };
+
+  // Positions within the unit cube, so that errors are relative to the
+  // extent of the mesh.
+  std::vector<Vec3> positions(nVertices);
+  Vec3 minPosition;
+  minPosition.fill(std::numeric_limits<float>::max());
+  Vec3 maxPosition;
+  maxPosition.fill(std::numeric_limits<float>::lowest());
+  for (std::uint32_t v = 0; v < nVertices; ++v) {
+    std::memcpy(positions[v].data(), vertex(v), sizeof(Vec3));
+    for (int iAxis = 0; iAxis < 3; ++iAxis) {
+      minPosition[iAxis] = std::min(minPosition[iAxis], positions[v][iAxis]);
+      maxPosition[iAxis] = std::max(maxPosition[iAxis], positions[v][iAxis]);
+    }
+  }
+  float extent = 0;
+  for (int iAxis = 0; iAxis < 3; ++iAxis) {
+    extent = std::max(extent, maxPosition[iAxis] - minPosition[iAxis]);
+  }
+  const auto positionScale = extent > 0 ? 1 / extent : 0.0f;
+  for (auto &position : positions) {
+    for (int iAxis = 0; iAxis < 3; ++iAxis) {
+      position[iAxis] = (position[iAxis] - minPosition[iAxis]) * positionScale;
+    }
+  }
+
+  // Vertices at the same position are remapped to the first of them, and
+  // linked in a ring by `wedge`.
+  std::vector<std::uint32_t> remap(nVertices);
+  std::vector<std::uint32_t> wedge(nVertices);
+  {
+    std::unordered_map<PositionKey, std::uint32_t, PositionKey::Hash>
+        positionVertices;
+    positionVertices.reserve(nVertices);
+    for (std::uint32_t v = 0; v < nVertices; ++v) {
+      PositionKey key;
+      std::memcpy(key.bits.data(), vertex(v), sizeof(key.bits));
+      const auto [rFirst, inserted] = positionVertices.emplace(key, v);
+      const auto first = rFirst->second;
+      remap[v] = first;
+      wedge[v] = v;
+      if (!inserted) {
+        wedge[v] = wedge[first];
+        wedge[first] = v;
+      }
+    }
+  }
+
+  // Attributes, scaled so that squared differences are weighted.
+  std::size_t nComponents = 0;
+  for (const auto &attribute : vertices_.attributes) {
+    nComponents += attribute.components;
+  }
+  std::vector<float> attributes(std::size_t{nVertices} * nComponents);
+  for (std::uint32_t v = 0; v < nVertices; ++v) {
+    auto out = attributes.data() + nComponents * v;
+    for (const auto &attribute : vertices_.attributes) {
+      const auto scale =
+          std::sqrt(attribute.weight) *
+          (attribute.positional ? positionScale : 1.0f);
+      std::memcpy(out, vertex(v) + attribute.offset,
+                  sizeof(float) * attribute.components);
+      for (std::uint32_t i = 0; i < attribute.components; ++i) {
+        out[i] *= scale;
+      }
+      out += attribute.components;
+    }
+  }
+  const auto attributesOf = [&attributes, nComponents](std::uint32_t v_) {
+    return attributes.data() + nComponents * v_;
+  };
+
+  const auto shares = [&vertex, &vertices_](std::uint32_t a_,
+                                            std::uint32_t b_) {
+    return std::all_of(
+        vertices_.shared.begin(), vertices_.shared.end(),
+        [a = vertex(a_), b = vertex(b_)](const auto &range_) {
+          return std::memcmp(a + range_.first, b + range_.first,
+                             range_.second) == 0;
+        });
+  };
+
+  // Open edges are those not shared the other way by another triangle.
+  // `loop` is where the one leaving each vertex goes, and `loopback` where
+  // the one reaching it comes from; the vertex itself if there are several.
+  std::vector<std::uint32_t> loop(nVertices, noVertex);
+  std::vector<std::uint32_t> loopback(nVertices, noVertex);
+  {
+    std::vector<std::uint32_t> identity(nVertices);
+    std::iota(identity.begin(), identity.end(), 0);
+    const EdgeAdjacency adjacency{indices_, identity};
+    for (std::uint32_t v = 0; v < nVertices; ++v) {
+      for (const auto &edge : adjacency[v]) {
+        if (edge.next != v && !adjacency.hasEdge(edge.next, v)) {
+          loop[v] = loop[v] == noVertex ? edge.next : v;
+          loopback[edge.next] =
+              loopback[edge.next] == noVertex ? v : edge.next;
+        }
+      }
+    }
+  }
+
+  std::vector<VertexKind> kinds(nVertices, VertexKind::locked);
+  for (std::uint32_t v = 0; v < nVertices; ++v) {
+    if (remap[v] != v) {
+      continue;
+    }
+    const auto isSingle = [&loop, &loopback](std::uint32_t v_) {
+      return loop[v_] != noVertex && loop[v_] != v_ &&
+             loopback[v_] != noVertex && loopback[v_] != v_;
+    };
+    if (wedge[v] == v) {
+      if (loop[v] == noVertex && loopback[v] == noVertex) {
+        kinds[v] = VertexKind::manifold;
+      } else if (isSingle(v)) {
+        kinds[v] = VertexKind::border;
+      }
+    } else if (const auto w = wedge[v]; wedge[w] == v) {
+      // The open edges of both sides of a seam meet at the same positions.
+      if (isSingle(v) && isSingle(w) && remap[loop[v]] == remap[loopback[w]] &&
+          remap[loopback[v]] == remap[loop[w]] &&
+          remap[loop[v]] != remap[loopback[v]]) {
+        kinds[v] = VertexKind::seam;
+      }
+    }
+  }
+  for (std::uint32_t v = 0; v < nVertices; ++v) {
+    kinds[v] = kinds[remap[v]];
+  }
+  const auto kindIndex = [&kinds](std::uint32_t v_) {
+    return static_cast<std::size_t>(kinds[v_]);
+  };
+  const auto isBoundary = [&kinds](std::uint32_t v_) {
+    return kinds[v_] == VertexKind::border || kinds[v_] == VertexKind::seam;
+  };
+
+  // Quadrics of positions, by the first vertex there.
+  // Those of attributes are by vertex: each component is taken as varying
+  // linearly over each triangle, `gradient · p + offset`, and the error is
+  // the squared difference of that to the component of the vertex collapsed
+  // onto. The quadric holds the squares of the linear functions, and
+  // `attributeGradients` their weighted gradients and offsets.
+  std::vector<Quadric> quadrics(nVertices);
+  std::vector<Quadric> attributeQuadrics(nVertices);
+  std::vector<double> attributeGradients(attributes.size() * 4);
+  for (std::size_t i = 0; i < indices_.size(); i += 3) {
+    const auto p0 = positions[indices_[i]];
+    const auto e1 = subtract(positions[indices_[i + 1]], p0);
+    const auto e2 = subtract(positions[indices_[i + 2]], p0);
+    auto normal = cross(e1, e2);
+    const auto area = normalize(normal);
+    for (std::size_t k = 0; k < 3; ++k) {
+      const auto v = indices_[i + k];
+      quadrics[remap[v]].addPlane(normal, -dot(normal, p0), area);
+    }
+
+    if (area > 0) {
+      // So that `gradient · e1` and `gradient · e2` are the differences.
+      const auto g1 = cross(e2, normal);
+      const auto g2 = cross(normal, e1);
+      const auto a0 = attributesOf(indices_[i]);
+      const auto a1 = attributesOf(indices_[i + 1]);
+      const auto a2 = attributesOf(indices_[i + 2]);
+      for (std::size_t c = 0; c < nComponents; ++c) {
+        const auto d1 = (a1[c] - a0[c]) / area;
+        const auto d2 = (a2[c] - a0[c]) / area;
+        const Vec3 gradient = {g1[0] * d1 + g2[0] * d2, g1[1] * d1 + g2[1] * d2,
+                               g1[2] * d1 + g2[2] * d2};
+        const auto offset = a0[c] - dot(gradient, p0);
+        for (std::size_t k = 0; k < 3; ++k) {
+          const auto v = indices_[i + k];
+          attributeQuadrics[v].addSquare(gradient, offset, area);
+          const auto sums =
+              attributeGradients.data() + (nComponents * v + c) * 4;
+          for (int iAxis = 0; iAxis < 3; ++iAxis) {
+            sums[iAxis] += gradient[iAxis] * area;
+          }
+          sums[3] += offset * area;
+        }
+      }
+      for (std::size_t k = 0; k < 3; ++k) {
+        attributeQuadrics[indices_[i + k]].weight += area;
+      }
+    }
+
+    for (std::size_t k = 0; k < 3; ++k) {
+      const auto i0 = indices_[i + k];
+      const auto i1 = indices_[i + (k + 1) % 3];
+      const auto i2 = indices_[i + (k + 2) % 3];
+      // Along a border or seam, rather than across.
+      if (!isBoundary(i0) && !isBoundary(i1)) {
+        continue;
+      }
+      if ((isBoundary(i0) && loop[i0] != i1) ||
+          (isBoundary(i1) && loopback[i1] != i0)) {
+        continue;
+      }
+      // Seams show up once on each side.
+      if (hasOpposite[kindIndex(i0)][kindIndex(i1)] && remap[i1] > remap[i0]) {
+        continue;
+      }
+      const auto &q0 = positions[i0];
+      auto edge = subtract(positions[i1], q0);
+      const auto length = normalize(edge);
+      // The plane through the edge, perpendicular to the triangle.
+      const auto toOpposite = subtract(positions[i2], q0);
+      const auto along = dot(toOpposite, edge);
+      Vec3 perpendicular = {toOpposite[0] - edge[0] * along,
+                            toOpposite[1] - edge[1] * along,
+                            toOpposite[2] - edge[2] * along};
+      normalize(perpendicular);
+      const auto distance = -dot(perpendicular, q0);
+      quadrics[remap[i0]].addPlane(perpendicular, distance,
+                                   length * boundaryWeight);
+      quadrics[remap[i1]].addPlane(perpendicular, distance,
+                                   length * boundaryWeight);
+    }
+  }
+
+  // The mean squared difference of the attributes over the triangles
+  // collapsed into `from_` to those of `to_`, at its position.
+  const auto attributeError = [&](std::uint32_t from_, std::uint32_t to_) {
+    const auto &quadric = attributeQuadrics[from_];
+    if (quadric.weight <= 0) {
+      return 0.0;
+    }
+    const auto &p = positions[to_];
+    const auto values = attributesOf(to_);
+    auto error = quadric.sum(p);
+    for (std::size_t c = 0; c < nComponents; ++c) {
+      const auto sums =
+          attributeGradients.data() + (nComponents * from_ + c) * 4;
+      const auto linear =
+          sums[0] * p[0] + sums[1] * p[1] + sums[2] * p[2] + sums[3];
+      error += quadric.weight * values[c] * values[c] - 2 * values[c] * linear;
+    }
+    return std::abs(error) / quadric.weight;
+  };
+  const auto mergeAttributes = [&](std::uint32_t into_, std::uint32_t from_) {
+    attributeQuadrics[into_] += attributeQuadrics[from_];
+    const auto size = nComponents * 4;
+    for (std::size_t i = 0; i < size; ++i) {
+      attributeGradients[size * into_ + i] +=
+          attributeGradients[size * from_ + i];
+    }
+  };
+  // The vertex across the seam of `from_` and the one it collapses onto.
+  const auto seamPair = [&](std::uint32_t from_, std::uint32_t to_) {
+    const auto across = wedge[from_];
+    return std::pair{across,
+                     loop[from_] == to_ ? loopback[across] : loop[across]};
+  };
+  const auto collapseError = [&](std::uint32_t from_, std::uint32_t to_) {
+    auto error = quadrics[remap[from_]].error(positions[to_]) +
+                 attributeError(from_, to_);
+    if (kinds[from_] == VertexKind::seam) {
+      const auto [acrossFrom, acrossTo] = seamPair(from_, to_);
+      error = shares(acrossFrom, acrossTo)
+                  ? error + attributeError(acrossFrom, acrossTo)
+                  : std::numeric_limits<double>::infinity();
+    }
+    return error;
+  };
+
+  const double errorLimit = double{target_error_} * target_error_;
+  double resultError = 0;
+  std::vector<std::uint32_t> result = indices_;
+  std::vector<Collapse> collapses;
+  std::vector<std::uint32_t> collapseRemap(nVertices);
+  std::vector<bool> collapseLocked(nVertices);
+  while (result.size() > target_index_count_) {
+    collapses.clear();
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+      for (std::size_t k = 0; k < 3; ++k) {
+        const auto i0 = result[i + k];
+        const auto i1 = result[i + (k + 1) % 3];
+        const auto k0 = kindIndex(i0);
+        const auto k1 = kindIndex(i1);
+        const auto forward = canCollapse[k0][k1];
+        const auto backward = canCollapse[k1][k0];
+        if ((!forward && !backward) || remap[i0] == remap[i1]) {
+          continue;
+        }
+        if (hasOpposite[k0][k1] && remap[i1] > remap[i0]) {
+          continue;
+        }
+        // Along the same border or seam only.
+        if (k0 == k1 && isBoundary(i0) && loop[i0] != i1) {
+          continue;
+        }
+        if (!shares(i0, i1)) {
+          continue;
+        }
+        collapses.push_back(
+            {forward ? i0 : i1, forward ? i1 : i0, forward && backward, 0});
+      }
+    }
+    if (collapses.empty()) {
+      break;
+    }
+
+    for (auto &collapse : collapses) {
+      collapse.error = collapseError(collapse.from, collapse.to);
+      if (collapse.bidirectional) {
+        if (const auto backError = collapseError(collapse.to, collapse.from);
+            backError < collapse.error) {
+          std::swap(collapse.from, collapse.to);
+          collapse.error = backError;
+        }
+      }
+    }
+    std::stable_sort(collapses.begin(), collapses.end(),
+                     [](const Collapse &a_, const Collapse &b_) {
+                       return a_.error < b_.error;
+                     });
+
+    // Collapses sharing a vertex with one done already wait for the next
+    // pass, so each pass does a part of what's left, up to an error a bit
+    // beyond that of the part.
+    const auto triangleGoal = (result.size() - target_index_count_) / 3;
+    const auto edgeGoal = triangleGoal / 2;
+    const auto errorGoal = edgeGoal < collapses.size()
+                               ? 1.5 * collapses[edgeGoal].error
+                               : std::numeric_limits<double>::infinity();
+    const EdgeAdjacency adjacency{result, remap};
+    const auto flips = [&](std::uint32_t from_, std::uint32_t to_) {
+      for (const auto &edge : adjacency[from_]) {
+        const auto a = remap[collapseRemap[edge.next]];
+        const auto b = remap[collapseRemap[edge.prev]];
+        // Triangles collapsed by this collapse or by an earlier one.
+        if (a == to_ || b == to_ || a == b) {
+          continue;
+        }
+        if (hasTriangleFlip(positions[a], positions[b], positions[from_],
+                            positions[to_])) {
+          return true;
+        }
+      }
+      return false;
+    };
+    std::iota(collapseRemap.begin(), collapseRemap.end(), 0);
+    std::fill(collapseLocked.begin(), collapseLocked.end(), false);
+    std::size_t triangleCollapses = 0;
+    std::size_t edgeCollapses = 0;
+    for (const auto &[from, to, bidirectional, error] : collapses) {
+      const auto r0 = remap[from];
+      const auto r1 = remap[to];
+      if (collapseLocked[r0] || collapseLocked[r1]) {
+        continue;
+      }
+      if (error > errorLimit || triangleCollapses >= triangleGoal ||
+          (error > errorGoal && triangleCollapses > triangleGoal / 6)) {
+        break;
+      }
+      if (flips(r0, r1)) {
+        continue;
+      }
+      if (kinds[from] == VertexKind::seam) {
+        const auto [acrossFrom, acrossTo] = seamPair(from, to);
+        collapseRemap[acrossFrom] = acrossTo;
+        mergeAttributes(acrossTo, acrossFrom);
+      }
+      collapseRemap[from] = to;
+      mergeAttributes(to, from);
+      quadrics[r1] += quadrics[r0];
+      collapseLocked[r0] = true;
+      collapseLocked[r1] = true;
+      // Border edges have a single triangle.
+      triangleCollapses += kinds[from] == VertexKind::border ? 1 : 2;
+      ++edgeCollapses;
+      resultError = std::max(resultError, error);
+    }
+    if (edgeCollapses == 0) {
+      break;
+    }
+
+    for (auto *edgeLoop : {&loop, &loopback}) {
+      for (std::uint32_t v = 0; v < nVertices; ++v) {
+        const auto next = (*edgeLoop)[v];
+        if (next == noVertex) {
+          continue;
+        }
+        // Past the vertex collapsed onto this one.
+        if (const auto collapsed = collapseRemap[next]; collapsed != v) {
+          (*edgeLoop)[v] = collapsed;
+        } else {
+          const auto after = (*edgeLoop)[next];
+          (*edgeLoop)[v] = after == noVertex ? noVertex : collapseRemap[after];
+        }
+      }
+    }
+    std::size_t nKept = 0;
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+      const auto a = collapseRemap[result[i]];
+      const auto b = collapseRemap[result[i + 1]];
+      const auto c = collapseRemap[result[i + 2]];
+      if (a != b && b != c && c != a) {
+        result[nKept++] = a;
+        result[nKept++] = b;
+        result[nKept++] = c;
+      }
+    }
+    result.resize(nKept);
+  }
+
+  indices_ = std::move(result);
+  return static_cast<float>(std::sqrt(resultError));
+}
+} // namespace bee
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Floats of each vertex whose changes count as simplification error, as
+/// positions moving do.
+/// </summary>
+struct SimplificationAttribute {
+  std::size_t offset = 0;
+
+  std::uint32_t components = 0;
+
+  /// <summary>
+  /// How much a squared difference of a component weighs, against positions
+  /// moving by the extent of the mesh.
+  /// </summary>
+  float weight = 1;
+
+  /// <summary>
+  /// Whether it's in the units of positions, such as the displacements of a
+  /// morph target, which then count relative to the extent of the mesh too.
+  /// </summary>
+  bool positional = false;
+};
+
+/// <summary>
+/// Vertices of `size` bytes each, whose positions are their first 3 floats.
+/// </summary>
+struct SimplificationVertices {
+  const std::byte *data = nullptr;
+
+  std::size_t size = 0;
+
+  std::uint32_t count = 0;
+
+  std::vector<SimplificationAttribute> attributes;
+
+  /// <summary>
+  /// Bytes, as offset and size, which a vertex shares with those it's allowed
+  /// to collapse onto, such as the joints skinning it.
+  /// </summary>
+  std::vector<std::pair<std::size_t, std::size_t>> shared;
+};
+
+/// <summary>
+/// Simplifies a triangle list by collapsing edges, the ones of least error
+/// first: the squared distance to the planes of the triangles collapsed into
+/// each vertex, as in Garland and Heckbert's "Surface Simplification Using
+/// Quadric Error Metrics", plus how far the attributes are from those of the
+/// vertices collapsed.
+/// Vertices collapse onto other vertices, so the result indexes the same
+/// vertices. Mesh borders, and attribute seams where vertices at the same
+/// position differ otherwise, collapse only along themselves; vertices where
+/// neither is that simple are kept.
+/// </summary>
+/// <param name="target_index_count_">
+/// Stops once the triangles are down to this many indices.
+/// </param>
+/// <param name="target_error_">
+/// Stops before an error beyond this, relative to the extent of the mesh.
+/// </param>
+/// <returns>
+/// The error reached, relative to the extent of the mesh.
+/// </returns>
+float simplify_mesh(std::vector<std::uint32_t> &indices_,
+                    const SimplificationVertices &vertices_,
+                    std::size_t target_index_count_,
+                    float target_error_);
+} // namespace bee
@@ -0,0 +1,641 @@
+#include <bee/MeshoptCompression.h>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace bee {
+namespace {
+/// <summary>
+/// Bytes are encoded in groups of this many elements.
+/// </summary>
+constexpr std::size_t byteGroupSize = 16;
+
+/// <summary>
+/// Vertex blocks span at most this many bytes, and this many vertices.
+/// </summary>
+constexpr std::size_t vertexBlockSizeBytes = 8192;
+constexpr std::size_t vertexBlockMaxSize = 256;
+
+/// <summary>
+/// The first vertex ends the stream, padded to this many bytes, so that
+/// decoders may read whole groups without bound checks.
+/// </summary>
+constexpr std::size_t vertexTailMaxSize = 32;
+
+constexpr std::uint8_t vertexHeader = 0xa0;
+constexpr std::uint8_t triangleHeader = 0xe1;
+constexpr std::uint8_t indexHeader = 0xd1;
+
+/// <summary>
+/// Pairs of vertex FIFO codes of the second and third vertices of a
+/// triangle sharing no edge, by their frequency in meshes. The table ends
+/// the stream, where decoders read it from.
+/// </summary>
+constexpr std::array<std::uint8_t, 16> codeAuxTable = {
+    0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xa9, 0x86,
+    0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+};
+
+std::uint8_t zigzag8(std::uint8_t value_) {
+  return static_cast<std::uint8_t>(
+      (static_cast<std::int8_t>(value_) >> 7) ^ (value_ << 1));
+}
+
+std::uint32_t zigzag32(std::uint32_t value_) {
+  return (value_ << 1) ^ static_cast<std::uint32_t>(
+                             static_cast<std::int32_t>(value_) >> 31);
+}
+
+void append_vbyte(std::vector<std::byte> &out_, std::uint32_t value_) {
+  do {
+    out_.push_back(static_cast<std::byte>((value_ & 127) |
+                                          (value_ > 127 ? 128 : 0)));
+    value_ >>= 7;
+  } while (value_);
+}
+
+/// <summary>
+/// Size of a group of bytes stored with `bits_` bits each, those which
+/// don't fit following in full.
+/// </summary>
+std::size_t measure_byte_group(const std::uint8_t *group_, int bits_) {
+  if (bits_ == 0) {
+    return std::all_of(group_, group_ + byteGroupSize,
+                       [](std::uint8_t byte_) { return byte_ == 0; })
+               ? 0
+               : std::numeric_limits<std::size_t>::max();
+  }
+  if (bits_ == 8) {
+    return byteGroupSize;
+  }
+  const auto sentinel = (1 << bits_) - 1;
+  return byteGroupSize * bits_ / 8 +
+         std::count_if(group_, group_ + byteGroupSize,
+                       [sentinel](std::uint8_t byte_) {
+                         return byte_ >= sentinel;
+                       });
+}
+
+void append_byte_group(std::vector<std::byte> &out_,
+                       const std::uint8_t *group_,
+                       int bits_) {
+  if (bits_ == 0) {
+    return;
+  }
+  if (bits_ == 8) {
+    const auto bytes = reinterpret_cast<const std::byte *>(group_);
+    out_.insert(out_.end(), bytes, bytes + byteGroupSize);
+    return;
+  }
+  const auto sentinel = static_cast<std::uint8_t>((1 << bits_) - 1);
+  const auto perByte = static_cast<std::size_t>(8 / bits_);
+  for (std::size_t i = 0; i < byteGroupSize; i += perByte) {
+    std::uint8_t byte = 0;
+    for (std::size_t k = 0; k < perByte; ++k) {
+      byte = static_cast<std::uint8_t>(byte << bits_) |
+             std::min(group_[i + k], sentinel);
+    }
+    out_.push_back(static_cast<std::byte>(byte));
+  }
+  for (std::size_t i = 0; i < byteGroupSize; ++i) {
+    if (group_[i] >= sentinel) {
+      out_.push_back(static_cast<std::byte>(group_[i]));
+    }
+  }
+}
+
+/// <summary>
+/// Appends the bytes, a multiple of the group size, each group with the
+/// fewest bits it fits in, 2 bits of a header before them telling which.
+/// </summary>
+void append_bytes(std::vector<std::byte> &out_,
+                  std::span<const std::uint8_t> bytes_) {
+  assert(bytes_.size() % byteGroupSize == 0);
+  const auto nGroups = bytes_.size() / byteGroupSize;
+  const auto headerOffset = out_.size();
+  out_.resize(out_.size() + (nGroups + 3) / 4);
+  for (std::size_t iGroup = 0; iGroup < nGroups; ++iGroup) {
+    const auto group = bytes_.data() + byteGroupSize * iGroup;
+    int bestBits = 8;
+    auto bestSize = measure_byte_group(group, 8);
+    for (const auto bits : {0, 2, 4}) {
+      if (const auto size = measure_byte_group(group, bits); size < bestSize) {
+        bestBits = bits;
+        bestSize = size;
+      }
+    }
+    const auto bitsLog2 = bestBits == 0   ? 0
+                          : bestBits == 2 ? 1
+                          : bestBits == 4 ? 2
+                                          : 3;
+    out_[headerOffset + iGroup / 4] |=
+        static_cast<std::byte>(bitsLog2 << (iGroup % 4 * 2));
+    append_byte_group(out_, group, bestBits);
+  }
+}
+
+std::vector<std::byte> encode_attributes(std::span<const std::byte> data_,
+                                         std::size_t vertex_size_) {
+  const auto vertices = reinterpret_cast<const std::uint8_t *>(data_.data());
+  const auto nVertices = data_.size() / vertex_size_;
+  const auto blockSize = std::min(
+      vertexBlockSizeBytes / vertex_size_ & ~(byteGroupSize - 1),
+      vertexBlockMaxSize);
+
+  std::vector<std::byte> out;
+  out.reserve(data_.size() / 2);
+  out.push_back(static_cast<std::byte>(vertexHeader));
+
+  // Each byte of a vertex is a delta from the same byte of the vertex
+  // before, starting from the first vertex.
+  std::array<std::uint8_t, 256> firstVertex{};
+  if (nVertices != 0) {
+    std::memcpy(firstVertex.data(), vertices, vertex_size_);
+  }
+  auto lastVertex = firstVertex;
+  std::array<std::uint8_t, vertexBlockMaxSize> deltas;
+  for (std::size_t iFirst = 0; iFirst < nVertices; iFirst += blockSize) {
+    const auto nBlockVertices = std::min(blockSize, nVertices - iFirst);
+    const auto nAligned =
+        (nBlockVertices + byteGroupSize - 1) & ~(byteGroupSize - 1);
+    const auto block = vertices + vertex_size_ * iFirst;
+    for (std::size_t k = 0; k < vertex_size_; ++k) {
+      auto previous = lastVertex[k];
+      for (std::size_t iVertex = 0; iVertex < nBlockVertices; ++iVertex) {
+        const auto byte = block[vertex_size_ * iVertex + k];
+        deltas[iVertex] = zigzag8(static_cast<std::uint8_t>(byte - previous));
+        previous = byte;
+      }
+      std::fill(deltas.begin() + nBlockVertices, deltas.begin() + nAligned, 0);
+      append_bytes(out, std::span{deltas.data(), nAligned});
+    }
+    std::memcpy(lastVertex.data(),
+                block + vertex_size_ * (nBlockVertices - 1), vertex_size_);
+  }
+
+  if (vertex_size_ < vertexTailMaxSize) {
+    out.resize(out.size() + vertexTailMaxSize - vertex_size_);
+  }
+  const auto first = reinterpret_cast<const std::byte *>(firstVertex.data());
+  out.insert(out.end(), first, first + vertex_size_);
+  return out;
+}
+
+std::uint32_t read_index(const std::byte *data_,
+                         std::size_t index_size_,
+                         std::size_t i_) {
+  if (index_size_ == 2) {
+    std::uint16_t index;
+    std::memcpy(&index, data_ + 2 * i_, 2);
+    return index;
+  }
+  std::uint32_t index;
+  std::memcpy(&index, data_ + 4 * i_, 4);
+  return index;
+}
+
+std::vector<std::byte> encode_triangles(std::span<const std::byte> data_,
+                                        std::size_t index_size_) {
+  constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+  // Codes 13 and 14 of a triangle sharing an edge mean the last index -1
+  // and +1, so fewer vertex FIFO entries are encoded.
+  constexpr int maxFifoCode = 13;
+  constexpr std::array<std::array<int, 3>, 3> rotations = {
+      {{0, 1, 2}, {1, 2, 0}, {2, 0, 1}}};
+
+  std::array<std::array<std::uint32_t, 2>, 16> edgeFifo;
+  std::array<std::uint32_t, 16> vertexFifo;
+  for (auto &edge : edgeFifo) {
+    edge = {none, none};
+  }
+  vertexFifo.fill(none);
+  std::size_t edgeFifoOffset = 0;
+  std::size_t vertexFifoOffset = 0;
+  const auto pushEdge = [&](std::uint32_t a_, std::uint32_t b_) {
+    edgeFifo[edgeFifoOffset] = {a_, b_};
+    edgeFifoOffset = (edgeFifoOffset + 1) & 15;
+  };
+  const auto pushVertex = [&](std::uint32_t v_) {
+    vertexFifo[vertexFifoOffset] = v_;
+    vertexFifoOffset = (vertexFifoOffset + 1) & 15;
+  };
+  const auto findVertex = [&](std::uint32_t v_) {
+    for (int i = 0; i < 16; ++i) {
+      if (vertexFifo[(vertexFifoOffset - 1 - i) & 15] == v_) {
+        return i;
+      }
+    }
+    return -1;
+  };
+  const auto findEdge = [&](std::uint32_t a_, std::uint32_t b_,
+                            std::uint32_t c_) {
+    for (int i = 0; i < 16; ++i) {
+      const auto &[e0, e1] = edgeFifo[(edgeFifoOffset - 1 - i) & 15];
+      if (e0 == a_ && e1 == b_) {
+        return (i << 2) | 0;
+      } else if (e0 == b_ && e1 == c_) {
+        return (i << 2) | 1;
+      } else if (e0 == c_ && e1 == a_) {
+        return (i << 2) | 2;
+      }
+    }
+    return -1;
+  };
+
+  const auto nIndices = data_.size() / index_size_;
+  std::vector<std::byte> codes;
+  codes.reserve(nIndices / 3);
+  std::vector<std::byte> extra;
+  extra.reserve(nIndices / 3);
+  const auto appendIndex = [&extra](std::uint32_t index_,
+                                    std::uint32_t last_) {
+    append_vbyte(extra, zigzag32(index_ - last_));
+  };
+  // The next index never used so far, and the last one encoded in full.
+  std::uint32_t next = 0;
+  std::uint32_t last = 0;
+  for (std::size_t i = 0; i < nIndices; i += 3) {
+    const std::array triangle = {read_index(data_.data(), index_size_, i),
+                                 read_index(data_.data(), index_size_, i + 1),
+                                 read_index(data_.data(), index_size_, i + 2)};
+    if (const auto edge = findEdge(triangle[0], triangle[1], triangle[2]);
+        edge >= 0 && (edge >> 2) < 15) {
+      // Rotated so that a-b is the edge.
+      const auto &rotation = rotations[edge & 3];
+      const auto a = triangle[rotation[0]];
+      const auto b = triangle[rotation[1]];
+      const auto c = triangle[rotation[2]];
+      const auto fifoC = findVertex(c);
+      int codeC = fifoC >= 1 && fifoC < maxFifoCode ? fifoC
+                  : c == next                     ? (++next, 0)
+                                                  : 15;
+      if (codeC == 15 && c + 1 == last) {
+        codeC = 13;
+        last = c;
+      } else if (codeC == 15 && c == last + 1) {
+        codeC = 14;
+        last = c;
+      }
+      codes.push_back(static_cast<std::byte>(((edge >> 2) << 4) | codeC));
+      if (codeC == 15) {
+        appendIndex(c, last);
+        last = c;
+      }
+      if (codeC == 0 || codeC >= maxFifoCode) {
+        pushVertex(c);
+      }
+      pushEdge(c, b);
+      pushEdge(a, c);
+    } else {
+      // Rotated so that a is the likeliest to be the next index.
+      const auto &rotation =
+          rotations[triangle[1] == next ? 1 : triangle[2] == next ? 2 : 0];
+      const auto a = triangle[rotation[0]];
+      const auto b = triangle[rotation[1]];
+      const auto c = triangle[rotation[2]];
+      // 0, 1, 2 after the first triangle resets the next index, as meshes
+      // concatenated do.
+      const bool reset = a == 0 && b == 1 && c == 2 && next > 0;
+      if (reset) {
+        next = 0;
+        vertexFifo.fill(none);
+      }
+      const auto fifoB = findVertex(b);
+      const auto fifoC = findVertex(c);
+      const int codeA = a == next ? (++next, 0) : 15;
+      const int codeB = fifoB >= 0 && fifoB < 14 ? fifoB + 1
+                        : b == next              ? (++next, 0)
+                                                 : 15;
+      const int codeC = fifoC >= 0 && fifoC < 14 ? fifoC + 1
+                        : c == next              ? (++next, 0)
+                                                 : 15;
+      const auto codeAux = static_cast<std::uint8_t>((codeB << 4) | codeC);
+      const auto tableEntry =
+          std::find(codeAuxTable.begin(), codeAuxTable.begin() + 14, codeAux);
+      if (codeA == 0 && tableEntry != codeAuxTable.begin() + 14 && !reset) {
+        codes.push_back(static_cast<std::byte>(
+            0xf0 | (tableEntry - codeAuxTable.begin())));
+      } else {
+        codes.push_back(static_cast<std::byte>(0xf0 | 14 | codeA));
+        extra.push_back(static_cast<std::byte>(codeAux));
+      }
+      if (codeA == 15) {
+        appendIndex(a, last);
+        last = a;
+      }
+      if (codeB == 15) {
+        appendIndex(b, last);
+        last = b;
+      }
+      if (codeC == 15) {
+        appendIndex(c, last);
+        last = c;
+      }
+      if (codeA == 0 || codeA == 15) {
+        pushVertex(a);
+      }
+      if (codeB == 0 || codeB == 15) {
+        pushVertex(b);
+      }
+      if (codeC == 0 || codeC == 15) {
+        pushVertex(c);
+      }
+      pushEdge(b, a);
+      pushEdge(c, b);
+      pushEdge(a, c);
+    }
+  }
+
+  std::vector<std::byte> out;
+  out.reserve(1 + codes.size() + extra.size() + codeAuxTable.size());
+  out.push_back(static_cast<std::byte>(triangleHeader));
+  out.insert(out.end(), codes.begin(), codes.end());
+  out.insert(out.end(), extra.begin(), extra.end());
+  for (const auto entry : codeAuxTable) {
+    out.push_back(static_cast<std::byte>(entry));
+  }
+  return out;
+}
+
+std::vector<std::byte> encode_indices(std::span<const std::byte> data_,
+                                      std::size_t index_size_) {
+  const auto nIndices = data_.size() / index_size_;
+  std::vector<std::byte> out;
+  out.reserve(1 + nIndices + 4);
+  out.push_back(static_cast<std::byte>(indexHeader));
+  // Deltas are from either of two baselines, switched to once the delta
+  // from the current one doesn't fit a byte, so that two interleaved
+  // sequences stay small.
+  std::array<std::uint32_t, 2> last = {0, 0};
+  std::uint32_t current = 0;
+  for (std::size_t i = 0; i < nIndices; ++i) {
+    const auto index = read_index(data_.data(), index_size_, i);
+    const auto delta = static_cast<std::int32_t>(index - last[current]);
+    current ^= (delta < 0 ? -static_cast<std::int64_t>(delta) : delta) >= 30;
+    append_vbyte(out, (zigzag32(index - last[current]) << 1) | current);
+    last[current] = index;
+  }
+  out.resize(out.size() + 4);
+  return out;
+}
+
+std::int32_t quantize_snorm(float value_, std::uint32_t bits_) {
+  const auto scale = static_cast<float>((1 << (bits_ - 1)) - 1);
+  value_ = std::clamp(value_, -1.0f, 1.0f);
+  return static_cast<std::int32_t>(value_ * scale +
+                                   (value_ >= 0 ? 0.5f : -0.5f));
+}
+
+template <typename Component_>
+void encode_octahedral(std::span<std::byte> data_, std::uint32_t bits_) {
+  constexpr auto max =
+      static_cast<float>(std::numeric_limits<Component_>::max());
+  bits_ = std::clamp<std::uint32_t>(bits_, 2, sizeof(Component_) * 8);
+  for (std::size_t offset = 0; offset < data_.size();
+       offset += 4 * sizeof(Component_)) {
+    std::array<Component_, 4> v;
+    std::memcpy(v.data(), data_.data() + offset, sizeof(v));
+    auto x = v[0] / max;
+    auto y = v[1] / max;
+    const auto z = v[2] / max;
+    const auto length = std::abs(x) + std::abs(y) + std::abs(z);
+    const auto scale = length == 0 ? 0.0f : 1.0f / length;
+    x *= scale;
+    y *= scale;
+    const auto u = z >= 0 ? x : (1 - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+    const auto w = z >= 0 ? y : (1 - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+    v[0] = static_cast<Component_>(quantize_snorm(u, bits_));
+    v[1] = static_cast<Component_>(quantize_snorm(w, bits_));
+    v[2] = static_cast<Component_>(quantize_snorm(1.0f, bits_));
+    std::memcpy(data_.data() + offset, v.data(), sizeof(v));
+  }
+}
+
+template <typename Component_>
+void decode_octahedral(std::span<std::byte> data_) {
+  constexpr auto max =
+      static_cast<float>(std::numeric_limits<Component_>::max());
+  for (std::size_t offset = 0; offset < data_.size();
+       offset += 4 * sizeof(Component_)) {
+    std::array<Component_, 4> v;
+    std::memcpy(v.data(), data_.data() + offset, sizeof(v));
+    auto x = static_cast<float>(v[0]);
+    auto y = static_cast<float>(v[1]);
+    const auto z = static_cast<float>(v[2]) - std::abs(x) - std::abs(y);
+    const auto t = std::min(z, 0.0f);
+    x += x >= 0 ? t : -t;
+    y += y >= 0 ? t : -t;
+    const auto scale = max / std::sqrt(x * x + y * y + z * z);
+    const auto round = [scale](float value_) {
+      return static_cast<Component_>(static_cast<int>(
+          value_ * scale + (value_ >= 0 ? 0.5f : -0.5f)));
+    };
+    v[0] = round(x);
+    v[1] = round(y);
+    v[2] = round(z);
+    std::memcpy(data_.data() + offset, v.data(), sizeof(v));
+  }
+}
+
+void encode_quaternion(std::span<std::byte> data_, std::uint32_t bits_) {
+  const auto scaler = std::sqrt(2.0f);
+  bits_ = std::clamp<std::uint32_t>(bits_, 4, 16);
+  for (std::size_t offset = 0; offset < data_.size(); offset += 8) {
+    std::array<std::int16_t, 4> v;
+    std::memcpy(v.data(), data_.data() + offset, sizeof(v));
+    std::array<float, 4> q;
+    std::transform(v.begin(), v.end(), q.begin(), [](std::int16_t value_) {
+      return value_ / 32767.0f;
+    });
+    // The largest component is left out, and restored from the others.
+    int largest = 0;
+    for (int i = 1; i < 4; ++i) {
+      largest = std::abs(q[i]) > std::abs(q[largest]) ? i : largest;
+    }
+    const auto sign = q[largest] < 0 ? -1.0f : 1.0f;
+    for (int i = 0; i < 3; ++i) {
+      v[i] = static_cast<std::int16_t>(
+          quantize_snorm(q[(largest + 1 + i) & 3] * scaler * sign, bits_));
+    }
+    v[3] = static_cast<std::int16_t>((quantize_snorm(1.0f, bits_) & ~3) |
+                                     largest);
+    std::memcpy(data_.data() + offset, v.data(), sizeof(v));
+  }
+}
+
+void decode_quaternion(std::span<std::byte> data_) {
+  const auto scale = 1.0f / std::sqrt(2.0f);
+  for (std::size_t offset = 0; offset < data_.size(); offset += 8) {
+    std::array<std::int16_t, 4> v;
+    std::memcpy(v.data(), data_.data() + offset, sizeof(v));
+    const auto componentScale = scale / static_cast<float>(v[3] | 3);
+    const auto x = v[0] * componentScale;
+    const auto y = v[1] * componentScale;
+    const auto z = v[2] * componentScale;
+    const auto w = std::sqrt(std::max(1.0f - x * x - y * y - z * z, 0.0f));
+    const auto round = [](float value_) {
+      return static_cast<std::int16_t>(static_cast<int>(
+          value_ * 32767.0f + (value_ >= 0 ? 0.5f : -0.5f)));
+    };
+    const auto largest = v[3] & 3;
+    v[(largest + 1) & 3] = round(x);
+    v[(largest + 2) & 3] = round(y);
+    v[(largest + 3) & 3] = round(z);
+    v[largest] = round(w);
+    std::memcpy(data_.data() + offset, v.data(), sizeof(v));
+  }
+}
+
+void encode_exponential(std::span<std::byte> data_,
+                        std::size_t byte_stride_,
+                        std::uint32_t bits_) {
+  bits_ = std::clamp<std::uint32_t>(bits_, 1, 24);
+  const auto nComponents = byte_stride_ / 4;
+  std::vector<float> element(nComponents);
+  for (std::size_t offset = 0; offset < data_.size(); offset += byte_stride_) {
+    std::memcpy(element.data(), data_.data() + offset, byte_stride_);
+    // The largest exponent keeps the mantissas within [-1, 1], which are
+    // then scaled to `bits_`-bit signed integers.
+    int exponent = -100;
+    for (const auto value : element) {
+      int valueExponent = 0;
+      std::frexp(value, &valueExponent);
+      exponent = std::max(exponent, valueExponent);
+    }
+    exponent -= static_cast<int>(bits_) - 1;
+    for (std::size_t i = 0; i < nComponents; ++i) {
+      const auto value = element[i];
+      const auto mantissa = static_cast<std::int32_t>(
+          std::ldexp(value, -exponent) + (value >= 0 ? 0.5f : -0.5f));
+      const auto stored = (static_cast<std::uint32_t>(mantissa) & 0xffffff) |
+                          (static_cast<std::uint32_t>(exponent) << 24);
+      std::memcpy(data_.data() + offset + 4 * i, &stored, 4);
+    }
+  }
+}
+
+void decode_exponential(std::span<std::byte> data_) {
+  for (std::size_t offset = 0; offset < data_.size(); offset += 4) {
+    std::uint32_t stored;
+    std::memcpy(&stored, data_.data() + offset, 4);
+    const auto mantissa = static_cast<std::int32_t>(stored << 8) >> 8;
+    const auto exponent = static_cast<std::int32_t>(stored) >> 24;
+    const auto value = std::ldexp(static_cast<float>(mantissa), exponent);
+    std::memcpy(data_.data() + offset, &value, 4);
+  }
+}
+} // namespace
+
+const char *to_string(MeshoptMode mode_) {
+  switch (mode_) {
+  case MeshoptMode::triangles:
+    return "TRIANGLES";
+  case MeshoptMode::indices:
+    return "INDICES";
+  default:
+    return "ATTRIBUTES";
+  }
+}
+
+const char *to_string(MeshoptFilter filter_) {
+  switch (filter_) {
+  case MeshoptFilter::octahedral:
+    return "OCTAHEDRAL";
+  case MeshoptFilter::quaternion:
+    return "QUATERNION";
+  case MeshoptFilter::exponential:
+    return "EXPONENTIAL";
+  default:
+    return "NONE";
+  }
+}
+
+bool is_meshopt_encodable(const MeshoptEncoding &encoding_, std::size_t size_) {
+  const auto byteStride = encoding_.byteStride;
+  if (byteStride == 0 || size_ % byteStride != 0) {
+    return false;
+  }
+  switch (encoding_.mode) {
+  case MeshoptMode::attributes:
+    if (byteStride % 4 != 0 || byteStride > 256) {
+      return false;
+    }
+    switch (encoding_.filter) {
+    case MeshoptFilter::octahedral:
+      return byteStride == 4 || byteStride == 8;
+    case MeshoptFilter::quaternion:
+      return byteStride == 8;
+    default:
+      return true;
+    }
+  case MeshoptMode::triangles:
+    return (byteStride == 2 || byteStride == 4) &&
+           size_ / byteStride % 3 == 0 &&
+           encoding_.filter == MeshoptFilter::none;
+  default:
+    return (byteStride == 2 || byteStride == 4) &&
+           encoding_.filter == MeshoptFilter::none;
+  }
+}
+
+std::vector<std::byte> encode_meshopt(std::span<const std::byte> data_,
+                                      const MeshoptEncoding &encoding_) {
+  if (!is_meshopt_encodable(encoding_, data_.size())) {
+    throw std::invalid_argument("Not encodable with EXT_meshopt_compression.");
+  }
+  switch (encoding_.mode) {
+  case MeshoptMode::triangles:
+    return encode_triangles(data_, encoding_.byteStride);
+  case MeshoptMode::indices:
+    return encode_indices(data_, encoding_.byteStride);
+  default:
+    return encode_attributes(data_, encoding_.byteStride);
+  }
+}
+
+void encode_meshopt_filter(std::span<std::byte> data_,
+                           const MeshoptEncoding &encoding_) {
+  switch (encoding_.filter) {
+  case MeshoptFilter::octahedral:
+    if (encoding_.byteStride == 4) {
+      encode_octahedral<std::int8_t>(data_, encoding_.filterBits);
+    } else {
+      encode_octahedral<std::int16_t>(data_, encoding_.filterBits);
+    }
+    break;
+  case MeshoptFilter::quaternion:
+    encode_quaternion(data_, encoding_.filterBits);
+    break;
+  case MeshoptFilter::exponential:
+    encode_exponential(data_, encoding_.byteStride, encoding_.filterBits);
+    break;
+  default:
+    break;
+  }
+}
+
+void decode_meshopt_filter(std::span<std::byte> data_,
+                           const MeshoptEncoding &encoding_) {
+  switch (encoding_.filter) {
+  case MeshoptFilter::octahedral:
+    if (encoding_.byteStride == 4) {
+      decode_octahedral<std::int8_t>(data_);
+    } else {
+      decode_octahedral<std::int16_t>(data_);
+    }
+    break;
+  case MeshoptFilter::quaternion:
+    decode_quaternion(data_);
+    break;
+  case MeshoptFilter::exponential:
+    decode_exponential(data_);
+    break;
+  default:
+    break;
+  }
+}
+} // namespace bee
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// Bitstreams of the `EXT_meshopt_compression` glTF extension.
+/// </summary>
+enum class MeshoptMode {
+  /// <summary>
+  /// Elements of any size multiple of 4 up to 256 bytes, such as vertices,
+  /// byte-wise delta encoded.
+  /// </summary>
+  attributes,
+
+  /// <summary>
+  /// Indices of a triangle list, encoded by the edges and vertices they
+  /// share with the triangles before.
+  /// </summary>
+  triangles,
+
+  /// <summary>
+  /// Any index sequence, delta encoded.
+  /// </summary>
+  indices,
+};
+
+/// <summary>
+/// Transforms of attribute elements, reverted after decompression, making
+/// them compress better at the cost of some precision.
+/// </summary>
+enum class MeshoptFilter {
+  none,
+
+  /// <summary>
+  /// Unit vectors, as 4 normalized bytes or shorts, stored octahedral.
+  /// The 4th component is kept as is.
+  /// </summary>
+  octahedral,
+
+  /// <summary>
+  /// Unit quaternions, as 4 normalized shorts, stored as their 3 smallest
+  /// components.
+  /// </summary>
+  quaternion,
+
+  /// <summary>
+  /// Floats stored as a mantissa of fewer bits and an exponent shared by the
+  /// components of each element.
+  /// </summary>
+  exponential,
+};
+
+/// <summary>
+/// How a buffer view may be compressed.
+/// </summary>
+struct MeshoptEncoding {
+  MeshoptMode mode = MeshoptMode::attributes;
+
+  /// <summary>
+  /// Bytes of each element: a vertex for `attributes`, an index of 2 or 4
+  /// bytes otherwise.
+  /// </summary>
+  std::uint32_t byteStride = 0;
+
+  MeshoptFilter filter = MeshoptFilter::none;
+
+  /// <summary>
+  /// Bits of each component the filter keeps.
+  /// </summary>
+  std::uint32_t filterBits = 0;
+};
+
+const char *to_string(MeshoptMode mode_);
+
+const char *to_string(MeshoptFilter filter_);
+
+/// <summary>
+/// Whether `encode_meshopt()` is able to encode `size_` bytes so.
+/// </summary>
+bool is_meshopt_encodable(const MeshoptEncoding &encoding_, std::size_t size_);
+
+/// <summary>
+/// Compresses the elements of a buffer view, filtered already if so.
+/// </summary>
+/// <exception cref="std::invalid_argument">
+/// Not `is_meshopt_encodable()`.
+/// </exception>
+std::vector<std::byte> encode_meshopt(std::span<const std::byte> data_,
+                                      const MeshoptEncoding &encoding_);
+
+/// <summary>
+/// Filters the elements, in place, as the filter of `encoding_` stores them.
+/// </summary>
+void encode_meshopt_filter(std::span<std::byte> data_,
+                           const MeshoptEncoding &encoding_);
+
+/// <summary>
+/// Reverts `encode_meshopt_filter()` in place, as decoders do. What's left
+/// is what readers of the compressed buffer view get, so that's what a
+/// fallback of it holds.
+/// </summary>
+void decode_meshopt_filter(std::span<std::byte> data_,
+                           const MeshoptEncoding &encoding_);
+} // namespace bee
@@ -0,0 +1,142 @@
+#include <bee/OutputFile.h>
+#include <bee/polyfills/filesystem.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+#endif
+
+namespace bee {
+OutputFile::OutputFile(std::u8string_view path_) : _path(path_) {
+  const auto path = bee::filesystem::path{_path};
+#ifdef _WIN32
+  ::_wsopen_s(&_fd, path.wstring().c_str(),
+              _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _SH_DENYNO,
+              _S_IREAD | _S_IWRITE);
+#else
+  do {
+    _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  } while (_fd < 0 && errno == EINTR);
+#endif
+  if (_fd < 0) {
+    _fail("Failed to open");
+  }
+}
+
+OutputFile::~OutputFile() {
+  if (_fd >= 0) {
+#ifdef _WIN32
+    ::_close(_fd);
+#else
+    ::close(_fd);
+#endif
+  }
+}
+
+void OutputFile::write(std::span<const std::byte> data_) {
+  while (!data_.empty()) {
+#ifdef _WIN32
+    const auto written = ::_write(
+        _fd, data_.data(),
+        static_cast<unsigned int>(std::min<std::size_t>(data_.size(), INT_MAX)));
+#else
+    const auto written = ::write(
+        _fd, data_.data(), std::min<std::size_t>(data_.size(), SSIZE_MAX));
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+#endif
+    if (written < 0) {
+      _fail("Failed to write");
+    }
+    data_ = data_.subspan(static_cast<std::size_t>(written));
+  }
+}
+
+void OutputFile::write(
+    std::span<const std::span<const std::byte>> segments_) {
+#ifdef _WIN32
+  for (const auto &segment : segments_) {
+    write(segment);
+  }
+#else
+  // POSIX guarantees at least 16; 1024 on Linux and macOS.
+  constexpr std::size_t maxIovecs = 1024;
+  std::vector<iovec> iovecs;
+  iovecs.reserve(std::min(segments_.size(), maxIovecs));
+  // The first segment not completely written, and how much of it was.
+  std::size_t iSegment = 0;
+  std::size_t segmentOffset = 0;
+  while (iSegment < segments_.size()) {
+    iovecs.clear();
+    for (auto i = iSegment; i < segments_.size() && iovecs.size() < maxIovecs;
+         ++i) {
+      auto segment = segments_[i];
+      if (i == iSegment) {
+        segment = segment.subspan(segmentOffset);
+      }
+      if (!segment.empty()) {
+        iovecs.push_back(iovec{const_cast<std::byte *>(segment.data()),
+                               segment.size()});
+      }
+    }
+    if (iovecs.empty()) {
+      break;
+    }
+
+    const auto written =
+        ::writev(_fd, iovecs.data(), static_cast<int>(iovecs.size()));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      _fail("Failed to write");
+    }
+
+    auto remaining = static_cast<std::size_t>(written);
+    while (iSegment < segments_.size()) {
+      const auto left = segments_[iSegment].size() - segmentOffset;
+      if (remaining < left) {
+        segmentOffset += remaining;
+        break;
+      }
+      remaining -= left;
+      ++iSegment;
+      segmentOffset = 0;
+    }
+  }
+#endif
+}
+
+void OutputFile::close() {
+  if (_fd < 0) {
+    return;
+  }
+  const auto fd = _fd;
+  _fd = -1;
+#ifdef _WIN32
+  const auto result = ::_close(fd);
+#else
+  const auto result = ::close(fd);
+#endif
+  if (result != 0) {
+    _fail("Failed to close");
+  }
+}
+
+void OutputFile::_fail(std::string_view what_) const {
+  throw std::runtime_error(std::string{what_} + " " +
+                           std::string{_path.begin(), _path.end()} + ": " +
+                           std::strerror(errno));
+}
+} // namespace bee
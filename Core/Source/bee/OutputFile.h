@@ -0,0 +1,55 @@
+#pragma once
+
+#include <bee/BEE_API.h>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace bee {
+/// <summary>
+/// A file written through its descriptor, without stream buffering,
+/// for outputs that are already in memory.
+/// </summary>
+class BEE_API OutputFile {
+public:
+  /// <summary>
+  /// Creates, or truncates, the file.
+  /// </summary>
+  /// <exception cref="std::runtime_error">
+  /// The file can not be opened.
+  /// </exception>
+  explicit OutputFile(std::u8string_view path_);
+
+  OutputFile(const OutputFile &) = delete;
+
+  OutputFile &operator=(const OutputFile &) = delete;
+
+  /// <summary>
+  /// Closes the file if `close()` wasn't called, ignoring errors.
+  /// </summary>
+  ~OutputFile();
+
+  /// <exception cref="std::runtime_error">
+  /// </exception>
+  void write(std::span<const std::byte> data_);
+
+  /// <summary>
+  /// Writes the segments in order, gathering them into as few system calls
+  /// as possible(`writev()`). On Windows, they're written one by one.
+  /// </summary>
+  /// <exception cref="std::runtime_error">
+  /// </exception>
+  void write(std::span<const std::span<const std::byte>> segments_);
+
+  /// <exception cref="std::runtime_error">
+  /// </exception>
+  void close();
+
+private:
+  int _fd = -1;
+  std::u8string _path;
+
+  [[noreturn]] void _fail(std::string_view what_) const;
+};
+} // namespace bee
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bee/Memory.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// A buffer kept as the sequence of segments it's made of, so that it
+/// needn't be copied into one block to be written:
+/// the segments can be handed as they are to a gather write.
+/// </summary>
+class SegmentedBuffer {
+public:
+  using Segment = std::span<const std::byte>;
+
+  SegmentedBuffer() = default;
+
+  /// <summary>
+  /// Copies would point into the blocks of the original.
+  /// </summary>
+  SegmentedBuffer(const SegmentedBuffer &) = delete;
+
+  SegmentedBuffer(SegmentedBuffer &&) = default;
+
+  SegmentedBuffer &operator=(const SegmentedBuffer &) = delete;
+
+  SegmentedBuffer &operator=(SegmentedBuffer &&) = default;
+
+  /// <summary>
+  /// The content, in order.
+  /// </summary>
+  const std::vector<Segment> &segments() const {
+    return _segments;
+  }
+
+  std::size_t size() const {
+    return _size;
+  }
+
+  /// <summary>
+  /// Appends a block, taking its ownership.
+  /// </summary>
+  void append(TrackedBytes &&block_) {
+    if (block_.empty()) {
+      return;
+    }
+    _blocks.push_back(std::move(block_));
+    const auto &block = _blocks.back();
+    _segments.emplace_back(block.data(), block.size());
+    _size += block.size();
+  }
+
+  /// <summary>
+  /// Appends zeros, which don't take any storage.
+  /// </summary>
+  void pad(std::size_t size_) {
+    while (size_ != 0) {
+      const auto n = std::min(size_, zeros.size());
+      _segments.emplace_back(zeros.data(), n);
+      _size += n;
+      size_ -= n;
+    }
+  }
+
+  /// <summary>
+  /// Copies the segments into one block.
+  /// </summary>
+  TrackedBytes join() const {
+    TrackedBytes result;
+    result.reserve(_size);
+    for (const auto &segment : _segments) {
+      result.insert(result.end(), segment.begin(), segment.end());
+    }
+    return result;
+  }
+
+private:
+  static constexpr std::array<std::byte, 64> zeros{};
+
+  /// <summary>
+  /// Where the non-padding segments point into.
+  /// Moving a block doesn't move its bytes, so the segments stay valid.
+  /// </summary>
+  std::vector<TrackedBytes> _blocks;
+  std::vector<Segment> _segments;
+  std::size_t _size = 0;
+};
+} // namespace bee
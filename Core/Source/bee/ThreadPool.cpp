@@ -0,0 +1,127 @@
+#include <bee/ThreadPool.h>
+
+namespace bee {
+ThreadPool::ThreadPool(std::uint32_t threads_) {
+  _queues.reserve(threads_);
+  for (std::uint32_t iThread = 0; iThread < threads_; ++iThread) {
+    _queues.push_back(std::make_unique<Queue>());
+  }
+  _workers.reserve(threads_);
+  for (std::uint32_t iThread = 0; iThread < threads_; ++iThread) {
+    _workers.emplace_back([this, iThread]() { _work(iThread); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock lock{_mutex};
+    _stopping = true;
+  }
+  _taskAvailable.notify_all();
+  for (auto &worker : _workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallel_for(
+    std::size_t count_, const std::function<void(std::size_t index_)> &task_) {
+  if (_queues.empty() || count_ <= 1) {
+    for (std::size_t i = 0; i < count_; ++i) {
+      task_(i);
+    }
+    return;
+  }
+
+  Batch batch;
+  batch.task = &task_;
+  batch.remaining = count_;
+
+  // Concurrent callers start dealing at different queues.
+  const auto firstQueue = _nextQueue.fetch_add(1) % _queues.size();
+  for (std::size_t i = 0; i < count_; ++i) {
+    auto &queue = *_queues[(firstQueue + i) % _queues.size()];
+    std::unique_lock lock{queue.mutex};
+    queue.tasks.push_back(Task{&batch, i});
+    ++_nQueued;
+  }
+  {
+    // So that no worker misses the wake-up between checking and waiting.
+    std::unique_lock lock{_mutex};
+  }
+  _taskAvailable.notify_all();
+
+  // Help rather than wait. This may run tasks of other batches, which is fine.
+  Task task;
+  while (_steal(firstQueue, task)) {
+    _run(task);
+  }
+
+  std::unique_lock lock{batch.mutex};
+  batch.finished.wait(lock, [&batch]() { return batch.remaining == 0; });
+  if (batch.error) {
+    std::rethrow_exception(batch.error);
+  }
+}
+
+void ThreadPool::_work(std::size_t queue_) {
+  while (true) {
+    Task task;
+    if (_pop(queue_, task) || _steal(queue_ + 1, task)) {
+      _run(task);
+      continue;
+    }
+    std::unique_lock lock{_mutex};
+    _taskAvailable.wait(lock,
+                        [this]() { return _stopping || _nQueued != 0; });
+    if (_stopping && _nQueued == 0) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::_pop(std::size_t queue_, Task &task_) {
+  auto &queue = *_queues[queue_];
+  std::unique_lock lock{queue.mutex};
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  task_ = queue.tasks.back();
+  queue.tasks.pop_back();
+  --_nQueued;
+  return true;
+}
+
+bool ThreadPool::_steal(std::size_t first_queue_, Task &task_) {
+  const auto nQueues = _queues.size();
+  for (std::size_t i = 0; i < nQueues; ++i) {
+    auto &queue = *_queues[(first_queue_ + i) % nQueues];
+    std::unique_lock lock{queue.mutex};
+    if (!queue.tasks.empty()) {
+      task_ = queue.tasks.front();
+      queue.tasks.pop_front();
+      --_nQueued;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::_run(const Task &task_) {
+  auto &batch = *task_.batch;
+  std::exception_ptr error;
+  try {
+    (*batch.task)(task_.index);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // The batch may be gone as soon as the lock is released with nothing
+  // remaining, so it's not touched afterwards.
+  std::unique_lock lock{batch.mutex};
+  if (error && !batch.error) {
+    batch.error = error;
+  }
+  if (--batch.remaining == 0) {
+    batch.finished.notify_all();
+  }
+}
+} // namespace bee
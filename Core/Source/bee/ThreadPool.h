@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bee {
+/// <summary>
+/// A fixed set of worker threads running the tasks of `parallel_for()`.
+///
+/// Each worker has a queue of its own. Tasks are dealt round-robin to the
+/// queues; a worker takes from the back of its own queue and, once that runs
+/// dry, steals from the front of the others'. So uneven tasks, such as meshes
+/// of very different sizes, still keep every worker busy.
+/// </summary>
+class ThreadPool {
+public:
+  /// <param name="threads_">
+  /// Number of worker threads, besides those calling `parallel_for()` which
+  /// take part as well. May be 0, in which case tasks run on the caller.
+  /// </param>
+  explicit ThreadPool(std::uint32_t threads_);
+
+  ThreadPool(const ThreadPool &) = delete;
+
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// <summary>
+  /// Stops the workers. No `parallel_for()` shall be running.
+  /// </summary>
+  ~ThreadPool();
+
+  std::uint32_t threads() const {
+    return static_cast<std::uint32_t>(_workers.size());
+  }
+
+  /// <summary>
+  /// Calls `task_(i)` for each `i` in `[0, count_)`, in no particular order
+  /// and on any thread, the calling one included, then returns once all of
+  /// them have returned.
+  /// May be called from several threads at once.
+  /// </summary>
+  /// <exception>
+  /// The first exception thrown by a task, rethrown once all tasks finished.
+  /// </exception>
+  void parallel_for(std::size_t count_,
+                    const std::function<void(std::size_t index_)> &task_);
+
+private:
+  struct Batch {
+    const std::function<void(std::size_t index_)> *task;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::size_t remaining;
+    std::exception_ptr error;
+  };
+
+  struct Task {
+    Batch *batch;
+    std::size_t index;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Queue>> _queues;
+  std::vector<std::thread> _workers;
+  std::mutex _mutex;
+  std::condition_variable _taskAvailable;
+  std::atomic<std::size_t> _nQueued = 0;
+  std::atomic<std::size_t> _nextQueue = 0;
+  bool _stopping = false;
+
+  void _work(std::size_t queue_);
+
+  bool _pop(std::size_t queue_, Task &task_);
+
+  bool _steal(std::size_t first_queue_, Task &task_);
+
+  static void _run(const Task &task_);
+};
+} // namespace bee
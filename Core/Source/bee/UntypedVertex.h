@@ -1,55 +1,197 @@
-
 #pragma once
 
+#include <bee/Hash.h>
+#include <bee/Memory.h>
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstring>
-#include <list>
 #include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace bee {
 using UntypedVertex = std::byte *;
 
+/// <summary>
+/// Vertices stored one after another in a `VirtualArena`, so that they never
+/// move as they're added and end up contiguous as they are.
+/// </summary>
 class UntypedVertexVector {
 public:
-  UntypedVertexVector(std::uint32_t vertex_size_) : _vertexSize(vertex_size_) {
-  }
+  /// <param name="max_vertices_">
+  /// Number of vertices which may be added at most.
+  /// </param>
+  /// <param name="arenas_">
+  /// Where the arena is taken from, and given back to once destroyed. If
+  /// null, one of its own is reserved.
+  /// </param>
+  UntypedVertexVector(std::uint32_t vertex_size_,
+                      std::size_t max_vertices_,
+                      VirtualArenaPool *arenas_ = nullptr);
+
+  UntypedVertexVector(const UntypedVertexVector &) = delete;
+
+  UntypedVertexVector &operator=(const UntypedVertexVector &) = delete;
+
+  ~UntypedVertexVector();
 
   std::uint32_t size() const {
     return _nextVertexIndex;
   }
 
-  std::tuple<UntypedVertex, std::uint32_t> allocate();
+  UntypedVertex operator[](std::uint32_t index_) {
+    return _arena->data() + std::size_t{_vertexSize} * index_;
+  }
+
+  std::tuple<UntypedVertex, std::uint32_t> allocate() {
+    return {_arena->append(_vertexSize), _nextVertexIndex++};
+  }
 
   void pop_back();
 
-  std::unique_ptr<std::byte[]> merge();
+  /// <summary>
+  /// All vertices, in place.
+  /// </summary>
+  std::span<std::byte> data() {
+    return {_arena->data(), _arena->size()};
+  }
 
 private:
-  using VertexPage = std::unique_ptr<std::byte[]>;
   std::uint32_t _vertexSize;
-  std::list<VertexPage> _vertexPages;
-  std::uint32_t _nVerticesPerPage = 1024;
-  std::uint32_t _nLastPageVertices = 0;
+  VirtualArenaPool *_arenas;
+  std::unique_ptr<VirtualArena> _arena;
   std::uint32_t _nextVertexIndex = 0;
 };
 
-class UntypedVertexHasher {
+/// <summary>
+/// Hashes all bytes of a vertex.
+/// `VertexSize_` is the vertex size if known at compile time, or 0.
+/// </summary>
+template <std::size_t VertexSize_ = 0> class UntypedVertexHasher {
 public:
-  std::size_t operator()(const UntypedVertex &vertex_) const;
+  UntypedVertexHasher(std::size_t vertex_size_) : _vertexSize(vertex_size_) {
+  }
+
+  std::uint64_t operator()(const std::byte *vertex_) const {
+    return hash64_short(vertex_, VertexSize_ ? VertexSize_ : _vertexSize);
+  }
+
+private:
+  std::size_t _vertexSize;
 };
 
-class UntypedVertexEqual {
+/// <summary>
+/// `VertexSize_` is the vertex size if known at compile time, so that the
+/// comparison may be inlined, or 0.
+/// </summary>
+template <std::size_t VertexSize_ = 0> class UntypedVertexEqual {
 public:
   UntypedVertexEqual(std::size_t vertex_size_) : _vertexSize(vertex_size_) {
   }
 
-  bool operator()(const UntypedVertex &lhs_, const UntypedVertex &rhs_) const {
+  bool operator()(const std::byte *lhs_, const std::byte *rhs_) const {
     return 0 == std::memcmp(reinterpret_cast<const void *>(lhs_),
-                            reinterpret_cast<const void *>(rhs_), _vertexSize);
+                            reinterpret_cast<const void *>(rhs_),
+                            VertexSize_ ? VertexSize_ : _vertexSize);
   }
 
 private:
   std::size_t _vertexSize;
 };
-} // namespace bee
\ No newline at end of file
+
+/// <summary>
+/// Deduplicates vertices into an `UntypedVertexVector`.
+///
+/// A flat open-addressing table with linear probing. Slots hold the vertex
+/// index and 32 bits of its hash, so that probing rarely touches vertices
+/// other than the equal one.
+/// `VertexSize_` is the vertex size if known at compile time, or 0.
+/// </summary>
+template <std::size_t VertexSize_ = 0> class UntypedVertexTable {
+public:
+  /// <param name="vertices_">Where the unique vertices are added.</param>
+  /// <param name="expected_vertices_">
+  /// Number of vertices expected to be added at most, such as the number of
+  /// polygon vertices, so that the table needn't grow.
+  /// </param>
+  UntypedVertexTable(UntypedVertexVector &vertices_,
+                     std::size_t vertex_size_,
+                     std::size_t expected_vertices_)
+      : _vertices(vertices_), _vertexSize(vertex_size_),
+        _hasher(vertex_size_), _equal(vertex_size_),
+        _firstVertex(vertices_.size()) {
+    _rehash(_capacityFor(expected_vertices_));
+  }
+
+  /// <summary>
+  /// Finds the vertex equal to `vertex_`, or adds a copy of it.
+  /// </summary>
+  /// <returns>
+  /// The index of the vertex, and whether it has been added just now.
+  /// </returns>
+  std::pair<std::uint32_t, bool> insert(const std::byte *vertex_) {
+    const auto hash = _hasher(vertex_);
+    const auto tag = static_cast<std::uint32_t>(hash >> 32);
+    for (auto iSlot = hash & _mask;; iSlot = (iSlot + 1) & _mask) {
+      auto &slot = _slots[iSlot];
+      if (slot.index == _emptySlot) {
+        if (_nVertices + 1 > _maxVertices) {
+          _rehash(_slots.size() * 2);
+          return insert(vertex_);
+        }
+        const auto [vertex, index] = _vertices.allocate();
+        std::memcpy(vertex, vertex_, _vertexSize);
+        slot = Slot{index, tag};
+        ++_nVertices;
+        return {index, true};
+      }
+      if (slot.tag == tag && _equal(_vertices[slot.index], vertex_)) {
+        return {slot.index, false};
+      }
+    }
+  }
+
+private:
+  struct Slot {
+    std::uint32_t index;
+    std::uint32_t tag;
+  };
+
+  static constexpr std::uint32_t _emptySlot = ~std::uint32_t{0};
+
+  UntypedVertexVector &_vertices;
+  std::size_t _vertexSize;
+  UntypedVertexHasher<VertexSize_> _hasher;
+  UntypedVertexEqual<VertexSize_> _equal;
+  std::uint32_t _firstVertex;
+  std::vector<Slot, TrackingAllocator<Slot>> _slots;
+  std::size_t _mask = 0;
+  std::size_t _nVertices = 0;
+  std::size_t _maxVertices = 0;
+
+  /// <summary>
+  /// Keeps the load factor under 3/4.
+  /// </summary>
+  static std::size_t _capacityFor(std::size_t vertices_) {
+    return std::bit_ceil(
+        std::max<std::size_t>(16, vertices_ + vertices_ / 3 + 1));
+  }
+
+  void _rehash(std::size_t capacity_) {
+    _slots.assign(capacity_, Slot{_emptySlot, 0});
+    _mask = capacity_ - 1;
+    _maxVertices = capacity_ / 4 * 3;
+    for (auto iVertex = _firstVertex; iVertex < _firstVertex + _nVertices;
+         ++iVertex) {
+      const auto hash = _hasher(_vertices[iVertex]);
+      auto iSlot = hash & _mask;
+      while (_slots[iSlot].index != _emptySlot) {
+        iSlot = (iSlot + 1) & _mask;
+      }
+      _slots[iSlot] = Slot{iVertex, static_cast<std::uint32_t>(hash >> 32)};
+    }
+  }
+};
+} // namespace bee
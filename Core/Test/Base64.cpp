@@ -0,0 +1,95 @@
+#include <bee/Base64.h>
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+std::string encode(std::string_view data_) {
+  std::string result(bee::base64_encoded_size(data_.size()), '\0');
+  bee::base64_encode(std::as_bytes(std::span{data_.data(), data_.size()}),
+                     result.data());
+  return result;
+}
+
+/// <summary>
+/// The straightforward bit-by-bit encoding.
+/// </summary>
+std::string reference_encode(const std::vector<std::uint8_t> &data_) {
+  constexpr std::string_view alphabet{
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+  std::string result;
+  std::uint32_t bits = 0;
+  int nBits = 0;
+  for (const auto byte : data_) {
+    bits = (bits << 8) | byte;
+    nBits += 8;
+    while (nBits >= 6) {
+      nBits -= 6;
+      result.push_back(alphabet[(bits >> nBits) & 0x3F]);
+    }
+  }
+  if (nBits != 0) {
+    result.push_back(alphabet[(bits << (6 - nBits)) & 0x3F]);
+  }
+  while (result.size() % 4 != 0) {
+    result.push_back('=');
+  }
+  return result;
+}
+
+std::vector<std::uint8_t> random_bytes(std::size_t size_) {
+  std::mt19937 random{static_cast<std::mt19937::result_type>(size_)};
+  std::vector<std::uint8_t> result(size_);
+  for (auto &byte : result) {
+    byte = static_cast<std::uint8_t>(random());
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("Base64") {
+  // RFC 4648 test vectors.
+  CHECK_EQ(encode(""), "");
+  CHECK_EQ(encode("f"), "Zg==");
+  CHECK_EQ(encode("fo"), "Zm8=");
+  CHECK_EQ(encode("foo"), "Zm9v");
+  CHECK_EQ(encode("foob"), "Zm9vYg==");
+  CHECK_EQ(encode("fooba"), "Zm9vYmE=");
+  CHECK_EQ(encode("foobar"), "Zm9vYmFy");
+
+  // Every tail length after the vectorized part.
+  for (std::size_t size = 0; size < 200; ++size) {
+    const auto data = random_bytes(size);
+    std::string encoded(bee::base64_encoded_size(size), '\0');
+    bee::base64_encode(std::as_bytes(std::span{data}), encoded.data());
+    CHECK_EQ(encoded, reference_encode(data));
+  }
+}
+
+TEST_CASE("Base64 segmented buffer") {
+  // Large enough to be encoded in parallel,
+  // and split so that groups straddle segments.
+  const auto data = random_bytes(9 * 1024 * 1024 + 7);
+  bee::SegmentedBuffer buffer;
+  std::vector<std::uint8_t> expected;
+  std::size_t offset = 0;
+  for (std::size_t segmentSize = 1; offset < data.size();
+       segmentSize = segmentSize * 7 % 100003 + 1) {
+    const auto end = std::min(data.size(), offset + segmentSize);
+    bee::TrackedBytes segment(end - offset);
+    std::memcpy(segment.data(), data.data() + offset, segment.size());
+    buffer.append(std::move(segment));
+    expected.insert(expected.end(), data.begin() + offset, data.begin() + end);
+    buffer.pad(1);
+    expected.push_back(0);
+    offset = end;
+  }
+
+  std::string uri{"data:,"};
+  bee::base64_append(uri, buffer);
+  CHECK_EQ(uri, "data:," + reference_encode(expected));
+}
@@ -0,0 +1,79 @@
+#include <bee/Converter.h>
+#include <doctest/doctest.h>
+#include <fbxsdk.h>
+#include <filesystem>
+#include <fmt/format.h>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+std::filesystem::path create_batch_fbx_fixture(int node_count_) {
+  const auto manager = fbxsdk::FbxManager::Create();
+  const auto scene = fbxsdk::FbxScene::Create(manager, "myScene");
+  for (int iNode = 0; iNode < node_count_; ++iNode) {
+    const auto node = fbxsdk::FbxNode::Create(
+        scene, fmt::format("node-{}", iNode).c_str());
+    CHECK_UNARY(scene->GetRootNode()->AddChild(node));
+  }
+
+  const auto fbxPath = std::filesystem::temp_directory_path() /
+                       u8"FBX-glTF-conv-test" /
+                       fmt::format("batch-{}.fbx", node_count_);
+  std::filesystem::create_directories(fbxPath.parent_path());
+
+  const auto exporter = fbxsdk::FbxExporter::Create(manager, "");
+  CHECK_UNARY(exporter->Initialize(fbxPath.string().c_str(), -1));
+  CHECK_UNARY(exporter->Export(scene));
+  exporter->Destroy();
+  manager->Destroy();
+
+  return fbxPath;
+}
+} // namespace
+
+TEST_CASE("Batch conversion") {
+  std::vector<std::filesystem::path> inputs;
+  for (int nodeCount = 1; nodeCount <= 6; ++nodeCount) {
+    inputs.push_back(create_batch_fbx_fixture(nodeCount));
+  }
+  inputs.push_back(std::filesystem::temp_directory_path() /
+                   u8"FBX-glTF-conv-test" / u8"batch-non-existing.fbx");
+
+  std::mutex resultsMutex;
+  std::vector<std::optional<std::size_t>> nodeCounts(inputs.size());
+  std::vector<bool> failed(inputs.size(), false);
+
+  {
+    bee::BatchConverter batchConverter{2};
+    CHECK_EQ(batchConverter.threads(), 2);
+
+    bee::ConvertOptions options;
+    for (std::size_t iInput = 0; iInput < inputs.size(); ++iInput) {
+      batchConverter.post(
+          inputs[iInput].u8string(), options,
+          [&, iInput](std::optional<bee::glTF_output> &&output_,
+                      std::exception_ptr error_) {
+            std::unique_lock lock{resultsMutex};
+            if (error_) {
+              failed[iInput] = true;
+            } else {
+              nodeCounts[iInput] =
+                  nlohmann::json::parse(output_->json_text)["nodes"].size();
+            }
+          });
+    }
+    batchConverter.wait();
+  }
+
+  // Each worker reuses its FBX manager across jobs;
+  // the results should not be affected by previous jobs.
+  for (std::size_t iInput = 0; iInput + 1 < inputs.size(); ++iInput) {
+    CHECK_UNARY_FALSE(failed[iInput]);
+    CHECK_EQ(nodeCounts[iInput], iInput + 1);
+    std::filesystem::remove(inputs[iInput]);
+  }
+
+  CHECK_UNARY(failed.back());
+}
@@ -0,0 +1,30 @@
+#include <array>
+#include <bee/DracoCompression.h>
+#include <doctest/doctest.h>
+#include <stdexcept>
+#include <vector>
+
+TEST_CASE("Draco compression") {
+  const std::array<float, 12> positions = {0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0};
+  const std::vector<std::uint32_t> indices = {0, 1, 2, 0, 2, 3};
+  bee::DracoAttribute position;
+  position.name = "POSITION";
+  position.data = reinterpret_cast<const std::byte *>(positions.data());
+  position.byteStride = sizeof(float) * 3;
+  position.components = 3;
+  const std::array attributes = {position};
+  bee::DracoEncoding encoding;
+  encoding.preserveOrder = true;
+
+  if (!bee::is_draco_available()) {
+    CHECK_THROWS_AS(bee::encode_draco(attributes, 4, indices, encoding),
+                    std::runtime_error);
+    return;
+  }
+
+  const auto dracoMesh = bee::encode_draco(attributes, 4, indices, encoding);
+  CHECK(!dracoMesh.data.empty());
+  CHECK_EQ(dracoMesh.attributeIds.size(), 1);
+  CHECK_EQ(dracoMesh.vertexCount, 4);
+  CHECK_EQ(dracoMesh.indexCount, 6);
+}
@@ -0,0 +1,88 @@
+#include <bee/GLBWriter.h>
+#include <bee/SegmentedBuffer.h>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+bee::TrackedBytes make_bytes(std::initializer_list<std::uint8_t> bytes_) {
+  bee::TrackedBytes result;
+  for (const auto byte : bytes_) {
+    result.push_back(static_cast<std::byte>(byte));
+  }
+  return result;
+}
+} // namespace
+
+TEST_CASE("Write GLB") {
+  namespace fs = std::filesystem;
+
+  const auto dir = fs::temp_directory_path() / u8"FBX-glTF-conv-test";
+  fs::create_directories(dir);
+  const auto path = dir / u8"write-glb.glb";
+
+  bee::SegmentedBuffer bin;
+  bin.append(make_bytes({1, 2, 3}));
+  bin.pad(1);
+  bin.append(make_bytes({}));
+  bin.append(make_bytes({4, 5}));
+
+  const std::string_view json{"{}"};
+  CHECK_EQ(bee::glb_size(json, &bin), 12 + 8 + 4 + 8 + 8);
+  CHECK_EQ(bee::glb_size(json, nullptr), 12 + 8 + 4);
+
+  {
+    bee::OutputFile file{path.u8string()};
+    bee::write_glb(file, json, &bin);
+    file.close();
+  }
+
+  std::ifstream stream{path, std::ios::binary};
+  const std::vector<std::uint8_t> glb{std::istreambuf_iterator<char>{stream},
+                                      {}};
+  const std::vector<std::uint8_t> expected{
+      'g', 'l', 'T', 'F', 2,   0,   0,   0,   40,  0,   0,   0,   // Header
+      4,   0,   0,   0,   'J', 'S', 'O', 'N', '{', '}', ' ', ' ', // JSON
+      8,   0,   0,   0,   'B', 'I', 'N', 0,   1,   2,   3,   0,   4, 5, 0, 0,
+  };
+  CHECK_EQ(glb, expected);
+
+  fs::remove(path);
+}
+
+TEST_CASE("Gather write") {
+  namespace fs = std::filesystem;
+
+  const auto dir = fs::temp_directory_path() / u8"FBX-glTF-conv-test";
+  fs::create_directories(dir);
+  const auto path = dir / u8"gather-write.bin";
+
+  // More segments than a single `writev()` takes.
+  bee::SegmentedBuffer buffer;
+  std::vector<std::uint8_t> expected;
+  for (int i = 0; i < 3000; ++i) {
+    const auto byte = static_cast<std::uint8_t>(i);
+    buffer.append(make_bytes({byte, byte}));
+    expected.insert(expected.end(), {byte, byte});
+    if (i % 7 == 0) {
+      buffer.pad(3);
+      expected.insert(expected.end(), {0, 0, 0});
+    }
+  }
+
+  {
+    bee::OutputFile file{path.u8string()};
+    file.write(buffer.segments());
+    file.close();
+  }
+
+  std::ifstream stream{path, std::ios::binary};
+  const std::vector<std::uint8_t> written{
+      std::istreambuf_iterator<char>{stream}, {}};
+  CHECK_EQ(written, expected);
+
+  fs::remove(path);
+}
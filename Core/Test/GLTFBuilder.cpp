@@ -0,0 +1,57 @@
+#include <bee/GLTFBuilder.h>
+#include <doctest/doctest.h>
+#include <stdexcept>
+
+TEST_CASE("Buffer partition") {
+  bee::GLTFBuilder builder;
+  const auto meshBuffer = builder.createBuffer("Mesh");
+  // Left empty, so dropped.
+  builder.createBuffer("Empty");
+
+  const auto a = builder.createBufferView(14, 0, 0).index;
+  const auto b = builder.createBufferView(8, 4, meshBuffer).index;
+  const auto c = builder.createBufferView(8, 4, meshBuffer).index;
+  const auto d = builder.createBufferView(20, 4, meshBuffer).index;
+  const auto e = builder.createBufferView(2, 2, 0).index;
+  const auto f = builder.createBufferView(4, 4, 0).index;
+
+  bee::GLTFBuilder::BuildOptions buildOptions;
+  buildOptions.maxBufferSize = 16;
+  const auto result = builder.build(buildOptions);
+
+  const auto &document = builder.document();
+  REQUIRE_EQ(document.buffers.size(), 4);
+  REQUIRE_EQ(result.buffers.size(), 4);
+
+  const auto &bufferViews = document.bufferViews;
+  CHECK_EQ(bufferViews[a].buffer, 0);
+  CHECK_EQ(bufferViews[e].buffer, 0);
+  CHECK_EQ(bufferViews[e].byteOffset, 14);
+  CHECK_EQ(document.buffers[0].byteLength, 16);
+  CHECK_EQ(result.buffers[0].size(), 16);
+
+  // Would exceed the limit, so starts another buffer.
+  CHECK_EQ(bufferViews[f].buffer, 1);
+  CHECK_EQ(bufferViews[f].byteOffset, 0);
+  CHECK_EQ(document.buffers[1].byteLength, 4);
+
+  CHECK_EQ(bufferViews[b].buffer, 2);
+  CHECK_EQ(bufferViews[c].buffer, 2);
+  CHECK_EQ(bufferViews[c].byteOffset, 8);
+  CHECK_EQ(document.buffers[2].name, "Mesh");
+  CHECK_EQ(document.buffers[2].byteLength, 16);
+
+  // Larger than the limit, on its own.
+  CHECK_EQ(bufferViews[d].buffer, 3);
+  CHECK_EQ(bufferViews[d].byteOffset, 0);
+  CHECK_EQ(document.buffers[3].name, "Mesh");
+  CHECK_EQ(document.buffers[3].byteLength, 20);
+}
+
+TEST_CASE("Buffer view size limit") {
+  bee::GLTFBuilder builder;
+  CHECK_THROWS_AS(
+      builder.createBufferView(bee::GLTFBuilder::maxBufferViewSize + 1, 0, 0),
+      std::runtime_error);
+  CHECK(builder.document().bufferViews.empty());
+}
@@ -0,0 +1,122 @@
+#include <bee/GLTFJsonWriter.h>
+#include <doctest/doctest.h>
+#include <sstream>
+#include <string>
+
+namespace {
+fx::gltf::Document make_document() {
+  fx::gltf::Document document;
+  document.asset.generator = "FBX-glTF-conv";
+  document.extensionsUsed.push_back("KHR_texture_transform");
+
+  auto &buffer = document.buffers.emplace_back();
+  buffer.byteLength = 48;
+  buffer.uri = "a.bin";
+
+  auto &bufferView = document.bufferViews.emplace_back();
+  bufferView.buffer = 0;
+  bufferView.byteLength = 48;
+  bufferView.target = fx::gltf::BufferView::TargetType::ArrayBuffer;
+
+  auto &accessor = document.accessors.emplace_back();
+  accessor.bufferView = 0;
+  accessor.componentType = fx::gltf::Accessor::ComponentType::Float;
+  accessor.count = 4;
+  accessor.type = fx::gltf::Accessor::Type::Vec3;
+  accessor.min = {-0.5f, 0.0f, -1.25f};
+  accessor.max = {0.5f, 2.0f, 1.25f};
+
+  auto &mesh = document.meshes.emplace_back();
+  auto &primitive = mesh.primitives.emplace_back();
+  primitive.attributes["POSITION"] = 0;
+  primitive.attributes["NORMAL"] = 0;
+  primitive.targets.emplace_back()["POSITION"] = 0;
+  mesh.weights = {0.25f};
+  mesh.extensionsAndExtras["extras"]["targetNames"] = {"smile"};
+
+  auto &material = document.materials.emplace_back();
+  material.name = "Quote\" Backslash\\ Tab\t Bell\x07";
+  material.alphaMode = fx::gltf::Material::AlphaMode::Mask;
+  material.pbrMetallicRoughness.baseColorTexture.index = 0;
+  material.pbrMetallicRoughness.baseColorTexture.extensionsAndExtras
+      ["extensions"]["KHR_texture_transform"]["scale"] = {2.0, 2.0};
+
+  auto &node = document.nodes.emplace_back();
+  node.name = "Root";
+  node.mesh = 0;
+  node.translation = {1.5f, 0.0f, -2.0f};
+
+  document.samplers.emplace_back();
+
+  auto &animation = document.animations.emplace_back();
+  auto &sampler = animation.samplers.emplace_back();
+  sampler.input = 0;
+  sampler.output = 0;
+  sampler.interpolation = fx::gltf::Animation::Sampler::Type::Step;
+  auto &channel = animation.channels.emplace_back();
+  channel.sampler = 0;
+  channel.target.node = 0;
+  channel.target.path = "translation";
+
+  document.scene = 0;
+  document.scenes.emplace_back().nodes.push_back(0);
+  return document;
+}
+} // namespace
+
+TEST_CASE("glTF JSON writer") {
+  const auto document = make_document();
+  nlohmann::json expected;
+  fx::gltf::to_json(expected, document);
+
+  SUBCASE("Same members as fx::gltf") {
+    const auto indented = bee::to_gltf_json(document, false);
+    CHECK_EQ(nlohmann::json::parse(indented), expected);
+
+    const auto compact = bee::to_gltf_json(document, true);
+    CHECK_EQ(nlohmann::json::parse(compact), expected);
+    CHECK_EQ(compact.find('\n'), std::string::npos);
+
+    std::ostringstream stream;
+    bee::write_gltf_json(stream, document, true);
+    CHECK_EQ(stream.str(), compact);
+  }
+
+  SUBCASE("Layout") {
+    fx::gltf::Document small;
+    small.asset.generator = "FBX-glTF-conv";
+    small.nodes.emplace_back().translation = {0.1f, 0.0f, 0.0f};
+    small.scenes.emplace_back();
+    small.extensionsAndExtras["extras"]["a"] = {1, 2};
+
+    CHECK_EQ(bee::to_gltf_json(small, true),
+             R"({"asset":{"generator":"FBX-glTF-conv","version":"2.0"},)"
+             R"("nodes":[{"translation":[0.1,0,0]}],"scenes":[{}],)"
+             R"("extras":{"a":[1,2]}})");
+
+    CHECK_EQ(bee::to_gltf_json(small, false), R"({
+  "asset": {
+    "generator": "FBX-glTF-conv",
+    "version": "2.0"
+  },
+  "nodes": [
+    {
+      "translation": [
+        0.1,
+        0,
+        0
+      ]
+    }
+  ],
+  "scenes": [
+    {}
+  ],
+  "extras": {
+    "a": [
+      1,
+      2
+    ]
+  }
+})");
+  }
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <array>
+#include <bee/Hash.h>
+#include <doctest/doctest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+std::uint64_t hash_string(std::string_view string_, std::uint64_t seed_ = 0) {
+  return bee::hash64(std::as_bytes(std::span{string_.data(), string_.size()}),
+                     seed_);
+}
+} // namespace
+
+TEST_CASE("XXH64") {
+  // Reference values from the xxHash implementation.
+  CHECK_EQ(hash_string(""), 0xEF46DB3751D8E999ULL);
+  CHECK_EQ(hash_string("abc"), 0x44BC2CF5AD770999ULL);
+
+  std::string data;
+  for (int i = 0; i < 1000; ++i) {
+    data.push_back(static_cast<char>((i * 131 + 7) & 0xFF));
+  }
+  CHECK_EQ(hash_string(data), 0x0BF0BDBCC82EB373ULL);
+
+  { // Incremental hashing equals one-shot hashing
+    for (const std::size_t size : {0, 1, 3, 4, 8, 31, 32, 33, 100, 1000}) {
+      const auto expected =
+          hash_string(std::string_view{data.data(), size}, 42);
+      bee::Hasher64 hasher{42};
+      for (std::size_t offset = 0; offset < size;) {
+        const auto nBytes =
+            std::min<std::size_t>(size - offset, offset % 7 + 1);
+        hasher.update(std::string_view{data.data() + offset, nBytes});
+        offset += nBytes;
+      }
+      CHECK_EQ(hasher.digest(), expected);
+    }
+  }
+
+  CHECK_NE(hash_string(data, 0), hash_string(data, 1));
+}
+
+TEST_CASE("Short key hash") {
+  std::array<std::byte, 40> key{};
+  for (std::size_t iByte = 0; iByte < key.size(); ++iByte) {
+    key[iByte] = static_cast<std::byte>(iByte * 7);
+  }
+  // Every byte and the size count.
+  std::vector<std::uint64_t> hashes;
+  for (const std::size_t size : {0, 4, 8, 12, 16, 24, 32, 40}) {
+    hashes.push_back(bee::hash64_short(key.data(), size));
+  }
+  for (std::size_t iByte = 0; iByte < key.size(); ++iByte) {
+    auto flipped = key;
+    flipped[iByte] ^= std::byte{1};
+    hashes.push_back(bee::hash64_short(flipped.data(), flipped.size()));
+  }
+  std::sort(hashes.begin(), hashes.end());
+  CHECK_EQ(std::adjacent_find(hashes.begin(), hashes.end()), hashes.end());
+  CHECK_EQ(bee::hash64_short(key.data(), key.size()),
+           bee::hash64_short(key.data(), key.size()));
+}
@@ -0,0 +1,63 @@
+#include <bee/Convert/fbxsdk/LayerelementAccessor.h>
+#include <doctest/doctest.h>
+#include <memory>
+#include <vector>
+
+TEST_CASE("Layer element accessor") {
+  using Mapping = bee::FbxLayerElementMapping;
+  const auto direct = std::make_shared<const std::vector<int>>(
+      std::vector<int>{10, 11, 12, 13, 14, 15});
+  const auto index = std::make_shared<const std::vector<int>>(
+      std::vector<int>{5, 4, 3, 2, 1, 0});
+
+  // Polygon vertex `i` is control point `5 - i`, of polygon `i / 3`.
+  const auto params = [](int i_) {
+    bee::FbxLayerElementAccessParams params;
+    params.controlPointIndex = 5 - i_;
+    params.polygonVertexIndex = i_;
+    params.polygonIndex = i_ / 3;
+    return params;
+  };
+  const bee::FbxLayerElementCounts counts{6, 6, 2};
+
+  const auto readAll = [&](const bee::FbxLayerElementAccessor<int> &accessor_,
+                           const bee::FbxLayerElementCounts &counts_) {
+    return accessor_.visit(counts_, [&](auto read_) {
+      std::vector<int> values;
+      for (int i = 0; i < 6; ++i) {
+        values.push_back(read_(params(i)));
+      }
+      return values;
+    });
+  };
+
+  SUBCASE("Specialized readers read as the generic one") {
+    for (const auto mapping : {Mapping::controlPoint, Mapping::polygonVertex,
+                               Mapping::polygon, Mapping::constant}) {
+      for (const auto indexed : {false, true}) {
+        const bee::FbxLayerElementAccessor<int> accessor{
+            mapping, direct, indexed ? index : nullptr, -1};
+        std::vector<int> expected;
+        for (int i = 0; i < 6; ++i) {
+          expected.push_back(accessor(params(i)));
+        }
+        CHECK_EQ(readAll(accessor, counts), expected);
+      }
+    }
+
+    const bee::FbxLayerElementAccessor<int> byPolygonVertex{
+        Mapping::polygonVertex, direct, index, -1};
+    const std::vector<int> reversed{15, 14, 13, 12, 11, 10};
+    CHECK_EQ(readAll(byPolygonVertex, counts), reversed);
+  }
+
+  SUBCASE("Out of range") {
+    const auto shortIndex = std::make_shared<const std::vector<int>>(
+        std::vector<int>{0, 1, 9, 2});
+    const bee::FbxLayerElementAccessor<int> accessor{
+        Mapping::polygonVertex, direct, shortIndex, -1};
+    // Falls back to the generic reader, which reads the default instead.
+    const std::vector<int> expected{10, 11, -1, 12, -1, -1};
+    CHECK_EQ(readAll(accessor, counts), expected);
+  }
+}
@@ -0,0 +1,99 @@
+#include <bee/ConvertStats.h>
+#include <bee/Memory.h>
+#include <doctest/doctest.h>
+#include <fstream>
+#include <new>
+#include <optional>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+TEST_CASE("Allocation tracking") {
+  const auto base = bee::AllocationTracker::live();
+
+  bee::ConvertStats::Phase outer;
+  bee::ConvertStats::Phase inner;
+  {
+    bee::ScopedPhase outerScope{outer};
+    std::optional<bee::TrackedBytes> bytes{bee::TrackedBytes(1000)};
+    CHECK_EQ(bee::AllocationTracker::live(), base + 1000);
+    {
+      bee::ScopedPhase innerScope{inner};
+      bytes.reset();
+      bee::TrackedBytes smaller(10);
+    }
+    CHECK_EQ(bee::AllocationTracker::live(), base);
+  }
+
+  // The inner phase starts from what's live then;
+  // the outer one keeps its own high-water mark across the inner one.
+  CHECK_EQ(inner.peak_allocated, base + 1000);
+  CHECK_EQ(outer.peak_allocated, base + 1000);
+  CHECK_GE(outer.wall, inner.wall);
+
+  bee::ConvertStats::Phase later;
+  {
+    bee::ScopedPhase laterScope{later};
+    bee::TrackedBytes bytes(10);
+  }
+  CHECK_EQ(later.peak_allocated, base + 10);
+}
+
+TEST_CASE("Virtual arena") {
+  const auto base = bee::AllocationTracker::live();
+
+  bee::VirtualArenaPool pool;
+  auto arena = pool.acquire(1 << 20);
+  CHECK_GE(arena->capacity(), 1 << 20);
+  const auto first = arena->append(3);
+  first[0] = std::byte{1};
+  // Growing commits more pages but never moves what's there.
+  const auto second = arena->append(256 << 10);
+  CHECK_EQ(second, first + 3);
+  CHECK_EQ(first[0], std::byte{1});
+  CHECK_EQ(arena->size(), 3 + (256 << 10));
+  CHECK_GE(bee::AllocationTracker::live(), base + arena->size());
+  CHECK_THROWS_AS(arena->append(arena->capacity()), std::bad_alloc);
+
+  const auto data = arena->data();
+  pool.release(std::move(arena));
+  // Given back empty, with its pages kept.
+  arena = pool.acquire(1 << 20);
+  CHECK_EQ(arena->data(), data);
+  CHECK_EQ(arena->size(), 0);
+  arena->trim(0);
+  CHECK_EQ(bee::AllocationTracker::live(), base);
+
+  // Larger than any kept.
+  const auto larger = pool.acquire(arena->capacity() + 1);
+  CHECK_NE(larger->data(), data);
+}
+
+#ifdef __linux__
+TEST_CASE("Virtual arena in limited address space") {
+  rlimit limit;
+  REQUIRE_EQ(::getrlimit(RLIMIT_AS, &limit), 0);
+  std::size_t pages = 0;
+  std::ifstream{"/proc/self/statm"} >> pages;
+  REQUIRE_GT(pages, 0);
+  // Room for what's asked for, but not for the default capacity.
+  const auto room = bee::VirtualArenaPool::defaultCapacity / 4;
+  const auto used = pages * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < used + room) {
+    return;
+  }
+  rlimit limited = limit;
+  limited.rlim_cur = used + room;
+  REQUIRE_EQ(::setrlimit(RLIMIT_AS, &limited), 0);
+
+  bee::VirtualArenaPool pool;
+  std::unique_ptr<bee::VirtualArena> arena;
+  CHECK_NOTHROW(arena = pool.acquire(1 << 20));
+  REQUIRE_EQ(::setrlimit(RLIMIT_AS, &limit), 0);
+  REQUIRE(arena);
+  CHECK_GE(arena->capacity(), 1 << 20);
+  CHECK_LT(arena->capacity(), bee::VirtualArenaPool::defaultCapacity);
+}
+#endif
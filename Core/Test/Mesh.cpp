@@ -1,4 +1,5 @@
-﻿#include <bee/Converter.Test.h>
+﻿#include <array>
+#include <bee/Converter.Test.h>
 #include <doctest/doctest.h>
 #include <fbxsdk.h>
 #include <filesystem>
@@ -667,4 +668,520 @@ TEST_CASE("Mesh") {
           get_gltf_node_by_name(result.document(), fmt::format("node{}-ref-to-shared-mesh", i));
     }
   }
+
+  SUBCASE("Mesh threads") {
+    const auto fixture = create_fbx_scene_fixture(
+        [](fbxsdk::FbxManager &manager_) -> fbxsdk::FbxScene & {
+          const auto scene = fbxsdk::FbxScene::Create(&manager_, "myScene");
+          for (const auto iNode : ranges::views::iota(0, 8)) {
+            const auto node = fbxsdk::FbxNode::Create(
+                scene, fmt::format("node-{}", iNode).c_str());
+            CHECK_UNARY(scene->GetRootNode()->AddChild(node));
+            const auto mesh = fbxsdk::FbxMesh::Create(
+                scene, fmt::format("mesh-{}", iNode).c_str());
+            const auto nTriangles = 1 + iNode * 50;
+            mesh->InitControlPoints(nTriangles * 3);
+            for (const auto iTriangle : ranges::views::iota(0, nTriangles)) {
+              mesh->SetControlPointAt(FbxVector4(iTriangle, 0, 0),
+                                      iTriangle * 3);
+              mesh->SetControlPointAt(FbxVector4(iTriangle, 1, 0),
+                                      iTriangle * 3 + 1);
+              mesh->SetControlPointAt(FbxVector4(iTriangle, 0, 1),
+                                      iTriangle * 3 + 2);
+              mesh->BeginPolygon();
+              mesh->AddPolygon(iTriangle * 3);
+              mesh->AddPolygon(iTriangle * 3 + 1);
+              mesh->AddPolygon(iTriangle * 3 + 2);
+              mesh->EndPolygon();
+            }
+            CHECK_UNARY(node->AddNodeAttribute(mesh));
+          }
+          return *scene;
+        });
+
+    const auto convert = [&fixture](std::uint32_t mesh_threads_) {
+      bee::ConvertOptions options;
+      options.mesh_threads = mesh_threads_;
+      const auto result = bee::_convert_test(fixture.path().u8string(), options);
+      nlohmann::json json;
+      fx::gltf::to_json(json, result.document());
+      return json;
+    };
+
+    const auto serial = convert(1);
+    CHECK_EQ(serial["meshes"].size(), 8);
+    CHECK_EQ(convert(4), serial);
+  }
+
+  SUBCASE("Vertices per control point") {
+    // A quad whose normals are mapped by polygon vertex. If their index
+    // array follows the control points, the control points are the vertices.
+    const auto convert = [](const std::vector<int> &normal_indices_) {
+      const auto fixture = create_fbx_scene_fixture(
+          [&normal_indices_](
+              fbxsdk::FbxManager &manager_) -> fbxsdk::FbxScene & {
+            const auto scene = fbxsdk::FbxScene::Create(&manager_, "myScene");
+            const auto mesh = fbxsdk::FbxMesh::Create(scene, "quad");
+            mesh->InitControlPoints(4);
+            mesh->SetControlPointAt(FbxVector4(0, 0, 0), 0);
+            mesh->SetControlPointAt(FbxVector4(1, 0, 0), 1);
+            mesh->SetControlPointAt(FbxVector4(1, 1, 0), 2);
+            mesh->SetControlPointAt(FbxVector4(0, 1, 0), 3);
+            for (const auto &triangle : {std::array{0, 1, 2}, {0, 2, 3}}) {
+              mesh->BeginPolygon();
+              for (const auto iControlPoint : triangle) {
+                mesh->AddPolygon(iControlPoint);
+              }
+              mesh->EndPolygon();
+            }
+
+            const auto normals = mesh->CreateElementNormal();
+            normals->SetMappingMode(
+                fbxsdk::FbxLayerElement::EMappingMode::eByPolygonVertex);
+            normals->SetReferenceMode(
+                fbxsdk::FbxLayerElement::EReferenceMode::eIndexToDirect);
+            for (const auto iNormal : ranges::views::iota(0, 5)) {
+              normals->GetDirectArray().Add(
+                  FbxVector4(0, iNormal == 4 ? 1 : 0, 1));
+            }
+            for (const auto iNormal : normal_indices_) {
+              normals->GetIndexArray().Add(iNormal);
+            }
+
+            const auto node = fbxsdk::FbxNode::Create(scene, "node");
+            CHECK_UNARY(scene->GetRootNode()->AddChild(node));
+            CHECK_UNARY(node->AddNodeAttribute(mesh));
+            return *scene;
+          });
+      bee::ConvertOptions options;
+      const auto result = bee::_convert_test(fixture.path().u8string(), options);
+      const auto &document = result.document();
+      const auto &primitive = document.meshes[0].primitives[0];
+      return std::make_pair(
+          document.accessors[primitive.attributes.at("POSITION")].count,
+          document.accessors[primitive.indices].count);
+    };
+
+    CHECK_EQ(convert({0, 1, 2, 0, 2, 3}), std::make_pair(4u, 6u));
+    // Control point 0 has another normal in the second triangle.
+    CHECK_EQ(convert({0, 1, 2, 4, 2, 3}), std::make_pair(5u, 6u));
+  }
+
+  SUBCASE("Shapes of deduplicated vertices") {
+    // A quad with hard normals at control points 0 and 2, shared by both
+    // triangles, and a shape lifting control point 0.
+    const auto fixture = create_fbx_scene_fixture(
+        [](fbxsdk::FbxManager &manager_) -> fbxsdk::FbxScene & {
+          const auto scene = fbxsdk::FbxScene::Create(&manager_, "myScene");
+          const auto mesh = fbxsdk::FbxMesh::Create(scene, "quad");
+          const std::array quad{FbxVector4(0, 0, 0), FbxVector4(1, 0, 0),
+                                FbxVector4(1, 1, 0), FbxVector4(0, 1, 0)};
+          mesh->InitControlPoints(4);
+          for (const auto iControlPoint : ranges::views::iota(0, 4)) {
+            mesh->SetControlPointAt(quad[iControlPoint], iControlPoint);
+          }
+          for (const auto &triangle : {std::array{0, 1, 2}, {0, 2, 3}}) {
+            mesh->BeginPolygon();
+            for (const auto iControlPoint : triangle) {
+              mesh->AddPolygon(iControlPoint);
+            }
+            mesh->EndPolygon();
+          }
+
+          const auto normals = mesh->CreateElementNormal();
+          normals->SetMappingMode(
+              fbxsdk::FbxLayerElement::EMappingMode::eByPolygonVertex);
+          normals->SetReferenceMode(
+              fbxsdk::FbxLayerElement::EReferenceMode::eDirect);
+          for (const auto iPolygonVertex : ranges::views::iota(0, 6)) {
+            normals->GetDirectArray().Add(
+                FbxVector4(0, iPolygonVertex < 3 ? 0 : 1, 1));
+          }
+
+          const auto shape = fbxsdk::FbxShape::Create(scene, "lift");
+          shape->InitControlPoints(4);
+          for (const auto iControlPoint : ranges::views::iota(0, 4)) {
+            shape->SetControlPointAt(
+                quad[iControlPoint] +
+                    FbxVector4(0, 0, iControlPoint == 0 ? 1 : 0),
+                iControlPoint);
+          }
+          const auto channel =
+              fbxsdk::FbxBlendShapeChannel::Create(scene, "lift");
+          CHECK_UNARY(channel->AddTargetShape(shape));
+          const auto blendShape =
+              fbxsdk::FbxBlendShape::Create(scene, "blend-shape");
+          CHECK_UNARY(blendShape->AddBlendShapeChannel(channel));
+          mesh->AddDeformer(blendShape);
+
+          const auto node = fbxsdk::FbxNode::Create(scene, "node");
+          CHECK_UNARY(scene->GetRootNode()->AddChild(node));
+          CHECK_UNARY(node->AddNodeAttribute(mesh));
+          return *scene;
+        });
+
+    bee::ConvertOptions options;
+    const auto result = bee::_convert_test(fixture.path().u8string(), options);
+    const auto &document = result.document();
+    const auto &primitive = document.meshes[0].primitives[0];
+    CHECK_EQ(document.accessors[primitive.attributes.at("POSITION")].count, 6);
+    REQUIRE_EQ(primitive.targets.size(), 1);
+    const auto &target =
+        document.accessors[primitive.targets[0].at("POSITION")];
+    CHECK_EQ(target.count, 6);
+    const std::vector<float> min{0, 0, 0}, max{0, 0, 1};
+    CHECK_EQ(target.min, min);
+    CHECK_EQ(target.max, max);
+    // Only the copies of control point 0 move, so it's sparse.
+    CHECK_EQ(target.bufferView, -1);
+    CHECK_EQ(target.sparse.count, 2);
+  }
+
+  SUBCASE("Quantization") {
+    // A quad from (0, 0) to (4, 4): quantized around (2, 2) by 2.
+    const auto fixture = create_fbx_scene_fixture(
+        [](fbxsdk::FbxManager &manager_) -> fbxsdk::FbxScene & {
+          const auto scene = fbxsdk::FbxScene::Create(&manager_, "myScene");
+          const auto mesh = fbxsdk::FbxMesh::Create(scene, "quad");
+          mesh->InitControlPoints(4);
+          mesh->SetControlPointAt(FbxVector4(0, 0, 0), 0);
+          mesh->SetControlPointAt(FbxVector4(4, 0, 0), 1);
+          mesh->SetControlPointAt(FbxVector4(4, 4, 0), 2);
+          mesh->SetControlPointAt(FbxVector4(0, 4, 0), 3);
+          for (const auto &triangle : {std::array{0, 1, 2}, {0, 2, 3}}) {
+            mesh->BeginPolygon();
+            for (const auto iControlPoint : triangle) {
+              mesh->AddPolygon(iControlPoint);
+            }
+            mesh->EndPolygon();
+          }
+
+          const auto node = fbxsdk::FbxNode::Create(scene, "node");
+          CHECK_UNARY(scene->GetRootNode()->AddChild(node));
+          CHECK_UNARY(node->AddNodeAttribute(mesh));
+          return *scene;
+        });
+
+    bee::ConvertOptions options;
+    options.meshQuantization.position_bits = 16;
+    const auto result = bee::_convert_test(fixture.path().u8string(), options);
+    const auto &document = result.document();
+    const auto &position = document.accessors[document.meshes[0]
+                                                  .primitives[0]
+                                                  .attributes.at("POSITION")];
+    CHECK_EQ(position.componentType, fx::gltf::Accessor::ComponentType::Short);
+    CHECK_UNARY(position.normalized);
+    const std::vector<float> min{-32767, -32767, 0}, max{32767, 32767, 0};
+    CHECK_EQ(position.min, min);
+    CHECK_EQ(position.max, max);
+    const std::vector<std::string> extensions{"KHR_mesh_quantization"};
+    CHECK_EQ(document.extensionsRequired, extensions);
+
+    // The mesh is scaled back by a child of its node.
+    const auto &node = *ranges::find_if(
+        document.nodes, [](const auto &node_) { return node_.name == "node"; });
+    CHECK_EQ(node.mesh, -1);
+    REQUIRE_EQ(node.children.size(), 1);
+    const auto &meshNode = document.nodes[node.children[0]];
+    CHECK_EQ(meshNode.mesh, 0);
+    const std::array<float, 3> translation{2, 2, 0}, scale{2, 2, 2};
+    CHECK_EQ(meshNode.translation, translation);
+    CHECK_EQ(meshNode.scale, scale);
+  }
+
+  SUBCASE("Meshopt filters without compression") {
+    // A quad lifted as a whole by a shape, of which the deltas are a bulk of
+    // positions only.
+    const auto fixture = create_fbx_scene_fixture(
+        [](fbxsdk::FbxManager &manager_) -> fbxsdk::FbxScene & {
+          const auto scene = fbxsdk::FbxScene::Create(&manager_, "myScene");
+          const auto mesh = fbxsdk::FbxMesh::Create(scene, "quad");
+          const std::array quad{FbxVector4(0, 0, 0), FbxVector4(1, 0, 0),
+                                FbxVector4(1, 1, 0), FbxVector4(0, 1, 0)};
+          mesh->InitControlPoints(4);
+          for (const auto iControlPoint : ranges::views::iota(0, 4)) {
+            mesh->SetControlPointAt(quad[iControlPoint], iControlPoint);
+          }
+          for (const auto &triangle : {std::array{0, 1, 2}, {0, 2, 3}}) {
+            mesh->BeginPolygon();
+            for (const auto iControlPoint : triangle) {
+              mesh->AddPolygon(iControlPoint);
+            }
+            mesh->EndPolygon();
+          }
+
+          const auto shape = fbxsdk::FbxShape::Create(scene, "lift");
+          shape->InitControlPoints(4);
+          for (const auto iControlPoint : ranges::views::iota(0, 4)) {
+            shape->SetControlPointAt(
+                quad[iControlPoint] + FbxVector4(0, 0, 1.001), iControlPoint);
+          }
+          const auto channel =
+              fbxsdk::FbxBlendShapeChannel::Create(scene, "lift");
+          CHECK_UNARY(channel->AddTargetShape(shape));
+          const auto blendShape =
+              fbxsdk::FbxBlendShape::Create(scene, "blend-shape");
+          CHECK_UNARY(blendShape->AddBlendShapeChannel(channel));
+          mesh->AddDeformer(blendShape);
+
+          const auto node = fbxsdk::FbxNode::Create(scene, "node");
+          CHECK_UNARY(scene->GetRootNode()->AddChild(node));
+          CHECK_UNARY(node->AddNodeAttribute(mesh));
+          return *scene;
+        });
+
+    bee::ConvertOptions options;
+    // 8 bits would round the deltas to 1.
+    options.meshoptCompression.exponential_bits = 8;
+    options.meshoptCompression.octahedral_normals = true;
+    const auto result = bee::_convert_test(fixture.path().u8string(), options);
+    const auto &document = result.document();
+    const auto &primitive = document.meshes[0].primitives[0];
+    REQUIRE_EQ(primitive.targets.size(), 1);
+    const auto &target =
+        document.accessors[primitive.targets[0].at("POSITION")];
+    CHECK_NE(target.bufferView, -1);
+    const std::vector<float> bounds{0, 0, 1.001f};
+    CHECK_EQ(target.min, bounds);
+    CHECK_EQ(target.max, bounds);
+    CHECK_UNARY(document.extensionsUsed.empty());
+  }
+
+  SUBCASE("Levels of detail") {
+    // A flat grid, which simplifies with no error.
+    createFbxGrid("LOD.fbx", 16);
+    bee::ConvertOptions options;
+    options.levelsOfDetail.levels.resize(2);
+    options.levelsOfDetail.levels[0].ratio = 0.5f;
+    options.levelsOfDetail.levels[1].ratio = 0.25f;
+    const auto result = bee::_convert_test(u8"LOD.fbx", options);
+    const auto &document = result.document();
+
+    const auto &node = get_gltf_node_by_name(document, "Gird");
+    REQUIRE_GE(node.mesh, 0);
+    const auto &mesh = document.meshes[node.mesh];
+    const auto countIndices = [&document](const fx::gltf::Mesh &mesh_) {
+      return document.accessors[mesh_.primitives[0].indices].count;
+    };
+
+    const auto &extensions = node.extensionsAndExtras.at("extensions");
+    const auto &ids = extensions.at("MSFT_lod").at("ids");
+    REQUIRE_EQ(ids.size(), 2);
+    auto previousIndexCount = countIndices(mesh);
+    for (const auto iLevel : ranges::views::iota(0, 2)) {
+      const auto levelNodeIndex = ids[iLevel].get<std::int32_t>();
+      const auto &levelNode = document.nodes[levelNodeIndex];
+      CHECK_EQ(levelNode.name, fmt::format("Gird/LOD{}", iLevel + 1));
+      // Readers put the level nodes beside the node, not in the hierarchy.
+      CHECK_EQ(ranges::count(document.scenes[0].nodes, levelNodeIndex), 0);
+      REQUIRE_GE(levelNode.mesh, 0);
+      const auto &levelMesh = document.meshes[levelNode.mesh];
+      CHECK_EQ(levelMesh.name, fmt::format("{}/LOD{}", mesh.name, iLevel + 1));
+      // Only the indices differ.
+      REQUIRE_EQ(levelMesh.primitives.size(), mesh.primitives.size());
+      CHECK_EQ(levelMesh.primitives[0].attributes,
+               mesh.primitives[0].attributes);
+      const auto indexCount = countIndices(levelMesh);
+      CHECK_LT(indexCount, previousIndexCount);
+      previousIndexCount = indexCount;
+    }
+
+    const auto &coverages =
+        node.extensionsAndExtras.at("extras").at("MSFT_screencoverage");
+    REQUIRE_EQ(coverages.size(), 3);
+    CHECK_EQ(coverages[2].get<float>(), 0);
+
+    // Readers not supporting it draw the full mesh.
+    CHECK_EQ(ranges::count(document.extensionsUsed, "MSFT_lod"), 1);
+    CHECK_EQ(ranges::count(document.extensionsRequired, "MSFT_lod"), 0);
+  }
+
+  SUBCASE("GPU instancing") {
+    // Under a group: three placed instances of a quad, an animated one and two
+    // instances of a deformed quad.
+    const auto fixture = create_fbx_scene_fixture(
+        [](fbxsdk::FbxManager &manager_) -> fbxsdk::FbxScene & {
+          const auto scene = fbxsdk::FbxScene::Create(&manager_, "myScene");
+          const auto createQuad = [scene](const char *name_) {
+            const auto mesh = fbxsdk::FbxMesh::Create(scene, name_);
+            mesh->InitControlPoints(4);
+            mesh->SetControlPointAt(FbxVector4(0, 0, 0), 0);
+            mesh->SetControlPointAt(FbxVector4(1, 0, 0), 1);
+            mesh->SetControlPointAt(FbxVector4(1, 1, 0), 2);
+            mesh->SetControlPointAt(FbxVector4(0, 1, 0), 3);
+            for (const auto &triangle : {std::array{0, 1, 2}, {0, 2, 3}}) {
+              mesh->BeginPolygon();
+              for (const auto iControlPoint : triangle) {
+                mesh->AddPolygon(iControlPoint);
+              }
+              mesh->EndPolygon();
+            }
+            return mesh;
+          };
+
+          const auto group = fbxsdk::FbxNode::Create(scene, "group");
+          CHECK_UNARY(scene->GetRootNode()->AddChild(group));
+          const auto addInstance = [scene, group](const char *name_,
+                                                  fbxsdk::FbxMesh *mesh_) {
+            const auto node = fbxsdk::FbxNode::Create(scene, name_);
+            CHECK_UNARY(group->AddChild(node));
+            CHECK_UNARY(node->AddNodeAttribute(mesh_));
+            return node;
+          };
+
+          const auto quad = createQuad("quad");
+          for (const auto iInstance : ranges::views::iota(0, 3)) {
+            const auto node = addInstance(
+                fmt::format("instance-{}", iInstance).c_str(), quad);
+            node->LclTranslation.Set(FbxDouble3(iInstance, 0, 0));
+            node->LclRotation.Set(FbxDouble3(0, 0, 90. * iInstance));
+            node->LclScaling.Set(FbxDouble3(1. + iInstance, 1, 1));
+          }
+
+          const auto animated = addInstance("animated", quad);
+          const auto animStack = fbxsdk::FbxAnimStack::Create(scene, "stack");
+          const auto animLayer = fbxsdk::FbxAnimLayer::Create(scene, "layer");
+          CHECK_UNARY(animStack->AddMember(animLayer));
+          const auto curve = animated->LclTranslation.GetCurve(
+              animLayer, FBXSDK_CURVENODE_COMPONENT_X, true);
+          curve->KeyModifyBegin();
+          for (const auto iKey : ranges::views::iota(0, 2)) {
+            fbxsdk::FbxTime time;
+            time.SetSecondDouble(iKey);
+            curve->KeySetValue(curve->KeyAdd(time), static_cast<float>(iKey));
+          }
+          curve->KeyModifyEnd();
+
+          const auto deformedQuad = createQuad("deformed-quad");
+          const auto shape = fbxsdk::FbxShape::Create(scene, "lift");
+          shape->InitControlPoints(4);
+          for (const auto iControlPoint : ranges::views::iota(0, 4)) {
+            shape->SetControlPointAt(
+                deformedQuad->GetControlPointAt(iControlPoint) +
+                    FbxVector4(0, 0, 1),
+                iControlPoint);
+          }
+          const auto channel =
+              fbxsdk::FbxBlendShapeChannel::Create(scene, "lift");
+          CHECK_UNARY(channel->AddTargetShape(shape));
+          const auto blendShape =
+              fbxsdk::FbxBlendShape::Create(scene, "blend-shape");
+          CHECK_UNARY(blendShape->AddBlendShapeChannel(channel));
+          deformedQuad->AddDeformer(blendShape);
+          addInstance("deformed-0", deformedQuad);
+          addInstance("deformed-1", deformedQuad);
+          return *scene;
+        });
+
+    const auto hasNode = [](const fx::gltf::Document &document_,
+                            std::string_view name_) {
+      return ranges::any_of(document_.nodes, [name_](const auto &node_) {
+        return node_.name == name_;
+      });
+    };
+    const auto getInstancing =
+        [](const fx::gltf::Node &node_) -> const bee::Json * {
+      const auto extensions = node_.extensionsAndExtras.find("extensions");
+      if (extensions == node_.extensionsAndExtras.end() ||
+          !extensions->contains("EXT_mesh_gpu_instancing")) {
+        return nullptr;
+      }
+      return &extensions->at("EXT_mesh_gpu_instancing");
+    };
+    const auto checkIdentity = [](const fx::gltf::Node &node_) {
+      const std::array<float, 3> translation{0, 0, 0}, scale{1, 1, 1};
+      const std::array<float, 4> rotation{0, 0, 0, 1};
+      CHECK_EQ(node_.translation, translation);
+      CHECK_EQ(node_.rotation, rotation);
+      CHECK_EQ(node_.scale, scale);
+    };
+    const auto checkExtension = [](const fx::gltf::Document &document_,
+                                   bool used_) {
+      const auto count = used_ ? 1 : 0;
+      CHECK_EQ(ranges::count(document_.extensionsUsed,
+                             "EXT_mesh_gpu_instancing"),
+               count);
+      // Readers not supporting it would draw a single instance.
+      CHECK_EQ(ranges::count(document_.extensionsRequired,
+                             "EXT_mesh_gpu_instancing"),
+               count);
+    };
+
+    bee::ConvertOptions options;
+    options.gpuInstancing.enabled = true;
+
+    SUBCASE("Siblings sharing a mesh") {
+      const auto result =
+          bee::_convert_test(fixture.path().u8string(), options);
+      const auto &document = result.document();
+
+      // The placed instances collapse into the first of them.
+      const auto &node = get_gltf_node_by_name(document, "instance-0");
+      CHECK_UNARY(!hasNode(document, "instance-1"));
+      CHECK_UNARY(!hasNode(document, "instance-2"));
+      CHECK_EQ(get_gltf_node_by_name(document, "group").children.size(), 4);
+      checkIdentity(node);
+      const auto instancing = getInstancing(node);
+      REQUIRE_NE(instancing, nullptr);
+      const auto &attributes = instancing->at("attributes");
+      for (const auto attribute : {"TRANSLATION", "ROTATION", "SCALE"}) {
+        REQUIRE_UNARY(attributes.contains(attribute));
+        const auto &accessor =
+            document.accessors[attributes.at(attribute).get<std::int32_t>()];
+        CHECK_EQ(accessor.count, 3);
+      }
+
+      // The others are moved or deformed on their own.
+      for (const auto name : {"animated", "deformed-0", "deformed-1"}) {
+        const auto &otherNode = get_gltf_node_by_name(document, name);
+        CHECK_GE(otherNode.mesh, 0);
+        CHECK_EQ(getInstancing(otherNode), nullptr);
+      }
+      checkExtension(document, true);
+    }
+
+    SUBCASE("Groups smaller than the minimum") {
+      options.gpuInstancing.min_instances = 4;
+      const auto result =
+          bee::_convert_test(fixture.path().u8string(), options);
+      const auto &document = result.document();
+      for (const auto name : {"instance-0", "instance-1", "instance-2"}) {
+        const auto &node = get_gltf_node_by_name(document, name);
+        CHECK_GE(node.mesh, 0);
+        CHECK_EQ(getInstancing(node), nullptr);
+      }
+      checkExtension(document, false);
+    }
+
+    SUBCASE("Quantized") {
+      options.meshQuantization.position_bits = 16;
+      const auto result =
+          bee::_convert_test(fixture.path().u8string(), options);
+      const auto &document = result.document();
+
+      // The instances are dequantized each, by the child drawing the mesh.
+      const auto &node = get_gltf_node_by_name(document, "instance-0");
+      CHECK_UNARY(!hasNode(document, "instance-1"));
+      CHECK_EQ(node.mesh, -1);
+      CHECK_EQ(getInstancing(node), nullptr);
+      checkIdentity(node);
+      REQUIRE_EQ(node.children.size(), 1);
+      const auto &meshNode = document.nodes[node.children[0]];
+      CHECK_GE(meshNode.mesh, 0);
+      checkIdentity(meshNode);
+      const auto instancing = getInstancing(meshNode);
+      REQUIRE_NE(instancing, nullptr);
+      const auto &attributes = instancing->at("attributes");
+      REQUIRE_UNARY(attributes.contains("TRANSLATION"));
+      CHECK_EQ(
+          document
+              .accessors[attributes.at("TRANSLATION").get<std::int32_t>()]
+              .count,
+          3);
+      CHECK_EQ(ranges::count(document.extensionsRequired,
+                             "KHR_mesh_quantization"),
+               1);
+      checkExtension(document, true);
+    }
+  }
 }
\ No newline at end of file
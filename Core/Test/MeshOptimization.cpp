@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <array>
+#include <bee/MeshOptimization.h>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+namespace {
+using Position = std::array<float, 3>;
+
+/// <summary>
+/// A `n_` × `n_` grid whose triangles are shuffled.
+/// </summary>
+void make_shuffled_grid(int n_,
+                        std::vector<Position> &positions_,
+                        std::vector<std::uint32_t> &indices_) {
+  for (int y = 0; y <= n_; ++y) {
+    for (int x = 0; x <= n_; ++x) {
+      positions_.push_back(
+          Position{static_cast<float>(x), static_cast<float>(y), 0.0f});
+    }
+  }
+  std::vector<std::array<std::uint32_t, 3>> triangles;
+  for (int y = 0; y < n_; ++y) {
+    for (int x = 0; x < n_; ++x) {
+      const auto vertex = [n_, x, y](int dx_, int dy_) {
+        return static_cast<std::uint32_t>((y + dy_) * (n_ + 1) + x + dx_);
+      };
+      triangles.push_back({vertex(0, 0), vertex(1, 0), vertex(1, 1)});
+      triangles.push_back({vertex(0, 0), vertex(1, 1), vertex(0, 1)});
+    }
+  }
+  std::shuffle(triangles.begin(), triangles.end(), std::mt19937{42});
+  for (const auto &triangle : triangles) {
+    indices_.insert(indices_.end(), triangle.begin(), triangle.end());
+  }
+}
+
+std::vector<std::array<std::uint32_t, 3>>
+sorted_triangles(const std::vector<std::uint32_t> &indices_) {
+  std::vector<std::array<std::uint32_t, 3>> triangles;
+  for (std::size_t i = 0; i < indices_.size(); i += 3) {
+    triangles.push_back({indices_[i], indices_[i + 1], indices_[i + 2]});
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+} // namespace
+
+TEST_CASE("Mesh optimization") {
+  std::vector<Position> positions;
+  std::vector<std::uint32_t> indices;
+  make_shuffled_grid(30, positions, indices);
+  const auto nVertices = static_cast<std::uint32_t>(positions.size());
+  const auto triangles = sorted_triangles(indices);
+  const auto shuffledRatio = bee::average_cache_miss_ratio(indices, nVertices);
+
+  SUBCASE("Vertex cache") {
+    bee::optimize_vertex_cache(indices, nVertices);
+    CHECK_EQ(sorted_triangles(indices), triangles);
+    const auto ratio = bee::average_cache_miss_ratio(indices, nVertices);
+    MESSAGE("ACMR " << shuffledRatio << " -> " << ratio);
+    CHECK_LT(ratio, 0.8f);
+  }
+
+  SUBCASE("Overdraw") {
+    bee::optimize_vertex_cache(indices, nVertices);
+    const auto cacheRatio = bee::average_cache_miss_ratio(indices, nVertices);
+    bee::optimize_overdraw(indices,
+                           reinterpret_cast<const std::byte *>(positions.data()),
+                           sizeof(Position), nVertices, 1.05f);
+    CHECK_EQ(sorted_triangles(indices), triangles);
+    // Cluster boundaries cost some misses, but not the cache order.
+    CHECK_LT(bee::average_cache_miss_ratio(indices, nVertices),
+             (cacheRatio + shuffledRatio) / 2);
+  }
+
+  SUBCASE("Vertex fetch") {
+    const auto oldIndices = indices;
+    auto vertices = positions;
+    bee::optimize_vertex_fetch(indices,
+                               reinterpret_cast<std::byte *>(vertices.data()),
+                               sizeof(Position), nVertices);
+    std::uint32_t nSeen = 0;
+    bool firstUseOrder = true;
+    bool sameVertices = true;
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+      firstUseOrder = firstUseOrder && indices[i] <= nSeen;
+      nSeen = std::max(nSeen, indices[i] + 1);
+      sameVertices =
+          sameVertices && vertices[indices[i]] == positions[oldIndices[i]];
+    }
+    CHECK_UNARY(firstUseOrder);
+    CHECK_UNARY(sameVertices);
+  }
+}
@@ -0,0 +1,138 @@
+#include <bee/MeshSimplification.h>
+#include <cmath>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <set>
+#include <vector>
+
+namespace {
+struct Vertex {
+  float position[3];
+  float uv[2];
+  std::uint32_t joint;
+};
+
+/// <summary>
+/// A `n_` × `n_` grid of unit squares, whose height is `height_(x, y)`.
+/// Its left and right halves are split by a UV seam if `seam_`.
+/// </summary>
+template <typename Height>
+void make_grid(int n_,
+               bool seam_,
+               Height height_,
+               std::vector<Vertex> &vertices_,
+               std::vector<std::uint32_t> &indices_) {
+  const auto half = n_ / 2;
+  const auto vertex = [&](int x_, int y_, bool right_) {
+    const auto column = seam_ && right_ && x_ >= half ? x_ + 1 : x_;
+    return static_cast<std::uint32_t>(y_ * (n_ + 2) + column);
+  };
+  for (int y = 0; y <= n_; ++y) {
+    for (int x = 0; x <= n_ + 1; ++x) {
+      const auto px = x > half && seam_ ? x - 1 : x;
+      const auto u =
+          static_cast<float>(px) / n_ + (seam_ && x > half ? 1.0f : 0.0f);
+      vertices_.push_back(Vertex{
+          {static_cast<float>(px), static_cast<float>(y), height_(px, y)},
+          {u, static_cast<float>(y) / n_},
+          0});
+    }
+  }
+  for (int y = 0; y < n_; ++y) {
+    for (int x = 0; x < n_; ++x) {
+      const auto right = x >= half;
+      const auto v00 = vertex(x, y, right);
+      const auto v10 = vertex(x + 1, y, right);
+      const auto v01 = vertex(x, y + 1, right);
+      const auto v11 = vertex(x + 1, y + 1, right);
+      indices_.insert(indices_.end(), {v00, v10, v11, v00, v11, v01});
+    }
+  }
+}
+
+bee::SimplificationVertices
+simplification_vertices(const std::vector<Vertex> &vertices_) {
+  bee::SimplificationVertices result;
+  result.data = reinterpret_cast<const std::byte *>(vertices_.data());
+  result.size = sizeof(Vertex);
+  result.count = static_cast<std::uint32_t>(vertices_.size());
+  result.attributes.push_back({offsetof(Vertex, uv), 2});
+  result.shared.emplace_back(offsetof(Vertex, joint), sizeof(std::uint32_t));
+  return result;
+}
+
+float flat(int, int) {
+  return 0;
+}
+} // namespace
+
+TEST_CASE("Simplify flat grid") {
+  std::vector<Vertex> vertices;
+  std::vector<std::uint32_t> indices;
+  make_grid(16, false, flat, vertices, indices);
+  const auto original = indices.size();
+
+  const auto error = bee::simplify_mesh(
+      indices, simplification_vertices(vertices), original / 4, 0.01f);
+  CHECK_LE(indices.size(), original / 4);
+  CHECK_EQ(indices.size() % 3, 0);
+  CHECK_LT(error, 1e-3f);
+
+  // The corners stay.
+  const std::set<std::uint32_t> kept{indices.begin(), indices.end()};
+  const auto row = 18u;
+  CHECK(kept.contains(0));
+  CHECK(kept.contains(16));
+  CHECK(kept.contains(16 * row));
+  CHECK(kept.contains(16 * row + 16));
+}
+
+TEST_CASE("Simplification keeps seams straight") {
+  std::vector<Vertex> vertices;
+  std::vector<std::uint32_t> indices;
+  make_grid(16, true, flat, vertices, indices);
+  const auto original = indices.size();
+
+  bee::simplify_mesh(indices, simplification_vertices(vertices),
+                     original / 4, 0.01f);
+  CHECK_LT(indices.size(), original / 2);
+
+  // Triangles stay on their side of the seam, so their UVs stay on theirs.
+  for (std::size_t i = 0; i < indices.size(); i += 3) {
+    const auto right = vertices[indices[i]].uv[0] > 1;
+    for (std::size_t k = 1; k < 3; ++k) {
+      const auto vertexRight = vertices[indices[i + k]].uv[0] > 1;
+      CHECK_EQ(vertexRight, right);
+    }
+  }
+}
+
+TEST_CASE("Simplification stops at the error") {
+  std::vector<Vertex> vertices;
+  std::vector<std::uint32_t> indices;
+  make_grid(
+      16, false,
+      [](int x_, int y_) {
+        return 4 * std::sin(x_ * 0.5f) * std::cos(y_ * 0.5f);
+      },
+      vertices, indices);
+  const auto original = indices.size();
+
+  const auto error = bee::simplify_mesh(
+      indices, simplification_vertices(vertices), 0, 0.001f);
+  CHECK_LE(error, 0.001f);
+  CHECK_GT(indices.size(), original / 4);
+}
+
+TEST_CASE("Simplification keeps vertices of different shared bytes") {
+  std::vector<Vertex> vertices;
+  std::vector<std::uint32_t> indices;
+  make_grid(8, false, flat, vertices, indices);
+  for (auto &vertex : vertices) {
+    vertex.joint = static_cast<std::uint32_t>(&vertex - vertices.data());
+  }
+  const auto original = indices.size();
+
+  bee::simplify_mesh(indices, simplification_vertices(vertices), 0, 1.0f);
+  CHECK_EQ(indices.size(), original);
+}
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <array>
+#include <bee/MeshoptCompression.h>
+#include <cmath>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <random>
+#include <vector>
+
+namespace {
+// Decoders as the EXT_meshopt_compression specification describes them.
+
+class StreamReader {
+public:
+  StreamReader(const std::vector<std::byte> &stream_) : _stream(stream_) {
+  }
+
+  std::size_t position() const {
+    return _position;
+  }
+
+  std::uint8_t byte() {
+    return static_cast<std::uint8_t>(_stream.at(_position++));
+  }
+
+  std::uint32_t vbyte() {
+    std::uint32_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      const auto next = byte();
+      value |= std::uint32_t{next & 127u} << shift;
+      if (next < 128) {
+        return value;
+      }
+    }
+  }
+
+private:
+  const std::vector<std::byte> &_stream;
+  std::size_t _position = 0;
+};
+
+std::uint32_t unzigzag(std::uint32_t value_) {
+  return (value_ >> 1) ^ (0u - (value_ & 1));
+}
+
+std::vector<std::byte> decode_attributes(const std::vector<std::byte> &stream_,
+                                         std::size_t count_,
+                                         std::size_t stride_) {
+  StreamReader reader{stream_};
+  const auto header = reader.byte();
+  REQUIRE_EQ(header, 0xa0);
+  const auto blockSize = std::min<std::size_t>((8192 / stride_) & ~15, 256);
+  std::vector<std::uint8_t> last(stride_);
+  std::memcpy(last.data(), stream_.data() + stream_.size() - stride_, stride_);
+  std::vector<std::byte> out(count_ * stride_);
+  for (std::size_t iFirst = 0; iFirst < count_; iFirst += blockSize) {
+    const auto nBlock = std::min(blockSize, count_ - iFirst);
+    const auto nGroups = (nBlock + 15) / 16;
+    for (std::size_t k = 0; k < stride_; ++k) {
+      std::vector<std::uint8_t> headers((nGroups + 3) / 4);
+      for (auto &header : headers) {
+        header = reader.byte();
+      }
+      std::vector<std::uint8_t> deltas(nGroups * 16);
+      for (std::size_t iGroup = 0; iGroup < nGroups; ++iGroup) {
+        const auto group = deltas.data() + 16 * iGroup;
+        const auto bits = 1 << ((headers[iGroup / 4] >> (iGroup % 4 * 2)) & 3);
+        if (bits == 1) {
+          continue;
+        }
+        if (bits == 8) {
+          for (int i = 0; i < 16; ++i) {
+            group[i] = reader.byte();
+          }
+          continue;
+        }
+        const auto perByte = 8 / bits;
+        const auto sentinel = (1 << bits) - 1;
+        for (int i = 0; i < 16; i += perByte) {
+          const auto packed = reader.byte();
+          for (int j = 0; j < perByte; ++j) {
+            group[i + j] = (packed >> ((perByte - 1 - j) * bits)) & sentinel;
+          }
+        }
+        for (int i = 0; i < 16; ++i) {
+          if (group[i] == sentinel) {
+            group[i] = reader.byte();
+          }
+        }
+      }
+      for (std::size_t iVertex = 0; iVertex < nBlock; ++iVertex) {
+        const auto delta = deltas[iVertex];
+        last[k] += static_cast<std::uint8_t>((delta >> 1) ^ (0u - (delta & 1)));
+        out[(iFirst + iVertex) * stride_ + k] = static_cast<std::byte>(last[k]);
+      }
+    }
+  }
+  const auto tailSize = std::max<std::size_t>(stride_, 32);
+  CHECK_EQ(reader.position(), stream_.size() - tailSize);
+  return out;
+}
+
+std::vector<std::uint32_t>
+decode_triangles(const std::vector<std::byte> &stream_, std::size_t count_) {
+  StreamReader codes{stream_};
+  const auto header = codes.byte();
+  REQUIRE_EQ(header, 0xe1);
+  std::vector<std::byte> dataStream(stream_.begin() + 1 + count_ / 3,
+                                    stream_.end());
+  StreamReader data{dataStream};
+  const auto table = stream_.data() + stream_.size() - 16;
+
+  std::array<std::array<std::uint32_t, 2>, 16> edgeFifo{};
+  std::array<std::uint32_t, 16> vertexFifo{};
+  std::size_t edgeOffset = 0;
+  std::size_t vertexOffset = 0;
+  const auto pushEdge = [&](std::uint32_t a_, std::uint32_t b_) {
+    edgeFifo[edgeOffset++ & 15] = {a_, b_};
+  };
+  const auto pushVertex = [&](std::uint32_t v_) {
+    vertexFifo[vertexOffset++ & 15] = v_;
+  };
+  const auto fifoVertex = [&](int code_) {
+    return vertexFifo[(vertexOffset - code_) & 15];
+  };
+
+  std::uint32_t next = 0;
+  std::uint32_t last = 0;
+  const auto readIndex = [&]() { return last += unzigzag(data.vbyte()); };
+  std::vector<std::uint32_t> indices;
+  for (std::size_t i = 0; i < count_; i += 3) {
+    const auto code = codes.byte();
+    if (code < 0xf0) {
+      const auto [a, b] = edgeFifo[(edgeOffset - 1 - (code >> 4)) & 15];
+      const int fec = code & 15;
+      std::uint32_t c = 0;
+      if (fec == 0) {
+        c = next++;
+      } else if (fec < 13) {
+        c = vertexFifo[(vertexOffset - 1 - fec) & 15];
+      } else if (fec == 13) {
+        c = --last;
+      } else if (fec == 14) {
+        c = ++last;
+      } else {
+        c = readIndex();
+      }
+      if (fec == 0 || fec >= 13) {
+        pushVertex(c);
+      }
+      indices.insert(indices.end(), {a, b, c});
+      pushEdge(c, b);
+      pushEdge(a, c);
+      continue;
+    }
+    std::uint8_t codeAux = 0;
+    int fea = 0;
+    if (code < 0xfe) {
+      codeAux = static_cast<std::uint8_t>(table[code & 15]);
+    } else {
+      codeAux = data.byte();
+      fea = code == 0xfe ? 0 : 15;
+      if (codeAux == 0) {
+        next = 0;
+        vertexFifo.fill(0);
+      }
+    }
+    const int feb = codeAux >> 4;
+    const int fec = codeAux & 15;
+    const auto a = fea == 0 ? next++ : readIndex();
+    const auto b = feb == 0 ? next++ : feb < 15 ? fifoVertex(feb) : readIndex();
+    const auto c = fec == 0 ? next++ : fec < 15 ? fifoVertex(fec) : readIndex();
+    pushVertex(a);
+    if (feb == 0 || feb == 15) {
+      pushVertex(b);
+    }
+    if (fec == 0 || fec == 15) {
+      pushVertex(c);
+    }
+    indices.insert(indices.end(), {a, b, c});
+    pushEdge(b, a);
+    pushEdge(c, b);
+    pushEdge(a, c);
+  }
+  CHECK_EQ(1 + count_ / 3 + data.position() + 16, stream_.size());
+  return indices;
+}
+
+std::vector<std::uint32_t> decode_indices(const std::vector<std::byte> &stream_,
+                                          std::size_t count_) {
+  StreamReader reader{stream_};
+  const auto header = reader.byte();
+  REQUIRE_EQ(header, 0xd1);
+  std::array<std::uint32_t, 2> last = {0, 0};
+  std::vector<std::uint32_t> indices;
+  for (std::size_t i = 0; i < count_; ++i) {
+    const auto value = reader.vbyte();
+    const auto current = value & 1;
+    last[current] += unzigzag(value >> 1);
+    indices.push_back(last[current]);
+  }
+  CHECK_EQ(reader.position() + 4, stream_.size());
+  return indices;
+}
+
+template <typename Ty_>
+std::span<std::byte> as_bytes(std::vector<Ty_> &values_) {
+  return std::as_writable_bytes(std::span{values_});
+}
+
+/// <summary>
+/// Triangles of a `n_` × `n_` grid, rotated so that they aren't all alike.
+/// </summary>
+std::vector<std::uint32_t> make_grid_triangles(std::uint32_t n_) {
+  std::vector<std::uint32_t> indices;
+  for (std::uint32_t y = 0; y < n_; ++y) {
+    for (std::uint32_t x = 0; x < n_; ++x) {
+      const auto v = y * (n_ + 1) + x;
+      indices.insert(indices.end(), {v, v + 1, v + n_ + 2});
+      if (x % 3 == 0) {
+        indices.insert(indices.end(), {v + n_ + 1, v, v + n_ + 2});
+      } else {
+        indices.insert(indices.end(), {v, v + n_ + 2, v + n_ + 1});
+      }
+    }
+  }
+  return indices;
+}
+} // namespace
+
+TEST_CASE("Meshopt compression") {
+  std::mt19937 random{7};
+
+  SUBCASE("Attributes") {
+    for (const std::size_t stride : {4, 12, 36}) {
+      std::vector<std::byte> data(1000 * stride);
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        // Slowly changing values with some noise.
+        const auto base = static_cast<int>(i / stride / 3 + i % stride * 17);
+        data[i] = static_cast<std::byte>(base + random() % 3);
+      }
+      const bee::MeshoptEncoding encoding{bee::MeshoptMode::attributes,
+                                          static_cast<std::uint32_t>(stride)};
+      const auto stream = bee::encode_meshopt(data, encoding);
+      CHECK_LT(stream.size(), data.size());
+      CHECK_EQ(decode_attributes(stream, 1000, stride), data);
+    }
+  }
+
+  SUBCASE("Triangles") {
+    auto indices = make_grid_triangles(20);
+    // Another mesh appended restarts from vertex 0.
+    auto more = make_grid_triangles(3);
+    indices.insert(indices.end(), more.begin(), more.end());
+    std::vector<std::uint16_t> shorts(indices.begin(), indices.end());
+    const bee::MeshoptEncoding encoding{bee::MeshoptMode::triangles, 2};
+    const auto stream = bee::encode_meshopt(as_bytes(shorts), encoding);
+    // About 2 bytes a triangle, rather than 6.
+    CHECK_LT(stream.size(), shorts.size());
+    const auto decoded = decode_triangles(stream, indices.size());
+    // Triangles may be rotated, but not flipped.
+    bool sameTriangles = decoded.size() == indices.size();
+    for (std::size_t i = 0; sameTriangles && i < indices.size(); i += 3) {
+      const std::array triangle = {indices[i], indices[i + 1], indices[i + 2]};
+      bool rotated = false;
+      for (int r = 0; r < 3; ++r) {
+        rotated = rotated || (decoded[i] == triangle[r] &&
+                              decoded[i + 1] == triangle[(r + 1) % 3] &&
+                              decoded[i + 2] == triangle[(r + 2) % 3]);
+      }
+      sameTriangles = rotated;
+    }
+    CHECK_UNARY(sameTriangles);
+
+    CHECK_FALSE(bee::is_meshopt_encodable(encoding, 8));
+  }
+
+  SUBCASE("Indices") {
+    std::vector<std::uint32_t> indices;
+    for (std::uint32_t i = 0; i < 500; ++i) {
+      indices.push_back(i * 3 + random() % 2);
+      indices.push_back(100000 + i);
+    }
+    const bee::MeshoptEncoding encoding{bee::MeshoptMode::indices, 4};
+    const auto stream = bee::encode_meshopt(as_bytes(indices), encoding);
+    CHECK_LT(stream.size(), indices.size() * 2);
+    CHECK_EQ(decode_indices(stream, indices.size()), indices);
+  }
+
+  SUBCASE("Octahedral filter") {
+    std::vector<std::int16_t> normals;
+    std::normal_distribution<float> distribution;
+    for (int i = 0; i < 100; ++i) {
+      std::array<float, 3> v = {distribution(random), distribution(random),
+                                distribution(random)};
+      const auto length = std::hypot(v[0], v[1], v[2]);
+      for (const auto c : v) {
+        normals.push_back(static_cast<std::int16_t>(c / length * 32767));
+      }
+      normals.push_back(0);
+    }
+    auto filtered = normals;
+    const bee::MeshoptEncoding encoding{bee::MeshoptMode::attributes, 8,
+                                        bee::MeshoptFilter::octahedral, 12};
+    bee::encode_meshopt_filter(as_bytes(filtered), encoding);
+    bee::decode_meshopt_filter(as_bytes(filtered), encoding);
+    float maxError = 0;
+    for (std::size_t i = 0; i < normals.size(); ++i) {
+      maxError = std::max(maxError,
+                          std::abs(normals[i] - filtered[i]) / 32767.0f);
+    }
+    CHECK_LT(maxError, 0.002f);
+  }
+
+  SUBCASE("Quaternion filter") {
+    std::vector<std::int16_t> quaternions;
+    std::normal_distribution<float> distribution;
+    for (int i = 0; i < 100; ++i) {
+      std::array<float, 4> q = {distribution(random), distribution(random),
+                                distribution(random), distribution(random)};
+      const auto length =
+          std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+      for (const auto c : q) {
+        quaternions.push_back(static_cast<std::int16_t>(c / length * 32767));
+      }
+    }
+    auto filtered = quaternions;
+    const bee::MeshoptEncoding encoding{bee::MeshoptMode::attributes, 8,
+                                        bee::MeshoptFilter::quaternion, 12};
+    bee::encode_meshopt_filter(as_bytes(filtered), encoding);
+    bee::decode_meshopt_filter(as_bytes(filtered), encoding);
+    // q and -q are the same rotation.
+    float maxError = 0;
+    for (std::size_t i = 0; i < quaternions.size(); i += 4) {
+      float dot = 0;
+      for (int c = 0; c < 4; ++c) {
+        dot += quaternions[i + c] / 32767.0f * (filtered[i + c] / 32767.0f);
+      }
+      maxError = std::max(maxError, 1 - std::abs(dot));
+    }
+    CHECK_LT(maxError, 0.0001f);
+  }
+
+  SUBCASE("Exponential filter") {
+    std::vector<float> values = {1.0f,   -0.5f, 1000.0f, 3.25f, 0.0f,
+                                 1e-6f, 12.5f,  -7.0f,   0.1f};
+    auto filtered = values;
+    const bee::MeshoptEncoding encoding{bee::MeshoptMode::attributes, 12,
+                                        bee::MeshoptFilter::exponential, 16};
+    bee::encode_meshopt_filter(as_bytes(filtered), encoding);
+    bee::decode_meshopt_filter(as_bytes(filtered), encoding);
+    for (std::size_t i = 0; i < values.size(); i += 3) {
+      // The largest component of each element keeps 15 bits.
+      const auto largest = std::max({std::abs(values[i]),
+                                     std::abs(values[i + 1]),
+                                     std::abs(values[i + 2])});
+      for (int c = 0; c < 3; ++c) {
+        CHECK_LE(std::abs(filtered[i + c] - values[i + c]),
+                 largest / (1 << 14));
+      }
+    }
+    // Filtering what's filtered changes nothing.
+    auto refiltered = filtered;
+    bee::encode_meshopt_filter(as_bytes(refiltered), encoding);
+    bee::decode_meshopt_filter(as_bytes(refiltered), encoding);
+    CHECK_EQ(refiltered, filtered);
+  }
+}
@@ -0,0 +1,53 @@
+#include <bee/ThreadPool.h>
+#include <atomic>
+#include <doctest/doctest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Thread pool") {
+  SUBCASE("Runs each task once") {
+    for (const std::uint32_t threads : {0u, 1u, 4u}) {
+      bee::ThreadPool threadPool{threads};
+      std::vector<std::atomic<int>> runs(1000);
+      threadPool.parallel_for(runs.size(),
+                              [&runs](std::size_t index_) { ++runs[index_]; });
+      bool once = true;
+      for (const auto &run : runs) {
+        once = once && run == 1;
+      }
+      CHECK_UNARY(once);
+    }
+  }
+
+  SUBCASE("Concurrent callers") {
+    bee::ThreadPool threadPool{3};
+    std::atomic<std::size_t> sum = 0;
+    std::vector<std::thread> callers;
+    for (int iCaller = 0; iCaller < 4; ++iCaller) {
+      callers.emplace_back([&threadPool, &sum]() {
+        threadPool.parallel_for(
+            100, [&sum](std::size_t index_) { sum += index_; });
+      });
+    }
+    for (auto &caller : callers) {
+      caller.join();
+    }
+    CHECK_EQ(sum.load(), 4 * (99 * 100 / 2));
+  }
+
+  SUBCASE("Rethrows") {
+    bee::ThreadPool threadPool{2};
+    std::atomic<int> runs = 0;
+    CHECK_THROWS_AS(threadPool.parallel_for(10,
+                                            [&runs](std::size_t index_) {
+                                              ++runs;
+                                              if (index_ == 3) {
+                                                throw std::runtime_error("3");
+                                              }
+                                            }),
+                    std::runtime_error);
+    // The others still ran.
+    CHECK_EQ(runs.load(), 10);
+  }
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <array>
+#include <bee/UntypedVertex.h>
+#include <chrono>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+/// <summary>
+/// A PNT vertex.
+/// </summary>
+using Vertex = std::array<float, 8>;
+
+/// <summary>
+/// Polygon vertices of a smooth `n_` × `n_` grid whose quads are each
+/// unwrapped on their own, as in lightmap UVs: all vertices at a position
+/// share the position and the normal, and differ by UVs only.
+/// </summary>
+std::vector<Vertex> make_seamed_grid(int n_) {
+  std::vector<Vertex> polygonVertices;
+  polygonVertices.reserve(std::size_t{6} * n_ * n_);
+  for (int y = 0; y < n_; ++y) {
+    for (int x = 0; x < n_; ++x) {
+      const auto corner = [&](int dx_, int dy_) {
+        const auto px = static_cast<float>(x + dx_);
+        const auto py = static_cast<float>(y + dy_);
+        return Vertex{px,   py,   0.0f, 0.0f, 0.0f, 1.0f,
+                      static_cast<float>(x * 2 + dx_),
+                      static_cast<float>(y * 2 + dy_)};
+      };
+      for (const auto &[dx, dy] :
+           {std::pair{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}}) {
+        polygonVertices.push_back(corner(dx, dy));
+      }
+    }
+  }
+  return polygonVertices;
+}
+
+std::vector<std::uint32_t> dedup_with_table(const std::vector<Vertex> &vertices_,
+                                            bee::UntypedVertexVector &unique_) {
+  bee::UntypedVertexTable<sizeof(Vertex)> table{unique_, sizeof(Vertex),
+                                                vertices_.size()};
+  std::vector<std::uint32_t> indices(vertices_.size());
+  for (std::size_t i = 0; i < vertices_.size(); ++i) {
+    indices[i] =
+        table.insert(reinterpret_cast<const std::byte *>(vertices_[i].data()))
+            .first;
+  }
+  return indices;
+}
+
+/// <summary>
+/// How vertices were deduplicated before `UntypedVertexTable`: a node-based
+/// map hashing the first 24 bytes.
+/// </summary>
+std::vector<std::uint32_t>
+dedup_with_unordered_map(const std::vector<Vertex> &vertices_,
+                         bee::UntypedVertexVector &unique_) {
+  const auto hasher = [](const bee::UntypedVertex &vertex_) {
+    const auto hasher = std::hash<double>{};
+    std::size_t seed = 5381;
+    for (int i = 0; i < 3; ++i) {
+      double value;
+      std::memcpy(&value, vertex_ + sizeof(double) * i, sizeof(value));
+      seed ^= hasher(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  };
+  std::unordered_map<bee::UntypedVertex, std::uint32_t, decltype(hasher),
+                     bee::UntypedVertexEqual<>>
+      map({}, 0, hasher, bee::UntypedVertexEqual<>{sizeof(Vertex)});
+  std::vector<std::uint32_t> indices(vertices_.size());
+  auto staging = unique_.allocate();
+  for (std::size_t i = 0; i < vertices_.size(); ++i) {
+    auto [data, index] = staging;
+    std::memcpy(data, vertices_[i].data(), sizeof(Vertex));
+    auto [inserted, success] = map.try_emplace(data, index);
+    if (success) {
+      staging = unique_.allocate();
+    }
+    indices[i] = inserted->second;
+  }
+  unique_.pop_back();
+  return indices;
+}
+} // namespace
+
+TEST_CASE("Untyped vertex table") {
+  const auto polygonVertices = make_seamed_grid(20);
+
+  bee::UntypedVertexVector expectedVertices{sizeof(Vertex),
+                                           polygonVertices.size()};
+  const auto expected =
+      dedup_with_unordered_map(polygonVertices, expectedVertices);
+
+  // Expecting a single vertex makes the table grow a few times.
+  bee::UntypedVertexVector vertices{sizeof(Vertex), polygonVertices.size()};
+  bee::UntypedVertexTable<> table{vertices, sizeof(Vertex), 1};
+  std::vector<std::uint32_t> indices;
+  for (const auto &vertex : polygonVertices) {
+    indices.push_back(
+        table.insert(reinterpret_cast<const std::byte *>(vertex.data()))
+            .first);
+  }
+
+  CHECK_EQ(vertices.size(), 20 * 20 * 4);
+  CHECK_EQ(vertices.size(), expectedVertices.size());
+  CHECK_EQ(indices, expected);
+  const auto data = vertices.data();
+  const auto expectedData = expectedVertices.data();
+  CHECK_EQ(data.size(), sizeof(Vertex) * vertices.size());
+  CHECK(std::equal(data.begin(), data.end(), expectedData.begin(),
+                   expectedData.end()));
+}
+
+TEST_CASE("Vertex dedup throughput" * doctest::skip()) {
+  const auto polygonVertices = make_seamed_grid(1000);
+  const auto measure = [&](const char *name_, auto dedup_) {
+    bee::UntypedVertexVector unique{sizeof(Vertex), polygonVertices.size()};
+    const auto start = std::chrono::steady_clock::now();
+    const auto indices = dedup_(polygonVertices, unique);
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    MESSAGE(name_ << ": " << polygonVertices.size() << " polygon vertices, "
+                  << unique.size() << " unique, "
+                  << polygonVertices.size() / elapsed.count() / 1e6
+                  << " M/s");
+    return indices;
+  };
+  const auto before =
+      measure("std::unordered_map, 24-byte hash", dedup_with_unordered_map);
+  const auto after =
+      measure("UntypedVertexTable, full-vertex hash", dedup_with_table);
+  CHECK_EQ(before, after);
+}